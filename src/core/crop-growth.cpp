@@ -43,13 +43,13 @@ using namespace Tools;
  * @brief Constructor
  * @param sc Soil column
  * @param gps General parameters
- * @param cps crop parameters
+ * @param cps shared crop parameters, are kept by the crop
  * @param stps site parameters
  *
  * @author Claas Nendel
  */
 CropGrowth::CropGrowth(SoilColumn& sc,
-											 const CropParameters& cps,
+											 CropParametersPtr cps,
 											 const SiteParameters& stps,
 											 const UserCropParameters& cropPs,
 											 const SimulationParameters& simPs,
@@ -59,104 +59,106 @@ CropGrowth::CropGrowth(SoilColumn& sc,
 	: _frostKillOn(simPs.pc_FrostKillOn)
 	, soilColumn(sc)
 	, cropPs(cropPs)
-	, speciesPs(cps.speciesParams)
-	, cultivarPs(cps.cultivarParams)
+	, _cropParams(cps)
+	, speciesPs(cps->speciesParams)
+	, cultivarPs(cps->cultivarParams)
 	, vs_Latitude(stps.vs_Latitude)
-	, pc_AbovegroundOrgan(cps.speciesParams.pc_AbovegroundOrgan)
-	, pc_AssimilatePartitioningCoeff(cps.cultivarParams.pc_AssimilatePartitioningCoeff)
-	, pc_AssimilateReallocation(cps.speciesParams.pc_AssimilateReallocation)
-	, pc_BaseDaylength(cps.cultivarParams.pc_BaseDaylength)
-	, pc_BaseTemperature(cps.speciesParams.pc_BaseTemperature)
-	, pc_BeginSensitivePhaseHeatStress(cps.cultivarParams.pc_BeginSensitivePhaseHeatStress)
-	, pc_CarboxylationPathway(cps.speciesParams.pc_CarboxylationPathway)
-	//  , pc_CO2Method(cps.pc_CO2Method)
-	, pc_CriticalOxygenContent(cps.speciesParams.pc_CriticalOxygenContent)
-	, pc_CriticalTemperatureHeatStress(cps.cultivarParams.pc_CriticalTemperatureHeatStress)
-	, pc_CropHeightP1(cps.cultivarParams.pc_CropHeightP1)
-	, pc_CropHeightP2(cps.cultivarParams.pc_CropHeightP2)
-	, pc_CropName(cps.pc_CropName())
-	, pc_CropSpecificMaxRootingDepth(cps.cultivarParams.pc_CropSpecificMaxRootingDepth)
-	, vc_CurrentTemperatureSum(cps.speciesParams.pc_NumberOfDevelopmentalStages(), 0.0)
-	, pc_CuttingDelayDays(cps.speciesParams.pc_CuttingDelayDays)
-	, pc_DaylengthRequirement(cps.cultivarParams.pc_DaylengthRequirement)
-	, pc_DefaultRadiationUseEfficiency(cps.speciesParams.pc_DefaultRadiationUseEfficiency)
-	, pc_DevelopmentAccelerationByNitrogenStress(cps.speciesParams.pc_DevelopmentAccelerationByNitrogenStress)
-	, pc_DroughtStressThreshold(cps.cultivarParams.pc_DroughtStressThreshold)
-	, pc_DroughtImpactOnFertilityFactor(cps.speciesParams.pc_DroughtImpactOnFertilityFactor)
+	, _solarGeometry(solarGeometryFor(stps.vs_Latitude))
+	, pc_AbovegroundOrgan(cps->speciesParams.pc_AbovegroundOrgan)
+	, pc_AssimilatePartitioningCoeff(cps->cultivarParams.pc_AssimilatePartitioningCoeff)
+	, pc_AssimilateReallocation(cps->speciesParams.pc_AssimilateReallocation)
+	, pc_BaseDaylength(cps->cultivarParams.pc_BaseDaylength)
+	, pc_BaseTemperature(cps->speciesParams.pc_BaseTemperature)
+	, pc_BeginSensitivePhaseHeatStress(cps->cultivarParams.pc_BeginSensitivePhaseHeatStress)
+	, pc_CarboxylationPathway(cps->speciesParams.pc_CarboxylationPathway)
+	//  , pc_CO2Method(cps->pc_CO2Method)
+	, pc_CriticalOxygenContent(cps->speciesParams.pc_CriticalOxygenContent)
+	, pc_CriticalTemperatureHeatStress(cps->cultivarParams.pc_CriticalTemperatureHeatStress)
+	, pc_CropHeightP1(cps->cultivarParams.pc_CropHeightP1)
+	, pc_CropHeightP2(cps->cultivarParams.pc_CropHeightP2)
+	, pc_CropName(cps->pc_CropName())
+	, pc_CropSpecificMaxRootingDepth(cps->cultivarParams.pc_CropSpecificMaxRootingDepth)
+	, vc_CurrentTemperatureSum(cps->speciesParams.pc_NumberOfDevelopmentalStages(), 0.0)
+	, pc_CuttingDelayDays(cps->speciesParams.pc_CuttingDelayDays)
+	, pc_DaylengthRequirement(cps->cultivarParams.pc_DaylengthRequirement)
+	, pc_DefaultRadiationUseEfficiency(cps->speciesParams.pc_DefaultRadiationUseEfficiency)
+	, pc_DevelopmentAccelerationByNitrogenStress(cps->speciesParams.pc_DevelopmentAccelerationByNitrogenStress)
+	, pc_DroughtStressThreshold(cps->cultivarParams.pc_DroughtStressThreshold)
+	, pc_DroughtImpactOnFertilityFactor(cps->speciesParams.pc_DroughtImpactOnFertilityFactor)
 	, pc_EmergenceFloodingControlOn(simPs.pc_EmergenceFloodingControlOn)
 	, pc_EmergenceMoistureControlOn(simPs.pc_EmergenceMoistureControlOn)
-	, pc_EndSensitivePhaseHeatStress(cps.cultivarParams.pc_EndSensitivePhaseHeatStress)
-	, pc_FieldConditionModifier(cps.speciesParams.pc_FieldConditionModifier)
+	, pc_EndSensitivePhaseHeatStress(cps->cultivarParams.pc_EndSensitivePhaseHeatStress)
+	, pc_FieldConditionModifier(cps->speciesParams.pc_FieldConditionModifier)
 	, vo_FreshSoilOrganicMatter(soilColumn.vs_NumberOfLayers(), 0.0)
-	, pc_FrostDehardening(cps.cultivarParams.pc_FrostDehardening)
-	, pc_FrostHardening(cps.cultivarParams.pc_FrostHardening)
-	, pc_HeatSumIrrigationStart(cps.cultivarParams.pc_HeatSumIrrigationStart)
-	, pc_HeatSumIrrigationEnd(cps.cultivarParams.pc_HeatSumIrrigationEnd)
+	, pc_FrostDehardening(cps->cultivarParams.pc_FrostDehardening)
+	, pc_FrostHardening(cps->cultivarParams.pc_FrostHardening)
+	, pc_HeatSumIrrigationStart(cps->cultivarParams.pc_HeatSumIrrigationStart)
+	, pc_HeatSumIrrigationEnd(cps->cultivarParams.pc_HeatSumIrrigationEnd)
 	, vs_HeightNN(stps.vs_HeightNN)
-	, pc_InitialKcFactor(cps.speciesParams.pc_InitialKcFactor)
-	, pc_InitialOrganBiomass(cps.speciesParams.pc_InitialOrganBiomass)
-	, pc_InitialRootingDepth(cps.speciesParams.pc_InitialRootingDepth)
-	, vc_sunlitLeafAreaIndex(24)
-	, vc_shadedLeafAreaIndex(24)
-	, pc_LowTemperatureExposure(cps.cultivarParams.pc_LowTemperatureExposure)
-	, pc_LimitingTemperatureHeatStress(cps.speciesParams.pc_LimitingTemperatureHeatStress)
-	, pc_LT50cultivar(cps.cultivarParams.pc_LT50cultivar)
-	, pc_LuxuryNCoeff(cps.speciesParams.pc_LuxuryNCoeff)
-	, pc_MaxAssimilationRate(cps.cultivarParams.pc_MaxAssimilationRate)
-	, pc_MaxCropDiameter(cps.speciesParams.pc_MaxCropDiameter)
-	, pc_MaxCropHeight(cps.cultivarParams.pc_MaxCropHeight)
-	, pc_MaxNUptakeParam(cps.speciesParams.pc_MaxNUptakeParam)
-	, pc_MinimumNConcentration(cps.speciesParams.pc_MinimumNConcentration)
-	, pc_MinimumTemperatureForAssimilation(cps.speciesParams.pc_MinimumTemperatureForAssimilation)
-	, pc_MaximumTemperatureForAssimilation(cps.speciesParams.pc_MaximumTemperatureForAssimilation)
-	, pc_OptimumTemperatureForAssimilation(cps.speciesParams.pc_OptimumTemperatureForAssimilation)
-	, pc_MinimumTemperatureRootGrowth(cps.speciesParams.pc_MinimumTemperatureRootGrowth)
-	, pc_NConcentrationAbovegroundBiomass(cps.speciesParams.pc_NConcentrationAbovegroundBiomass)
-	, pc_NConcentrationB0(cps.speciesParams.pc_NConcentrationB0)
-	, pc_NConcentrationPN(cps.speciesParams.pc_NConcentrationPN)
-	, pc_NConcentrationRoot(cps.speciesParams.pc_NConcentrationRoot)
+	, pc_InitialKcFactor(cps->speciesParams.pc_InitialKcFactor)
+	, pc_InitialOrganBiomass(cps->speciesParams.pc_InitialOrganBiomass)
+	, pc_InitialRootingDepth(cps->speciesParams.pc_InitialRootingDepth)
+	, vc_sunlitLeafAreaIndex()
+	, vc_shadedLeafAreaIndex()
+	, pc_LowTemperatureExposure(cps->cultivarParams.pc_LowTemperatureExposure)
+	, pc_LimitingTemperatureHeatStress(cps->speciesParams.pc_LimitingTemperatureHeatStress)
+	, pc_LT50cultivar(cps->cultivarParams.pc_LT50cultivar)
+	, pc_LuxuryNCoeff(cps->speciesParams.pc_LuxuryNCoeff)
+	, pc_MaxAssimilationRate(cps->cultivarParams.pc_MaxAssimilationRate)
+	, pc_MaxCropDiameter(cps->speciesParams.pc_MaxCropDiameter)
+	, pc_MaxCropHeight(cps->cultivarParams.pc_MaxCropHeight)
+	, pc_MaxNUptakeParam(cps->speciesParams.pc_MaxNUptakeParam)
+	, pc_MinimumNConcentration(cps->speciesParams.pc_MinimumNConcentration)
+	, pc_MinimumTemperatureForAssimilation(cps->speciesParams.pc_MinimumTemperatureForAssimilation)
+	, pc_MaximumTemperatureForAssimilation(cps->speciesParams.pc_MaximumTemperatureForAssimilation)
+	, pc_OptimumTemperatureForAssimilation(cps->speciesParams.pc_OptimumTemperatureForAssimilation)
+	, pc_MinimumTemperatureRootGrowth(cps->speciesParams.pc_MinimumTemperatureRootGrowth)
+	, pc_NConcentrationAbovegroundBiomass(cps->speciesParams.pc_NConcentrationAbovegroundBiomass)
+	, pc_NConcentrationB0(cps->speciesParams.pc_NConcentrationB0)
+	, pc_NConcentrationPN(cps->speciesParams.pc_NConcentrationPN)
+	, pc_NConcentrationRoot(cps->speciesParams.pc_NConcentrationRoot)
 	, pc_NitrogenResponseOn(simPs.pc_NitrogenResponseOn)
-	, pc_NumberOfDevelopmentalStages(cps.speciesParams.pc_NumberOfDevelopmentalStages())
-	, pc_NumberOfOrgans(cps.speciesParams.pc_NumberOfOrgans())
+	, pc_NumberOfDevelopmentalStages(cps->speciesParams.pc_NumberOfDevelopmentalStages())
+	, pc_NumberOfOrgans(cps->speciesParams.pc_NumberOfOrgans())
 	, vc_NUptakeFromLayer(soilColumn.vs_NumberOfLayers(), 0.0)
-	, pc_OptimumTemperature(cps.cultivarParams.pc_OptimumTemperature)
+	, pc_OptimumTemperature(cps->cultivarParams.pc_OptimumTemperature)
 	, vc_OrganBiomass(pc_NumberOfOrgans, 0.0)
-	, vc_OrganDeadBiomass(cps.speciesParams.pc_NumberOfOrgans(), 0.0)
-	, vc_OrganGreenBiomass(cps.speciesParams.pc_NumberOfOrgans(), 0.0)
+	, vc_OrganDeadBiomass(cps->speciesParams.pc_NumberOfOrgans(), 0.0)
+	, vc_OrganGreenBiomass(cps->speciesParams.pc_NumberOfOrgans(), 0.0)
 	, vc_OrganGrowthIncrement(pc_NumberOfOrgans, 0.0)
-	, pc_OrganGrowthRespiration(cps.speciesParams.pc_OrganGrowthRespiration)
-	, pc_OrganIdsForPrimaryYield(cps.cultivarParams.pc_OrganIdsForPrimaryYield)
-	, pc_OrganIdsForSecondaryYield(cps.cultivarParams.pc_OrganIdsForSecondaryYield)
-	, pc_OrganIdsForCutting(cps.cultivarParams.pc_OrganIdsForCutting)
-	, pc_OrganMaintenanceRespiration(cps.speciesParams.pc_OrganMaintenanceRespiration)
+	, pc_OrganGrowthRespiration(cps->speciesParams.pc_OrganGrowthRespiration)
+	, pc_OrganIdsForPrimaryYield(cps->cultivarParams.pc_OrganIdsForPrimaryYield)
+	, pc_OrganIdsForSecondaryYield(cps->cultivarParams.pc_OrganIdsForSecondaryYield)
+	, pc_OrganIdsForCutting(cps->cultivarParams.pc_OrganIdsForCutting)
+	, pc_OrganMaintenanceRespiration(cps->speciesParams.pc_OrganMaintenanceRespiration)
 	, vc_OrganSenescenceIncrement(pc_NumberOfOrgans, 0.0)
-	, pc_OrganSenescenceRate(cps.cultivarParams.pc_OrganSenescenceRate)
-	, pc_PartBiologicalNFixation(cps.speciesParams.pc_PartBiologicalNFixation)
-	, pc_Perennial(cps.cultivarParams.pc_Perennial)
-	, pc_PlantDensity(cps.speciesParams.pc_PlantDensity)
-	, pc_ResidueNRatio(cps.cultivarParams.pc_ResidueNRatio)
-	, pc_RespiratoryStress(cps.cultivarParams.pc_RespiratoryStress)
+	, pc_OrganSenescenceRate(cps->cultivarParams.pc_OrganSenescenceRate)
+	, pc_PartBiologicalNFixation(cps->speciesParams.pc_PartBiologicalNFixation)
+	, pc_Perennial(cps->cultivarParams.pc_Perennial)
+	, pc_PlantDensity(cps->speciesParams.pc_PlantDensity)
+	, pc_ResidueNRatio(cps->cultivarParams.pc_ResidueNRatio)
+	, pc_RespiratoryStress(cps->cultivarParams.pc_RespiratoryStress)
 	, vc_RootDensity(soilColumn.vs_NumberOfLayers(), 0.0)
 	, vc_RootDiameter(soilColumn.vs_NumberOfLayers(), 0.0)
-	, pc_RootDistributionParam(cps.speciesParams.pc_RootDistributionParam)
+	, pc_RootDistributionParam(cps->speciesParams.pc_RootDistributionParam)
 	, vc_RootEffectivity(soilColumn.vs_NumberOfLayers(), 0.0)
-	, pc_RootFormFactor(cps.speciesParams.pc_RootFormFactor)
-	, pc_RootGrowthLag(cps.speciesParams.pc_RootGrowthLag)
-	, pc_RootPenetrationRate(cps.speciesParams.pc_RootPenetrationRate)
+	, pc_RootFormFactor(cps->speciesParams.pc_RootFormFactor)
+	, pc_RootGrowthLag(cps->speciesParams.pc_RootGrowthLag)
+	, pc_RootPenetrationRate(cps->speciesParams.pc_RootPenetrationRate)
 	, vs_SoilMineralNContent(soilColumn.vs_NumberOfLayers(), 0.0)
-	, pc_SpecificLeafArea(cps.cultivarParams.pc_SpecificLeafArea)
-	, pc_SpecificRootLength(cps.speciesParams.pc_SpecificRootLength)
-	, pc_StageAfterCut(cps.speciesParams.pc_StageAfterCut-1)
-	, pc_StageAtMaxDiameter(cps.speciesParams.pc_StageAtMaxDiameter)
-	, pc_StageAtMaxHeight(cps.speciesParams.pc_StageAtMaxHeight)
-	, pc_StageMaxRootNConcentration(cps.speciesParams.pc_StageMaxRootNConcentration)
-	, pc_StageKcFactor(cps.cultivarParams.pc_StageKcFactor)
-	, pc_StageTemperatureSum(cps.cultivarParams.pc_StageTemperatureSum)
-	, pc_StorageOrgan(cps.speciesParams.pc_StorageOrgan)
+	, pc_SpecificLeafArea(cps->cultivarParams.pc_SpecificLeafArea)
+	, pc_SpecificRootLength(cps->speciesParams.pc_SpecificRootLength)
+	, pc_StageAfterCut(cps->speciesParams.pc_StageAfterCut-1)
+	, pc_StageAtMaxDiameter(cps->speciesParams.pc_StageAtMaxDiameter)
+	, pc_StageAtMaxHeight(cps->speciesParams.pc_StageAtMaxHeight)
+	, pc_StageMaxRootNConcentration(cps->speciesParams.pc_StageMaxRootNConcentration)
+	, pc_StageKcFactor(cps->cultivarParams.pc_StageKcFactor)
+	, pc_StageTemperatureSum(cps->cultivarParams.pc_StageTemperatureSum)
+	, pc_StorageOrgan(cps->speciesParams.pc_StorageOrgan)
 	, vs_Tortuosity(cropPs.pc_Tortuosity)
 	, vc_Transpiration(soilColumn.vs_NumberOfLayers(), 0.0)
 	, vc_TranspirationRedux(soilColumn.vs_NumberOfLayers(), 1.0)
-	, pc_VernalisationRequirement(cps.cultivarParams.pc_VernalisationRequirement)
+	, pc_VernalisationRequirement(cps->cultivarParams.pc_VernalisationRequirement)
 	, pc_WaterDeficitResponseOn(simPs.pc_WaterDeficitResponseOn)
 	, eva2_usage(usage)
 	, vs_MaxEffectiveRootingDepth(stps.vs_MaxEffectiveRootingDepth)
@@ -261,6 +263,37 @@ CropGrowth::CropGrowth(SoilColumn& sc,
 			eva2_secondaryYieldComponents.push_back(yc);
 	}
 
+	// the species' VOC parameters don't change over the crop's lifetime
+	//_vocSpecies.id = 0; // right now we just have one crop at a time, so no need to distinguish multiple crops
+	_vocSpecies.EF_MONO = speciesPs.EF_MONO;
+	_vocSpecies.EF_MONOS = speciesPs.EF_MONOS;
+	_vocSpecies.EF_ISO = speciesPs.EF_ISO;
+	_vocSpecies.VCMAX25 = speciesPs.VCMAX25;
+	_vocSpecies.AEKC = speciesPs.AEKC;
+	_vocSpecies.AEKO = speciesPs.AEKO;
+	_vocSpecies.AEVC = speciesPs.AEVC;
+	_vocSpecies.KC25 = speciesPs.KC25;
+
+	// the soil layers' constant properties the water and N uptake kernels need
+	size_t nols = soilColumn.vs_NumberOfLayers();
+	_layerThickness.resize(nols);
+	_layerPermanentWiltingPoint.resize(nols);
+	_layerAvailableWater.resize(nols);
+	for(size_t i_Layer = 0; i_Layer < nols; i_Layer++)
+	{
+		const auto& layer = soilColumn[i_Layer];
+		_layerThickness[i_Layer] = layer.vs_LayerThickness;
+		_layerPermanentWiltingPoint[i_Layer] = layer.vs_PermanentWiltingPoint();
+		_layerAvailableWater[i_Layer] = layer.vs_FieldCapacity() - layer.vs_PermanentWiltingPoint();
+	}
+	_layerPlantAvailableWater.resize(nols, 0.0);
+	_layerUptakeWeight.resize(nols, 0.0);
+	_layerSoilMoisture.resize(nols, 0.0);
+	_layerConvectiveNUptake.resize(nols, 0.0);
+	_layerDiffusiveNUptake.resize(nols, 0.0);
+	_rootDensityFactor.resize(nols, 0.0);
+
+	selectCropPhotosynthesis();
 }
 
 /**
@@ -292,7 +325,8 @@ void CropGrowth::step(double vw_MeanAirTemperature,
 											double vw_AtmosphericCO2Concentration,
 											double vw_AtmosphericO3Concentration,
 											double vw_GrossPrecipitation,
-											double vw_ReferenceEvapotranspiration)
+											double vw_ReferenceEvapotranspiration,
+											const DailyAtmosphere& atmosphere)
 {
 	int vs_JulianDay = int(currentDate.julianDay());
 	if(vc_CuttingDelayDays > 0)
@@ -300,7 +334,7 @@ void CropGrowth::step(double vw_MeanAirTemperature,
 		vc_CuttingDelayDays--;
 	}
 	//  cout << "Cropstep: " << vw_MinAirTemperature << "\t" << vw_MaxAirTemperature << "\t" << vw_MeanAirTemperature << endl;
-	fc_Radiation(vs_JulianDay, vs_Latitude, vw_GlobalRadiation, vw_SunshineHours);
+	fc_Radiation(_solarGeometry->day(vs_JulianDay), vw_GlobalRadiation, vw_SunshineHours);
 
 	vc_OxygenDeficit = fc_OxygenDeficiency(pc_CriticalOxygenContent[vc_DevelopmentalStage]);
 
@@ -382,14 +416,20 @@ void CropGrowth::step(double vw_MeanAirTemperature,
 	if(vc_DevelopmentalStage > 0)
 	{
 
-		fc_CropSize(pc_MaxCropHeight,
-								pc_MaxCropDiameter,
-								pc_StageAtMaxHeight,
-								pc_StageAtMaxDiameter,
-								pc_StageTemperatureSum,
-								vc_CurrentTotalTemperatureSum,
-								pc_CropHeightP1,
-								pc_CropHeightP2);
+		// the crop's size only depends on its development, so it stays the same
+		// as long as the temperature sum doesn't increase (e.g. during winter dormancy)
+		if(vc_CurrentTotalTemperatureSum != _cropSizeTemperatureSum)
+		{
+			fc_CropSize(pc_MaxCropHeight,
+									pc_MaxCropDiameter,
+									pc_StageAtMaxHeight,
+									pc_StageAtMaxDiameter,
+									pc_StageTemperatureSum,
+									vc_CurrentTotalTemperatureSum,
+									pc_CropHeightP1,
+									pc_CropHeightP2);
+			_cropSizeTemperatureSum = vc_CurrentTotalTemperatureSum;
+		}
 
 		fc_CropGreenArea(vw_MeanAirTemperature,
 										 vc_DevelopmentalStage,
@@ -408,7 +448,7 @@ void CropGrowth::step(double vw_MeanAirTemperature,
 		vc_SoilCoverage = fc_SoilCoverage(vc_LeafAreaIndex);
 
 
-		fc_CropPhotosynthesis(vw_MeanAirTemperature,
+		(this->*_cropPhotosynthesis)(vw_MeanAirTemperature,
 													vw_MaxAirTemperature,
 													vw_MinAirTemperature,
 													vc_GlobalRadiation,
@@ -449,16 +489,10 @@ void CropGrowth::step(double vw_MeanAirTemperature,
 
 		// calculate reference evapotranspiration if not provided directly via climate files
 		if (vw_ReferenceEvapotranspiration < 0) {
-			vc_ReferenceEvapotranspiration = fc_ReferenceEvapotranspiration(vs_HeightNN,
-				vw_MaxAirTemperature,
-				vw_MinAirTemperature,
-				vw_RelativeHumidity,
-				vw_MeanAirTemperature,
-				vw_WindSpeed,
-				vw_WindSpeedHeight,
+			vc_ReferenceEvapotranspiration = fc_ReferenceEvapotranspiration(atmosphere,
 				vc_GlobalRadiation,
 				vw_AtmosphericCO2Concentration,
-				vc_GrossPhotosynthesisReference_mol);			
+				vc_GrossPhotosynthesisReference_mol);
 		}
 		else {			
 			// use reference evapotranspiration from climate file
@@ -494,73 +528,27 @@ void CropGrowth::step(double vw_MeanAirTemperature,
  * (1991): Modelling nitrogen dynamics in a plant-soil system with a
  * simple model for advisory purposes. Fert. Res. 27 (2-3), 273 - 281.
  *
- * @param vs_JulianDay
- * @param vs_Latitude
+ * The astronomic terms only depend on latitude and day of year and are
+ * looked up from the precalculated solar geometry.
+ *
+ * @param solarDay
+ * @param vw_GlobalRadiation
+ * @param vw_SunshineHours
  *
  * @author Claas Nendel
  */
-void CropGrowth::fc_Radiation(double vs_JulianDay, double vs_Latitude,
+void CropGrowth::fc_Radiation(const SolarDay& solarDay,
 															double vw_GlobalRadiation,
 															double vw_SunshineHours)
 {
-	
-	double vc_DeclinationSinus = 0.0; // old SINLD
-	double vc_DeclinationCosinus = 0.0; // old COSLD
-
-	// Calculation of declination - old DEC
-	vc_Declination = -23.4 * cos(2.0 * PI * ((vs_JulianDay + 10.0) / 365.0));
-
-	vc_DeclinationSinus = sin(vc_Declination * PI / 180.0) * sin(vs_Latitude * PI / 180.0);
-	vc_DeclinationCosinus = cos(vc_Declination * PI / 180.0) * cos(vs_Latitude * PI / 180.0);
-
-	// Calculation of the atmospheric day lenght - old DL
-	double arg_AstroDayLength = vc_DeclinationSinus / vc_DeclinationCosinus;
-	arg_AstroDayLength = bound(-1.0, arg_AstroDayLength, 1.0); //The argument of asin must be in the range of -1 to 1 
-	vc_AstronomicDayLenght = 12.0 * (PI + 2.0 * asin(arg_AstroDayLength)) / PI;
-
-	// Calculation of the effective day length - old DLE
-
-	double EDLHelper = (-sin(8.0 * PI / 180.0) + vc_DeclinationSinus) / vc_DeclinationCosinus;
-
-	if((EDLHelper < -1.0) || (EDLHelper > 1.0))
-	{
-		vc_EffectiveDayLength = 0.01;
-	}
-	else
-	{
-		vc_EffectiveDayLength = 12.0 * (PI + 2.0 * asin(EDLHelper)) / PI;
-	}
-	/*EDLHelper = bound(-1.0, EDLHelper, 1.0);
-	vc_EffectiveDayLength = 12.0 * (PI + 2.0 * asin(EDLHelper)) / PI;*/
-
-	// old DLP
-	double arg_PhotoDayLength = (-sin(-6.0 * PI / 180.0) + vc_DeclinationSinus) / vc_DeclinationCosinus;
-	arg_PhotoDayLength = bound(-1.0, arg_PhotoDayLength, 1.0); //The argument of asin must be in the range of -1 to 1
-	vc_PhotoperiodicDaylength = 12.0 * (PI + 2.0 * asin(arg_PhotoDayLength)) / PI;
-
-	// Calculation of the mean photosynthetically active radiation [J m-2] - old RDN
-	double arg_PhotAct = min(1.0, ((vc_DeclinationSinus / vc_DeclinationCosinus) * (vc_DeclinationSinus / vc_DeclinationCosinus))); //The argument of sqrt must be >= 0
-	vc_PhotActRadiationMean = 3600.0 * (vc_DeclinationSinus * vc_AstronomicDayLenght + 24.0 / PI * vc_DeclinationCosinus
-																			* sqrt(1.0 - arg_PhotAct));
-
-	// Calculation of radiation on a clear day [J m-2] - old DRC	
-	if (vc_PhotActRadiationMean > 0 && vc_AstronomicDayLenght > 0)
-		vc_ClearDayRadiation = 0.5 * 1300.0 * vc_PhotActRadiationMean * exp(-0.14 / (vc_PhotActRadiationMean
-			/ (vc_AstronomicDayLenght * 3600.0)));
-	else
-		vc_ClearDayRadiation = 0;
-
-	// Calculation of radiation on an overcast day [J m-2] - old DRO
-	vc_OvercastDayRadiation = 0.2 * vc_ClearDayRadiation;
-
-	// Calculation of extraterrestrial radiation - old EXT
-	double pc_SolarConstant = 0.082; //[MJ m-2 d-1] Note: Here is the difference to HERMES, which calculates in [J cm-2 d-1]!
-	double SC = 24.0 * 60.0 / PI * pc_SolarConstant *(1.0 + 0.033 * cos(2.0 * PI * vs_JulianDay / 365.0));
-
-	double arg_SolarAngle = -tan(vs_Latitude * PI / 180.0) * tan(vc_Declination * PI / 180.0);
-	arg_SolarAngle = bound(-1.0, arg_SolarAngle, 1.0);
-	double vc_SunsetSolarAngle = acos(arg_SolarAngle);
-	vc_ExtraterrestrialRadiation = SC * (vc_SunsetSolarAngle * vc_DeclinationSinus + vc_DeclinationCosinus * sin(vc_SunsetSolarAngle)); // [MJ m-2]
+	vc_Declination = solarDay.declination;
+	vc_AstronomicDayLenght = solarDay.astronomicDayLength;
+	vc_EffectiveDayLength = solarDay.effectiveDayLength;
+	vc_PhotoperiodicDaylength = solarDay.photoperiodicDayLength;
+	vc_PhotActRadiationMean = solarDay.photActRadiationMean;
+	vc_ClearDayRadiation = solarDay.clearDayRadiation;
+	vc_OvercastDayRadiation = solarDay.overcastDayRadiation;
+	vc_ExtraterrestrialRadiation = solarDay.extraterrestrialRadiation;
 
 	if (vw_GlobalRadiation > 0.0)
 		vc_GlobalRadiation = vw_GlobalRadiation;
@@ -807,9 +795,9 @@ double WangEngelTemperatureResponse (double t, double tmin, double topt, double
  * @author Claas Nendel
  */
 void CropGrowth::fc_CropDevelopmentalStage(double vw_MeanAirTemperature, 
-																					 std::vector<double> pc_BaseTemperature,
-																					 std::vector<double> pc_OptimumTemperature, 
-																					 std::vector<double> pc_StageTemperatureSum,
+																					 const std::vector<double>& pc_BaseTemperature,
+																					 const std::vector<double>& pc_OptimumTemperature, 
+																					 const std::vector<double>& pc_StageTemperatureSum,
 																					 bool pc_Perennial, 
 																					 bool vc_GrowthCycleEnded, 
 																					 double vc_TimeStep, 
@@ -1136,7 +1124,7 @@ void CropGrowth::fc_CropSize(double pc_MaxCropHeight,
 														 double pc_MaxCropDiameter,
 														 double pc_StageAtMaxHeight,
 														 double pc_StageAtMaxDiameter,
-														 std::vector <double> pc_StageTemperatureSum,
+														 const std::vector<double>& pc_StageTemperatureSum,
 														 double vc_CurrentTotalTemperatureSum,
 														 double pc_CropHeightP1,
 														 double pc_CropHeightP2)
@@ -1352,6 +1340,157 @@ ostream& Monica::tout(bool closeFile)
 }
 #endif
 
+//! configuration taken from the crop's parameters, the reference for the specialized versions
+struct CropGrowth::GenericPhotosynthesisMode
+{
+	static bool isC3(const CropGrowth& cg) { return cg.pc_CarboxylationPathway == 1; }
+	static bool hourlyFvCB(const CropGrowth& cg) { return cg.cropPs.__enable_hourly_FvCB_photosynthesis__ && isC3(cg); }
+};
+
+//! configuration fixed at compile time, so the unused branches can be dropped
+template<bool C3, bool HourlyFvCB>
+struct CropGrowth::PhotosynthesisMode
+{
+	static_assert(C3 || !HourlyFvCB, "hourly FvCB photosynthesis is only available for C3 crops");
+	static bool isC3(const CropGrowth&) { return C3; }
+	static bool hourlyFvCB(const CropGrowth&) { return HourlyFvCB; }
+};
+
+void CropGrowth::selectCropPhotosynthesis()
+{
+//#define GENERIC_CROP_PHOTOSYNTHESIS
+#ifdef GENERIC_CROP_PHOTOSYNTHESIS
+	_cropPhotosynthesis = &CropGrowth::fc_CropPhotosynthesis<GenericPhotosynthesisMode>;
+#else
+	if(pc_CarboxylationPathway == 1)
+		_cropPhotosynthesis = cropPs.__enable_hourly_FvCB_photosynthesis__
+			? &CropGrowth::fc_CropPhotosynthesis<PhotosynthesisMode<true, true>>
+			: &CropGrowth::fc_CropPhotosynthesis<PhotosynthesisMode<true, false>>;
+	else
+		_cropPhotosynthesis = &CropGrowth::fc_CropPhotosynthesis<PhotosynthesisMode<false, false>>;
+
+//#define CHECK_CROP_PHOTOSYNTHESIS
+#ifdef CHECK_CROP_PHOTOSYNTHESIS
+	_specializedCropPhotosynthesis = _cropPhotosynthesis;
+	_cropPhotosynthesis = &CropGrowth::fc_CheckedCropPhotosynthesis;
+#endif
+#endif
+}
+
+namespace
+{
+	//! report a state variable which differs between the generic and the specialized photosynthesis
+	void checkSame(const Date& date, const string& name, double generic, double specialized)
+	{
+		// both paths evaluate the same expressions, so the results have to be bit-identical
+		if(generic != specialized && !(std::isnan(generic) && std::isnan(specialized)))
+			cerr << "Error: " << date.toIsoDateString() << " specialized crop photosynthesis differs in "
+			<< name << ": generic: " << generic << " specialized: " << specialized << endl;
+	}
+
+	void checkSame(const Date& date, const string& name, const Voc::Emissions& generic, const Voc::Emissions& specialized)
+	{
+		checkSame(date, name + ".isoprene_emission", generic.isoprene_emission, specialized.isoprene_emission);
+		checkSame(date, name + ".monoterpene_emission", generic.monoterpene_emission, specialized.monoterpene_emission);
+	}
+
+	template<typename Container>
+	void checkSame(const Date& date, const string& name, const Container& generic, const Container& specialized)
+	{
+		for(size_t i = 0, size = generic.size(); i < size; i++)
+			checkSame(date, name + "[" + to_string(i) + "]", generic[i], specialized[i]);
+	}
+}
+
+void CropGrowth::fc_CheckedCropPhotosynthesis(double vw_MeanAirTemperature,
+																							double vw_MaxAirTemperature,
+																							double vw_MinAirTemperature,
+																							double vw_GlobalRadiation,
+																							double vw_AtmosphericCO2Concentration,
+																							double vw_AtmosphericO3Concentration,
+																							double vs_Latitude,
+																							double vc_LeafAreaIndex,
+																							double pc_DefaultRadiationUseEfficiency,
+																							double pc_MaxAssimilationRate,
+																							double pc_MinimumTemperatureForAssimilation,
+																							double pc_OptimumTemperatureForAssimilation,
+																							double pc_MaximumTemperatureForAssimilation,
+																							double vc_AstronomicDayLenght,
+																							double vc_Declination,
+																							double vc_ClearDayRadiation,
+																							double vc_EffectiveDayLength,
+																							double vc_OvercastDayRadiation,
+																							Date currentDate)
+{
+	// the photosynthesis only reads the soil column, so a copy of the crop is independent
+	CropGrowth generic(*this);
+	generic.fc_CropPhotosynthesis<GenericPhotosynthesisMode>(vw_MeanAirTemperature,
+																													 vw_MaxAirTemperature,
+																													 vw_MinAirTemperature,
+																													 vw_GlobalRadiation,
+																													 vw_AtmosphericCO2Concentration,
+																													 vw_AtmosphericO3Concentration,
+																													 vs_Latitude,
+																													 vc_LeafAreaIndex,
+																													 pc_DefaultRadiationUseEfficiency,
+																													 pc_MaxAssimilationRate,
+																													 pc_MinimumTemperatureForAssimilation,
+																													 pc_OptimumTemperatureForAssimilation,
+																													 pc_MaximumTemperatureForAssimilation,
+																													 vc_AstronomicDayLenght,
+																													 vc_Declination,
+																													 vc_ClearDayRadiation,
+																													 vc_EffectiveDayLength,
+																													 vc_OvercastDayRadiation,
+																													 currentDate);
+
+	(this->*_specializedCropPhotosynthesis)(vw_MeanAirTemperature,
+																					vw_MaxAirTemperature,
+																					vw_MinAirTemperature,
+																					vw_GlobalRadiation,
+																					vw_AtmosphericCO2Concentration,
+																					vw_AtmosphericO3Concentration,
+																					vs_Latitude,
+																					vc_LeafAreaIndex,
+																					pc_DefaultRadiationUseEfficiency,
+																					pc_MaxAssimilationRate,
+																					pc_MinimumTemperatureForAssimilation,
+																					pc_OptimumTemperatureForAssimilation,
+																					pc_MaximumTemperatureForAssimilation,
+																					vc_AstronomicDayLenght,
+																					vc_Declination,
+																					vc_ClearDayRadiation,
+																					vc_EffectiveDayLength,
+																					vc_OvercastDayRadiation,
+																					currentDate);
+
+	const auto& d = currentDate;
+#define CHECK_SAME(member) checkSame(d, #member, generic.member, member)
+	CHECK_SAME(vc_GrossPhotosynthesis);
+	CHECK_SAME(vc_GrossPhotosynthesis_mol);
+	CHECK_SAME(vc_GrossPhotosynthesisReference_mol);
+	CHECK_SAME(vc_Assimilates);
+	CHECK_SAME(vc_GrossAssimilates);
+	CHECK_SAME(vc_MaintenanceRespirationAS);
+	CHECK_SAME(vc_GrowthRespirationAS);
+	CHECK_SAME(vc_TotalRespired);
+	CHECK_SAME(vc_NetMaintenanceRespiration);
+	CHECK_SAME(vc_O3_shortTermDamage);
+	CHECK_SAME(vc_O3_longTermDamage);
+	CHECK_SAME(vc_O3_senescence);
+	CHECK_SAME(vc_O3_sumUptake);
+	CHECK_SAME(vc_O3_WStomatalClosure);
+	CHECK_SAME(vc_sunlitLeafAreaIndex);
+	CHECK_SAME(vc_shadedLeafAreaIndex);
+	CHECK_SAME(_rad24);
+	CHECK_SAME(_rad240);
+	CHECK_SAME(_tfol24);
+	CHECK_SAME(_tfol240);
+	CHECK_SAME(_guentherEmissions);
+	CHECK_SAME(_jjvEmissions);
+#undef CHECK_SAME
+}
+
 /**
  * @brief Calculation of photosynthesis
  *
@@ -1378,6 +1517,7 @@ ostream& Monica::tout(bool closeFile)
  *
  * @author Claas Nendel
  */
+template<typename Mode>
 void CropGrowth::fc_CropPhotosynthesis(double vw_MeanAirTemperature,
 																			 double vw_MaxAirTemperature,
 																			 double vw_MinAirTemperature,
@@ -1483,7 +1623,7 @@ void CropGrowth::fc_CropPhotosynthesis(double vw_MeanAirTemperature,
 	vc_RadiationUseEfficiency = pc_DefaultRadiationUseEfficiency;
 	vc_RadiationUseEfficiencyReference = pc_DefaultRadiationUseEfficiency;
 
-	if(pc_CarboxylationPathway == 1)
+	if(Mode::isC3(*this))
 	{
 		// Calculation of CO2 impact on crop growth
 		if(pc_CO2Method == 3)
@@ -1911,27 +2051,86 @@ void CropGrowth::fc_CropPhotosynthesis(double vw_MeanAirTemperature,
 
 	int vs_JulianDay = currentDate.julianDay();
 	double dailyGP = 0;
-	if(cropPs.__enable_hourly_FvCB_photosynthesis__ && pc_CarboxylationPathway == 1)
+	if(Mode::hourlyFvCB(*this))
 	{
-		vector<double> hourlyGlobrads;
-		vector<double> hourlyExtrarad;
-		int sunriseH = 0;
+		using namespace FvCB;
+
+		const SolarDay& solarDay = _solarGeometry->day(vs_JulianDay);
+		FvCB_canopy_day_in FvCB_day_in;
+		FvCB_day_in.extra_terr_rad = solarDay.hourlyExtraterrestrialRadiation;
+		FvCB_day_in.solar_el = solarDay.solarElevation;
+		// the hourly global radiation has the daily course of the extraterrestrial one,
+		// so both start at the same hour (unless there is no radiation at all)
+		int sunriseH = vc_GlobalRadiation > 0 ? solarDay.sunriseHour : 0;
 
 		for(int h = 0; h < 24; h++)
-		{
-			double hgr = hourlyRad(vc_GlobalRadiation, vs_Latitude, vs_JulianDay, h);
-			if(hgr > 0 && hourlyGlobrads.back() == 0.0)
-				sunriseH = h;
-			hourlyGlobrads.push_back(hgr);
+			FvCB_day_in.global_rad[h] = hourlyRad(vc_GlobalRadiation, vs_Latitude, vs_JulianDay, h);
 
-			hourlyExtrarad.push_back(hourlyRad(vc_ExtraterrestrialRadiation, vs_Latitude, vs_JulianDay, h));
+		for(int h = 0; h < 24; h++)
+		{
+			double hourlyTemp = hourlyT(vw_MinAirTemperature, vw_MaxAirTemperature, h, sunriseH);
+			FvCB_day_in.leaf_temp[h] = hourlyTemp;
+			FvCB_day_in.VPD[h] = hourlyVaporPressureDeficit(hourlyTemp, vw_MinAirTemperature, vw_MeanAirTemperature, vw_MaxAirTemperature);
 		}
-
-		using namespace FvCB;
+		FvCB_day_in.LAI = vc_LeafAreaIndex;
+		FvCB_day_in.Ca = vw_AtmosphericCO2Concentration;
+
+		// all Vcmax independent terms of the day at once, only the O3 damage of
+		// the previous hour changes Vcmax from hour to hour
+		FvCB_canopy_hourly_params hps;
+		auto FvCB_day = FvCB_canopy_day_C3(FvCB_day_in, hps.kn);
+
+//#define CHECK_FVCB_CANOPY_DAY
+#ifdef CHECK_FVCB_CANOPY_DAY
+		hps.Vcmax_25 = speciesPs.VCMAX25 * vc_O3_shortTermDamage * vc_O3_senescence;
+		for(const auto& diff : check_FvCB_canopy_day_C3(FvCB_day_in, hps))
+			cerr << "Error: " << currentDate.toIsoDateString() << " FvCB canopy day differs at " << diff << endl;
+#endif
 
 		_guentherEmissions = Voc::Emissions();
 		_jjvEmissions = Voc::Emissions();
 
+		//the O3 inputs which don't change during the day
+		O3impact::O3_impact_in O3_in;
+		O3impact::O3_impact_params O3_par;
+		O3_par.gamma3 = 0.05; //TODO: calibrate and add to crop params
+		O3_par.gamma1 = 0.025; //TODO: calibrate and add to crop params
+
+		int root_depth = get_RootingDepth();
+		if(root_depth >= 1) //the crop has emerged
+		{
+			double FC = 0, WP = 0, SWC = 0;
+			for(int i = 0; i < root_depth; i++)
+			{
+				FC += soilColumn[i].vs_FieldCapacity();
+				WP += soilColumn[i].vs_PermanentWiltingPoint();
+				SWC += soilColumn[i].get_Vs_SoilMoisture_m3();
+			}
+			O3_in.FC = FC / (root_depth + 1); //field capacity, m3 m-3, avg in the rooted zone
+			O3_in.WP = WP / (root_depth + 1); //wilting point, m3 m-3
+			O3_in.SWC = SWC / (root_depth + 1); //soil water content, m3 m-3
+			O3_in.ET0 = get_ReferenceEvapotranspiration();
+			O3_in.O3a = vw_AtmosphericO3Concentration; //ambient O3 partial pressure, nbar or nmol mol-1
+			O3_in.reldev = vc_RelativeTotalDevelopment;
+			O3_in.GDD_flo = vc_TemperatureSumToFlowering; //GDD from emergence to flowering
+			O3_in.GDD_mat = vc_TotalTemperatureSum; //GDD from emergence to maturity
+		}
+
+		//the leaf biomass used by the VOC models doesn't change during the day
+		double greenLeafBiomass = get_OrganGreenBiomass(LEAF) / (100. * 100.); //kg/ha -> kg/m2
+		double defaultSla = pc_SpecificLeafArea[vc_DevelopmentalStage] * 100. * 100.; //ha/kg -> m2/kg
+		Voc::SpeciesData& species = _vocSpecies;
+
+		//moving windows of the VOC models, the sums are updated with each new value
+		//and recalculated once per cycle to keep round-off errors from accumulating
+		auto updateWindow = [](vector<double>& window, double& sum, int index, double value)
+		{
+			sum += value - window[index];
+			window[index] = value;
+			if(index == 0)
+				sum = accumulate(window.begin(), window.end(), 0.0);
+		};
+
 		for(int h = 0; h < 24; h++)
 		{
 #ifdef TEST_FVCB_HOURLY_OUTPUT
@@ -1942,21 +2141,11 @@ void CropGrowth::fc_CropPhotosynthesis(double vw_MeanAirTemperature,
 				<< "," << vw_AtmosphericCO2Concentration;
 #endif
 			//hourly photosynthesis
-			FvCB_canopy_hourly_in FvCB_in;
+			FvCB_canopy_hourly_in FvCB_in = FvCB_day_in.at(h);
 
-			double hourlyTemp = hourlyT(vw_MinAirTemperature, vw_MaxAirTemperature, h, sunriseH);
-			FvCB_in.leaf_temp = hourlyTemp;
-			FvCB_in.global_rad = hourlyGlobrads.at(h);
-			FvCB_in.extra_terr_rad = hourlyExtrarad.at(h);
-			FvCB_in.LAI = vc_LeafAreaIndex;
-			FvCB_in.solar_el = solarElevation(h, vs_Latitude, vs_JulianDay);
-			FvCB_in.VPD = hourlyVaporPressureDeficit(hourlyTemp, vw_MinAirTemperature, vw_MeanAirTemperature, vw_MaxAirTemperature);
-			FvCB_in.Ca = vw_AtmosphericCO2Concentration;
-
-			FvCB_canopy_hourly_params hps;
 			hps.Vcmax_25 = speciesPs.VCMAX25 * vc_O3_shortTermDamage * vc_O3_senescence;
 
-			auto FvCB_res = FvCB_canopy_hourly_C3(FvCB_in, hps);
+			auto FvCB_res = FvCB_canopy_hourly_C3(FvCB_day, h, hps);
 			
 			vc_sunlitLeafAreaIndex[h] = FvCB_res.sunlit.LAI;
 			vc_shadedLeafAreaIndex[h] = FvCB_res.shaded.LAI;
@@ -1965,12 +2154,6 @@ void CropGrowth::fc_CropPhotosynthesis(double vw_MeanAirTemperature,
 			dailyGP += FvCB_res.canopy_gross_photos * 44. / 100. / 1000.;
 
 			//hourly O3 uptake and damage
-			O3impact::O3_impact_in O3_in;
-			O3impact::O3_impact_params O3_par;
-			O3_par.gamma3 = 0.05; //TODO: calibrate and add to crop params
-			O3_par.gamma1 = 0.025; //TODO: calibrate and add to crop params
-
-			int root_depth = get_RootingDepth();
 			if (root_depth >= 1) //the crop has emerged
 			{
 #ifdef TEST_O3_HOURLY_OUTPUT
@@ -1981,14 +2164,6 @@ void CropGrowth::fc_CropPhotosynthesis(double vw_MeanAirTemperature,
 					<< "," << vw_AtmosphericCO2Concentration
 					<< "," << vw_AtmosphericO3Concentration;
 #endif
-				double FC = 0, WP = 0, SWC = 0;
-				for (int i = 0; i < root_depth; i++)
-				{
-					FC += soilColumn[i].vs_FieldCapacity();
-					WP += soilColumn[i].vs_PermanentWiltingPoint();
-					SWC += soilColumn[i].get_Vs_SoilMoisture_m3();
-				}
-
 				//weighted average gs and conversion from unit ground area to unit leaf area
 				double lai_sun_weight = FvCB_res.sunlit.LAI / (FvCB_res.sunlit.LAI + FvCB_res.shaded.LAI);
 				double lai_sh_weight = 1 - lai_sun_weight;
@@ -1998,16 +2173,8 @@ void CropGrowth::fc_CropPhotosynthesis(double vw_MeanAirTemperature,
 					avg_leaf_gs += lai_sun_weight * FvCB_res.sunlit.gs / FvCB_res.sunlit.LAI;
 				}
 
-				O3_in.FC = FC / (root_depth + 1); //field capacity, m3 m-3, avg in the rooted zone
-				O3_in.WP = WP / (root_depth + 1); //wilting point, m3 m-3
-				O3_in.SWC = SWC / (root_depth + 1); //soil water content, m3 m-3
-				O3_in.ET0 = get_ReferenceEvapotranspiration();
-				O3_in.O3a = vw_AtmosphericO3Concentration; //ambient O3 partial pressure, nbar or nmol mol-1
 				O3_in.gs = avg_leaf_gs; //stomatal conductance mol m-2 s-1 bar-1 
 				O3_in.h = h; //hour of the day (0-23)
-				O3_in.reldev = vc_RelativeTotalDevelopment;
-				O3_in.GDD_flo = vc_TemperatureSumToFlowering; //GDD from emergence to flowering
-				O3_in.GDD_mat = vc_TotalTemperatureSum; //GDD from emergence to maturity
 				O3_in.fO3s_d_prev = vc_O3_shortTermDamage; //short term ozone induced reduction of Ac of the previous time step
 				O3_in.sum_O3_up = vc_O3_sumUptake; //cumulated O3 uptake, µmol m-2 (unit ground area)			
 
@@ -2020,6 +2187,10 @@ void CropGrowth::fc_CropPhotosynthesis(double vw_MeanAirTemperature,
 				vc_O3_WStomatalClosure = O3_res.WS_st_clos;
 			}			
 				
+			// VOC emissions are diagnostics only, skip them if nobody asks for them
+			if(!(_diagnostics & (GUENTHER_VOC_EMISSIONS | JJV_VOC_EMISSIONS)))
+				continue;
+
 			// calculate VOC emissions
 			double globradWm2 = FvCB_in.global_rad * 1000000.0 / 3600; //MJ m-2 h-1 -> W m-2
 			if(_index240 < _stepSize240 - 1)
@@ -2029,8 +2200,8 @@ void CropGrowth::fc_CropPhotosynthesis(double vw_MeanAirTemperature,
 				_index240 = 0;
 				_full240 = true;
 			}
-			_rad240[_index240] = globradWm2;
-			_tfol240[_index240] = FvCB_in.leaf_temp;
+			updateWindow(_rad240, _rad240Sum, _index240, globradWm2);
+			updateWindow(_tfol240, _tfol240Sum, _index240, FvCB_in.leaf_temp);
 
 			if(_index24 < _stepSize24 - 1)
 				_index24++;
@@ -2039,41 +2210,34 @@ void CropGrowth::fc_CropPhotosynthesis(double vw_MeanAirTemperature,
 				_index24 = 0;
 				_full24 = true;
 			}
-			_rad24[_index24] = globradWm2;
-			_tfol24[_index24] = FvCB_in.leaf_temp;
+			updateWindow(_rad24, _rad24Sum, _index24, globradWm2);
+			updateWindow(_tfol24, _tfol24Sum, _index24, FvCB_in.leaf_temp);
 
 			Voc::MicroClimateData mcd;
 			//hourly or time step average global radiation (in case of monica usually 24h)
 			mcd.rad = globradWm2;
-			mcd.rad24 = accumulate(_rad24.begin(), _rad24.end(), 0.0) / (_full24 ? _rad24.size() : _index24 + 1);
-			mcd.rad240 = accumulate(_rad240.begin(), _rad240.end(), 0.0) / (_full240 ? _rad240.size() : _index240 + 1);
+			mcd.rad24 = _rad24Sum / (_full24 ? _rad24.size() : _index24 + 1);
+			mcd.rad240 = _rad240Sum / (_full240 ? _rad240.size() : _index240 + 1);
 			mcd.tFol = FvCB_in.leaf_temp;
-			mcd.tFol24 = accumulate(_tfol24.begin(), _tfol24.end(), 0.0) / (_full24 ? _tfol24.size() : _index24 + 1);
-			mcd.tFol240 = accumulate(_tfol240.begin(), _tfol240.end(), 0.0) / (_full240 ? _tfol240.size() : _index240 + 1);
+			mcd.tFol24 = _tfol24Sum / (_full24 ? _tfol24.size() : _index24 + 1);
+			mcd.tFol240 = _tfol240Sum / (_full240 ? _tfol240.size() : _index240 + 1);
 			mcd.co2concentration = vw_AtmosphericCO2Concentration;
 
 			//auto sunShadeLaiAtZenith = laiSunShade(_sitePs.vs_Latitude, julday, 12, vc_LeafAreaIndex);
 			//mcd.sunlitfoliagefraction = sunShadeLaiAtZenith.first / lai;
 			//mcd.sunlitfoliagefraction24 = mcd.sunlitfoliagefraction;
 
-			Voc::SpeciesData species;
-			//species.id = 0; // right now we just have one crop at a time, so no need to distinguish multiple crops
-			species.lai = vc_LeafAreaIndex;
-			species.mFol = get_OrganGreenBiomass(LEAF) / (100. * 100.); //kg/ha -> kg/m2
-			species.sla = species.mFol > 0 ? species.lai / species.mFol : pc_SpecificLeafArea[vc_DevelopmentalStage] * 100. * 100.; //ha/kg -> m2/kg
-			
-			species.EF_MONO = speciesPs.EF_MONO;
-			species.EF_MONOS = speciesPs.EF_MONOS;
-			species.EF_ISO = speciesPs.EF_ISO;
-			species.VCMAX25 = speciesPs.VCMAX25;
-			species.AEKC = speciesPs.AEKC;
-			species.AEKO = speciesPs.AEKO;
-			species.AEVC = speciesPs.AEVC;
-			species.KC25 = speciesPs.KC25;
-			
-			auto ges = Voc::calculateGuentherVOCEmissions(species, mcd, 1. / 24.);
-			//cout << "G: C: " << ges.monoterpene_emission << " em: " << ges.isoprene_emission << endl;
-			_guentherEmissions += ges;
+			Voc::Emissions ges;
+			if(_diagnostics & GUENTHER_VOC_EMISSIONS)
+			{
+				species.lai = vc_LeafAreaIndex;
+				species.mFol = greenLeafBiomass;
+				species.sla = species.mFol > 0 ? species.lai / species.mFol : defaultSla;
+
+				ges = Voc::calculateGuentherVOCEmissions(species, mcd, 1. / 24.);
+				//cout << "G: C: " << ges.monoterpene_emission << " em: " << ges.isoprene_emission << endl;
+				_guentherEmissions += ges;
+			}
 			//debug() << "guenther: isoprene: " << gems.isoprene_emission << " monoterpene: " << gems.monoterpene_emission << endl;
 
 #ifdef TEST_HOURLY_OUTPUT
@@ -2106,57 +2270,60 @@ void CropGrowth::fc_CropPhotosynthesis(double vw_MeanAirTemperature,
 			double sun_LAI = FvCB_res.sunlit.LAI;
 			double sh_LAI = FvCB_res.shaded.LAI;
 			//JJV
-			for (const auto& lf : { FvCB_res.sunlit, FvCB_res.shaded })
+			if(_diagnostics & JJV_VOC_EMISSIONS)
 			{
-				species.lai = lf.LAI;
-				species.mFol = get_OrganGreenBiomass(LEAF) / (100. * 100.) * lf.LAI / (sun_LAI + sh_LAI); //kg/ha -> kg/m2
-				species.sla = species.mFol > 0 ? species.lai / species.mFol : pc_SpecificLeafArea[vc_DevelopmentalStage] * 100. * 100.; //ha/kg -> m2/kg
-
-
-				mcd.rad = lf.rad;//lf.rad; //W m-2 global incident
-
-				//auto ges = Voc::calculateGuentherVOCEmissions(species, mcd, 1. / 24.);
-				//cout << "G: C: " << ges.monoterpene_emission << " em: " << ges.isoprene_emission << endl;
-				//_guentherEmissions += ges;
-				//debug() << "guenther: isoprene: " << gems.isoprene_emission << " monoterpene: " << gems.monoterpene_emission << endl;
-
-				_cropPhotosynthesisResults.kc = lf.kc;
-				_cropPhotosynthesisResults.ko = lf.ko *1000;
-				_cropPhotosynthesisResults.oi = lf.oi *1000;
-				_cropPhotosynthesisResults.ci = lf.ci;
-				_cropPhotosynthesisResults.vcMax = FvCB::Vcmax_bernacchi_f(mcd.tFol, speciesPs.VCMAX25) * vc_CropNRedux * vc_TranspirationDeficit;//lf.vcMax;
-				_cropPhotosynthesisResults.jMax = FvCB::Jmax_bernacchi_f(mcd.tFol, 120)  * vc_CropNRedux * vc_TranspirationDeficit;//lf.jMax;
-				_cropPhotosynthesisResults.jj = lf.jj;
-				_cropPhotosynthesisResults.jj1000 = lf.jj1000;
-				_cropPhotosynthesisResults.jv = lf.jv;
-
-				auto jjves = Voc::calculateJJVVOCEmissions(species, mcd, _cropPhotosynthesisResults, 1. / 24., false);
-				//cout << "J: C: " << jjves.monoterpene_emission << " em: " << jjves.isoprene_emission << endl;
-				_jjvEmissions += jjves;
-				//debug() << "jjv: isoprene: " << jjvems.isoprene_emission << " monoterpene: " << jjvems.monoterpene_emission << endl;
+				for (const auto& lf : { FvCB_res.sunlit, FvCB_res.shaded })
+				{
+					species.lai = lf.LAI;
+					species.mFol = greenLeafBiomass * lf.LAI / (sun_LAI + sh_LAI);
+					species.sla = species.mFol > 0 ? species.lai / species.mFol : defaultSla;
+
+
+					mcd.rad = lf.rad;//lf.rad; //W m-2 global incident
+
+					//auto ges = Voc::calculateGuentherVOCEmissions(species, mcd, 1. / 24.);
+					//cout << "G: C: " << ges.monoterpene_emission << " em: " << ges.isoprene_emission << endl;
+					//_guentherEmissions += ges;
+					//debug() << "guenther: isoprene: " << gems.isoprene_emission << " monoterpene: " << gems.monoterpene_emission << endl;
+
+					_cropPhotosynthesisResults.kc = lf.kc;
+					_cropPhotosynthesisResults.ko = lf.ko *1000;
+					_cropPhotosynthesisResults.oi = lf.oi *1000;
+					_cropPhotosynthesisResults.ci = lf.ci;
+					_cropPhotosynthesisResults.vcMax = FvCB::Vcmax_bernacchi_f(mcd.tFol, speciesPs.VCMAX25) * vc_CropNRedux * vc_TranspirationDeficit;//lf.vcMax;
+					_cropPhotosynthesisResults.jMax = FvCB::Jmax_bernacchi_f(mcd.tFol, 120)  * vc_CropNRedux * vc_TranspirationDeficit;//lf.jMax;
+					_cropPhotosynthesisResults.jj = lf.jj;
+					_cropPhotosynthesisResults.jj1000 = lf.jj1000;
+					_cropPhotosynthesisResults.jv = lf.jv;
+
+					auto jjves = Voc::calculateJJVVOCEmissions(species, mcd, _cropPhotosynthesisResults, 1. / 24., false);
+					//cout << "J: C: " << jjves.monoterpene_emission << " em: " << jjves.isoprene_emission << endl;
+					_jjvEmissions += jjves;
+					//debug() << "jjv: isoprene: " << jjvems.isoprene_emission << " monoterpene: " << jjvems.monoterpene_emission << endl;
 					
 #ifdef TEST_HOURLY_OUTPUT
-				tout()
-					<< "," << species.lai
-					<< "," << species.mFol
-					<< "," << species.sla
-					<< "," << lf.gs
-					<< "," << lf.kc
-					<< "," << lf.ko
-					<< "," << lf.oi
-					<< "," << lf.ci
-					<< "," << lf.comp
-					<< "," << lf.vcMax
-					<< "," << lf.jMax
-					<< "," << lf.rad
-					<< "," << lf.jj
-					<< "," << lf.jj1000
-					<< "," << lf.jv
-					<< "," << ges.isoprene_emission
-					<< "," << ges.monoterpene_emission
-					<< "," << jjves.isoprene_emission
-					<< "," << jjves.monoterpene_emission;
+					tout()
+						<< "," << species.lai
+						<< "," << species.mFol
+						<< "," << species.sla
+						<< "," << lf.gs
+						<< "," << lf.kc
+						<< "," << lf.ko
+						<< "," << lf.oi
+						<< "," << lf.ci
+						<< "," << lf.comp
+						<< "," << lf.vcMax
+						<< "," << lf.jMax
+						<< "," << lf.rad
+						<< "," << lf.jj
+						<< "," << lf.jj1000
+						<< "," << lf.jv
+						<< "," << ges.isoprene_emission
+						<< "," << ges.monoterpene_emission
+						<< "," << jjves.isoprene_emission
+						<< "," << jjves.monoterpene_emission;
 #endif
+				}
 			}
 #ifdef TEST_HOURLY_OUTPUT
 			tout() << endl;
@@ -2165,7 +2332,7 @@ void CropGrowth::fc_CropPhotosynthesis(double vw_MeanAirTemperature,
 	}
 #pragma endregion hourly FvCB code
 	
-	vc_GrossCO2Assimilation = cropPs.__enable_hourly_FvCB_photosynthesis__ && pc_CarboxylationPathway == 1 
+	vc_GrossCO2Assimilation = Mode::hourlyFvCB(*this)
 		? dailyGP 
 		: vc_GrossCO2Assimilation;
 
@@ -2913,8 +3080,8 @@ void CropGrowth::fc_CropDryMatter(int vc_DevelopmentalStage,
 		vc_MaxRootingDepth += 0.005;
 	}
 
-	if(vc_MaxRootingDepth > (double(nols - 1) * layerThickness))
-		vc_MaxRootingDepth = double(nols - 1) * layerThickness;
+	if(vc_MaxRootingDepth > soilColumn.layerTopDepth(nols - 1))
+		vc_MaxRootingDepth = soilColumn.layerTopDepth(nols - 1);
 
 	//restrict rootgrowth to everything above impentrable layer
 	if(vs_ImpenetrableLayerDepth > 0)
@@ -2994,11 +3161,11 @@ void CropGrowth::fc_CropDryMatter(int vc_DevelopmentalStage,
 	//std::cout << "pc_InitialRootingDepth: " << pc_InitialRootingDepth << std::endl;
 
 	// Calculating rooting depth layer []
-	vc_RootingDepth = int(std::floor(0.5 + (vc_RootingDepth_m / layerThickness))); // []
+	vc_RootingDepth = soilColumn.getNumberOfLayersAbove(vc_RootingDepth_m); // []
 	if(vc_RootingDepth > nols)
 		vc_RootingDepth = nols;
 
-	vc_RootingZone = int(std::floor(0.5 + ((1.3 * vc_RootingDepth_m) / layerThickness))); // []
+	vc_RootingZone = soilColumn.getNumberOfLayersAbove(1.3 * vc_RootingDepth_m); // []
 	if(vc_RootingZone > nols)
 		vc_RootingZone = nols;
 
@@ -3014,24 +3181,34 @@ void CropGrowth::fc_CropDryMatter(int vc_DevelopmentalStage,
 	//std::cout << "pc_SpecificRootLength: " << pc_SpecificRootLength << std::endl;
 
 	// Calculating a root density distribution factor []
-	std::vector<double> vc_RootDensityFactor(nols, 0.0);
-	for(size_t i_Layer = 0; i_Layer < nols; i_Layer++)
+	// (it only changes with the rooting depth, so not while the crop is dormant or fully rooted)
+	if(int(vc_RootingDepth) != _rootDensityFactorDepth || int(vc_RootingZone) != _rootDensityFactorZone)
 	{
-		if(i_Layer < vc_RootingDepth)
-			vc_RootDensityFactor[i_Layer] = exp(-pc_RootFormFactor * (i_Layer * layerThickness)); // []
-		else if(i_Layer < vc_RootingZone)
-			vc_RootDensityFactor[i_Layer] = exp(-pc_RootFormFactor * (i_Layer * layerThickness))
-			* (1.0 - ((i_Layer - vc_RootingDepth) / (vc_RootingZone - vc_RootingDepth))); // []
-		else
-			vc_RootDensityFactor[i_Layer] = 0.0; // []
+		for(size_t i_Layer = 0; i_Layer < nols; i_Layer++)
+		{
+			if(i_Layer < vc_RootingDepth)
+				_rootDensityFactor[i_Layer] = exp(-pc_RootFormFactor * soilColumn.layerTopDepth(i_Layer)); // []
+			else if(i_Layer < vc_RootingZone)
+				_rootDensityFactor[i_Layer] = exp(-pc_RootFormFactor * soilColumn.layerTopDepth(i_Layer))
+				* (1.0 - ((i_Layer - vc_RootingDepth) / (vc_RootingZone - vc_RootingDepth))); // []
+			else
+				_rootDensityFactor[i_Layer] = 0.0; // []
 
-		//std::cout << setprecision(11) << "vc_RootDensityFactor[i_Layer]: " << i_Layer << ", " << vc_RootDensityFactor[i_Layer] << std::endl;
-	}
+			//std::cout << setprecision(11) << "vc_RootDensityFactor[i_Layer]: " << i_Layer << ", " << _rootDensityFactor[i_Layer] << std::endl;
+		}
 
-	// Summing up all factors to scale to a relative factor between [0;1]
-	double vc_RootDensityFactorSum = 0.0;
-	for(size_t i_Layer = 0; i_Layer < vc_RootingZone; i_Layer++)
-		vc_RootDensityFactorSum += vc_RootDensityFactor[i_Layer]; // []
+		// Summing up all factors to scale to a relative factor between [0;1],
+		// weighted by the layers' thickness relative to the nominal one
+		_rootDensityFactorSum = 0.0;
+		for(size_t i_Layer = 0; i_Layer < vc_RootingZone; i_Layer++)
+			_rootDensityFactorSum += _rootDensityFactor[i_Layer]
+			* soilColumn[i_Layer].vs_LayerThickness / layerThickness; // []
+
+		_rootDensityFactorDepth = int(vc_RootingDepth);
+		_rootDensityFactorZone = int(vc_RootingZone);
+	}
+	const std::vector<double>& vc_RootDensityFactor = _rootDensityFactor;
+	double vc_RootDensityFactorSum = _rootDensityFactorSum;
 
 	// Calculating root density per layer from total root length and
 	// a relative root density distribution factor
@@ -3050,6 +3227,7 @@ void CropGrowth::fc_CropDryMatter(int vc_DevelopmentalStage,
 		// Default root decay - 10 %
 		vo_FreshSoilOrganicMatter[i_Layer] += vc_RootNIncrement
 			* vc_RootDensity[i_Layer]
+			* soilColumn[i_Layer].vs_LayerThickness / layerThickness
 			* 10.0
 			/ vc_TotalRootLength;
 
@@ -3160,135 +3338,50 @@ void CropGrowth::fc_CropDryMatter(int vc_DevelopmentalStage,
  * Guidelines for computing crop water requirements. FAO Irrigation and
  * Drainage Paper 56, FAO, Roma
  *
- * @param vs_HeightNN Height above sea level
- * @param vw_MaxAirTemperature Maximal air temperature for the calculated day
- * @param vw_MinAirTemperature Minimal air temperature for the calculated day
- * @param vw_RelativeHumidity Relative humidity
- * @param vw_MeanAirTemperature Mean air temperature
- * @param vw_WindSpeed Spped of wind
- * @param vw_WindSpeedHeight Height in which the wind speed has been measured *
+ * The weather dependent terms are taken from the daily atmosphere
+ * prepared by MonicaModel, which are shared with the soil moisture module.
+ *
+ * @param atmosphere daily atmospheric terms
  * @param vc_GlobalRadiation Global radiation
  * @param vw_AtmosphericCO2Concentration CO2 concentration in the athmosphere (needed for photosynthesis)
  * @param vc_GrossPhotosynthesisReference_mol under well watered conditions
  * @return Reference evapotranspiration
  */
-double CropGrowth::fc_ReferenceEvapotranspiration(double vs_HeightNN,
-																									double vw_MaxAirTemperature,
-																									double vw_MinAirTemperature,
-																									double vw_RelativeHumidity,
-																									double vw_MeanAirTemperature,
-																									double vw_WindSpeed,
-																									double vw_WindSpeedHeight,
+double CropGrowth::fc_ReferenceEvapotranspiration(const DailyAtmosphere& atmosphere,
 																									double vc_GlobalRadiation,
 																									double vw_AtmosphericCO2Concentration,
 																									double vc_GrossPhotosynthesisReference_mol)
 {
-	double vc_AtmosphericPressure; //[kPA]
-	double vc_PsycrometerConstant; //[kPA °C-1]
-	double vc_SaturatedVapourPressureMax; //[kPA]
-	double vc_SaturatedVapourPressureMin; //[kPA]
-	double vc_SaturatedVapourPressure; //[kPA]
-	double vc_VapourPressure; //[kPA]
-	double vc_SaturationDeficit; //[kPA]
-	double vc_SaturatedVapourPressureSlope; //[kPA °C-1]
-	double vc_WindSpeed_2m; //[m s-1]
-	double vc_AerodynamicResistance; //[s m-1]
-	double vc_SurfaceResistance; //[s m-1]
-	double vc_ReferenceEvapotranspiration; //[mm]
-	double vw_NetRadiation; //[MJ m-2]
-
 	const UserCropParameters& user_crops = cropPs;
 	double pc_SaturationBeta = user_crops.pc_SaturationBeta; // Original: Yu et al. 2001; beta = 3.5
 	double pc_StomataConductanceAlpha = user_crops.pc_StomataConductanceAlpha; // Original: Yu et al. 2001; alpha = 0.06
 	double pc_ReferenceAlbedo = user_crops.pc_ReferenceAlbedo; // FAO Green gras reference albedo from Allen et al. (1998)
 
-	// Calculation of atmospheric pressure
-	vc_AtmosphericPressure = 101.3 * pow(((293.0 - (0.0065 * vs_HeightNN)) / 293.0), 5.26);
-
-	// Calculation of psychrometer constant - Luchtfeuchtigkeit
-	vc_PsycrometerConstant = 0.000665 * vc_AtmosphericPressure;
-
-	// Calc. of saturated water vapour pressure at daily max temperature
-	vc_SaturatedVapourPressureMax = 0.6108 * exp((17.27 * vw_MaxAirTemperature) / (237.3 + vw_MaxAirTemperature));
-
-	// Calc. of saturated water vapour pressure at daily min temperature
-	vc_SaturatedVapourPressureMin = 0.6108 * exp((17.27 * vw_MinAirTemperature) / (237.3 + vw_MinAirTemperature));
-
-	// Calculation of the saturated water vapour pressure
-	vc_SaturatedVapourPressure = (vc_SaturatedVapourPressureMax + vc_SaturatedVapourPressureMin) / 2.0;
-
-	// Calculation of the water vapour pressure
-	if(vw_RelativeHumidity <= 0.0)
-	{
-		// Assuming Tdew = Tmin as suggested in FAO56 Allen et al. 1998
-		vc_VapourPressure = vc_SaturatedVapourPressureMin;
-	}
-	else
-	{
-		vc_VapourPressure = vw_RelativeHumidity * vc_SaturatedVapourPressure;
-	}
-
-	// Calculation of the air saturation deficit
-	vc_SaturationDeficit = vc_SaturatedVapourPressure - vc_VapourPressure;
-
-	// Slope of saturation water vapour pressure-to-temperature relation
-	vc_SaturatedVapourPressureSlope = (4098.0 * (0.6108 * exp((17.27 * vw_MeanAirTemperature) / (vw_MeanAirTemperature
-																																															 + 237.3)))) / ((vw_MeanAirTemperature + 237.3) * (vw_MeanAirTemperature + 237.3));
-
-	// Calculation of wind speed in 2m height
-	vc_WindSpeed_2m = vw_WindSpeed * (4.87 / (log(67.8 * vw_WindSpeedHeight - 5.42)));
-
-	// Calculation of the aerodynamic resistance
-	vc_AerodynamicResistance = 208.0 / vc_WindSpeed_2m;
-
 	if(vc_GrossPhotosynthesisReference_mol <= 0.0)
 	{
 		vc_StomataResistance = 999999.9; // [s m-1]
 	}
 	else
 	{
-
-		if(pc_CarboxylationPathway == 1)
-		{
-			vc_StomataResistance = // [s m-1]
-				(vw_AtmosphericCO2Concentration * (1.0 + vc_SaturationDeficit / pc_SaturationBeta))
-				/ (pc_StomataConductanceAlpha * vc_GrossPhotosynthesisReference_mol);
-		}
-		else
-		{
-			vc_StomataResistance = // [s m-1]
-				(vw_AtmosphericCO2Concentration * (1.0 + vc_SaturationDeficit / pc_SaturationBeta))
-				/ (pc_StomataConductanceAlpha * vc_GrossPhotosynthesisReference_mol);
-		}
+		vc_StomataResistance = // [s m-1]
+			(vw_AtmosphericCO2Concentration * (1.0 + atmosphere.saturationDeficit / pc_SaturationBeta))
+			/ (pc_StomataConductanceAlpha * vc_GrossPhotosynthesisReference_mol);
 	}
 
-	vc_SurfaceResistance = vc_StomataResistance / 1.44;
+	double vc_SurfaceResistance = vc_StomataResistance / 1.44; //[s m-1]
 
 	// vc_SurfaceResistance = vc_StomataResistance / (vc_CropHeight * vc_LeafAreaIndex);
 
-	// vw_NetRadiation = vc_GlobalRadiation * (1.0 - pc_ReferenceAlbedo); // [MJ m-2]
-
-	double vc_ClearSkyShortwaveRadiation = (0.75 + 0.00002 * vs_HeightNN) * vc_ExtraterrestrialRadiation;
+	double vc_ClearSkyShortwaveRadiation = atmosphere.clearSkyFactor * vc_ExtraterrestrialRadiation;
 	
 	double vc_RelativeShortwaveRadiation = vc_ClearSkyShortwaveRadiation > 0
 		? vc_GlobalRadiation / vc_ClearSkyShortwaveRadiation : 0;	
 
-	double vc_NetShortwaveRadiation = (1.0 - pc_ReferenceAlbedo) * vc_GlobalRadiation;
-
-	double pc_BolzmanConstant = 0.0000000049; // Bolzmann constant 4.903 * 10-9 MJ m-2 K-4 d-1
-	vw_NetRadiation = vc_NetShortwaveRadiation - (pc_BolzmanConstant
-																								* (pow((vw_MinAirTemperature + 273.16), 4.0) + pow((vw_MaxAirTemperature
-																																																		+ 273.16), 4.0)) / 2.0 * (1.35 * vc_RelativeShortwaveRadiation - 0.35)
-																								* (0.34 - 0.14 * sqrt(vc_VapourPressure)));
+	double vw_NetRadiation = netRadiation(atmosphere, pc_ReferenceAlbedo, vc_GlobalRadiation, vc_RelativeShortwaveRadiation); //[MJ m-2]
 
 	// Calculation of reference evapotranspiration
 	// Penman-Monteith-Method FAO
-	vc_ReferenceEvapotranspiration = ((0.408 * vc_SaturatedVapourPressureSlope * vw_NetRadiation)
-																		+ (vc_PsycrometerConstant * (900.0 / (vw_MeanAirTemperature + 273.0)) * vc_WindSpeed_2m * vc_SaturationDeficit))
-		/ (vc_SaturatedVapourPressureSlope + vc_PsycrometerConstant * (1.0 + (vc_SurfaceResistance / vc_AerodynamicResistance)));
-
-	
-	return vc_ReferenceEvapotranspiration;
+	return penmanMonteithET0(atmosphere, vw_NetRadiation, vc_SurfaceResistance); //[mm]
 }
 
 /**
@@ -3326,7 +3419,6 @@ void CropGrowth::fc_CropWaterUptake(double vc_SoilCoverage,
 	double vc_TranspirationReduced = 0.0; // old TDRED [mm]
 	vc_ActualTranspiration = 0.0; // [mm]
 	double vc_RemainingTotalRootEffectivity = 0.0; //old WEFFREST [m]
-	double vc_CropWaterUptakeFromGroundwater = 0.0; // old GAUF [mm]
 	double vc_TotalRootEffectivity = 0.0; // old WEFF [m]
 	double vc_ActualTranspirationDeficit = 0.0; // old TREST [mm]
 	double vc_Interception = 0.0;
@@ -3337,6 +3429,7 @@ void CropGrowth::fc_CropWaterUptake(double vc_SoilCoverage,
 		vc_Transpiration[i_Layer] = 0.0; // old TP [mm]
 		vc_TranspirationRedux[i_Layer] = 0.0; // old TRRED []
 		vc_RootEffectivity[i_Layer] = 0.0; // old WUEFF [?]
+		_layerUptakeWeight[i_Layer] = 0.0;
 	}
 
 	// ################
@@ -3414,105 +3507,85 @@ void CropGrowth::fc_CropWaterUptake(double vc_SoilCoverage,
 
 		vc_PotentialTranspiration = vc_RemainingEvapotranspiration * vc_SoilCoverage; // [mm]
 
+		// the layers are processed as contiguous arrays, first gathering the
+		// soil state the uptake depends on
+		for(size_t i_Layer = 0; i_Layer < vc_RootingZone; i_Layer++)
+			_layerPlantAvailableWater[i_Layer] = soilColumn[i_Layer].get_Vs_SoilMoisture_m3() - _layerPermanentWiltingPoint[i_Layer]; // [m3 m-3]
+
+		// layers reaching below the max effective rooting depth don't take up water
+		size_t vc_EffectiveRootingZone = 0;
+		while(vc_EffectiveRootingZone < vc_RootingZone
+					&& soilColumn.layerBottomDepth(int(vc_EffectiveRootingZone)) < vs_MaxEffectiveRootingDepth)
+			vc_EffectiveRootingZone++;
+
 		for(size_t i_Layer = 0; i_Layer < vc_RootingZone; i_Layer++)
 		{
-			double vc_AvailableWater = soilColumn[i_Layer].vs_FieldCapacity() - soilColumn[i_Layer].vs_PermanentWiltingPoint();
-			double vc_AvailableWaterPercentage = (soilColumn[i_Layer].get_Vs_SoilMoisture_m3()
-																						- soilColumn[i_Layer].vs_PermanentWiltingPoint()) / vc_AvailableWater;
-			if(vc_AvailableWaterPercentage < 0.0) vc_AvailableWaterPercentage = 0.0;
+			double vc_AvailableWaterPercentage = max(_layerPlantAvailableWater[i_Layer] / _layerAvailableWater[i_Layer], 0.0);
 
+			double redux, effectivity;
 			if(vc_AvailableWaterPercentage < 0.15)
 			{
-				vc_TranspirationRedux[i_Layer] = vc_AvailableWaterPercentage * 3.0; // []
-				vc_RootEffectivity[i_Layer] = 0.15 + 0.45 * vc_AvailableWaterPercentage / 0.15; // []
+				redux = vc_AvailableWaterPercentage * 3.0; // []
+				effectivity = 0.15 + 0.45 * vc_AvailableWaterPercentage / 0.15; // []
 			}
 			else if(vc_AvailableWaterPercentage < 0.3)
 			{
-				vc_TranspirationRedux[i_Layer] = 0.45 + (0.25 * (vc_AvailableWaterPercentage - 0.15) / 0.15);
-				vc_RootEffectivity[i_Layer] = 0.6 + (0.2 * (vc_AvailableWaterPercentage - 0.15) / 0.15);
+				redux = 0.45 + (0.25 * (vc_AvailableWaterPercentage - 0.15) / 0.15);
+				effectivity = 0.6 + (0.2 * (vc_AvailableWaterPercentage - 0.15) / 0.15);
 			}
 			else if(vc_AvailableWaterPercentage < 0.5)
 			{
-				vc_TranspirationRedux[i_Layer] = 0.7 + (0.275 * (vc_AvailableWaterPercentage - 0.3) / 0.2);
-				vc_RootEffectivity[i_Layer] = 0.8 + (0.2 * (vc_AvailableWaterPercentage - 0.3) / 0.2);
+				redux = 0.7 + (0.275 * (vc_AvailableWaterPercentage - 0.3) / 0.2);
+				effectivity = 0.8 + (0.2 * (vc_AvailableWaterPercentage - 0.3) / 0.2);
 			}
 			else if(vc_AvailableWaterPercentage < 0.75)
 			{
-				vc_TranspirationRedux[i_Layer] = 0.975 + (0.025 * (vc_AvailableWaterPercentage - 0.5) / 0.25);
-				vc_RootEffectivity[i_Layer] = 1.0;
+				redux = 0.975 + (0.025 * (vc_AvailableWaterPercentage - 0.5) / 0.25);
+				effectivity = 1.0;
 			}
 			else
 			{
-				vc_TranspirationRedux[i_Layer] = 1.0;
-				vc_RootEffectivity[i_Layer] = 1.0;
-			}
-			if(vc_TranspirationRedux[i_Layer] < 0)
-				vc_TranspirationRedux[i_Layer] = 0.0;
-			if(vc_RootEffectivity[i_Layer] < 0)
-				vc_RootEffectivity[i_Layer] = 0.0;
-			if(i_Layer == vc_GroundwaterTable)
-			{ // old GRW
-				vc_RootEffectivity[i_Layer] = 0.5;
-			}
-			if(i_Layer > vc_GroundwaterTable)
-			{ // old GRW
-				vc_RootEffectivity[i_Layer] = 0.0;
-			}
-			if(((i_Layer + 1)*layerThickness) >= vs_MaxEffectiveRootingDepth)
-			{
-				vc_RootEffectivity[i_Layer] = 0.0;
+				redux = 1.0;
+				effectivity = 1.0;
 			}
-
-			vc_TotalRootEffectivity += vc_RootEffectivity[i_Layer] * vc_RootDensity[i_Layer]; //[m m-3]
-			vc_RemainingTotalRootEffectivity = vc_TotalRootEffectivity;
+			vc_TranspirationRedux[i_Layer] = max(redux, 0.0);
+			effectivity = max(effectivity, 0.0);
+
+			if(i_Layer == vc_GroundwaterTable) // old GRW
+				effectivity = 0.5;
+			if(i_Layer > vc_GroundwaterTable || i_Layer >= vc_EffectiveRootingZone) // old GRW
+				effectivity = 0.0;
+			vc_RootEffectivity[i_Layer] = effectivity;
+
+			// root length in a layer scales with its thickness relative to the nominal one
+			_layerUptakeWeight[i_Layer] = effectivity * vc_RootDensity[i_Layer] * _layerThickness[i_Layer] / layerThickness; //[m m-3]
+			vc_TotalRootEffectivity += _layerUptakeWeight[i_Layer];
 		}
+		vc_RemainingTotalRootEffectivity = vc_TotalRootEffectivity;
 
-		//std::cout << setprecision(11) << "vc_TotalRootEffectivity: " << vc_TotalRootEffectivity << std::endl;
-		//std::cout << setprecision(11) << "vc_OxygenDeficit: " << vc_OxygenDeficit << std::endl;
-
-		for(size_t i_Layer = 0; i_Layer < nols; i_Layer++)
+		// distribute the potential transpiration by the layers' share of the root effectivity
+		size_t vc_UptakeZone = min(vc_RootingZone, vc_GroundwaterTable + 1);
+		if(vc_TotalRootEffectivity != 0.0)
 		{
-			if(i_Layer > min(vc_RootingZone, vc_GroundwaterTable + 1))
+			for(size_t i_Layer = 0, uz = min(nols, vc_UptakeZone + 1); i_Layer < uz; i_Layer++)
 			{
-				vc_Transpiration[i_Layer] = 0.0; //[mm]
-			}
-			else
-			{
-				vc_Transpiration[i_Layer] = vc_TotalRootEffectivity != 0.0
-					? vc_PotentialTranspiration * ((vc_RootEffectivity[i_Layer] * vc_RootDensity[i_Layer])
-																				 / vc_TotalRootEffectivity) * vc_OxygenDeficit
-					: 0;
-
-				//std::cout << setprecision(11) << "vc_Transpiration[i_Layer]: " << i_Layer << ", " << vc_Transpiration[i_Layer] << std::endl;
-				//std::cout << setprecision(11) << "vc_RootEffectivity[i_Layer]: " << i_Layer << ", " << vc_RootEffectivity[i_Layer] << std::endl;
-				//std::cout << setprecision(11) << "vc_RootDensity[i_Layer]: " << i_Layer << ", " << vc_RootDensity[i_Layer] << std::endl;
-
-				// [mm]
+				vc_Transpiration[i_Layer] = vc_PotentialTranspiration
+					* (_layerUptakeWeight[i_Layer] / vc_TotalRootEffectivity) * vc_OxygenDeficit; // [mm]
 			}
 		}
 
-		for(size_t i_Layer = 0; i_Layer < min(vc_RootingZone, vc_GroundwaterTable + 1); i_Layer++)
+		for(size_t i_Layer = 0; i_Layer < vc_UptakeZone; i_Layer++)
 		{
-
-
-			vc_RemainingTotalRootEffectivity -= vc_RootEffectivity[i_Layer] * vc_RootDensity[i_Layer]; // [m m-3]
+			vc_RemainingTotalRootEffectivity -= _layerUptakeWeight[i_Layer]; // [m m-3]
 
 			if(vc_RemainingTotalRootEffectivity <= 0.0)
 				vc_RemainingTotalRootEffectivity = 0.00001;
-			if(((vc_Transpiration[i_Layer] / 1000.0) / layerThickness) > ((soilColumn[i_Layer].get_Vs_SoilMoisture_m3()
-																																		 - soilColumn[i_Layer].vs_PermanentWiltingPoint())))
+			double lt = _layerThickness[i_Layer];
+			double paw = _layerPlantAvailableWater[i_Layer];
+			if(((vc_Transpiration[i_Layer] / 1000.0) / lt) > paw)
 			{
-				vc_PotentialTranspirationDeficit = (((vc_Transpiration[i_Layer] / 1000.0) / layerThickness)
-																						- (soilColumn[i_Layer].get_Vs_SoilMoisture_m3() - soilColumn[i_Layer].vs_PermanentWiltingPoint()))
-					* layerThickness * 1000.0; // [mm]
-				if(vc_PotentialTranspirationDeficit < 0.0)
-				{
-					vc_PotentialTranspirationDeficit = 0.0;
-				}
-				if(vc_PotentialTranspirationDeficit > vc_Transpiration[i_Layer])
-				{
-					vc_PotentialTranspirationDeficit = vc_Transpiration[i_Layer]; //[mm]
-				}
+				vc_PotentialTranspirationDeficit = (((vc_Transpiration[i_Layer] / 1000.0) / lt) - paw) * lt * 1000.0; // [mm]
+				vc_PotentialTranspirationDeficit = min(max(vc_PotentialTranspirationDeficit, 0.0), vc_Transpiration[i_Layer]); //[mm]
 			}
 			else
 			{
@@ -3524,24 +3597,15 @@ void CropGrowth::fc_CropWaterUptake(double vc_SoilCoverage,
 			vc_ActualTranspirationDeficit = max(vc_TranspirationReduced, vc_PotentialTranspirationDeficit); //[mm]
 			if(vc_ActualTranspirationDeficit > 0.0)
 			{
-				if(i_Layer < min(vc_RootingZone, vc_GroundwaterTable + 1))
+				// shift the deficit to the deeper layers
+				for(size_t i_Layer2 = i_Layer + 1; i_Layer2 < vc_UptakeZone; i_Layer2++)
 				{
-					for(size_t i_Layer2 = i_Layer + 1; i_Layer2 < min(vc_RootingZone, vc_GroundwaterTable + 1); i_Layer2++)
-					{
-						vc_Transpiration[i_Layer2] += vc_ActualTranspirationDeficit * (vc_RootEffectivity[i_Layer2]
-																																					 * vc_RootDensity[i_Layer2] / vc_RemainingTotalRootEffectivity);
-
-					}
+					vc_Transpiration[i_Layer2] += vc_ActualTranspirationDeficit
+						* (_layerUptakeWeight[i_Layer2] / vc_RemainingTotalRootEffectivity);
 				}
 			}
-			vc_Transpiration[i_Layer] = vc_Transpiration[i_Layer] - vc_ActualTranspirationDeficit;
-			if(vc_Transpiration[i_Layer] < 0.0)
-				vc_Transpiration[i_Layer] = 0.0;
+			vc_Transpiration[i_Layer] = max(vc_Transpiration[i_Layer] - vc_ActualTranspirationDeficit, 0.0);
 			vc_ActualTranspiration += vc_Transpiration[i_Layer];
-			if(i_Layer == vc_GroundwaterTable)
-			{
-				vc_CropWaterUptakeFromGroundwater = (vc_Transpiration[i_Layer] / 1000.0) / layerThickness; //[m3 m-3]
-			}
 		}
 		if(vc_PotentialTranspiration > 0)
 		{
@@ -3582,17 +3646,10 @@ void CropGrowth::fc_CropNUptake(int vc_RootingZone,
 																double /*vc_CurrentTotalTemperatureSum*/,
 																double /*vc_TotalTemperatureSum*/)
 {
-	size_t nols = soilColumn.vs_NumberOfLayers();
 	double layerThickness = soilColumn.vs_LayerThickness();
 
 	double vc_ConvectiveNUptake = 0.0; // old TRNSUM
 	double vc_DiffusiveNUptake = 0.0; // old SUMDIFF
-	std::vector<double> vc_ConvectiveNUptakeFromLayer(nols, 0.0); // old MASS
-
-	std::vector<double> vc_DiffusionCoeff(nols, 0.0); // old D
-	std::vector<double> vc_DiffusiveNUptakeFromLayer(nols, 0.0); // old DIFF
-	double vc_ConvectiveNUptake_1 = 0.0; // old MASSUM
-	double vc_DiffusiveNUptake_1 = 0.0; // old DIFFSUM
 	double pc_MinimumAvailableN = cropPs.pc_MinimumAvailableN; // kg m-3
 	double pc_MinimumNConcentrationRoot = cropPs.pc_MinimumNConcentrationRoot;  // kg kg-1
 	double pc_MaxCropNDemand = cropPs.pc_MaxCropNDemand;
@@ -3600,8 +3657,6 @@ void CropGrowth::fc_CropNUptake(int vc_RootingZone,
 	vc_TotalNUptake = 0.0;
 	vc_TotalNInput = 0.0;
 	vc_FixedN = 0.0;
-	//for (size_t i_Layer = 0; i_Layer < nols; i_Layer++)
-	//	vc_NUptakeFromLayer[i_Layer] = 0.0;
 	for(auto& v : vc_NUptakeFromLayer)
 		v = 0.0;
 
@@ -3610,92 +3665,70 @@ void CropGrowth::fc_CropNUptake(int vc_RootingZone,
 	{
 		//if ((vc_CurrentTotalTemperatureSum / vc_TotalTemperatureSum) < 1.0){
 
-		for(int i_Layer = 0; i_Layer < (min(vc_RootingZone, vc_GroundwaterTable)); i_Layer++)
-		{
+		int vc_UptakeZone = min(vc_RootingZone, vc_GroundwaterTable);
 
+		// the layers are processed as contiguous arrays, first gathering the
+		// soil state the uptake depends on
+		for(int i_Layer = 0; i_Layer < vc_UptakeZone; i_Layer++)
+		{
 			vs_SoilMineralNContent[i_Layer] = soilColumn[i_Layer].vs_SoilNO3; // [kg m-3]
+			_layerSoilMoisture[i_Layer] = soilColumn[i_Layer].get_Vs_SoilMoisture_m3(); // old WG [m3 m-3]
+		}
+
+		for(int i_Layer = 0; i_Layer < vc_UptakeZone; i_Layer++)
+		{
+			double sm = _layerSoilMoisture[i_Layer];
 
 			// Convective N uptake per layer
-			vc_ConvectiveNUptakeFromLayer[i_Layer] = (vc_Transpiration[i_Layer] / 1000.0) * //[mm --> m]
+			_layerConvectiveNUptake[i_Layer] = (vc_Transpiration[i_Layer] / 1000.0) * //[mm --> m]
 				(vs_SoilMineralNContent[i_Layer] / // [kg m-3]
-				(soilColumn[i_Layer].get_Vs_SoilMoisture_m3())) * // old WG [m3 m-3]
+				sm) * // old WG [m3 m-3]
 				vc_TimeStep; // -->[kg m-2]
 
-			vc_ConvectiveNUptake += vc_ConvectiveNUptakeFromLayer[i_Layer]; // [kg m-2]
+			vc_ConvectiveNUptake += _layerConvectiveNUptake[i_Layer]; // [kg m-2]
 
 			/** @todo Claas: Woher kommt der Wert für vs_Tortuosity? */
 			/** @todo Claas: Prüfen ob Umstellung auf [m] die folgenden Gleichungen beeinflusst */
-			vc_DiffusionCoeff[i_Layer] = 0.000214 * (vs_Tortuosity * exp(soilColumn[i_Layer].get_Vs_SoilMoisture_m3() * 10))
-				/ soilColumn[i_Layer].get_Vs_SoilMoisture_m3(); //[m2 d-1]
-
-			vc_DiffusiveNUptakeFromLayer[i_Layer] = (vc_DiffusionCoeff[i_Layer] * // [m2 d-1]
-																							 soilColumn[i_Layer].get_Vs_SoilMoisture_m3() * // [m3 m-3]
-																							 2.0 * PI * vc_RootDiameter[i_Layer] * // [m]
-																							 (vs_SoilMineralNContent[i_Layer] / 1000.0 / // [kg m-3]
-																								soilColumn[i_Layer].get_Vs_SoilMoisture_m3() - 0.000014) * // [m3 m-3]
-																							 sqrt(PI * vc_RootDensity[i_Layer])) * // [m m-3]
-				vc_RootDensity[i_Layer] * 1000.0 * vc_TimeStep; // -->[kg m-2]
-
-			if(vc_DiffusiveNUptakeFromLayer[i_Layer] < 0.0)
-			{
-				vc_DiffusiveNUptakeFromLayer[i_Layer] = 0;
-			}
-
-			vc_DiffusiveNUptake += vc_DiffusiveNUptakeFromLayer[i_Layer]; // [kg m-2]
-
+			double vc_DiffusionCoeff = 0.000214 * (vs_Tortuosity * exp(sm * 10)) / sm; //[m2 d-1] old D
+
+			double diffusiveNUptake = (vc_DiffusionCoeff * // [m2 d-1]
+																 sm * // [m3 m-3]
+																 2.0 * PI * vc_RootDiameter[i_Layer] * // [m]
+																 (vs_SoilMineralNContent[i_Layer] / 1000.0 / // [kg m-3]
+																	sm - 0.000014) * // [m3 m-3]
+																 sqrt(PI * vc_RootDensity[i_Layer])) * // [m m-3]
+				vc_RootDensity[i_Layer] * 1000.0 * vc_TimeStep // -->[kg m-2]
+				* _layerThickness[i_Layer] / layerThickness;
+			_layerDiffusiveNUptake[i_Layer] = max(diffusiveNUptake, 0.0);
+
+			vc_DiffusiveNUptake += _layerDiffusiveNUptake[i_Layer]; // [kg m-2]
 		}
 
-		for(int i_Layer = 0; i_Layer < (min(vc_RootingZone, vc_GroundwaterTable)); i_Layer++)
+		if(vc_CropNDemand > 0.0)
 		{
+			// which of convective and diffusive uptake cover the demand is the same for all layers
+			bool convectiveSufficient = vc_ConvectiveNUptake >= vc_CropNDemand;
+			bool diffusiveSufficient = (vc_CropNDemand - vc_ConvectiveNUptake) < vc_DiffusiveNUptake;
+			double maxNUptakeFromLayer = pc_MaxCropNDemand / 10000.0 * 0.75;
 
-			if(vc_CropNDemand > 0.0)
+			for(int i_Layer = 0; i_Layer < vc_UptakeZone; i_Layer++)
 			{
-
-				if(vc_ConvectiveNUptake >= vc_CropNDemand)
-				{
-					// convective N uptake is sufficient
-					vc_NUptakeFromLayer[i_Layer] = vc_CropNDemand * vc_ConvectiveNUptakeFromLayer[i_Layer] / vc_ConvectiveNUptake;
-				}
+				double nUptake;
+				if(convectiveSufficient)
+					nUptake = vc_CropNDemand * _layerConvectiveNUptake[i_Layer] / vc_ConvectiveNUptake;
+				else if(diffusiveSufficient)
+					nUptake = _layerConvectiveNUptake[i_Layer] + ((vc_CropNDemand
+																												 - vc_ConvectiveNUptake) * _layerDiffusiveNUptake[i_Layer] / vc_DiffusiveNUptake);
 				else
-				{
-					// N demand is not covered
-					if((vc_CropNDemand - vc_ConvectiveNUptake) < vc_DiffusiveNUptake)
-					{
-						vc_NUptakeFromLayer[i_Layer] = vc_ConvectiveNUptakeFromLayer[i_Layer] + ((vc_CropNDemand
-																																											- vc_ConvectiveNUptake) * vc_DiffusiveNUptakeFromLayer[i_Layer] / vc_DiffusiveNUptake);
-					}
-					else
-					{
-						vc_NUptakeFromLayer[i_Layer] = vc_ConvectiveNUptakeFromLayer[i_Layer] + vc_DiffusiveNUptakeFromLayer[i_Layer];
-					}
-				}
-
-				vc_ConvectiveNUptake_1 += vc_ConvectiveNUptakeFromLayer[i_Layer];
-				vc_DiffusiveNUptake_1 += vc_DiffusiveNUptakeFromLayer[i_Layer];
+					nUptake = _layerConvectiveNUptake[i_Layer] + _layerDiffusiveNUptake[i_Layer];
 
-				if(vc_NUptakeFromLayer[i_Layer] > ((vs_SoilMineralNContent[i_Layer] * layerThickness) - pc_MinimumAvailableN))
-				{
-					vc_NUptakeFromLayer[i_Layer] = (vs_SoilMineralNContent[i_Layer] * layerThickness) - pc_MinimumAvailableN;
-				}
+				nUptake = min(nUptake, (vs_SoilMineralNContent[i_Layer] * _layerThickness[i_Layer]) - pc_MinimumAvailableN);
+				nUptake = min(nUptake, maxNUptakeFromLayer);
+				vc_NUptakeFromLayer[i_Layer] = max(nUptake, 0.0);
 
-				if(vc_NUptakeFromLayer[i_Layer] > (pc_MaxCropNDemand / 10000.0 * 0.75))
-				{
-					vc_NUptakeFromLayer[i_Layer] = (pc_MaxCropNDemand / 10000.0 * 0.75);
-				}
-
-				if(vc_NUptakeFromLayer[i_Layer] < 0.0)
-				{
-					vc_NUptakeFromLayer[i_Layer] = 0.0;
-				}
-			}
-			else
-			{
-				vc_NUptakeFromLayer[i_Layer] = 0.0;
+				vc_TotalNUptake += vc_NUptakeFromLayer[i_Layer] * 10000.0; //[kg m-2] --> [kg ha-1]
 			}
-
-			vc_TotalNUptake += vc_NUptakeFromLayer[i_Layer] * 10000.0; //[kg m-2] --> [kg ha-1]
-
-		} // for
+		}
 
 		vc_FixedN = pc_PartBiologicalNFixation * vc_CropNDemand * 10000.0; // [kg N ha-1]
 		//Part of the deficit which can be covered by biologocal N fixation.
@@ -3899,21 +3932,11 @@ double CropGrowth::get_NetPhotosynthesis() const
 
 void CropGrowth::calculateVOCEmissions(const Voc::MicroClimateData& mcd)
 {
-	Voc::SpeciesData species;
-	//species.id = 0; // right now we just have one crop at a time, so no need to distinguish multiple crops
+	Voc::SpeciesData& species = _vocSpecies;
 	species.lai = get_LeafAreaIndex();
 	species.mFol = get_OrganBiomass(LEAF) / (100. * 100.); //kg/ha -> kg/m2
 	species.sla = pc_SpecificLeafArea[vc_DevelopmentalStage] * 100. * 100.; //ha/kg -> m2/kg
 
-	species.EF_MONO = speciesPs.EF_MONO;
-	species.EF_MONOS = speciesPs.EF_MONOS;
-	species.EF_ISO = speciesPs.EF_ISO;
-	species.VCMAX25 = speciesPs.VCMAX25;
-	species.AEKC = speciesPs.AEKC;
-	species.AEKO = speciesPs.AEKO;
-	species.AEVC = speciesPs.AEVC;
-	species.KC25 = speciesPs.KC25;
-
 	_guentherEmissions = Voc::calculateGuentherVOCEmissions(species, mcd);
 	//debug() << "guenther: isoprene: " << gems.isoprene_emission << " monoterpene: " << gems.monoterpene_emission << endl;
 
@@ -4292,7 +4315,7 @@ namespace
  * @param v Vector yield component
  * @param bmv
  */
-	double calculateCropYield(const VYC& ycs, const vector<double>& bmv)
+	double calculateCropYield(const VYC& ycs, const OrganValues& bmv)
 	{
 		double yield = 0;
 		for(auto yc : ycs)
@@ -4306,7 +4329,7 @@ namespace
  * @param v Vector yield component
  * @param bmv
  */
-	double calculateCropFreshMatterYield(const VYC& ycs, const vector<double>& bmv)
+	double calculateCropFreshMatterYield(const VYC& ycs, const OrganValues& bmv)
 	{
 		double freshMatterYield = 0;
 		for(auto yc : ycs)
@@ -4630,7 +4653,7 @@ CropGrowth::applyFruitHarvest(double yieldPercentage)
 	double residues = 0.0;
 
 	debug() << "CropGrowth::applyFruitHarvest()" << endl;
-	std::vector<double> new_OrganBiomass;
+	OrganValues new_OrganBiomass;
 
 	double fruitBiomass = vc_OrganBiomass.at(3);
 	debug() << "Old fruit biomass: " << fruitBiomass << endl;
@@ -4759,6 +4782,13 @@ void CropGrowth::fc_UpdateCropParametersForPerennial()
 	pc_StageTemperatureSum = perennialCropParams->cultivarParams.pc_StageTemperatureSum;
 	pc_StorageOrgan = perennialCropParams->speciesParams.pc_StorageOrgan;
 	pc_VernalisationRequirement = perennialCropParams->cultivarParams.pc_VernalisationRequirement;
+
+	// the cached development driven terms depend on the replaced parameters
+	_rootDensityFactorDepth = _rootDensityFactorZone = -1;
+	_cropSizeTemperatureSum = -1.0;
+
+	// the perennial parameters might use another carboxylation pathway
+	selectCropPhotosynthesis();
 }
 
 /**
@@ -28,10 +28,15 @@ Copyright (C) Leibniz Centre for Agricultural Landscape Research (ZALF)
 #include <iomanip>
 #include <vector>
 #include <utility>
+#include <array>
+#include <stdexcept>
+#include <cassert>
 
 #include "monica-parameters.h"
 #include "soilcolumn.h"
 #include "voc-common.h"
+#include "reference-evapotranspiration.h"
+#include "solar-geometry.h"
 
 namespace Monica
 {
@@ -42,6 +47,131 @@ namespace Monica
     SHOOT=2,
     STORAGE_ORGAN=3
   };
+
+	//! groups of crop results which only feed outputs and don't influence the crop's state,
+	//! thus can be skipped if no output depends on them
+	enum CropDiagnostics
+	{
+		NO_CROP_DIAGNOSTICS = 0,
+		GUENTHER_VOC_EMISSIONS = 1 << 0,
+		JJV_VOC_EMISSIONS = 1 << 1,
+		ALL_CROP_DIAGNOSTICS = GUENTHER_VOC_EMISSIONS | JJV_VOC_EMISSIONS
+	};
+
+	//! read-only view of a parameter vector in the crop's shared parameter block,
+	//! can be pointed to another block (e.g. the perennial crop parameters)
+	template<typename T>
+	class ParameterRef
+	{
+	public:
+		ParameterRef(const T& v) : _v(&v) {}
+		ParameterRef(const T&&) = delete;
+
+		ParameterRef& operator=(const T& v) { _v = &v; return *this; }
+		ParameterRef& operator=(const T&&) = delete;
+
+		operator const T&() const { return *_v; }
+		typename T::const_reference operator[](size_t i) const { return (*_v)[i]; }
+		size_t size() const { return _v->size(); }
+		typename T::const_iterator begin() const { return _v->begin(); }
+		typename T::const_iterator end() const { return _v->end(); }
+
+	private:
+		const T* _v;
+	};
+
+	//! organ and developmental stage counts up to which the crop state is stored inline
+	const size_t MaxNumberOfOrgans = 8;
+	const size_t MaxNumberOfDevelopmentalStages = 8;
+
+	//! vector like container with its elements stored inline up to a fixed capacity,
+	//! to keep the small per organ/stage crop state contiguous and off the heap,
+	//! crop parameters with more organs/stages than that move the elements to the heap
+	template<typename T, size_t Capacity>
+	class InlineVector
+	{
+	public:
+		typedef T value_type;
+		typedef T& reference;
+		typedef const T& const_reference;
+		typedef T* iterator;
+		typedef const T* const_iterator;
+
+		InlineVector() {}
+		InlineVector(size_t n, const T& value = T()) { resize(n, value); }
+
+		size_t size() const { return _size; }
+		bool empty() const { return _size == 0; }
+		static size_t capacity() { return Capacity; }
+
+		T& operator[](size_t i) { return data()[i]; }
+		const T& operator[](size_t i) const { return data()[i]; }
+
+		T& at(size_t i)
+		{
+			if(i >= _size)
+				throw std::out_of_range("InlineVector::at");
+			return data()[i];
+		}
+		const T& at(size_t i) const { return const_cast<InlineVector*>(this)->at(i); }
+
+		iterator begin() { return data(); }
+		iterator end() { return data() + _size; }
+		const_iterator begin() const { return data(); }
+		const_iterator end() const { return data() + _size; }
+
+		T* data() { return _heap.empty() ? _data : _heap.data(); }
+		const T* data() const { return _heap.empty() ? _data : _heap.data(); }
+
+		void resize(size_t n, const T& value = T())
+		{
+			if(n > Capacity || !_heap.empty())
+			{
+				moveToHeap();
+				_heap.resize(n, value);
+			}
+			else
+			{
+				for(size_t i = _size; i < n; i++)
+					_data[i] = value;
+			}
+			_size = n;
+		}
+
+		void push_back(const T& value)
+		{
+			if(_size < Capacity && _heap.empty())
+				_data[_size] = value;
+			else
+			{
+				moveToHeap();
+				_heap.push_back(value);
+			}
+			_size++;
+		}
+
+		void clear()
+		{
+			_size = 0;
+			_heap.clear();
+		}
+
+	private:
+		void moveToHeap()
+		{
+			if(_heap.empty())
+				_heap.assign(_data, _data + _size);
+		}
+
+		T _data[Capacity];
+		//! only used if there are more than Capacity elements
+		std::vector<T> _heap;
+		size_t _size{0};
+	};
+
+	typedef InlineVector<double, MaxNumberOfOrgans> OrganValues;
+	typedef InlineVector<double, MaxNumberOfDevelopmentalStages> StageValues;
+
   /*
  * @brief  Crop part of model
  *
@@ -59,7 +189,7 @@ namespace Monica
   {
   public:
     CropGrowth(SoilColumn& soilColumn,
-               const CropParameters& cropParams,
+               CropParametersPtr cropParams,
                const SiteParameters& siteParams,
                const UserCropParameters& cropPs,
                const SimulationParameters& simPs,
@@ -84,13 +214,13 @@ namespace Monica
               double vw_AtmosphericCO2Concentration,
 			  double vw_AtmosphericO3Concentration,
               double vw_GrossPrecipitation,
-		      double vw_ReferenceEvapotranspiration);
+		      double vw_ReferenceEvapotranspiration,
+              const DailyAtmosphere& atmosphere);
 
     //void get_CropIdentity();
     //void get_CropParameters();
 
-    void fc_Radiation(double vs_JulianDay,
-                      double vs_Latitude,
+    void fc_Radiation(const SolarDay& solarDay,
                       double vw_GlobalRadiation,
                       double vw_SunshineHours);
 
@@ -108,9 +238,9 @@ namespace Monica
 
 
     void fc_CropDevelopmentalStage(double vw_MeanAirTemperature,
-                                   std::vector<double> pc_BaseTemperature,
-                                   std::vector<double> pc_OptimumTemperature,
-                                   std::vector<double> pc_StageTemperatureSum,
+                                   const std::vector<double>& pc_BaseTemperature,
+                                   const std::vector<double>& pc_OptimumTemperature,
+                                   const std::vector<double>& pc_StageTemperatureSum,
                                    bool pc_Perennial,
                                    bool vc_GrowthCycleEnded,
                                    double vc_TimeStep,
@@ -133,7 +263,7 @@ namespace Monica
                      double pc_MaxCropDiameter,
                      double pc_StageAtMaxHeight,
                      double pc_StageAtMaxDiameter,
-                     std::vector<double> pc_StageTemperatureSum,
+                     const std::vector<double>& pc_StageTemperatureSum,
                      double vc_CurrentTotalTemperatureSum,
                      double pc_CropHeightP1,
                      double pc_CropHeightP2);
@@ -154,6 +284,7 @@ namespace Monica
 
     double fc_SoilCoverage(double vc_LeafAreaIndex);
 
+		template<typename Mode>
 		void fc_CropPhotosynthesis(double vw_MeanAirTemperature,
                                double vw_MaxAirTemperature,
                                double vw_MinAirTemperature,
@@ -190,13 +321,7 @@ namespace Monica
                           double vc_NetMaintenanceRespiration,
                           double vw_MeanAirTemperature);
 
-    double fc_ReferenceEvapotranspiration(double vs_HeightNN,
-                                          double vw_MaxAirTemperature,
-                                          double vw_MinAirTemperature,
-                                          double vw_RelativeHumidity,
-                                          double vw_MeanAirTemperature,
-                                          double vw_WindSpeed,
-                                          double vw_WindSpeedHeight,
+    double fc_ReferenceEvapotranspiration(const DailyAtmosphere& atmosphere,
                                           double vw_GlobalRadiation,
                                           double vw_AtmosphericCO2Concentration,
                                           double vc_GrossPhotosynthesisReference_mol);
@@ -223,6 +348,9 @@ namespace Monica
 		Voc::Emissions guentherEmissions() const { return _guentherEmissions; }
 		Voc::Emissions jjvEmissions() const { return _jjvEmissions; }
 
+		//! calculate only the given CropDiagnostics groups
+		void setDiagnostics(int groups) { _diagnostics = groups; }
+
     double get_ReferenceEvapotranspiration() const;
     double get_RemainingEvapotranspiration() const;
     double get_EvaporatedFromIntercept() const;
@@ -409,7 +537,7 @@ namespace Monica
 
     void fc_UpdateCropParametersForPerennial();
 
-		std::pair<const std::vector<double>&, const std::vector<double>&> sunlitAndShadedLAI() const 
+		std::pair<const std::array<double, 24>&, const std::array<double, 24>&> sunlitAndShadedLAI() const 
 		{ 
 			return make_pair(vc_sunlitLeafAreaIndex, vc_shadedLeafAreaIndex); 
 		}
@@ -437,23 +565,25 @@ namespace Monica
     SoilColumn& soilColumn;
 		CropParametersPtr perennialCropParams;
     const UserCropParameters& cropPs;
-		SpeciesParameters speciesPs;
-		CultivarParameters cultivarPs;
+		CropParametersPtr _cropParams; //!< shared and read-only, the crop keeps just its state
+		const SpeciesParameters& speciesPs;
+		const CultivarParameters& cultivarPs;
 
     //! old N
     //    static const double vw_AtmosphericCO2Concentration;
     double vs_Latitude;
+    std::shared_ptr<const SolarGeometry> _solarGeometry; //!< tables for vs_Latitude
     double vc_AbovegroundBiomass{0.0};//! old OBMAS
     double vc_AbovegroundBiomassOld{0.0}; //! old OBALT
-    std::vector<bool> pc_AbovegroundOrgan;	//! old KOMP
+    ParameterRef<std::vector<bool>> pc_AbovegroundOrgan;	//! old KOMP
     double vc_ActualTranspiration{0.0};
-    std::vector<std::vector<double>> pc_AssimilatePartitioningCoeff; //! old PRO
+    ParameterRef<std::vector<std::vector<double>>> pc_AssimilatePartitioningCoeff; //! old PRO
     double pc_AssimilateReallocation;
     double vc_Assimilates{0.0};
     double vc_AssimilationRate{0.0}; //! old AMAX
     double vc_AstronomicDayLenght{0.0};	//! old DL
-    std::vector<double> pc_BaseDaylength;	//! old DLBAS
-    std::vector<double> pc_BaseTemperature;	//! old BAS
+    ParameterRef<std::vector<double>> pc_BaseDaylength;	//! old DLBAS
+    ParameterRef<std::vector<double>> pc_BaseTemperature;	//! old BAS
     double pc_BeginSensitivePhaseHeatStress;
     double vc_BelowgroundBiomass{0.0};
     double vc_BelowgroundBiomassOld{0.0};
@@ -461,7 +591,7 @@ namespace Monica
     double vc_ClearDayRadiation{0.0};		//! old DRC
     int pc_CO2Method{3};
     double vc_CriticalNConcentration{0.0}; //! old GEHMIN
-    std::vector<double> pc_CriticalOxygenContent; //! old LUKRIT
+    ParameterRef<std::vector<double>> pc_CriticalOxygenContent; //! old LUKRIT
     double pc_CriticalTemperatureHeatStress;
     double vc_CropDiameter{0.0};
     double vc_CropFrostRedux{1.0};
@@ -474,12 +604,12 @@ namespace Monica
     double vc_CropNRedux{1.0};							//! old REDUK
     double pc_CropSpecificMaxRootingDepth;			//! old WUMAXPF [m]
     std::vector<double> vc_CropWaterUptake; //! old TP
-    std::vector<double> vc_CurrentTemperatureSum;	//! old SUM
+    StageValues vc_CurrentTemperatureSum;	//! old SUM
     double vc_CurrentTotalTemperatureSum{0.0};			//! old FP
     double vc_CurrentTotalTemperatureSumRoot{0.0};
 		int pc_CuttingDelayDays{0};
     double vc_DaylengthFactor{0.0};						//! old DAYL
-    std::vector<double> pc_DaylengthRequirement;		//! old DEC
+    ParameterRef<std::vector<double>> pc_DaylengthRequirement;		//! old DEC
     int vc_DaysAfterBeginFlowering{0};
     double vc_Declination{0.0};							//! old EFF0
     double pc_DefaultRadiationUseEfficiency;
@@ -489,7 +619,7 @@ namespace Monica
 		int _noOfCropSteps{0};
     double vc_DroughtImpactOnFertility{1.0};
     double pc_DroughtImpactOnFertilityFactor;
-    std::vector<double> pc_DroughtStressThreshold;	//! old DRYswell
+    ParameterRef<std::vector<double>> pc_DroughtStressThreshold;	//! old DRYswell
     bool pc_EmergenceFloodingControlOn;
     bool pc_EmergenceMoistureControlOn;
     double pc_EndSensitivePhaseHeatStress;
@@ -517,13 +647,13 @@ namespace Monica
     double pc_HeatSumIrrigationEnd;
     double vs_HeightNN;
     double pc_InitialKcFactor;						//! old Kcini
-    std::vector<double> pc_InitialOrganBiomass;
+    ParameterRef<std::vector<double>> pc_InitialOrganBiomass;
     double pc_InitialRootingDepth;
     double vc_InterceptionStorage{0.0};
     double vc_KcFactor{0.6};			//! old FKc
     double vc_LeafAreaIndex{0.0};	//! old LAI
-		std::vector<double> vc_sunlitLeafAreaIndex;	
-		std::vector<double> vc_shadedLeafAreaIndex;	
+		std::array<double, 24> vc_sunlitLeafAreaIndex;	
+		std::array<double, 24> vc_shadedLeafAreaIndex;	
     double pc_LowTemperatureExposure;
     double pc_LimitingTemperatureHeatStress;
     double vc_LT50{-3.0};
@@ -558,18 +688,18 @@ namespace Monica
     int pc_NumberOfDevelopmentalStages;
     int pc_NumberOfOrgans;							//! old NRKOM
     std::vector<double> vc_NUptakeFromLayer; //! old PE
-    std::vector<double> pc_OptimumTemperature;
-    std::vector<double> vc_OrganBiomass;	//! old WORG
-    std::vector<double> vc_OrganDeadBiomass;	//! old WDORG
-    std::vector<double> vc_OrganGreenBiomass;
-    std::vector<double> vc_OrganGrowthIncrement;			//! old GORG
-    std::vector<double> pc_OrganGrowthRespiration;	//! old MAIRT
-    std::vector<YieldComponent> pc_OrganIdsForPrimaryYield;
-    std::vector<YieldComponent> pc_OrganIdsForSecondaryYield;
-    std::vector<YieldComponent> pc_OrganIdsForCutting;
-    std::vector<double> pc_OrganMaintenanceRespiration;	//! old MAIRT
-    std::vector<double> vc_OrganSenescenceIncrement; //! old DGORG
-    std::vector<std::vector<double> > pc_OrganSenescenceRate;	//! old DEAD
+    ParameterRef<std::vector<double>> pc_OptimumTemperature;
+    OrganValues vc_OrganBiomass;	//! old WORG
+    OrganValues vc_OrganDeadBiomass;	//! old WDORG
+    OrganValues vc_OrganGreenBiomass;
+    OrganValues vc_OrganGrowthIncrement;			//! old GORG
+    ParameterRef<std::vector<double>> pc_OrganGrowthRespiration;	//! old MAIRT
+    ParameterRef<std::vector<YieldComponent>> pc_OrganIdsForPrimaryYield;
+    ParameterRef<std::vector<YieldComponent>> pc_OrganIdsForSecondaryYield;
+    ParameterRef<std::vector<YieldComponent>> pc_OrganIdsForCutting;
+    ParameterRef<std::vector<double>> pc_OrganMaintenanceRespiration;	//! old MAIRT
+    OrganValues vc_OrganSenescenceIncrement; //! old DGORG
+    ParameterRef<std::vector<std::vector<double>>> pc_OrganSenescenceRate;	//! old DEAD
     double vc_OvercastDayRadiation{0.0};					//! old DRO
     double vc_OxygenDeficit{0.0};					//! old LURED
     double pc_PartBiologicalNFixation;
@@ -601,16 +731,16 @@ namespace Monica
     std::vector<double> vs_SoilMineralNContent;		//! old C1
     double vc_SoilSpecificMaxRootingDepth{0.0};				//! old WURZMAX [m]
     double vs_SoilSpecificMaxRootingDepth{0.0};
-    std::vector<double> pc_SpecificLeafArea;		//! old LAIFKT [ha kg-1]
+    ParameterRef<std::vector<double>> pc_SpecificLeafArea;		//! old LAIFKT [ha kg-1]
     double pc_SpecificRootLength;
 		int pc_StageAfterCut{0}; //0-indexed
     double pc_StageAtMaxDiameter;
     double pc_StageAtMaxHeight;
-    std::vector<double> pc_StageMaxRootNConcentration;	//! old WGMAX
-    std::vector<double> pc_StageKcFactor;		//! old Kc
-    std::vector<double> pc_StageTemperatureSum;	//! old TSUM
+    ParameterRef<std::vector<double>> pc_StageMaxRootNConcentration;	//! old WGMAX
+    ParameterRef<std::vector<double>> pc_StageKcFactor;		//! old Kc
+    ParameterRef<std::vector<double>> pc_StageTemperatureSum;	//! old TSUM
     double vc_StomataResistance{0.0};					//! old RSTOM
-    std::vector<bool> pc_StorageOrgan;
+    ParameterRef<std::vector<bool>> pc_StorageOrgan;
     int vc_StorageOrgan{4};
     double vc_TargetNConcentration{0.0}; //! old GEHMAX
     double vc_TimeStep{1.0}; //! old dt
@@ -632,7 +762,7 @@ namespace Monica
     double vc_TranspirationDeficit{1.0};					//! old TRREL
     double vc_VernalisationDays{0.0}; //
     double vc_VernalisationFactor{0.0};					//! old FV
-    std::vector<double> pc_VernalisationRequirement;	//! old VSCHWELL
+    ParameterRef<std::vector<double>> pc_VernalisationRequirement;	//! old VSCHWELL
     bool pc_WaterDeficitResponseOn;
 
     int eva2_usage;
@@ -660,8 +790,66 @@ namespace Monica
 		//VOC members
 		const int _stepSize24{24}, _stepSize240{240};
 		std::vector<double> _rad24, _rad240, _tfol24, _tfol240;
+		double _rad24Sum{0.0}, _rad240Sum{0.0}, _tfol24Sum{0.0}, _tfol240Sum{0.0};
 		int _index24{0}, _index240{0};
 		bool _full24{false}, _full240{false};
+		int _diagnostics{ALL_CROP_DIAGNOSTICS}; //!< CropDiagnostics groups to calculate
+
+		//! contiguous per layer arrays of the root water and N uptake,
+		//! the soil column's constant properties and the kernels' intermediates
+		std::vector<double> _layerThickness; //!< [m]
+		std::vector<double> _layerPermanentWiltingPoint; //!< [m3 m-3]
+		std::vector<double> _layerAvailableWater; //!< field capacity - permanent wilting point [m3 m-3]
+		std::vector<double> _layerPlantAvailableWater; //!< soil moisture - permanent wilting point [m3 m-3]
+		std::vector<double> _layerUptakeWeight; //!< root effectivity * root density, thickness weighted [m m-3]
+		std::vector<double> _layerSoilMoisture; //!< [m3 m-3]
+		std::vector<double> _layerConvectiveNUptake; //!< old MASS [kg m-2]
+		std::vector<double> _layerDiffusiveNUptake; //!< old DIFF [kg m-2]
+
+		//! development driven terms which stay the same while the crop doesn't develop
+		//! (e.g. during winter dormancy), so are only recalculated if their drivers change
+		std::vector<double> _rootDensityFactor; //!< relative root density distribution []
+		double _rootDensityFactorSum{0.0};
+		int _rootDensityFactorDepth{-1}; //!< rooting depth the distribution was calculated for
+		int _rootDensityFactorZone{-1}; //!< rooting zone the distribution was calculated for
+		double _cropSizeTemperatureSum{-1.0}; //!< total temperature sum the crop size was calculated for
+
+		//! the run-invariant configuration of fc_CropPhotosynthesis, either read
+		//! from the crop's parameters at runtime (generic reference path) or fixed at compile time
+		struct GenericPhotosynthesisMode;
+		template<bool C3, bool HourlyFvCB> struct PhotosynthesisMode;
+
+		typedef void (CropGrowth::*CropPhotosynthesisF)(double, double, double, double, double, double,
+		                                                double, double, double, double, double, double,
+		                                                double, double, double, double, double, double,
+		                                                Tools::Date);
+		CropPhotosynthesisF _cropPhotosynthesis{nullptr}; //!< chosen by selectCropPhotosynthesis()
+
+		//! choose the specialized photosynthesis for the crop's carboxylation pathway and hourly mode
+		void selectCropPhotosynthesis();
+
+		//! runs the specialized photosynthesis and the generic one on a copy of the crop
+		//! and reports every state variable which differs (CHECK_CROP_PHOTOSYNTHESIS)
+		void fc_CheckedCropPhotosynthesis(double vw_MeanAirTemperature,
+		                                  double vw_MaxAirTemperature,
+		                                  double vw_MinAirTemperature,
+		                                  double vw_GlobalRadiation,
+		                                  double vw_AtmosphericCO2Concentration,
+		                                  double vw_AtmosphericO3Concentration,
+		                                  double vs_Latitude,
+		                                  double vc_LeafAreaIndex,
+		                                  double pc_DefaultRadiationUseEfficiency,
+		                                  double pc_MaxAssimilationRate,
+		                                  double pc_MinimumTemperatureForAssimilation,
+		                                  double pc_OptimumTemperatureForAssimilation,
+		                                  double pc_MaximumTemperatureForAssimilation,
+		                                  double vc_AstronomicDayLenght,
+		                                  double vc_Declination,
+		                                  double vc_ClearDayRadiation,
+		                                  double vc_EffectiveDayLength,
+		                                  double vc_OvercastDayRadiation,
+		                                  Tools::Date currentDate);
+		CropPhotosynthesisF _specializedCropPhotosynthesis{nullptr}; //!< checked by fc_CheckedCropPhotosynthesis
 
 		Voc::Emissions _guentherEmissions;
 		Voc::Emissions _jjvEmissions;
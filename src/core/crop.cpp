@@ -145,6 +145,21 @@ Errors Crop::merge(json11::Json j)
 			_cuttingDates.push_back(Tools::Date::fromIsoDateString(cd.string_value()));
 	}
 
+	// identical parameters of crops in a rotation (and in other runs) share one block
+	// parameters not read from this JSON are only registered
+	json11::Json source, perennialSource;
+	if(j["cropParams"].is_object())
+	{
+		source = J11Object{{"cropParams", j["cropParams"]}, {"is-perennial-crop", j["is-perennial-crop"]}};
+		if(j["perennialCropParams"].is_object())
+			perennialSource = J11Object{{"perennialCropParams", j["cropParams"]}};
+	}
+	bool samePerennialParams = _perennialCropParams == _cropParams;
+	_cropParams = internCropParameters(_cropParams, source);
+	_perennialCropParams = samePerennialParams
+		? _cropParams
+		: internCropParameters(_perennialCropParams, perennialSource);
+
 	return res;
 }
 
@@ -21,6 +21,8 @@ Copyright (C) Leibniz Centre for Agricultural Landscape Research (ZALF)
 #include <set>
 #include <sstream>
 #include <mutex>
+#include <stdexcept>
+#include <cassert>
 #include <memory>
 #include <chrono>
 #include <thread>
@@ -73,6 +75,7 @@ MonicaModel::MonicaModel(const CentralParameterProvider& cpp)
   //, _pathToOutputDir(cpp.pathToOutputDir())
   , _groundwaterInformation(cpp.groundwaterInformation)
   , _soilColumn(_simPs.p_LayerThickness,
+                _simPs.layerThicknesses(),
                 _soilOrganicPs.ps_MaxMineralisationDepth,
                 _sitePs.vs_SoilParameters,
                 _smPs.pm_CriticalMoistureDepth)
@@ -91,6 +94,7 @@ MonicaModel::MonicaModel(const CentralParameterProvider& cpp)
 	, _rad240(_stepSize240)
 	, _tfol24(_stepSize24)
 	, _tfol240(_stepSize240)
+  , _solarGeometry(solarGeometryFor(_sitePs.vs_Latitude))
   , vw_AtmosphericCO2Concentration(_envPs.p_AtmosphericCO2)
 {}
 
@@ -111,6 +115,16 @@ void MonicaModel::seedCrop(CropPtr crop)
   p_accuHeatStress = 0.0;
   p_accuOxygenStress = 0.0;
 
+	//without an event for each stage, events (e.g. outputs "at" or "while" Stage-N) would silently be missing
+	if(crop->isValid()
+		 && size_t(crop->cropParameters()->speciesParams.pc_NumberOfDevelopmentalStages()) > noOfStageEvents())
+	{
+		cerr << "Error: Crop " << crop->id() << " has " << crop->cropParameters()->speciesParams.pc_NumberOfDevelopmentalStages()
+			<< " developmental stages, but MONICA can fire events for only " << noOfStageEvents()
+			<< " stages (MaxNumberOfEvents). The crop won't be sown!" << endl;
+		return;
+	}
+
   if(crop->isValid())
   {
 		_currentCrop = crop;
@@ -122,13 +136,14 @@ void MonicaModel::seedCrop(CropPtr crop)
 		};
     auto cps = _currentCrop->cropParameters();
     _currentCropGrowth = new CropGrowth(_soilColumn,
-                                        *cps,
+                                        cps,
                                         _sitePs,
                                         _cropPs,
                                         _simPs,
 																				[this](string event){ this->addEvent(event); },
 																				addOMFunc,
                                         crop->getEva2TypeUsage());
+		_currentCropGrowth->setDiagnostics(_cropDiagnostics);
 
     if (_currentCrop->perennialCropParameters())
       _currentCropGrowth->setPerennialCropParameters(_currentCrop->perennialCropParameters());
@@ -553,6 +568,23 @@ void MonicaModel::applyTillage(double depth)
 
 void MonicaModel::step()
 {
+	// the weather dependent terms of the reference evapotranspiration are
+	// the same for the crop and the soil, so prepare them just once a day
+	auto climateData = currentStepClimateData();
+	auto rhit = climateData.find(Climate::relhumid);
+	double relhumid = rhit == climateData.end() ? -1.0 : rhit->second;
+	// missing wind speed is taken as calm (as the soil moisture module always did)
+	auto wind_it = climateData.find(Climate::wind);
+	double wind = wind_it == climateData.end() ? 0.0 : wind_it->second;
+	_dailyAtmosphere = prepareDailyAtmosphere(_sitePs.vs_HeightNN,
+	                                          climateData[Climate::tmax],
+	                                          climateData[Climate::tmin],
+	                                          relhumid / 100.0,
+	                                          climateData[Climate::tavg],
+	                                          wind,
+	                                          _envPs.p_WindSpeedHeight,
+	                                          _solarGeometry->day(int(_currentStepDate.julianDay())).extraterrestrialRadiation);
+
 	if(isCropPlanted() && !_clearCropUponNextDay)
 		cropStep();
 
@@ -576,8 +608,11 @@ void MonicaModel::generalStep()
 	double precip = climateData[Climate::precip];
 	double wind = climateData[Climate::wind];
 	double globrad = climateData[Climate::globrad];	
-	
-	
+
+	// test if data for relhumid are available; if not, value is set to -1.0
+	auto rhit = climateData.find(Climate::relhumid);
+	double relhumid = rhit == climateData.end() ? -1.0 : rhit->second;
+
 
 
   // test if simulated gw or measured values should be used
@@ -614,6 +649,7 @@ void MonicaModel::generalStep()
   //  debug << "step: " << stepNo << " p: " << precip << " gr: " << globrad << endl;
 
   _soilColumn.deleteAOMPool();
+  _soilColumn.compactAOMPool(_soilOrganicPs.po_AOM_PoolCompactionTolerance);
 
 	auto possibleDelayedFertilizerAmount = _soilColumn.applyPossibleDelayedFerilizer();
 	addDailySumFertiliser(possibleDelayedFertilizerAmount);
@@ -725,7 +761,8 @@ void MonicaModel::cropStep()
 
   _currentCropGrowth->step(tavg, tmax, tmin, globrad, sunhours, date,
                            (relhumid / 100.0), wind, vw_WindSpeedHeight,
-                           vw_AtmosphericCO2Concentration, vw_AtmosphericO3Concentration, precip, et0);
+                           vw_AtmosphericCO2Concentration, vw_AtmosphericO3Concentration, precip, et0,
+                           _dailyAtmosphere);
   if(_simPs.p_UseAutomaticIrrigation)
   {
     const AutomaticIrrigationParameters& aips = _simPs.p_AutoIrrigationParams;
@@ -842,16 +879,16 @@ double MonicaModel::avgCorg(double depth_m) const
   double lsum = 0, sum = 0;
   int count = 0;
 
-  for(int i = 0, nols = _simPs.p_NumberOfLayers; i < nols; i++)
+  for(int i = 0, nols = _soilColumn.vs_NumberOfLayers(); i < nols; i++)
   {
     count++;
-    sum +=_soilColumn[i].vs_SoilOrganicCarbon(); //[kg C / kg Boden]
+    sum +=_soilColumn[i].vs_SoilOrganicCarbon() * _soilColumn[i].vs_LayerThickness; //[kg C / kg Boden]
     lsum += _soilColumn[i].vs_LayerThickness;
     if(lsum >= depth_m)
       break;
   }
 
-  return sum / double(count) * 100.0;
+  return count > 0 ? sum / lsum * 100.0 : 0.0;
 }
 
 
@@ -883,36 +920,66 @@ double MonicaModel::sumNmin(double depth_m) const
   double lsum = 0, sum = 0;
   int count = 0;
 
-  for(int i = 0, nols = _simPs.p_NumberOfLayers; i < nols; i++)
+  for(int i = 0, nols = _soilColumn.vs_NumberOfLayers(); i < nols; i++)
   {
     count++;
-    sum += _soilColumn[i].get_SoilNmin(); //[kg N m-3]
+    sum += _soilColumn[i].get_SoilNmin() * _soilColumn[i].vs_LayerThickness; //[kg N m-2]
     lsum += _soilColumn[i].vs_LayerThickness;
     if(lsum >= depth_m)
       break;
   }
 
-  return sum / double(count) * lsum * 10000;
+  return sum * 10000;
+}
+
+namespace
+{
+  //! part of layer i above the given depth, in nominal layer thicknesses,
+  //! so that per layer sums of variable layers stay comparable to those of uniform layers
+  double nominalLayersAbove(const SoilColumn& sc, int i, double depth_m)
+  {
+    double top = sc.layerTopDepth(i);
+    double bottom = sc.layerBottomDepth(i);
+    if(bottom <= depth_m + 1e-9)
+      return sc[i].vs_LayerThickness / sc.vs_LayerThickness();
+    return max(0.0, depth_m - top) / sc.vs_LayerThickness();
+  }
 }
 
 /**
  * Returns accumulation of soil nitrate for 90cm soil at 31.03.
+ * Uniform layers are summed as always, up to and including the layer where the
+ * accumulated thicknesses reach the depth (for 0.9m these are 10 layers of 0.1m,
+ * because nine accumulated 0.1m stay below 0.9).
+ * Variable layers are weighted by their thickness, the last one is cut at the given depth.
  * @param depth Depth of soil
  * @return Accumulated nitrate
  */
 double
 MonicaModel::sumNO3AtDay(double depth_m) const
 {
-  double lsum = 0, sum = 0;
-  int count = 0;
+  int nols = _soilColumn.vs_NumberOfLayers();
 
-  for(int i = 0, nols = _simPs.p_NumberOfLayers; i < nols; i++)
+  bool uniformLayers = true;
+  for(int i = 0; i < nols && uniformLayers; i++)
+    uniformLayers = _soilColumn[i].vs_LayerThickness == _soilColumn.vs_LayerThickness();
+
+  double sum = 0;
+  if(uniformLayers)
   {
-    count++;
-    sum += _soilColumn[i].get_SoilNO3(); //[kg m-3]
-    lsum += _soilColumn[i].vs_LayerThickness;
-    if(lsum >= depth_m)
-      break;
+    double lsum = 0;
+    for(int i = 0; i < nols; i++)
+    {
+      sum += _soilColumn[i].get_SoilNO3(); //[kg m-3]
+      lsum += _soilColumn[i].vs_LayerThickness;
+      if(lsum >= depth_m)
+        break;
+    }
+  }
+  else
+  {
+    for(int i = 0; i < nols && _soilColumn.layerTopDepth(i) < depth_m; i++)
+      sum += _soilColumn[i].get_SoilNO3() * nominalLayersAbove(_soilColumn, i, depth_m); //[kg m-3]
   }
 
   return sum;
@@ -973,12 +1040,16 @@ double MonicaModel::getAccumulatedFrostDepth() const
  */
 double MonicaModel::avg30cmSoilTemperature() const
 {
-  double nols = 3;
+  int nols = _soilColumn.getLayerNumberForDepth(0.3) + 1;
   double acc = 0.0;
+  double lsum = 0.0;
   for (int l = 0; l < nols; l++)
-    acc += _soilColumn.at(l).get_Vs_SoilTemperature();
+  {
+    acc += _soilColumn.at(l).get_Vs_SoilTemperature() * _soilColumn.at(l).vs_LayerThickness;
+    lsum += _soilColumn.at(l).vs_LayerThickness;
+  }
 
-  return acc / nols;
+  return acc / lsum;
 }
 
 /**
@@ -1095,14 +1166,16 @@ double MonicaModel::getETa() const
 }
 
 /**
- * Returns sum of evolution rate in first three layers.
+ * Returns sum of evolution rate in first 30cm soil.
+ * Layers are weighted by their thickness, the last one is cut at 30cm.
  * @return
  */
 double MonicaModel::get_sum30cmSMB_CO2EvolutionRate() const
 {
   double sum = 0.0;
-  for (int layer=0; layer<3; layer++) {
-    sum+=_soilOrganic.get_SMB_CO2EvolutionRate(layer);
+  int nols = min(_soilColumn.getLayerNumberForDepth(0.3) + 1, _soilColumn.vs_NumberOfOrganicLayers());
+  for (int layer=0; layer<nols; layer++) {
+    sum+=_soilOrganic.get_SMB_CO2EvolutionRate(layer) * nominalLayersAbove(_soilColumn, layer, 0.3);
   }
 
   return sum;
@@ -1129,14 +1202,16 @@ double MonicaModel::getSumNH3Volatilised() const
 
 /**
  * Returns sum of denitrification rate in first 30cm soil.
+ * Layers are weighted by their thickness, the last one is cut at 30cm.
  * @return Denitrification rate [kg N m-3 d-1]
  */
 double MonicaModel::getsum30cmActDenitrificationRate() const
 {
   double sum=0.0;
-  for (int layer=0; layer<3; layer++) {
+  int nols = min(_soilColumn.getLayerNumberForDepth(0.3) + 1, _soilColumn.vs_NumberOfOrganicLayers());
+  for (int layer=0; layer<nols; layer++) {
 //    cout << "DENIT: " << _soilOrganic.get_ActDenitrificationRate(layer) << endl;
-    sum+=_soilOrganic.get_ActDenitrificationRate(layer);
+    sum+=_soilOrganic.get_ActDenitrificationRate(layer) * nominalLayersAbove(_soilColumn, layer, 0.3);
   }
 
   return sum;
@@ -1145,5 +1220,60 @@ double MonicaModel::getsum30cmActDenitrificationRate() const
 void MonicaModel::clearEvents() 
 { 
 	_previousDaysEvents = _currentEvents;
-	_currentEvents.clear(); 
+	_currentEvents.reset(); 
+}
+
+namespace
+{
+	//! the fixed table of all events fired by MONICA, built once and read-only afterwards,
+	//! so names coming with runs (specs, workstep "after" keys) can't make it grow
+	struct EventRegistry
+	{
+		EventRegistry()
+		{
+			for(auto name : {"Workstep", "Sowing", "AutomaticSowing", "Harvest", "AutomaticHarvest",
+			                 "Cutting", "MineralFertilization", "NDemandFertilization", "OrganicFertilization",
+			                 "Tillage", "SetValue", "Irrigation", "anthesis", "maturity"})
+				add(name);
+			//crops may have more stages than are stored inline, so all the remaining ids are used for stages,
+			//seedCrop refuses crops with even more stages (see noOfStageEvents)
+			while(names.size() < MaxNumberOfEvents)
+				add(string("Stage-") + to_string(++noOfStageEvents));
+		}
+
+		void add(const string& name)
+		{
+			assert(names.size() < MaxNumberOfEvents);
+			name2id[name] = int(names.size());
+			names.push_back(name);
+		}
+
+		map<string, int> name2id;
+		vector<string> names;
+		size_t noOfStageEvents{0};
+	};
+
+	const EventRegistry& eventRegistry()
+	{
+		static const EventRegistry registry;
+		return registry;
+	}
+}
+
+int Monica::eventId(const std::string& name)
+{
+	const auto& r = eventRegistry();
+	auto it = r.name2id.find(name);
+	return it != r.name2id.end() ? it->second : -1;
+}
+
+size_t Monica::noOfStageEvents()
+{
+	return eventRegistry().noOfStageEvents;
+}
+
+std::string Monica::eventName(int id)
+{
+	const auto& r = eventRegistry();
+	return 0 <= id && size_t(id) < r.names.size() ? r.names.at(id) : string();
 }
\ No newline at end of file
@@ -29,14 +29,18 @@ Copyright (C) Leibniz Centre for Agricultural Landscape Research (ZALF)
 #include <memory>
 #include <queue>
 #include <set>
+#include <bitset>
 
 #include "climate/climate-common.h"
 #include "soilcolumn.h"
 #include "soiltemperature.h"
 #include "soilmoisture.h"
+#include "reference-evapotranspiration.h"
+#include "solar-geometry.h"
 #include "soilorganic.h"
 #include "soiltransport.h"
 #include "crop.h"
+#include "crop-growth.h"
 #include "tools/date.h"
 #include "tools/datastructures.h"
 #include "monica-parameters.h"
@@ -51,6 +55,24 @@ namespace Monica
 	/* forward declaration */
 	class Configuration;
 
+	const std::size_t MaxNumberOfEvents = 64;
+
+	//! the events of a day, one bit per event MONICA can fire
+	typedef std::bitset<MaxNumberOfEvents> EventSet;
+
+	//! get the id of an event MONICA fires (worksteps, "anthesis", "maturity", "Stage-N"),
+	//! names from user input are only looked up, unknown names get -1 and never match an event
+	int eventId(const std::string& name);
+
+	//! get the name of an event id
+	std::string eventName(int id);
+
+	//! the number of "Stage-N" events (N = 1 .. noOfStageEvents()), crops with more developmental stages can't be sown
+	std::size_t noOfStageEvents();
+
+	//! test if event id (-1 = no event) is part of the event set
+	inline bool hasEvent(const EventSet& events, int id) { return id >= 0 && events.test(std::size_t(id)); }
+
 
 	//----------------------------------------------------------------------------
 
@@ -234,6 +256,9 @@ namespace Monica
 
 		CropGrowth* cropGrowth() const { return _currentCropGrowth; }
 
+		//! the CropDiagnostics groups the outputs depend on, the others won't be calculated
+		void setCropDiagnostics(int groups) { _cropDiagnostics = groups; }
+
 		double netRadiation(double globrad) { return globrad * (1 - _envPs.p_Albedo); }
 
 		int daysWithCrop() const {return p_daysWithCrop; }
@@ -263,10 +288,14 @@ namespace Monica
 		
 		const std::vector<std::map<Climate::ACD, double>>& climateData() const { return _climateData; }
 
-		void addEvent(std::string e) { _currentEvents.insert(e); }
+		//! weather dependent evapotranspiration terms of the current step
+		const DailyAtmosphere& dailyAtmosphere() const { return _dailyAtmosphere; }
+
+		void addEvent(int eventId) { if(eventId >= 0) _currentEvents.set(std::size_t(eventId)); }
+		void addEvent(const std::string& e) { addEvent(eventId(e)); }
 		void clearEvents();
-		const std::set<std::string>& currentEvents() const { return _currentEvents; }
-		const std::set<std::string>& previousDaysEvents() const { return _previousDaysEvents; }
+		const EventSet& currentEvents() const { return _currentEvents; }
+		const EventSet& previousDaysEvents() const { return _previousDaysEvents; }
 		
 		int cultivationMethodCount() const { return _cultivationMethodCount; }
 
@@ -299,6 +328,7 @@ namespace Monica
 		std::vector<double> _rad24, _rad240, _tfol24, _tfol240;
 		int _index24{0}, _index240{0};
 		bool _full24{false}, _full240{false};
+		int _cropDiagnostics{ALL_CROP_DIAGNOSTICS};
 
 		//! store applied fertiliser during one production process
 		double _sumFertiliser{0.0}; //mineral N
@@ -320,8 +350,10 @@ namespace Monica
 
 		Tools::Date _currentStepDate;
 		std::vector<std::map<Climate::ACD, double>> _climateData;
-		std::set<std::string> _currentEvents;
-		std::set<std::string> _previousDaysEvents;
+		DailyAtmosphere _dailyAtmosphere; //!< shared by soil moisture and crop growth
+		std::shared_ptr<const SolarGeometry> _solarGeometry; //!< of the site's latitude
+		EventSet _currentEvents;
+		EventSet _previousDaysEvents;
 
 		bool _clearCropUponNextDay{false};
 
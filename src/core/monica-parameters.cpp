@@ -16,12 +16,14 @@ Copyright (C) Leibniz Centre for Agricultural Landscape Research (ZALF)
 */
 
 #include <map>
+#include <algorithm>
 #include <sstream>
 #include <iostream>
 #include <fstream>
 #include <cmath>
 #include <utility>
 #include <mutex>
+#include <tuple>
 
 #include "monica-parameters.h"
 #include "db/abstract-db-connections.h"
@@ -384,6 +386,35 @@ json11::Json CropParameters::to_json() const
     {"cultivar", cultivarParams.to_json()}};
 }
 
+CropParametersPtr Monica::internCropParameters(CropParametersPtr cps,
+                                               json11::Json source)
+{
+	if(!cps)
+		return cps;
+
+	// the blocks are only kept as long as a crop or run is using them
+	static mutex lockable;
+	typedef pair<string, string> Key;
+	static map<Key, vector<pair<json11::Json, weak_ptr<CropParameters>>>> key2cps;
+
+	Key key(cps->speciesParams.pc_SpeciesId, cps->cultivarParams.pc_CultivarId);
+
+	lock_guard<mutex> lock(lockable);
+	auto& candidates = key2cps[key];
+	for(auto it = candidates.begin(); it != candidates.end();)
+	{
+		auto shared = it->second.lock();
+		if(!shared)
+			it = candidates.erase(it);
+		else if(shared == cps || (!source.is_null() && it->first == source))
+			return shared;
+		else
+			++it;
+	}
+	candidates.push_back(make_pair(source, weak_ptr<CropParameters>(cps)));
+	return cps;
+}
+
 
 //------------------------------------------------------------------------------
 
@@ -635,7 +666,7 @@ Errors SiteParameters::merge(json11::Json j)
 
 	if(j.has_shape({{"SoilProfileParameters", json11::Json::ARRAY}}, err))
 	{
-		auto p = createSoilPMs(j["SoilProfileParameters"].array_items());
+		auto p = sharedSoilPMs(j["SoilProfileParameters"].array_items());
 		vs_SoilParameters = p.first;
 		if(p.second.failure())
 			res.append(p.second);
@@ -668,6 +699,30 @@ json11::Json SiteParameters::to_json() const
   return sps;
 }
 
+pair<SoilPMsPtr, Errors> Monica::sharedSoilPMs(const J11Array& soilProfileParameters)
+{
+	// grid runs come back to the same few profiles over and over, so keep them for the whole process
+	static mutex lockable;
+	static map<string, pair<SoilPMsPtr, Errors>> profile2sps;
+	static const size_t maxNoOfProfiles = 10000;
+
+	string profile = json11::Json(soilProfileParameters).dump();
+	{
+		lock_guard<mutex> lock(lockable);
+		auto ci = profile2sps.find(profile);
+		if(ci != profile2sps.end())
+			return ci->second;
+	}
+
+	auto p = createSoilPMs(soilProfileParameters);
+	pair<SoilPMsPtr, Errors> res(p.first, p.second);
+
+	lock_guard<mutex> lock(lockable);
+	if(profile2sps.size() >= maxNoOfProfiles)
+		profile2sps.clear();
+	return profile2sps.insert(make_pair(profile, res)).first->second;
+}
+
 //------------------------------------------------------------------------------
 
 AutomaticHarvestParameters::AutomaticHarvestParameters(HarvestTime yt)
@@ -865,6 +920,8 @@ Errors SimulationParameters::merge(json11::Json j)
   set_bool_value(p_UseAutomaticHarvestTrigger, j, "UseAutomaticHarvestTrigger");
   set_int_value(p_NumberOfLayers, j, "NumberOfLayers");
   set_double_value(p_LayerThickness, j, "LayerThickness");
+  set_double_vector(p_LayerThicknesses, j, "LayerThicknesses");
+  set_string_value(p_LayeringPreset, j, "LayeringPreset");
 
   set_int_value(p_StartPVIndex, j, "StartPVIndex");
   
@@ -892,10 +949,63 @@ json11::Json SimulationParameters::to_json() const
   ,{"UseAutomaticHarvestTrigger", p_UseAutomaticHarvestTrigger}
   ,{"NumberOfLayers", p_NumberOfLayers}
   ,{"LayerThickness", p_LayerThickness}
+  ,{"LayerThicknesses", toPrimJsonArray(p_LayerThicknesses)}
+  ,{"LayeringPreset", p_LayeringPreset}
   ,{"StartPVIndex", p_StartPVIndex}
 	};
 }
 
+/**
+ * @brief Returns the thicknesses of the soil layers
+ *
+ * The profile depth is always p_NumberOfLayers * p_LayerThickness, the
+ * presets just distribute it differently onto the layers:
+ * "fine-topsoil" halves the layers down to 30 cm, "coarse-subsoil" doubles
+ * the layers below 1 m. The last layer is cut to fit the profile depth.
+ *
+ * @return thicknesses from top to bottom [m], empty for a uniform layering
+ */
+vector<double> SimulationParameters::layerThicknesses() const
+{
+	if(!p_LayerThicknesses.empty())
+		return p_LayerThicknesses;
+
+	bool fineTopsoil = p_LayeringPreset == "fine-topsoil" 
+		|| p_LayeringPreset == "fine-topsoil-coarse-subsoil";
+	bool coarseSubsoil = p_LayeringPreset == "coarse-subsoil" 
+		|| p_LayeringPreset == "fine-topsoil-coarse-subsoil";
+	if(!fineTopsoil && !coarseSubsoil)
+	{
+		if(!p_LayeringPreset.empty() && p_LayeringPreset != "uniform")
+			cerr << "Unknown LayeringPreset: " << p_LayeringPreset << " using uniform layers!" << endl;
+		return vector<double>();
+	}
+
+	const double topsoilDepth = 0.3; // [m]
+	const double subsoilDepth = 1.0; // [m]
+	const double eps = 1e-9;
+
+	double profileDepth = p_NumberOfLayers * p_LayerThickness;
+	vector<double> lts;
+	double depth = 0.0;
+	while(depth < profileDepth - eps)
+	{
+		double lt = p_LayerThickness;
+		if(fineTopsoil && depth < topsoilDepth - eps)
+			lt = min(0.5 * p_LayerThickness, topsoilDepth - depth);
+		else if(coarseSubsoil && depth >= subsoilDepth - eps)
+			lt = 2.0 * p_LayerThickness;
+		else if(coarseSubsoil)
+			lt = min(p_LayerThickness, subsoilDepth - depth);
+
+		lt = min(lt, profileDepth - depth);
+		lts.push_back(lt);
+		depth += lt;
+	}
+
+	return lts;
+}
+
 //-----------------------------------------------------------------------------------------
 
 UserCropParameters::UserCropParameters(json11::Json j)
@@ -1023,6 +1133,31 @@ json11::Json UserEnvironmentParameters::to_json() const
 
 //-----------------------------------------------------------------------------------------
 
+const int CapillaryRiseRates::maxDistance;
+
+CapillaryRiseRates::CapillaryRiseRates(std::function<double(std::string, int)> getRate)
+	: _getRate(getRate)
+{}
+
+shared_ptr<const CapillaryRiseRates::Table> 
+CapillaryRiseRates::table(const string& soilTexture) const
+{
+	lock_guard<mutex> lock(_lock);
+
+	auto it = _tables.find(soilTexture);
+	if(it != _tables.end())
+		return it->second;
+
+	auto t = make_shared<Table>(maxDistance + 1, 0.0);
+	for(int d = 1; d <= maxDistance; d++)
+		(*t)[d] = _getRate(soilTexture, d);
+	(*t)[0] = (*t)[1];
+
+	return _tables[soilTexture] = t;
+}
+
+//-----------------------------------------------------------------------------------------
+
 UserSoilMoistureParameters::UserSoilMoistureParameters()
 {
 	getCapillaryRiseRate = [](string soilTexture, int distance) { return 0; };
@@ -1219,6 +1354,10 @@ Errors UserSoilOrganicParameters::merge(json11::Json j)
   set_double_value(po_AtmosphericResistance, j, "AtmosphericResistance");
   set_double_value(po_N2OProductionRate, j, "N2OProductionRate");
   set_double_value(po_Inhibitor_NH3, j, "Inhibitor_NH3");
+  set_double_value(po_AOM_PoolCompactionTolerance, j, "AOM_PoolCompactionTolerance");
+  set_int_value(po_SpinUpDays, j, "SpinUpDays");
+  set_bool_value(po_SpinUpKeepTotalCarbon, j, "SpinUpKeepTotalCarbon");
+  set_int_value(po_SpinUpBruteForceYears, j, "SpinUpBruteForceYears");
   set_double_value(ps_MaxMineralisationDepth, j, "MaxMineralisationDepth");
 
 	return res;
@@ -1263,6 +1402,10 @@ json11::Json UserSoilOrganicParameters::to_json() const
     {"AtmosphericResistance", J11Array {po_AtmosphericResistance, "s m-1"}},
     {"N2OProductionRate", J11Array {po_N2OProductionRate, "d-1"}},
     {"Inhibitor_NH3", J11Array {po_Inhibitor_NH3, "kg N m-3"}},
+    {"AOM_PoolCompactionTolerance", J11Array {po_AOM_PoolCompactionTolerance, ""}},
+    {"SpinUpDays", J11Array {po_SpinUpDays, "d"}},
+    {"SpinUpKeepTotalCarbon", po_SpinUpKeepTotalCarbon},
+    {"SpinUpBruteForceYears", po_SpinUpBruteForceYears},
     {"MaxMineralisationDepth", ps_MaxMineralisationDepth}
   };
 }
@@ -28,6 +28,7 @@ Copyright (C) Leibniz Centre for Agricultural Landscape Research (ZALF)
 #include <iostream>
 #include <memory>
 #include <functional>
+#include <mutex>
 #include <assert.h>
 
 #include "json11/json11.hpp"
@@ -256,6 +257,14 @@ namespace Monica
 
 	typedef std::shared_ptr<CropParameters> CropParametersPtr;
 
+	//! return a shared instance equal to cps, so crops and runs with identical
+	//! parameters use the same block, which must be treated as read-only afterwards
+	//! blocks are looked up by their species and cultivar ids and are the same
+	//! if they were made from the same source (e.g. the crop's JSON or the database schema),
+	//! without a source cps is only registered
+	DLL_API CropParametersPtr internCropParameters(CropParametersPtr cps,
+	                                               json11::Json source = json11::Json());
+
 	//----------------------------------------------------------------------------
 
 	enum FertiliserType { mineral, organic, undefined };
@@ -425,6 +434,12 @@ namespace Monica
 		Soil::SoilPMsPtr vs_SoilParameters;
 	};
 
+	//! create the soil parameters of a soil profile, but return the shared instance for
+	//! a profile seen before, so sites with repeated profiles skip the texture and pedotransfer
+	//! conversions and use the same block, which must be treated as read-only afterwards
+	DLL_API std::pair<Soil::SoilPMsPtr, Tools::Errors>
+	sharedSoilPMs(const json11::Json::array& soilProfileParameters);
+
 	//----------------------------------------------------------------------------
 
 	/**
@@ -593,6 +608,18 @@ namespace Monica
 		int p_NumberOfLayers{ 20 };
 		double p_LayerThickness{ 0.1 };
 
+		//! explicit thicknesses of the soil layers from top to bottom [m],
+		//! if set, overrides p_NumberOfLayers and p_LayerThickness
+		std::vector<double> p_LayerThicknesses;
+
+		//! name of a predefined variable layering of the profile,
+		//! "uniform" (default), "fine-topsoil", "coarse-subsoil" or "fine-topsoil-coarse-subsoil"
+		std::string p_LayeringPreset{ "uniform" };
+
+		//! the thicknesses of the soil layers to be used [m] or
+		//! an empty vector if all layers are p_LayerThickness thick
+		std::vector<double> layerThicknesses() const;
+
 		int p_StartPVIndex{ 0 };
 		int p_JulianDayAutomaticFertilising{ 0 };
 	};
@@ -667,6 +694,33 @@ namespace Monica
 
 	};
 
+	//----------------------------------------------------------------------------
+
+	/**
+	 * @brief Capillary rise rates per soil texture, resolved once into dense tables.
+	 *
+	 * A table holds the rates [m d-1] indexed by the groundwater distance [dm]
+	 * (index 0 uses the rate of 1 dm), so the daily capillary rise does not
+	 * need to touch texture strings or the rate source anymore. Tables are
+	 * shared by all soil columns with the same texture.
+	 */
+	class DLL_API CapillaryRiseRates
+	{
+	public:
+		static const int maxDistance = 27; //!< [dm], rates are only defined until 2.70 m
+
+		typedef std::vector<double> Table;
+
+		CapillaryRiseRates(std::function<double(std::string, int)> getRate);
+
+		std::shared_ptr<const Table> table(const std::string& soilTexture) const;
+
+	private:
+		std::function<double(std::string, int)> _getRate;
+		mutable std::mutex _lock;
+		mutable std::map<std::string, std::shared_ptr<const Table>> _tables;
+	};
+
 	//----------------------------------------------------------------------------
 
 	  /**
@@ -685,6 +739,9 @@ namespace Monica
 
 		std::function<double(std::string, int)> getCapillaryRiseRate;
 
+		//! optional resolved tables of getCapillaryRiseRate, e.g. to share them between several runs
+		std::shared_ptr<CapillaryRiseRates> capillaryRiseRates;
+
 		double pm_CriticalMoistureDepth{ 0.0 };
 		double pm_SaturatedHydraulicConductivity{ 0.0 };
 		double pm_SurfaceRoughness{ 0.0 };
@@ -815,6 +872,10 @@ namespace Monica
 		double po_AtmosphericResistance{ 0.0025 }; // 0.0025 [s m-1], from Sadeghi et al. 1988
 		double po_N2OProductionRate{ 0.5 }; // 0.5 [d-1]
 		double po_Inhibitor_NH3{ 1.0 }; // 1.0 [kg N m-3] NH3-induced inhibitor for nitrite oxidation
+		double po_AOM_PoolCompactionTolerance{ 0.0 }; // 0.0 [], relative C/N ratio difference up to which AOM pools get merged
+		int po_SpinUpDays{ 0 }; // 0 [d], length of the forcing cycle the SOM/SMB pools are equilibrated to, 0 = no accelerated spin-up
+		bool po_SpinUpKeepTotalCarbon{ true }; // true, scale the equilibrated pools to the initial SOM + SMB carbon of each layer
+		int po_SpinUpBruteForceYears{ 0 }; // 0 [], > 0 = compare the equilibrium with this many forcing cycles simulated in a row
 
 		double ps_MaxMineralisationDepth{ 0.4 };
 	};
@@ -18,6 +18,8 @@ Copyright (C) Leibniz Centre for Agricultural Landscape Research (ZALF)
 #define _USE_MATH_DEFINES
 #include <math.h>
 #include <iostream>
+#include <sstream>
+#include <algorithm>
 
 #include  "photosynthesis-FvCB.h"
 #include "tools/helper.h"
@@ -26,9 +28,6 @@ using namespace FvCB;
 using namespace Tools;
 using namespace std;
 
-std::map<FvCB_Model_Consts, double> FvCB::c_bernacchi = {{Rd, 18.72},{Vcmax, 26.35},{Vomax, 22.98},{Gamma, 19.02},{Kc, 38.05},{Ko, 20.30},{Jmax, 17.57}}; //dimensionless
-std::map<FvCB_Model_Consts, double> FvCB::deltaH_bernacchi = {{Rd, 46.39},{Vcmax, 65.33},{Vomax, 60.11},{Gamma, 37.83},{Kc, 79.43},{Ko, 36.38},{Jmax, 43.54}}; //kJ mol - 1
-
 //estimate the fraction of diffuse radiation; it requires hourly input
 double diffuse_fraction_hourly_f(double globrad, double extra_terr_rad, double solar_elev)
 {
@@ -210,29 +209,30 @@ std::tuple<double, double> LAI_sunlit_shaded_f(double LAI, double solar_elev)
 //FvCB model params
 
 //T response
-double Tresp_bernacchi_f(double c, double deltaH, double leafT)
+double Tresp_bernacchi_f(FvCB_Model_Consts which, double leafT)
 {
 	double Tk = leafT + 273;
 	double R = 8.314472 * pow(10, -3); //kJ K - 1 mol - 1
-	return exp(c - deltaH / (R * Tk));
+	return exp(c_bernacchi[which] - deltaH_bernacchi[which] / (R * Tk));
 }
 
+//the value at 25oC calculated with bernacchi slightly deviates from 1
+const double Tresp_Vcmax_25 = Tresp_bernacchi_f(Vcmax, 25.0);
+
 double FvCB::Vcmax_bernacchi_f(double leafT, double Vcmax_25)
 {
-	return Vcmax_25 * Tresp_bernacchi_f(c_bernacchi[Vcmax], deltaH_bernacchi[Vcmax], leafT);
+	return Vcmax_25 * Tresp_bernacchi_f(Vcmax, leafT);
 }
 
 double FvCB::Jmax_bernacchi_f(double leafT, double Jmax_25)
 {
-	return Jmax_25 * Tresp_bernacchi_f(c_bernacchi[Jmax], deltaH_bernacchi[Jmax], leafT);
+	return Jmax_25 * Tresp_bernacchi_f(Jmax, leafT);
 }
 
-double J_bernacchi_f(double Q, double leafT, double Jmax)
+double J_f(double Q, double theta_ps2, double phi_ps2max, double Jmax)
 {
 	double alfa = 0.85; //total leaf absorbance 
 	double beta = 0.5; //fraction of absorbed quanta reaching PSII
-	double theta_ps2 = 0.76 + 0.018 * leafT - 3.7 * pow(10, -4) * pow(leafT, 2);
-	double phi_ps2max = 0.352 + 0.022 *leafT - 3.4 * pow(10, -4) * pow(leafT, 2);
 	double Q2 = Q * alfa * phi_ps2max * beta;
 
 	double numerator = Q2 + Jmax - sqrt(pow((Q2 + Jmax), 2) - 4 * theta_ps2 * Q2 * Jmax);
@@ -248,26 +248,6 @@ double J_grote_f(double Q, double Jmax)
 	double  jj = tmp_var > 0.0 ? (Q + Jmax - sqrt(tmp_var)) / (2.0 * species_THETA) : 0.0;
 	return jj;
 }
-	
-double Rd_bernacchi_f(double leafT)
-{
-	return Tresp_bernacchi_f(c_bernacchi[Rd], deltaH_bernacchi[Rd], leafT);
-}
-
-double Vomax_bernacchi_f(double leafT, double Vcmax_25)
-{
-	return Vcmax_25 * Tresp_bernacchi_f(c_bernacchi[Vomax], deltaH_bernacchi[Vomax], leafT);
-}
-
-double Kc_bernacchi_f(double leafT)
-{
-	return Tresp_bernacchi_f(c_bernacchi[Kc], deltaH_bernacchi[Kc], leafT);
-}
-
-double Ko_bernacchi_f(double leafT)
-{
-	return Tresp_bernacchi_f(c_bernacchi[Ko], deltaH_bernacchi[Ko], leafT);
-}
 
 double Oi_f(double leafT)
 {
@@ -277,10 +257,25 @@ double Oi_f(double leafT)
 	return 210 * (4.7 * pow(10, -2) - T1 + T2 - T3) / (2.6934 * pow(10, -2));
 }
 
-double Gamma_bernacchi_f(double leafT, double Vcmax, double Vomax)
+FvCB_leaf_T_responses FvCB::FvCB_leaf_T_responses_f(double leafT)
+{
+	FvCB_leaf_T_responses tr;
+	tr.Vcmax = Tresp_bernacchi_f(Vcmax, leafT);
+	tr.Jmax = Tresp_bernacchi_f(Jmax, leafT);
+	tr.Vomax = Tresp_bernacchi_f(Vomax, leafT);
+	tr.Rd = Tresp_bernacchi_f(Rd, leafT);
+	tr.Kc = Tresp_bernacchi_f(Kc, leafT);
+	tr.Ko = Tresp_bernacchi_f(Ko, leafT);
+	tr.Oi = Oi_f(leafT);
+	tr.theta_ps2 = 0.76 + 0.018 * leafT - 3.7 * pow(10, -4) * pow(leafT, 2);
+	tr.phi_ps2max = 0.352 + 0.022 *leafT - 3.4 * pow(10, -4) * pow(leafT, 2);
+	return tr;
+}
+
+double Gamma_bernacchi_f(const FvCB_leaf_T_responses& tr, double Vcmax, double Vomax)
 {
-	double numerator = 0.5 * Vomax * Kc_bernacchi_f(leafT) * Oi_f(leafT);
-	double denominator = Vcmax * Ko_bernacchi_f(leafT);
+	double numerator = 0.5 * Vomax * tr.Kc * tr.Oi;
+	double denominator = Vcmax * tr.Ko;
 	return flt_equal_zero(denominator) ? 0.0 : numerator / denominator;
 }
 
@@ -356,10 +351,10 @@ double fVPD_f(double VPD)
 #pragma region 
 //Lumped coefficients cubic equation C3
 
-std::tuple<double, double> x_rubisco(double leafT, double Vcmax)
+std::tuple<double, double> x_rubisco(const FvCB_leaf_T_responses& tr, double Vcmax)
 {
 	double x1 = Vcmax;
-	double x2 = Kc_bernacchi_f(leafT) * (1 + Oi_f(leafT) / Ko_bernacchi_f(leafT));
+	double x2 = tr.Kc * (1 + tr.Oi / tr.Ko);
 
 	return std::make_tuple(x1, x2);
 }
@@ -521,140 +516,177 @@ ostream& FvCB::tout(bool closeFile)
 
 #pragma region
 //Model composition (C3)
-FvCB_canopy_hourly_out FvCB::FvCB_canopy_hourly_C3(FvCB_canopy_hourly_in in, FvCB_canopy_hourly_params par)
+//fill hour h of a prepared day with the terms which don't depend on Vcmax_25
+void prepare_hour_C3(FvCB_canopy_day& day, int h, const FvCB_canopy_hourly_in& in, double kn)
+{
+	day.global_rad[h] = in.global_rad;
+	day.leaf_temp[h] = in.leaf_temp;
+
+	//temperature and VPD responses
+	auto tr = FvCB_leaf_T_responses_f(in.leaf_temp);
+	day.tresp_Vcmax[h] = tr.Vcmax;
+	day.tresp_Jmax[h] = tr.Jmax;
+	day.tresp_Vomax[h] = tr.Vomax;
+	day.Rd[h] = tr.Rd;
+	day.kc[h] = tr.Kc;
+	day.ko[h] = tr.Ko;
+	day.oi[h] = tr.Oi;
+	day.theta_ps2[h] = tr.theta_ps2;
+	day.phi_ps2max[h] = tr.phi_ps2max;
+	day.fVPD[h] = fVPD_f(in.VPD);
+
+	//sunlit/shaded LAI and capacity
+	double el = in.solar_el;
+	double kb = el > 0 ? 0.5 / sin(el) : 1000; //beam radiation extinction coefficient of canopy
+	double up = el < 0 ? 0.0 : 1.0;
+	day.LAI_sun[h] = up * (1 - exp(-kb * in.LAI)) / kb;
+	day.LAI_sh[h] = in.LAI - day.LAI_sun[h];
+	day.Vc_sun_per_Vcmax[h] = up * in.LAI * (1 - exp(-kn - kb * in.LAI)) / (kn + kb * in.LAI);
+
+	//absorbed radiation, only during daylight
+	day.daylight[h] = in.global_rad > 0.0;
+	day.Ic_sun[h] = day.Ic_sh[h] = 0.0;
+	if (!day.daylight[h])
+		return;
+
+	double diffuse_fraction = diffuse_fraction_hourly_f(in.global_rad, in.extra_terr_rad, in.solar_el);
+	double hourly_diffuse_rad = in.global_rad * diffuse_fraction;
+	double hourly_direct_rad = in.global_rad - hourly_diffuse_rad;
+	double inst_diff_rad = hourly_diffuse_rad * pow(10, 6) / 3600.0 * 4.56 * 0.45; //umol m - 2 s - 1 (unit ground area)
+	double inst_dir_rad = hourly_direct_rad * pow(10, 6) / 3600.0 * 4.56 * 0.45; //1 W m-2 = 4.56 umol m-2 s-1; PAR = 0.45 * global radiation 
+
+	day.Ic_sun[h] = Ic_sun_f(inst_dir_rad, inst_diff_rad, in.solar_el, in.LAI);
+	day.Ic_sh[h] = Ic_f(inst_dir_rad, inst_diff_rad, in.solar_el, in.LAI) - day.Ic_sun[h];
+}
+
+FvCB_canopy_hourly_in FvCB::FvCB_canopy_day_in::at(int h) const
 {
-	FvCB_canopy_hourly_out out;
-	//0. initialize VOCE out
-	out.sunlit.vcMax = 0.0;
-	out.sunlit.jMax = 0.0;
-	out.sunlit.jj = 0.0;
+	FvCB_canopy_hourly_in in;
+	in.global_rad = global_rad[h];
+	in.extra_terr_rad = extra_terr_rad[h];
+	in.solar_el = solar_el[h];
+	in.LAI = LAI;
+	in.leaf_temp = leaf_temp[h];
+	in.VPD = VPD[h];
+	in.Ca = Ca;
+	return in;
+}
 
-	out.shaded.vcMax = 0.0;
-	out.shaded.jMax = 0.0;
-	out.shaded.jj = 0.0;
+FvCB_canopy_day FvCB::FvCB_canopy_day_C3(const FvCB_canopy_day_in& in, double kn)
+{
+	FvCB_canopy_day day;
+	day.Ca = in.Ca;
+	day.tresp_Vcmax_25 = Tresp_Vcmax_25;
+	day.Vc_per_Vcmax = in.LAI * (1 - exp(-kn)) / kn;
 
-	out.sunlit.jj1000 = 0.0;
-	out.shaded.jj1000 = 0.0;
-	
-	out.sunlit.jv = 0.0;
-	out.shaded.jv = 0.0;
+	for (int h = 0; h < 24; h++)
+		prepare_hour_C3(day, h, in.at(h), kn);
 
-	//1. calculate diffuse and direct radiation
-	double diffuse_fraction = diffuse_fraction_hourly_f(in.global_rad, in.extra_terr_rad, in.solar_el);	
-	double hourly_diffuse_rad = in.global_rad * diffuse_fraction;
-	double hourly_direct_rad = in.global_rad - hourly_diffuse_rad;
-	double inst_diff_rad = hourly_diffuse_rad * pow(10, 6) / 3600.0 * 4.56 * 0.45; //mol m - 2 s - 1 (unit ground area)
-	double inst_dir_rad = hourly_direct_rad * pow(10, 6) / 3600.0 * 4.56 * 0.45; //1 W m-2 = 4.56 mol m-2 s-1; PAR = 0.45 * global radiation 
-	
-	//2. calculate Radiation absorbed by sunlit / shaded canopy
-	double Ic_sun = Ic_sun_f(inst_dir_rad, inst_diff_rad, in.solar_el, in.LAI); //mol m - 2 s - 1 (unit ground area)
-	double Ic_sh = Ic_shade_f(inst_dir_rad, inst_diff_rad, in.solar_el, in.LAI); //mol m - 2 s - 1 (unit ground area)
+	return day;
+}
 
-	//2.1. calculate sunlit/shaded LAI
-	std::tuple<double, double> sun_shade_LAI = LAI_sunlit_shaded_f(in.LAI, in.solar_el);
-	out.sunlit.LAI = std::get<0>(sun_shade_LAI);
-	out.shaded.LAI = std::get<1>(sun_shade_LAI);
+FvCB_canopy_hourly_out FvCB::FvCB_canopy_hourly_C3(FvCB_canopy_hourly_in in, FvCB_canopy_hourly_params par)
+{
+	//a day with just the one hour prepared
+	FvCB_canopy_day day;
+	day.Ca = in.Ca;
+	day.tresp_Vcmax_25 = Tresp_Vcmax_25;
+	day.Vc_per_Vcmax = in.LAI * (1 - exp(-par.kn)) / par.kn;
+	prepare_hour_C3(day, 0, in, par.kn);
+
+	return FvCB_canopy_hourly_C3(day, 0, par);
+}
+
+FvCB_canopy_hourly_out FvCB::FvCB_canopy_hourly_C3(const FvCB_canopy_day& day, int h, FvCB_canopy_hourly_params par)
+{
+	FvCB_canopy_hourly_out out = FvCB_canopy_hourly_out();
+	double leafT = day.leaf_temp[h];
+	double Ic_sun = day.Ic_sun[h];
+	double Ic_sh = day.Ic_sh[h];
+	out.sunlit.LAI = day.LAI_sun[h];
+	out.shaded.LAI = day.LAI_sh[h];
 
 #ifdef TEST_FVCB_HOURLY_OUTPUT
 	tout()
-		<< "," << in.leaf_temp
+		<< "," << leafT
 		<< "," << out.sunlit.LAI
 		<< "," << out.shaded.LAI
 		<< "," << Ic_sun
 		<< "," << Ic_sh;
 #endif
 
-	//For each fraction :
-	//-------------------
 	//3. canopy photosynthetic capacity
-	double Vcmax = Vcmax_bernacchi_f(in.leaf_temp, par.Vcmax_25);
-	double Vcmax_25 = Vcmax_bernacchi_f(25.0, par.Vcmax_25); //the value at 25C calculated with bernacchi slightly deviates from par.Vcmax_25
+	double Vcmax = par.Vcmax_25 * day.tresp_Vcmax[h];
+	double Vcmax_25 = par.Vcmax_25 * day.tresp_Vcmax_25;
 
-	//test
-	//Vcmax = 100.0;
-		
-	double Vc_25 = canopy_ps_capacity_f(in.LAI, Vcmax_25, par.kn); //mol m - 2 s - 1 (unit ground area)
-	double Vc_sun_25 = canopy_ps_capacity_sunlit_f(in.LAI, in.solar_el, Vcmax_25, par.kn);
+	double Vc_25 = day.Vc_per_Vcmax * Vcmax_25;
+	double Vc_sun_25 = day.Vc_sun_per_Vcmax[h] * Vcmax_25;
 	double Vc_sh_25 = Vc_25 - Vc_sun_25;
-	double Vc = canopy_ps_capacity_f(in.LAI, Vcmax, par.kn); 
-	double Vc_sun = canopy_ps_capacity_sunlit_f(in.LAI, in.solar_el, Vcmax, par.kn);
+	double Vc = day.Vc_per_Vcmax * Vcmax;
+	double Vc_sun = day.Vc_sun_per_Vcmax[h] * Vcmax;
 	double Vc_sh = Vc - Vc_sun;
-	//cout << Vc << endl;
 
 	//4. canopy electron transport capacity
-	double Jmax_c_sun_25 = 1.6 * Vc_sun_25; // mol m - 2 s - 1 (unit ground area)
-	double Jmax_c_sh_25 = 1.6 * Vc_sh_25; 
-	
-	double Jmax_c_sun = Jmax_bernacchi_f(in.leaf_temp, Jmax_c_sun_25);
-	double Jmax_c_sh = Jmax_bernacchi_f(in.leaf_temp, Jmax_c_sh_25);
+	double Jmax_c_sun = 1.6 * Vc_sun_25 * day.tresp_Jmax[h];
+	double Jmax_c_sh = 1.6 * Vc_sh_25 * day.tresp_Jmax[h];
 	out.jmax_c = Jmax_c_sun + Jmax_c_sh;
 
-	double J_c_sun = J_bernacchi_f(Ic_sun, in.leaf_temp, Jmax_c_sun); //mol m - 2 s - 1 (unit ground area)
-	double J_c_sh = J_bernacchi_f(Ic_sh, in.leaf_temp, Jmax_c_sh);
-	//double J_c_sun = J_grote_f(Ic_sun, Jmax_c_sun); //mol m - 2 s - 1 (unit ground area)
-	//double J_c_sh = J_grote_f(Ic_sh, Jmax_c_sh);
-	
-	//5. canopy respiration
-	double Rd_sun = Rd_bernacchi_f(in.leaf_temp)* out.sunlit.LAI; //mol m - 2 s - 1 (unit ground area)
-	double Rd_sh = Rd_bernacchi_f(in.leaf_temp)* out.shaded.LAI;
+	double theta = day.theta_ps2[h];
+	double phi = day.phi_ps2max[h];
+	double J_c_sun = J_f(Ic_sun, theta, phi, Jmax_c_sun);
+	double J_c_sh = J_f(Ic_sh, theta, phi, Jmax_c_sh);
 
+	//5. canopy respiration
+	double Rd_sun = day.Rd[h] * out.sunlit.LAI;
+	double Rd_sh = day.Rd[h] * out.shaded.LAI;
 	out.canopy_resp = (Rd_sun + Rd_sh) * 3600.0;
-	
-	//6. Coupled photosynthesis - stomatal conductance
-	//6.1. estimate inputs (for solving cubic equation)
+
 	//6.1.1 Gamma
-	double Vomax_sun = Vomax_bernacchi_f(in.leaf_temp, Vc_sun_25);
-	double Vomax_sh = Vomax_bernacchi_f(in.leaf_temp, Vc_sh_25);
-	double gamma_sun = Gamma_bernacchi_f(in.leaf_temp, Vc_sun, Vomax_sun);
-	double gamma_sh = Gamma_bernacchi_f(in.leaf_temp, Vc_sh, Vomax_sh);
-
-	//calculate some outputs to be used in VOCE modules
-	out.sunlit.kc = out.shaded.kc = Kc_bernacchi_f(in.leaf_temp);
-	out.sunlit.ko = out.shaded.ko = Ko_bernacchi_f(in.leaf_temp);
-	out.sunlit.oi = out.shaded.oi = Oi_f(in.leaf_temp);
-	out.sunlit.comp = gamma_sun; 
+	double kc = day.kc[h], ko = day.ko[h], oi = day.oi[h];
+	auto gamma_f = [=](double Vc_, double Vomax_)
+	{
+		double denominator = Vc_ * ko;
+		return flt_equal_zero(denominator) ? 0.0 : 0.5 * Vomax_ * kc * oi / denominator;
+	};
+	double gamma_sun = gamma_f(Vc_sun, Vc_sun_25 * day.tresp_Vomax[h]);
+	double gamma_sh = gamma_f(Vc_sh, Vc_sh_25 * day.tresp_Vomax[h]);
+
+	out.sunlit.kc = out.shaded.kc = kc;
+	out.sunlit.ko = out.shaded.ko = ko;
+	out.sunlit.oi = out.shaded.oi = oi;
+	out.sunlit.comp = gamma_sun;
 	out.shaded.comp = gamma_sh;
-	//out.sunlit.rad = Ic_sun / 4.56 / 0.45 / 0.860; //W m - 2 (glob rad, 1 W m-2 = 4.56 mol m-2 s-1; PAR = 0.45 * global radiation, 0.860 = adsorberd fraction in JJV model)
-	//out.shaded.rad = Ic_sh / 4.56 / 0.45 / 0.860; //W m-2
-	double hourly_globrad = in.global_rad * pow(10, 6) / 3600.0; //W m - 2
-	out.sunlit.rad = hourly_globrad > 0 ? hourly_globrad * Ic_sun / (Ic_sun + Ic_sh): 0.0;
+	double hourly_globrad = day.global_rad[h] * pow(10, 6) / 3600.0; //W m - 2
+	out.sunlit.rad = hourly_globrad > 0 ? hourly_globrad * Ic_sun / (Ic_sun + Ic_sh) : 0.0;
 	out.shaded.rad = hourly_globrad > 0 ? hourly_globrad * Ic_sh / (Ic_sun + Ic_sh) : 0.0;
 
 	if (out.sunlit.LAI > 0)
 	{
-		out.sunlit.vcMax = Vc_sun / out.sunlit.LAI; //Vcmax;
-		out.sunlit.jMax = Jmax_c_sun / out.sunlit.LAI; //Jmax_bernacchi_f(in.leaf_temp, Vcmax_25*2.1);
+		out.sunlit.vcMax = Vc_sun / out.sunlit.LAI;
+		out.sunlit.jMax = Jmax_c_sun / out.sunlit.LAI;
 		out.sunlit.jj = J_c_sun / out.sunlit.LAI;
-		out.sunlit.jj1000 = J_bernacchi_f(1000, in.leaf_temp, out.sunlit.jMax);
-	}	
+		out.sunlit.jj1000 = J_f(1000, theta, phi, out.sunlit.jMax);
+	}
 	if (out.shaded.LAI > 0)
 	{
-		out.shaded.vcMax = Vc_sh / out.shaded.LAI;//Vcmax;
-		out.shaded.jMax = Jmax_c_sh / out.shaded.LAI; //Jmax_bernacchi_f(in.leaf_temp, Vcmax_25*2.1);
+		out.shaded.vcMax = Vc_sh / out.shaded.LAI;
+		out.shaded.jMax = Jmax_c_sh / out.shaded.LAI;
 		out.shaded.jj = J_c_sh / out.shaded.LAI;
-		out.shaded.jj1000 = J_bernacchi_f(1000, in.leaf_temp, out.shaded.jMax);
+		out.shaded.jj1000 = J_f(1000, theta, phi, out.shaded.jMax);
 	}
-	
-	//6.1.2 x1, x2 rubisco
-	std::tuple<double, double> x1_x2_rub_sun = x_rubisco(in.leaf_temp, Vc_sun);
-	std::tuple<double, double> x1_x2_rub_sh = x_rubisco(in.leaf_temp, Vc_sh);
-
-	//6.1.2 x1, x2 electron
-	std::tuple<double, double> x1_x2_el_sun = x_electron(J_c_sun, gamma_sun);
-	std::tuple<double, double> x1_x2_el_sh = x_electron(J_c_sh, gamma_sh);
 
 	// 6.1.3 g0, gm, gb
-	double gb_sun = par.gb * out.sunlit.LAI; //mol m-2 s-1 bar-1 per unit ground area
+	double gb_sun = par.gb * out.sunlit.LAI;
 	double gb_sh = par.gb * out.shaded.LAI;
 	double g0_sun = par.g0 * out.sunlit.LAI;
 	double g0_sh = par.g0 * out.shaded.LAI;
-	double gm_t = 0.4;// gm_bernacchi_f(in.leaf_temp, par.gm_25); //TODO: check correctness of gm_bernacchi_f
+	double gm_t = 0.4;
 	double gm_sun = gm_t * out.sunlit.LAI;
 	double gm_sh = gm_t * out.shaded.LAI;
 
-	if (in.global_rad <= 0.0)
+	if (!day.daylight[h])
 	{
-		//handle cases where no photosynthesis can occur
+		//night hour, no photosynthesis can occur
 		out.canopy_gross_photos = 0.0;
 		out.canopy_net_photos = out.canopy_gross_photos - out.canopy_resp;
 		out.sunlit.gs = g0_sun;
@@ -662,21 +694,23 @@ FvCB_canopy_hourly_out FvCB::FvCB_canopy_hourly_C3(FvCB_canopy_hourly_in in, FvC
 	}
 	else
 	{
-		//6.1.4 fVPD
-		double fVPD = fVPD_f(in.VPD);
+		double fVPD = day.fVPD[h];
 
-		//6.2 calculate lumped coeffs (sun/shade)
-		Lumped_Coeffs lumped_rub_sun = calculate_lumped_coeffs(std::get<0>(x1_x2_rub_sun), std::get<1>(x1_x2_rub_sun), fVPD, in.Ca, gamma_sun, Rd_sun, g0_sun, gm_sun, gb_sun);
-		Lumped_Coeffs lumped_el_sun = calculate_lumped_coeffs(std::get<0>(x1_x2_el_sun), std::get<1>(x1_x2_el_sun), fVPD, in.Ca, gamma_sun, Rd_sun, g0_sun, gm_sun, gb_sun);
+		//6.1.2 x1, x2 rubisco and electron
+		double x2_rub = kc * (1 + oi / ko);
+		double x1_el_sun = J_c_sun / 4.0, x2_el_sun = 2 * gamma_sun;
+		double x1_el_sh = J_c_sh / 4.0, x2_el_sh = 2 * gamma_sh;
 
-		Lumped_Coeffs lumped_rub_sh = calculate_lumped_coeffs(std::get<0>(x1_x2_rub_sh), std::get<1>(x1_x2_rub_sh), fVPD, in.Ca, gamma_sh, Rd_sh, g0_sh, gm_sh, gb_sh);
-		Lumped_Coeffs lumped_el_sh = calculate_lumped_coeffs(std::get<0>(x1_x2_el_sh), std::get<1>(x1_x2_el_sh), fVPD, in.Ca, gamma_sh, Rd_sh, g0_sh, gm_sh, gb_sh);
+		//6.2 calculate lumped coeffs (sun/shade)
+		Lumped_Coeffs lumped_rub_sun = calculate_lumped_coeffs(Vc_sun, x2_rub, fVPD, day.Ca, gamma_sun, Rd_sun, g0_sun, gm_sun, gb_sun);
+		Lumped_Coeffs lumped_el_sun = calculate_lumped_coeffs(x1_el_sun, x2_el_sun, fVPD, day.Ca, gamma_sun, Rd_sun, g0_sun, gm_sun, gb_sun);
+		Lumped_Coeffs lumped_rub_sh = calculate_lumped_coeffs(Vc_sh, x2_rub, fVPD, day.Ca, gamma_sh, Rd_sh, g0_sh, gm_sh, gb_sh);
+		Lumped_Coeffs lumped_el_sh = calculate_lumped_coeffs(x1_el_sh, x2_el_sh, fVPD, day.Ca, gamma_sh, Rd_sh, g0_sh, gm_sh, gb_sh);
 
 		//6.3 calculate assimilation
-		double A_rub_sun = A1_f(lumped_rub_sun); //mol CO2 m-2 s-1 (unit ground area)
+		double A_rub_sun = A1_f(lumped_rub_sun);
 		double A_el_sun = A1_f(lumped_el_sun);
-
-		double A_rub_sh = A1_f(lumped_rub_sh); //mol CO2 m-2 s-1 (unit ground area)
+		double A_rub_sh = A1_f(lumped_rub_sh);
 		double A_el_sh = A1_f(lumped_el_sh);
 
 #ifdef TEST_FVCB_HOURLY_OUTPUT
@@ -687,49 +721,24 @@ FvCB_canopy_hourly_out FvCB::FvCB_canopy_hourly_C3(FvCB_canopy_hourly_in in, FvC
 			<< "," << A_el_sh;
 #endif
 
-		//double A_sun = std::fmin(A_rub_sun * in.fO3 * in.fls, A_el_sun);
-		//double A_sh = std::fmin(A_rub_sh * in.fO3 * in.fls, A_el_sh);
-
 		double A_sun = std::fmin(A_rub_sun, A_el_sun);
 		double A_sh = std::fmin(A_rub_sh, A_el_sh);
 
 		out.canopy_net_photos = (A_sun + A_sh) * 3600.0;
 		out.canopy_gross_photos = out.canopy_net_photos + out.canopy_resp;
 
-		//6.4 derive stomatal conductance
-		//6.4.1 determine whether photosynthesis is rubisco or electron limited
-		double x1_sun;
-		double x2_sun;
-		if (A_sun == A_el_sun)
-		{
-			x1_sun = std::get<0>(x1_x2_el_sun);
-			x2_sun = std::get<1>(x1_x2_el_sun);
-		}
-		else
-		{
-			x1_sun = std::get<0>(x1_x2_rub_sun);
-			x2_sun = std::get<1>(x1_x2_rub_sun);
-		}
-		double x1_sh;
-		double x2_sh;
-		if (A_sh == A_el_sh)
-		{
-			x1_sh = std::get<0>(x1_x2_el_sh);
-			x2_sh = std::get<1>(x1_x2_el_sh);
-		}
-		else
-		{
-			x1_sh = std::get<0>(x1_x2_rub_sh);
-			x2_sh = std::get<1>(x1_x2_rub_sh);
-		}
-		//6.4.2 gs
-		auto sun_ci_cc_gs = derive_ci_cc_gs_f(A_sun, x1_sun, x2_sun, gamma_sun, Rd_sun, gm_sun, fVPD, par.g0);
+		//6.4 derive stomatal conductance, depending on rubisco or electron limitation
+		bool el_sun = A_sun == A_el_sun;
+		bool el_sh = A_sh == A_el_sh;
+		auto sun_ci_cc_gs = derive_ci_cc_gs_f(A_sun, el_sun ? x1_el_sun : Vc_sun, el_sun ? x2_el_sun : x2_rub, 
+																					gamma_sun, Rd_sun, gm_sun, fVPD, par.g0);
 		out.sunlit.ci = get<0>(sun_ci_cc_gs);
 		out.sunlit.cc = get<1>(sun_ci_cc_gs);
 		out.sunlit.gs = get<2>(sun_ci_cc_gs);
-		auto sh_ci_cc_gs = derive_ci_cc_gs_f(A_sh, x1_sh, x2_sh, gamma_sh, Rd_sh, gm_sh, fVPD, par.g0);
+		auto sh_ci_cc_gs = derive_ci_cc_gs_f(A_sh, el_sh ? x1_el_sh : Vc_sh, el_sh ? x2_el_sh : x2_rub, 
+																				 gamma_sh, Rd_sh, gm_sh, fVPD, par.g0);
 		out.shaded.ci = get<0>(sh_ci_cc_gs);
-		out.shaded.cc = get<0>(sh_ci_cc_gs);
+		out.shaded.cc = get<1>(sh_ci_cc_gs);
 		out.shaded.gs = get<2>(sh_ci_cc_gs);
 
 #ifdef TEST_FVCB_HOURLY_OUTPUT
@@ -751,23 +760,79 @@ FvCB_canopy_hourly_out FvCB::FvCB_canopy_hourly_C3(FvCB_canopy_hourly_in in, FvC
 
 		//6.5 derive jv
 		if (out.sunlit.LAI > 0)
-		{
 			out.sunlit.jv = derive_jv_f(A_sun, Rd_sun, gamma_sun, get<1>(sun_ci_cc_gs)) / out.sunlit.LAI;
-		}
 		if (out.shaded.LAI > 0)
-		{
 			out.shaded.jv = derive_jv_f(A_sh, Rd_sh, gamma_sh, get<1>(sh_ci_cc_gs)) / out.shaded.LAI;
-		}
+	}
 
-	}	
-	
-	#ifdef TEST_FVCB_HOURLY_OUTPUT
-		tout() << endl;
-	#endif
+#ifdef TEST_FVCB_HOURLY_OUTPUT
+	tout() << endl;
+#endif
 
 	return out;
 }
 
+std::vector<std::string> FvCB::check_FvCB_canopy_day_C3(const FvCB_canopy_day_in& in, 
+																														 FvCB_canopy_hourly_params par,
+																														 double relTolerance)
+{
+	std::vector<std::string> diffs;
+	auto check = [&](int h, const char* name, double batched, double reference)
+	{
+		double scale = std::max(std::fabs(batched), std::fabs(reference));
+		if (std::fabs(batched - reference) > relTolerance * std::max(scale, 1e-300))
+		{
+			std::ostringstream oss;
+			oss.precision(17);
+			oss << "hour " << h << ": " << name << " batched: " << batched << " reference: " << reference;
+			diffs.push_back(oss.str());
+		}
+	};
+
+	auto day = FvCB_canopy_day_C3(in, par.kn);
+	for (int h = 0; h < 24; h++)
+	{
+		auto out = FvCB_canopy_hourly_C3(day, h, par);
+
+		//the per hour terms of the batched kernel against the single model functions
+		auto sun_shade_LAI = LAI_sunlit_shaded_f(in.LAI, in.solar_el[h]);
+		check(h, "sunlit.LAI", out.sunlit.LAI, get<0>(sun_shade_LAI));
+		check(h, "shaded.LAI", out.shaded.LAI, get<1>(sun_shade_LAI));
+
+		if (in.global_rad[h] > 0.0)
+		{
+			double diffuse_fraction = diffuse_fraction_hourly_f(in.global_rad[h], in.extra_terr_rad[h], in.solar_el[h]);
+			double inst_diff_rad = in.global_rad[h] * diffuse_fraction * pow(10, 6) / 3600.0 * 4.56 * 0.45;
+			double inst_dir_rad = (in.global_rad[h] - in.global_rad[h] * diffuse_fraction) * pow(10, 6) / 3600.0 * 4.56 * 0.45;
+			check(h, "Ic_sh", day.Ic_sh[h], Ic_shade_f(inst_dir_rad, inst_diff_rad, in.solar_el[h], in.LAI));
+		}
+
+		//linear scaling by Vcmax_25 applied after the canopy integration
+		auto tr = FvCB_leaf_T_responses_f(in.leaf_temp[h]);
+		double Vcmax = par.Vcmax_25 * tr.Vcmax;
+		double Vcmax_25 = par.Vcmax_25 * Tresp_Vcmax_25;
+		double Vc_sun = canopy_ps_capacity_sunlit_f(in.LAI, in.solar_el[h], Vcmax, par.kn);
+		double Vc_sh = canopy_ps_capacity_shaded_f(in.LAI, in.solar_el[h], Vcmax, par.kn);
+		double Vc_sun_25 = canopy_ps_capacity_sunlit_f(in.LAI, in.solar_el[h], Vcmax_25, par.kn);
+		double Vc_sh_25 = canopy_ps_capacity_shaded_f(in.LAI, in.solar_el[h], Vcmax_25, par.kn);
+		if (out.sunlit.LAI > 0)
+			check(h, "sunlit.vcMax", out.sunlit.vcMax, Vc_sun / out.sunlit.LAI);
+		if (out.shaded.LAI > 0)
+			check(h, "shaded.vcMax", out.shaded.vcMax, Vc_sh / out.shaded.LAI);
+		check(h, "jmax_c", out.jmax_c, 1.6 * (Vc_sun_25 + Vc_sh_25) * tr.Jmax);
+		check(h, "sunlit.comp", out.sunlit.comp, Gamma_bernacchi_f(tr, Vc_sun, Vc_sun_25 * tr.Vomax));
+		check(h, "shaded.comp", out.shaded.comp, Gamma_bernacchi_f(tr, Vc_sh, Vc_sh_25 * tr.Vomax));
+		check(h, "canopy_resp", out.canopy_resp, tr.Rd * in.LAI * 3600.0);
+
+		//the scalar entry point has to give the same hour
+		auto sout = FvCB_canopy_hourly_C3(in.at(h), par);
+		check(h, "canopy_gross_photos (scalar)", sout.canopy_gross_photos, out.canopy_gross_photos);
+		check(h, "canopy_net_photos (scalar)", sout.canopy_net_photos, out.canopy_net_photos);
+	}
+
+	return diffs;
+}
+
 #pragma endregion Model composition
 	
 	
\ No newline at end of file
@@ -18,15 +18,32 @@ Copyright (C) Leibniz Centre for Agricultural Landscape Research (ZALF)
 #ifndef  PHOTOSYNTHESIS_FVCB_H_
 #define  PHOTOSYNTHESIS_FVCB_H_
 
-#include <map>
 #include <vector>
+#include <string>
+#include <array>
 #include <cmath>
 
 namespace FvCB
 {
 	enum FvCB_Model_Consts { Rd = 0, Vcmax, Vomax, Gamma, Kc, Ko, Jmax };
-	extern std::map<FvCB_Model_Consts, double> c_bernacchi;// = {{ Rd, 18.72},{ Vcmax, 26.35 },{ Vomax, 22.98 },{ Gamma, 19.02 },{ Kc, 38.05 },{ Ko, 20.30 }, { Jmax, 17.57 }}; //dimensionless
-	extern std::map<FvCB_Model_Consts, double> deltaH_bernacchi;// = {{ Rd, 46.39 },{ Vcmax, 65.33 },{ Vomax, 60.11 },{ Gamma, 37.83 },{ Kc, 79.43 },{ Ko, 36.38 },{ Jmax, 43.54 }}; //kJ mol - 1
+	//indexed by FvCB_Model_Consts
+	constexpr double c_bernacchi[] = { 18.72, 26.35, 22.98, 19.02, 38.05, 20.30, 17.57 }; //dimensionless
+	constexpr double deltaH_bernacchi[] = { 46.39, 65.33, 60.11, 37.83, 79.43, 36.38, 43.54 }; //kJ mol - 1
+
+	//temperature dependent factors at one leaf temperature, shared by the sunlit and shaded fraction
+	struct FvCB_leaf_T_responses {
+		double Vcmax; //Arrhenius factors (bernacchi), multiplied with the respective value at 25oC
+		double Jmax;
+		double Vomax;
+		double Rd; //umol m-2 s-1 (unit leaf area)
+		double Kc;
+		double Ko;
+		double Oi;
+		double theta_ps2; //curvature of the light response of PSII electron transport
+		double phi_ps2max; //max. quantum efficiency of PSII
+	};
+
+	FvCB_leaf_T_responses FvCB_leaf_T_responses_f(double leafT);
 		
 	struct FvCB_canopy_hourly_params {
 		double Vcmax_25;
@@ -75,6 +92,61 @@ namespace FvCB
 	};
 
 	FvCB_canopy_hourly_out FvCB_canopy_hourly_C3(FvCB_canopy_hourly_in in, FvCB_canopy_hourly_params par);
+
+	//hourly inputs of a whole day for the batched canopy photosynthesis
+	struct FvCB_canopy_day_in {
+		std::array<double, 24> global_rad; //MJ m-2 h-1
+		std::array<double, 24> extra_terr_rad; //MJ m - 2 h - 1
+		std::array<double, 24> solar_el; //radians
+		std::array<double, 24> leaf_temp; //oC
+		std::array<double, 24> VPD; //KPa
+		double LAI; //m2 m-2
+		double Ca; //ambient CO2 partial pressure, ubar or umol mol-1
+
+		FvCB_canopy_hourly_in at(int h) const;
+	};
+
+	//terms of all 24 hours of a day which don't depend on Vcmax_25 (structure of arrays)
+	//hours without global radiation are night hours, for them the absorbed radiation and 
+	//the coupled photosynthesis - stomatal conductance are skipped
+	struct FvCB_canopy_day {
+		std::array<bool, 24> daylight;
+		std::array<double, 24> global_rad; //MJ m-2 h-1
+		std::array<double, 24> leaf_temp; //oC
+		std::array<double, 24> LAI_sun; //m2 m-2
+		std::array<double, 24> LAI_sh; //m2 m-2
+		std::array<double, 24> Ic_sun; //umol m - 2 s - 1 (unit ground area)
+		std::array<double, 24> Ic_sh; //umol m - 2 s - 1 (unit ground area)
+		std::array<double, 24> Vc_sun_per_Vcmax; //sunlit canopy photosynthetic capacity per leaf Vcmax
+		std::array<double, 24> tresp_Vcmax; //bernacchi temperature responses
+		std::array<double, 24> tresp_Jmax;
+		std::array<double, 24> tresp_Vomax;
+		std::array<double, 24> Rd; //umol m - 2 s - 1 (unit leaf area)
+		std::array<double, 24> kc;
+		std::array<double, 24> ko;
+		std::array<double, 24> oi;
+		std::array<double, 24> theta_ps2;
+		std::array<double, 24> phi_ps2max;
+		std::array<double, 24> fVPD;
+		double Vc_per_Vcmax{0.0}; //canopy photosynthetic capacity per leaf Vcmax
+		double tresp_Vcmax_25{0.0};
+		double Ca{0.0};
+	};
+
+	//prepare the hour terms of a whole day, kn has to match the parameters later used for the hours
+	FvCB_canopy_day FvCB_canopy_day_C3(const FvCB_canopy_day_in& in, double kn);
+	
+	//canopy photosynthesis for hour h of a prepared day, the scalar FvCB_canopy_hourly_C3
+	//prepares a day with just this one hour and calls this version;
+	//leaf ci/cc and jv are 0 during night hours
+	FvCB_canopy_hourly_out FvCB_canopy_hourly_C3(const FvCB_canopy_day& day, int h, FvCB_canopy_hourly_params par);
+
+	//compare the batched terms of all hours of a day (the linear scaling by Vcmax_25 is applied 
+	//after the canopy integration) with the single model functions and the scalar entry point,
+	//returns a description of every term which differs by more than relTolerance
+	std::vector<std::string> check_FvCB_canopy_day_C3(const FvCB_canopy_day_in& in, 
+																										FvCB_canopy_hourly_params par,
+																										double relTolerance = 1e-10);
 	double Jmax_bernacchi_f(double leafT, double Jmax_25);
 	double Vcmax_bernacchi_f(double leafT, double Vcmax_25);
 	
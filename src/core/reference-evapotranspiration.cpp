@@ -0,0 +1,110 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/*
+Authors:
+Claas Nendel <claas.nendel@zalf.de>
+Michael Berg <michael.berg@zalf.de>
+
+Maintainers:
+Currently maintained by the authors.
+
+This file is part of the MONICA model.
+Copyright (C) Leibniz Centre for Agricultural Landscape Research (ZALF)
+*/
+
+#include <cmath>
+
+#include "reference-evapotranspiration.h"
+
+using namespace std;
+using namespace Monica;
+
+DailyAtmosphere Monica::prepareDailyAtmosphere(double heightNN,
+                                               double maxAirTemperature,
+                                               double minAirTemperature,
+                                               double relativeHumidity,
+                                               double meanAirTemperature,
+                                               double windSpeed,
+                                               double windSpeedHeight,
+                                               double extraterrestrialRadiation)
+{
+	DailyAtmosphere da;
+	da.meanAirTemperature = meanAirTemperature;
+
+	// Calculation of atmospheric pressure
+	da.atmosphericPressure = 101.3 * pow(((293.0 - (0.0065 * heightNN)) / 293.0), 5.26);
+
+	// Calculation of psychrometer constant - Luchtfeuchtigkeit
+	da.psychrometerConstant = 0.000665 * da.atmosphericPressure;
+
+	// Calc. of saturated water vapour pressure at daily max temperature
+	da.saturatedVapourPressureMax = 0.6108 * exp((17.27 * maxAirTemperature) / (237.3 + maxAirTemperature));
+
+	// Calc. of saturated water vapour pressure at daily min temperature
+	da.saturatedVapourPressureMin = 0.6108 * exp((17.27 * minAirTemperature) / (237.3 + minAirTemperature));
+
+	// Calculation of the saturated water vapour pressure
+	da.saturatedVapourPressure = (da.saturatedVapourPressureMax + da.saturatedVapourPressureMin) / 2.0;
+
+	// Calculation of the water vapour pressure
+	if(relativeHumidity <= 0.0)
+	{
+		// Assuming Tdew = Tmin as suggested in FAO56 Allen et al. 1998
+		da.vapourPressure = da.saturatedVapourPressureMin;
+	}
+	else
+	{
+		da.vapourPressure = relativeHumidity * da.saturatedVapourPressure;
+	}
+
+	// Calculation of the air saturation deficit
+	da.saturationDeficit = da.saturatedVapourPressure - da.vapourPressure;
+
+	// Slope of saturation water vapour pressure-to-temperature relation
+	da.saturatedVapourPressureSlope = (4098.0 * (0.6108 * exp((17.27 * meanAirTemperature) / (meanAirTemperature + 237.3))))
+		/ ((meanAirTemperature + 237.3) * (meanAirTemperature + 237.3));
+
+	// Calculation of wind speed in 2m height
+	da.windSpeed_2m = windSpeed * (4.87 / (log(67.8 * windSpeedHeight - 5.42)));
+
+	// Calculation of the aerodynamic resistance
+	da.aerodynamicResistance = 208.0 / da.windSpeed_2m;
+
+	// temperature and humidity parts of the net longwave radiation
+	double pc_BolzmannConstant = 0.0000000049; // Bolzmann constant 4.903 * 10-9 MJ m-2 K-4 d-1
+	da.longwaveTemperatureTerm = pc_BolzmannConstant
+		* ((pow((minAirTemperature + 273.16), 4.0) + pow((maxAirTemperature + 273.16), 4.0)) / 2.0);
+	da.longwaveHumidityTerm = 0.34 - 0.14 * sqrt(da.vapourPressure);
+
+	da.clearSkyFactor = 0.75 + 0.00002 * heightNN;
+
+	// looked up from the site's solar geometry
+	da.extraterrestrialRadiation = extraterrestrialRadiation;
+
+	return da;
+}
+
+double Monica::netRadiation(const DailyAtmosphere& da,
+                            double albedo,
+                            double globalRadiation,
+                            double relativeShortwaveRadiation)
+{
+	double shortwaveRadiation = (1.0 - albedo) * globalRadiation;
+	double longwaveRadiation = da.longwaveTemperatureTerm
+		* (1.35 * relativeShortwaveRadiation - 0.35)
+		* da.longwaveHumidityTerm;
+	return shortwaveRadiation - longwaveRadiation;
+}
+
+double Monica::penmanMonteithET0(const DailyAtmosphere& da,
+                                 double netRadiation,
+                                 double surfaceResistance)
+{
+	// Penman-Monteith-Method FAO
+	// (surface / aerodynamic resistance written with the wind speed to stay finite on calm days)
+	return ((0.408 * da.saturatedVapourPressureSlope * netRadiation)
+					+ (da.psychrometerConstant * (900.0 / (da.meanAirTemperature + 273.0)) * da.windSpeed_2m * da.saturationDeficit))
+		/ (da.saturatedVapourPressureSlope + da.psychrometerConstant * (1.0 + (surfaceResistance / 208.0) * da.windSpeed_2m));
+}
@@ -0,0 +1,74 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/*
+Authors:
+Claas Nendel <claas.nendel@zalf.de>
+Michael Berg <michael.berg@zalf.de>
+
+Maintainers:
+Currently maintained by the authors.
+
+This file is part of the MONICA model.
+Copyright (C) Leibniz Centre for Agricultural Landscape Research (ZALF)
+*/
+
+#ifndef _REFERENCE_EVAPOTRANSPIRATION_H
+#define _REFERENCE_EVAPOTRANSPIRATION_H
+
+/**
+ * @file reference-evapotranspiration.h
+ */
+
+namespace Monica
+{
+	/**
+	 * @brief Weather dependent terms of the FAO Penman-Monteith equation for one day.
+	 *
+	 * Soil moisture and crop growth both calculate a reference evapotranspiration
+	 * from the same daily weather, so the atmospheric and energy balance terms
+	 * are prepared once per day by MonicaModel and shared between both modules.
+	 */
+	struct DailyAtmosphere
+	{
+		double meanAirTemperature{0.0}; //!< [°C]
+		double atmosphericPressure{0.0}; //!< [kPa]
+		double psychrometerConstant{0.0}; //!< [kPa °C-1]
+		double saturatedVapourPressureMax{0.0}; //!< at daily max temperature [kPa]
+		double saturatedVapourPressureMin{0.0}; //!< at daily min temperature [kPa]
+		double saturatedVapourPressure{0.0}; //!< [kPa]
+		double vapourPressure{0.0}; //!< [kPa]
+		double saturationDeficit{0.0}; //!< [kPa]
+		double saturatedVapourPressureSlope{0.0}; //!< [kPa °C-1]
+		double windSpeed_2m{0.0}; //!< [m s-1]
+		double aerodynamicResistance{0.0}; //!< [s m-1]
+		double longwaveTemperatureTerm{0.0}; //!< sigma * (Tmax^4 + Tmin^4) / 2 [MJ m-2 d-1]
+		double longwaveHumidityTerm{0.0}; //!< net emissivity 0.34 - 0.14 * sqrt(ea) []
+		double clearSkyFactor{0.0}; //!< clear sky shortwave radiation per extraterrestrial radiation []
+		double extraterrestrialRadiation{0.0}; //!< [MJ m-2 d-1]
+	};
+
+	//! prepare the daily terms from the weather and site data
+	DailyAtmosphere prepareDailyAtmosphere(double heightNN,
+	                                       double maxAirTemperature,
+	                                       double minAirTemperature,
+	                                       double relativeHumidity,
+	                                       double meanAirTemperature,
+	                                       double windSpeed,
+	                                       double windSpeedHeight,
+	                                       double extraterrestrialRadiation);
+
+	//! net radiation [MJ m-2] of a surface with the given albedo
+	double netRadiation(const DailyAtmosphere& atmosphere,
+	                    double albedo,
+	                    double globalRadiation,
+	                    double relativeShortwaveRadiation);
+
+	//! FAO Penman-Monteith reference evapotranspiration [mm]
+	double penmanMonteithET0(const DailyAtmosphere& atmosphere,
+	                         double netRadiation,
+	                         double surfaceResistance);
+}
+
+#endif
@@ -117,21 +117,44 @@ double SoilLayer::vs_SoilMoisture_pF()
  *
  * Constructor with parameter initialization. Initializes every layer
  * in vector with the layer-thickness and special soil parameter in this layer.
+ * If no layer thicknesses are given, there is one layer of ps_LayerThickness
+ * per soil parameter entry. Otherwise the layers are built from the given
+ * thicknesses and each layer gets the soil parameters found at its centre,
+ * as the soil parameters are given in steps of ps_LayerThickness.
  *
- * @param gps General Parameters
+ * @param ps_LayerThickness thickness the soil parameters are given for [m]
+ * @param layerThicknesses thicknesses of a variable layering [m]
  * @param soilParams Soil Parameter
  */
 SoilColumn::SoilColumn(double ps_LayerThickness,
+	const vector<double>& layerThicknesses,
 	double ps_MaxMineralisationDepth,
 	const SoilPMsPtr soilParams,
 	double pm_CriticalMoistureDepth)
-	: ps_MaxMineralisationDepth(ps_MaxMineralisationDepth)
+	: ps_LayerThickness(ps_LayerThickness)
+	, ps_MaxMineralisationDepth(ps_MaxMineralisationDepth)
 	, pm_CriticalMoistureDepth(pm_CriticalMoistureDepth)
 {
 	debug() << "Constructor: SoilColumn " << (soilParams ? soilParams->size() : 0) << endl;
-	if (soilParams)
+	if (soilParams && layerThicknesses.empty())
+	{
 		for (auto sp : *soilParams)
 			push_back(SoilLayer(ps_LayerThickness, sp));
+	}
+	else if (soilParams && !soilParams->empty())
+	{
+		double topDepth = 0.0;
+		for (double lt : layerThicknesses)
+		{
+			size_t spIndex = size_t((topDepth + 0.5 * lt) / ps_LayerThickness);
+			push_back(SoilLayer(lt, soilParams->at(min(spIndex, soilParams->size() - 1))));
+			topDepth += lt;
+		}
+	}
+
+	_layerTopDepths.push_back(0.0);
+	for (const auto& layer : *this)
+		_layerTopDepths.push_back(_layerTopDepths.back() + layer.vs_LayerThickness);
 
 	_vs_NumberOfOrganicLayers = calculateNumberOfOrganicLayers();
 }
@@ -233,35 +256,35 @@ applyMineralFertiliserViaNMinMethod(MineralFertiliserParameters fp,
 	int vf_Layer30cm = getLayerNumberForDepth(0.3);
 	int layerSamplingDepth = getLayerNumberForDepth(vf_SamplingDepth);
 
+	// layers may differ in thickness, so sum up N contents instead of concentrations
 	double vf_SoilNO3Sum = 0.0;
 	double vf_SoilNH4Sum = 0.0;
 	for (int i_Layer = 0; i_Layer < layerSamplingDepth /*(ceil(vf_SamplingDepth / at(i_Layer).vs_LayerThickness))*/; i_Layer++)
 	{
 		//vf_TargetLayer is in cm. We want number of layers
-		vf_SoilNO3Sum += at(i_Layer).vs_SoilNO3; //! [kg N m-3]
-		vf_SoilNH4Sum += at(i_Layer).vs_SoilNH4; //! [kg N m-3]
+		vf_SoilNO3Sum += at(i_Layer).vs_SoilNO3 * at(i_Layer).vs_LayerThickness; //! [kg N m-2]
+		vf_SoilNH4Sum += at(i_Layer).vs_SoilNH4 * at(i_Layer).vs_LayerThickness; //! [kg N m-2]
 	}
 
 	double vf_SoilNO3Sum30 = 0.0;
 	double vf_SoilNH4Sum30 = 0.0;
 	// Same calculation for a depth of 30 cm
-  /** @todo Must be adapted when using variable layer depth. */
 	for (int i_Layer = 0; i_Layer < vf_Layer30cm; i_Layer++)
 	{
-		vf_SoilNO3Sum30 += at(i_Layer).vs_SoilNO3; //! [kg N m-3]
-		vf_SoilNH4Sum30 += at(i_Layer).vs_SoilNH4; //! [kg N m-3]
+		vf_SoilNO3Sum30 += at(i_Layer).vs_SoilNO3 * at(i_Layer).vs_LayerThickness; //! [kg N m-2]
+		vf_SoilNH4Sum30 += at(i_Layer).vs_SoilNH4 * at(i_Layer).vs_LayerThickness; //! [kg N m-2]
 	}
 
-	// Converts [kg N ha-1] to [kg N m-3]
-	double vf_CropNTargetValue = vf_CropNTarget / 10000.0 / at(0).vs_LayerThickness;
-	double vf_CropNTargetValue30 = vf_CropNTarget30 / 10000.0 / at(0).vs_LayerThickness;
+	// Converts [kg N ha-1] to [kg N m-2]
+	double vf_CropNTargetValue = vf_CropNTarget / 10000.0;
+	double vf_CropNTargetValue30 = vf_CropNTarget30 / 10000.0;
 
-	double vf_FertiliserDemandVol = vf_CropNTargetValue - (vf_SoilNO3Sum + vf_SoilNH4Sum);
-	double vf_FertiliserDemandVol30 = vf_CropNTargetValue30 - (vf_SoilNO3Sum30 + vf_SoilNH4Sum30);
+	double vf_FertiliserDemandArea = vf_CropNTargetValue - (vf_SoilNO3Sum + vf_SoilNH4Sum);
+	double vf_FertiliserDemandArea30 = vf_CropNTargetValue30 - (vf_SoilNO3Sum30 + vf_SoilNH4Sum30);
 
-	// Converts fertiliser demand back from [kg N m-3] to [kg N ha-1]
-	double vf_FertiliserDemand = vf_FertiliserDemandVol * 10000.0 * at(0).vs_LayerThickness;
-	double vf_FertiliserDemand30 = vf_FertiliserDemandVol30 * 10000.0 * at(0).vs_LayerThickness;
+	// Converts fertiliser demand back from [kg N m-2] to [kg N ha-1]
+	double vf_FertiliserDemand = vf_FertiliserDemandArea * 10000.0;
+	double vf_FertiliserDemand30 = vf_FertiliserDemandArea30 * 10000.0;
 
 	double vf_FertiliserRecommendation = max(vf_FertiliserDemand, vf_FertiliserDemand30);
 
@@ -396,6 +419,89 @@ void SoilColumn::deleteAOMPool() {
 	}
 }
 
+namespace
+{
+	//! true if the two C/N ratios differ by not more than the relative tolerance
+	bool cnRatiosMatch(double cn1, double cn2, double tolerance)
+	{
+		if (cn1 == cn2)
+			return true;
+		return fabs(cn1 - cn2) <= tolerance * max(fabs(cn1), fabs(cn2));
+	}
+
+	//! C/N ratio of the merged pool, chosen to keep the N content of both pools
+	double mergedCNRatio(double c1, double cn1, double c2, double cn2)
+	{
+		if (cn1 == cn2 || c1 + c2 <= 0.0 || cn1 <= 0.0 || cn2 <= 0.0)
+			return cn1;
+		return (c1 + c2) / (c1 / cn1 + c2 / cn2);
+	}
+}
+
+/**
+ * @brief Merges AOM pools which decompose identically
+ *
+ * Every organic fertiliser application and every residue incorporation adds
+ * a new AOM pool to each organic layer. Two pools are merged if their
+ * decomposition parameters and fertilisation properties are identical and
+ * their C/N ratios differ at most by the given relative tolerance.
+ * Because decomposition is linear in the pool size, merging pools with
+ * identical parameters (tolerance 0) doesn't change the results. The C/N ratio
+ * of a merged pool is chosen such that the N content of the layer is kept.
+ *
+ * @param cnRatioTolerance relative difference of C/N ratios still merged []
+ */
+void SoilColumn::compactAOMPool(double cnRatioTolerance) {
+
+	if (empty() || at(0).vo_AOM_Pool.size() < 2)
+		return;
+
+	auto compatible = [=](const AOM_Properties& p1, const AOM_Properties& p2)
+	{
+		return p1.vo_AOM_SlowDecCoeffStandard == p2.vo_AOM_SlowDecCoeffStandard
+			&& p1.vo_AOM_FastDecCoeffStandard == p2.vo_AOM_FastDecCoeffStandard
+			&& p1.vo_PartAOM_Slow_to_SMB_Slow == p2.vo_PartAOM_Slow_to_SMB_Slow
+			&& p1.vo_PartAOM_Slow_to_SMB_Fast == p2.vo_PartAOM_Slow_to_SMB_Fast
+			&& p1.vo_AOM_DryMatterContent == p2.vo_AOM_DryMatterContent
+			&& p1.vo_AOM_NH4Content == p2.vo_AOM_NH4Content
+			&& p1.vo_DaysAfterApplication == p2.vo_DaysAfterApplication
+			&& p1.incorporation == p2.incorporation
+			&& cnRatiosMatch(p1.vo_CN_Ratio_AOM_Slow, p2.vo_CN_Ratio_AOM_Slow, cnRatioTolerance)
+			&& cnRatiosMatch(p1.vo_CN_Ratio_AOM_Fast, p2.vo_CN_Ratio_AOM_Fast, cnRatioTolerance);
+	};
+
+	for (size_t i_AOMPool = 0; i_AOMPool < at(0).vo_AOM_Pool.size(); i_AOMPool++) {
+
+		for (size_t j_AOMPool = i_AOMPool + 1; j_AOMPool < at(0).vo_AOM_Pool.size();) {
+
+			// pools are index aligned over the organic layers, so all of them have to match
+			bool merge = true;
+			for (int i_Layer = 0; merge && i_Layer < _vs_NumberOfOrganicLayers; i_Layer++)
+				merge = compatible(at(i_Layer).vo_AOM_Pool.at(i_AOMPool), at(i_Layer).vo_AOM_Pool.at(j_AOMPool));
+
+			if (!merge) {
+				j_AOMPool++;
+				continue;
+			}
+
+			for (int i_Layer = 0; i_Layer < _vs_NumberOfOrganicLayers; i_Layer++) {
+				vector<AOM_Properties>& pools = at(i_Layer).vo_AOM_Pool;
+				AOM_Properties& target = pools.at(i_AOMPool);
+				const AOM_Properties& source = pools.at(j_AOMPool);
+
+				target.vo_CN_Ratio_AOM_Slow = mergedCNRatio(target.vo_AOM_Slow, target.vo_CN_Ratio_AOM_Slow,
+					source.vo_AOM_Slow, source.vo_CN_Ratio_AOM_Slow);
+				target.vo_CN_Ratio_AOM_Fast = mergedCNRatio(target.vo_AOM_Fast, target.vo_CN_Ratio_AOM_Fast,
+					source.vo_AOM_Fast, source.vo_CN_Ratio_AOM_Fast);
+				target.vo_AOM_Slow += source.vo_AOM_Slow;
+				target.vo_AOM_Fast += source.vo_AOM_Fast;
+
+				pools.erase(pools.begin() + j_AOMPool);
+			}
+		}
+	}
+}
+
 /**
  * Method for calculating irrigation demand from soil moisture status.
  * The trigger will be activated and deactivated according to crop parameters
@@ -426,17 +532,16 @@ bool SoilColumn::applyIrrigationViaTrigger(double vi_IrrigationThreshold,
 	double vi_MaxPlantAvailableWater = 0.0;
 	double vi_PlantAvailableWaterFraction = 0.0;
 
-	int vi_CriticalMoistureLayer = int(ceil(vi_CriticalMoistureDepth /
-		at(0).vs_LayerThickness));
+	int vi_CriticalMoistureLayer = min(getLayerNumberForDepth(vi_CriticalMoistureDepth) + 1, vs_NumberOfLayers());
 	for (int i_Layer = 0; i_Layer < vi_CriticalMoistureLayer; i_Layer++)
 	{
 		vi_ActualPlantAvailableWater +=
 			(at(i_Layer).get_Vs_SoilMoisture_m3() - at(i_Layer).vs_PermanentWiltingPoint())
-			* vs_LayerThickness()
+			* at(i_Layer).vs_LayerThickness
 			* 1000.0; // [mm]
 		vi_MaxPlantAvailableWater += (at(i_Layer).vs_FieldCapacity()
 			- at(i_Layer).vs_PermanentWiltingPoint())
-			* vs_LayerThickness() * 1000.0; // [mm]
+			* at(i_Layer).vs_LayerThickness * 1000.0; // [mm]
 		vi_PlantAvailableWaterFraction = vi_ActualPlantAvailableWater
 			/ vi_MaxPlantAvailableWater; // []
 	}
@@ -501,38 +606,42 @@ void SoilColumn::applyTillage(double depth)
 	double no2 = 0.0;
 	double no3 = 0.0;
 
-	// add up all parameters that are affected by tillage
+	// add up all parameters that are affected by tillage,
+	// weighted by the layers' thicknesses
+	double tilled_depth = 0.0;
 	for (int i = 0; i < layer_index; i++)
 	{
-		soil_organic_carbon += at(i).vs_SoilOrganicCarbon();
+		const double lt = at(i).vs_LayerThickness;
+		tilled_depth += lt;
+		soil_organic_carbon += at(i).vs_SoilOrganicCarbon() * lt;
 		//soil_organic_matter += at(i).vs_SoilOrganicMatter();
-		soil_temperature += at(i).get_Vs_SoilTemperature();
-		soil_moisture += at(i).get_Vs_SoilMoisture_m3();
+		soil_temperature += at(i).get_Vs_SoilTemperature() * lt;
+		soil_moisture += at(i).get_Vs_SoilMoisture_m3() * lt;
 		//soil_moistureOld += at(i).vs_SoilMoistureOld_m3;
-		som_slow += at(i).vs_SOM_Slow;
-		som_fast += at(i).vs_SOM_Fast;
-		smb_slow += at(i).vs_SMB_Slow;
-		smb_fast += at(i).vs_SMB_Fast;
-		carbamid += at(i).vs_SoilCarbamid;
-		nh4 += at(i).vs_SoilNH4;
-		no2 += at(i).vs_SoilNO2;
-		no3 += at(i).vs_SoilNO3;
+		som_slow += at(i).vs_SOM_Slow * lt;
+		som_fast += at(i).vs_SOM_Fast * lt;
+		smb_slow += at(i).vs_SMB_Slow * lt;
+		smb_fast += at(i).vs_SMB_Fast * lt;
+		carbamid += at(i).vs_SoilCarbamid * lt;
+		nh4 += at(i).vs_SoilNH4 * lt;
+		no2 += at(i).vs_SoilNO2 * lt;
+		no3 += at(i).vs_SoilNO3 * lt;
 	}
 
 	// calculate mean value of accumulated soil paramters
-	soil_organic_carbon /= layer_index;
+	soil_organic_carbon /= tilled_depth;
 	//soil_organic_matter /= layer_index;
-	soil_temperature /= layer_index;
-	soil_moisture /= layer_index;
+	soil_temperature /= tilled_depth;
+	soil_moisture /= tilled_depth;
 	//soil_moistureOld /= layer_index;
-	som_slow /= layer_index;
-	som_fast /= layer_index;
-	smb_slow /= layer_index;
-	smb_fast /= layer_index;
-	carbamid /= layer_index;
-	nh4 /= layer_index;
-	no2 /= layer_index;
-	no3 /= layer_index;
+	som_slow /= tilled_depth;
+	som_fast /= tilled_depth;
+	smb_slow /= tilled_depth;
+	smb_fast /= tilled_depth;
+	carbamid /= tilled_depth;
+	nh4 /= tilled_depth;
+	no2 /= tilled_depth;
+	no3 /= tilled_depth;
 
 	// use calculated mean values for all affected layers
 	for (int i = 0; i < layer_index; i++)
@@ -573,16 +682,18 @@ void SoilColumn::applyTillage(double depth)
 		//cout << "Soil parameters before applying tillage for the first "<< layer_index+1 << " layers: " << endl;
 
 		// add up pools for affected layer with same index
+		double tilled_organic_depth = 0.0;
 		for (int j = 0; j < layer_index; j++)
 		{
 			//cout << "Layer " << j << endl << endl;
 
 			SoilLayer &layer = at(j);
+			tilled_organic_depth += layer.vs_LayerThickness;
 			unsigned int pool_index = 0;
 			for (auto aomp : layer.vo_AOM_Pool)
 			{
-				aom_slow[pool_index] += aomp.vo_AOM_Slow;
-				aom_fast[pool_index] += aomp.vo_AOM_Fast;
+				aom_slow[pool_index] += aomp.vo_AOM_Slow * layer.vs_LayerThickness;
+				aom_fast[pool_index] += aomp.vo_AOM_Fast * layer.vs_LayerThickness;
 
 				//cout << "AOMPool " << pool_index << endl;
 				//cout << "vo_AOM_Slow:\t"<< aomp.vo_AOM_Slow << endl;
@@ -595,8 +706,8 @@ void SoilColumn::applyTillage(double depth)
 		//
 		for (unsigned int pool_index = 0; pool_index < aom_pool_count; pool_index++)
 		{
-			aom_slow[pool_index] = aom_slow[pool_index] / layer_index;
-			aom_fast[pool_index] = aom_fast[pool_index] / layer_index;
+			aom_slow[pool_index] = aom_slow[pool_index] / tilled_organic_depth;
+			aom_fast[pool_index] = aom_fast[pool_index] / tilled_organic_depth;
 		}
 
 		//cout << "Soil parameters after applying tillage for the first "<< layer_index+1 << " layers: " << endl;
@@ -638,20 +749,18 @@ void SoilColumn::applyTillage(double depth)
 
 /**
  * @brief Returns index of layer that lays in the given depth.
+ * A depth on a layer boundary belongs to the upper layer.
  * @param depth Depth in meters
  * @return Index of layer
  */
-int SoilColumn::getLayerNumberForDepth(double depth)
+int SoilColumn::getLayerNumberForDepth(double depth) const
 {
 	int layer = 0;
-	double accu_depth = 0;
-	double layer_thickness = at(0).vs_LayerThickness;
 
 	// find number of layer that lay between the given depth
-	for (size_t i = 0, _size = size(); i < _size; i++)
+	for (size_t i = 1, _size = _layerTopDepths.size(); i < _size; i++)
 	{
-		accu_depth += layer_thickness;
-		if (depth <= accu_depth)
+		if (depth <= _layerTopDepths[i])
 			break;
 		layer++;
 	}
@@ -659,6 +768,55 @@ int SoilColumn::getLayerNumberForDepth(double depth)
 	return layer;
 }
 
+/**
+ * @brief Returns index of layer which contains the given depth.
+ * A depth on a layer boundary belongs to the lower layer and depths
+ * below the profile are mapped onto virtual layers as thick as the bottom layer
+ * (e.g. to locate a deep groundwater table).
+ * @param depth Depth in meters
+ * @return Index of layer
+ */
+int SoilColumn::getLayerIndexAtDepth(double depth) const
+{
+	int nols = vs_NumberOfLayers();
+	if (nols == 0 || depth <= 0.0)
+		return 0;
+
+	if (depth >= _layerTopDepths.back())
+		return nols + int((depth - _layerTopDepths.back()) / back().vs_LayerThickness);
+
+	auto it = upper_bound(_layerTopDepths.begin(), _layerTopDepths.end(), depth);
+	return int(it - _layerTopDepths.begin()) - 1;
+}
+
+/**
+ * @brief Returns the number of layers whose centre lies above the given depth,
+ * thus the given depth rounded to whole layers.
+ * @param depth Depth in meters
+ * @return Number of layers
+ */
+int SoilColumn::getNumberOfLayersAbove(double depth) const
+{
+	int count = 0;
+	for (int i = 0, nols = vs_NumberOfLayers(); i < nols; i++)
+	{
+		if (_layerTopDepths[i] + 0.5 * at(i).vs_LayerThickness > depth)
+			break;
+		count++;
+	}
+	return count;
+}
+
+double SoilColumn::layerTopDepth(int layer) const
+{
+	int nols = vs_NumberOfLayers();
+	if (layer <= 0 || nols == 0)
+		return 0.0;
+	if (layer <= nols)
+		return _layerTopDepths[layer];
+	return _layerTopDepths.back() + (layer - nols) * back().vs_LayerThickness;
+}
+
 /**
  * @brief Makes crop information available when needed.
  *
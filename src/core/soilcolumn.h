@@ -213,6 +213,7 @@ namespace Monica
   {
   public:
     SoilColumn(double ps_LayerThickness,
+               const std::vector<double>& layerThicknesses,
                double ps_MaxMineralisationDepth,
                const Soil::SoilPMsPtr soilParams,
                double pm_CriticalMoistureDepth);
@@ -246,6 +247,8 @@ namespace Monica
                          double vi_IrrigationNConcentration);
     void deleteAOMPool();
 
+    void compactAOMPool(double cnRatioTolerance);
+
 
     /**
      * Returns number of layers.
@@ -266,15 +269,26 @@ namespace Monica
      */
     inline int vs_NumberOfOrganicLayers() const { return _vs_NumberOfOrganicLayers; }
 
-    //! Returns the thickness of a layer.
-    //! Right now by definition all layers have the same size,
-    //! therefor only the thickness of first layer is returned.
-    double vs_LayerThickness() const { return at(0).vs_LayerThickness; } 
+    //! Returns the nominal thickness of a layer, the thickness the soil parameters
+    //! are given for. With a variable layering the actual layers may differ,
+    //! use at(i).vs_LayerThickness for the thickness of a particular layer.
+    double vs_LayerThickness() const { return ps_LayerThickness; } 
+
+    //! Returns the depth of the upper boundary of a layer [m],
+    //! layers below the profile are assumed to be as thick as the bottom layer
+    double layerTopDepth(int layer) const;
+
+    //! Returns the depth of the lower boundary of a layer [m]
+    double layerBottomDepth(int layer) const { return layerTopDepth(layer + 1); }
 
     //! Returns daily crop N uptake [kg N ha-1 d-1]
     double get_DailyCropNUptake() const { return vq_CropNUptake * 10000.0; }
 
-    int getLayerNumberForDepth(double depth);
+    int getLayerNumberForDepth(double depth) const;
+
+    int getLayerIndexAtDepth(double depth) const;
+
+    int getNumberOfLayersAbove(double depth) const;
 
     void put_Crop(CropGrowth* crop);
 
@@ -295,8 +309,11 @@ namespace Monica
   private:
     int calculateNumberOfOrganicLayers();
 
+    double ps_LayerThickness{0.1};
     double ps_MaxMineralisationDepth{0.4};
 
+    std::vector<double> _layerTopDepths; //!< depths of the upper layer boundaries incl. the profile's bottom [m]
+
     int _vs_NumberOfOrganicLayers{0}; //!< Number of organic layers.
     double _vf_TopDressing{0.0};
     MineralFertiliserParameters _vf_TopDressingPartition;
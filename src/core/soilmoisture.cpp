@@ -609,10 +609,12 @@ void
 FrostComponent::updateLambdaRedux()
 {
   auto vs_number_of_layers = soilColumn.vs_NumberOfLayers();
+  int frozenLayers = soilColumn.getNumberOfLayersAbove(vm_FrostDepth);
+  int thawingLayers = soilColumn.getNumberOfLayersAbove(vm_ThawDepth);
 
   for (int i_Layer = 0; i_Layer < vs_number_of_layers; i_Layer++) {
 
-    if (i_Layer < (std::floor((vm_FrostDepth / soilColumn[i_Layer].vs_LayerThickness) + 0.5))) {
+    if (i_Layer < frozenLayers) {
 
       // soil layer is frozen
       soilColumn[i_Layer].vs_SoilFrozen = true;
@@ -623,10 +625,10 @@ FrostComponent::updateLambdaRedux()
       }
     }
 
-    if (i_Layer < (std::floor((vm_ThawDepth / soilColumn[i_Layer].vs_LayerThickness) + 0.5))) {
+    if (i_Layer < thawingLayers) {
       // soil layer is thawing
 
-      if (vm_ThawDepth < (double(i_Layer + 1) * soilColumn[i_Layer].vs_LayerThickness) && (vm_ThawDepth < vm_FrostDepth)) {
+      if (vm_ThawDepth < soilColumn.layerBottomDepth(i_Layer) && (vm_ThawDepth < vm_FrostDepth)) {
         // soil layer is thawing but there is more frost than thaw
         soilColumn[i_Layer].vs_SoilFrozen = true;
         vm_LambdaRedux[i_Layer] = 0.0;
@@ -650,6 +652,9 @@ FrostComponent::updateLambdaRedux()
       vm_FrostDepth = 0.0;
       vm_NegativeDegreeDays = 0.0;
       vm_FrostDays = 0;
+      // the depths are reset, so no layer below is frozen or thawing anymore
+      frozenLayers = 0;
+      thawingLayers = 0;
 
       vm_HydraulicConductivityRedux = pm_HydraulicConductivityRedux;
       for (int i_Layer = 0; i_Layer < vs_number_of_layers; i_Layer++)
@@ -681,7 +686,6 @@ SoilMoisture::SoilMoisture(MonicaModel& mm)
   , vm_NumberOfLayers(soilColumn.vs_NumberOfLayers() + 1)
   , vs_NumberOfLayers(soilColumn.vs_NumberOfLayers()) //extern
   , vm_AvailableWater(vm_NumberOfLayers, 0.0) // Soil available water in [mm]
-  , pm_CapillaryRiseRate(vm_NumberOfLayers, 0.0)
   , vm_CapillaryWater(vm_NumberOfLayers, 0.0) // soil capillary water in [mm]
   , vm_CapillaryWater70(vm_NumberOfLayers, 0.0) // 70% of soil capillary water in [mm]
   , vm_Evaporation(vm_NumberOfLayers, 0.0) //intern
@@ -713,9 +717,21 @@ SoilMoisture::SoilMoisture(MonicaModel& mm)
   pm_LeachingDepth = envPs.p_LeachingDepth;
   
   //  cout << "pm_LeachingDepth:\t" << pm_LeachingDepth << endl;
-  pm_LayerThickness = mm.simulationParameters().p_LayerThickness;
+  pm_LeachingDepthLayer = soilColumn.getNumberOfLayersAbove(pm_LeachingDepth) - 1;
 
-  pm_LeachingDepthLayer = int(std::floor(0.5 + (pm_LeachingDepth / pm_LayerThickness))) - 1;
+  // resolve the capillary rise rates of the layer textures once, instead of every day
+  auto capillaryRiseRates = smPs.capillaryRiseRates
+    ? smPs.capillaryRiseRates
+    : make_shared<CapillaryRiseRates>(smPs.getCapillaryRiseRate);
+  for(int i_Layer = 0; i_Layer < vs_NumberOfLayers; i_Layer++)
+  {
+    std::string vs_SoilTexture = soilColumn[i_Layer].vs_SoilTexture();
+    if(vs_SoilTexture.empty())
+      vs_SoilTexture = Soil::sandAndClay2KA5texture(soilColumn[i_Layer].vs_SoilSandContent(), soilColumn[i_Layer].vs_SoilClayContent());
+
+    assert(!vs_SoilTexture.empty());
+    pm_CapillaryRiseRates.push_back(capillaryRiseRates->table(vs_SoilTexture));
+  }
 
   for (int i=0; i<vm_NumberOfLayers; i++) {
     vm_SaturatedHydraulicConductivity.resize(vm_NumberOfLayers, smPs.pm_SaturatedHydraulicConductivity); // original [8640 mm d-1]
@@ -820,14 +836,15 @@ void SoilMoisture::step(double vs_GroundwaterDepth,
       vm_GroundwaterTable = i_Layer;
     }
   }
-  if ((vm_GroundwaterTable > (int(vs_GroundwaterDepth / soilColumn[0].vs_LayerThickness)))
+  const int groundwaterDepthLayer = soilColumn.getLayerIndexAtDepth(vs_GroundwaterDepth);
+  if ((vm_GroundwaterTable > groundwaterDepthLayer)
        && (vm_GroundwaterTable < (vs_NumberOfLayers + 2))) {
 
-    vm_GroundwaterTable = (int(vs_GroundwaterDepth / soilColumn[0].vs_LayerThickness));
+    vm_GroundwaterTable = groundwaterDepthLayer;
 
   } else if (vm_GroundwaterTable >= (vs_NumberOfLayers + 2)){
 
-    vm_GroundwaterTable = (int(vs_GroundwaterDepth / soilColumn[0].vs_LayerThickness));
+    vm_GroundwaterTable = groundwaterDepthLayer;
 
   }
 
@@ -1091,14 +1108,17 @@ void SoilMoisture::fm_CapillaryRise() {
 
   vc_RootingDepth = crop ? crop->get_RootingDepth() : 0;
 
-  vm_GroundwaterDistance = vm_GroundwaterTable - vc_RootingDepth;// []
+  // distance between rooting depth and groundwater table in the capillary rise table's
+  // decimetre steps, independent of the actual layer thicknesses
+  vm_GroundwaterDistance = int(std::round((soilColumn.layerTopDepth(vm_GroundwaterTable)
+                                           - soilColumn.layerTopDepth(vc_RootingDepth)) * 10.0));// [dm]
 
   if (vm_GroundwaterDistance < 1)
   {
     vm_GroundwaterDistance = 1;
   }
 
-  if ((double (vm_GroundwaterDistance) * vm_LayerThickness[0]) <= 2.70) { // [m]
+  if ((double (vm_GroundwaterDistance) * 0.1) <= 2.70) { // [m]
   // Capillary rise rates in table defined only until 2.70 m
 
     for (int i_Layer = 0; i_Layer < vs_NumberOfLayers; i_Layer++) {
@@ -1123,12 +1143,7 @@ void SoilMoisture::fm_CapillaryRise() {
     int vm_StartLayer = min(vm_GroundwaterTable,(vs_NumberOfLayers - 1));
     for (int i_Layer = vm_StartLayer; i_Layer >= 0; i_Layer--)
     {
-      std::string vs_SoilTexture = soilColumn[i_Layer].vs_SoilTexture();
-			if (vs_SoilTexture.empty())
-				vs_SoilTexture = Soil::sandAndClay2KA5texture(soilColumn[i_Layer].vs_SoilSandContent(), soilColumn[i_Layer].vs_SoilClayContent());
-		
-			assert(!vs_SoilTexture.empty());
-			pm_CapillaryRiseRate = smPs.getCapillaryRiseRate(vs_SoilTexture, vm_GroundwaterDistance);
+      pm_CapillaryRiseRate = (*pm_CapillaryRiseRates[i_Layer])[vm_GroundwaterDistance];
 
       if(pm_CapillaryRiseRate < vm_CapillaryRiseRate)
       {
@@ -1147,7 +1162,7 @@ void SoilMoisture::fm_CapillaryRise() {
         break;
       }
     }
-  } // if((double (vm_GroundwaterDistance) * vm_LayerThickness[0]) <= 2.70)
+  } // if((double (vm_GroundwaterDistance) * 0.1) <= 2.70)
 }
 
 /**
@@ -1156,13 +1171,14 @@ void SoilMoisture::fm_CapillaryRise() {
 void SoilMoisture::fm_PercolationWithGroundwater(double vs_GroundwaterDepth) {
 
   vm_GroundwaterAdded = 0.0;
+  const int groundwaterDepthLayer = soilColumn.getLayerIndexAtDepth(vs_GroundwaterDepth);
 
   for (int i_Layer = 0; i_Layer < vm_NumberOfLayers - 1; i_Layer++) {
 
     if (i_Layer < vm_GroundwaterTable - 1) {
 
       // well above groundwater table
-      vm_SoilMoisture[i_Layer + 1] += vm_PercolationRate[i_Layer] / 1000.0 / vm_LayerThickness[i_Layer];
+      vm_SoilMoisture[i_Layer + 1] += vm_PercolationRate[i_Layer] / 1000.0 / vm_LayerThickness[i_Layer + 1];
       vm_WaterFlux[i_Layer + 1] = vm_PercolationRate[i_Layer];
 
       if (vm_SoilMoisture[i_Layer + 1] > vm_FieldCapacity[i_Layer + 1]) {
@@ -1207,14 +1223,14 @@ void SoilMoisture::fm_PercolationWithGroundwater(double vs_GroundwaterDepth) {
 
       // groundwater table shall not undermatch the oscillating groundwater depth
       // which is generated within the outer framework
-      if (vm_GroundwaterTable >= int(vs_GroundwaterDepth / vm_LayerThickness[i_Layer])) {
+      if (vm_GroundwaterTable >= groundwaterDepthLayer) {
         vm_SoilMoisture[i_Layer + 1] += (vm_PercolationRate[i_Layer]) / 1000.0
-				/ vm_LayerThickness[i_Layer];
+				/ vm_LayerThickness[i_Layer + 1];
         vm_PercolationRate[i_Layer + 1] = vm_GroundwaterDischarge;
         vm_WaterFlux[i_Layer + 1] = vm_PercolationRate[i_Layer];
       } else {
         vm_SoilMoisture[i_Layer + 1] += (vm_PercolationRate[i_Layer] - vm_GroundwaterDischarge) / 1000.0
-				/ vm_LayerThickness[i_Layer];
+				/ vm_LayerThickness[i_Layer + 1];
         vm_PercolationRate[i_Layer + 1] = vm_GroundwaterDischarge;
         vm_WaterFlux[i_Layer + 1] = vm_GroundwaterDischarge;
       }
@@ -1242,7 +1258,7 @@ void SoilMoisture::fm_PercolationWithGroundwater(double vs_GroundwaterDepth) {
 
       vm_SoilMoisture[i_Layer + 1] = vm_SoilPoreVolume[i_Layer + 1];
 
-      if (vm_GroundwaterTable >= int(vs_GroundwaterDepth / vm_LayerThickness[i_Layer])) {
+      if (vm_GroundwaterTable >= groundwaterDepthLayer) {
         vm_PercolationRate[i_Layer + 1] = vm_PercolationRate[i_Layer];
         vm_WaterFlux[i_Layer] = vm_PercolationRate[i_Layer + 1];
       } else {
@@ -1275,7 +1291,7 @@ void SoilMoisture::fm_GroundwaterReplenishment()
   {
     vm_SoilMoisture[i_Layer] += vm_GroundwaterAdded
                                 / 1000.0
-                                / vm_LayerThickness[i_Layer + 1];
+                                / vm_LayerThickness[i_Layer];
 
     if (i_Layer == vm_StartLayer)
     {
@@ -1291,7 +1307,7 @@ void SoilMoisture::fm_GroundwaterReplenishment()
     {
       vm_GroundwaterAdded = (vm_SoilMoisture[i_Layer] - vm_SoilPoreVolume[i_Layer])
                             * 1000.0
-                            * vm_LayerThickness[i_Layer + 1];
+                            * vm_LayerThickness[i_Layer];
       vm_SoilMoisture[i_Layer] = vm_SoilPoreVolume[i_Layer];
       vm_GroundwaterTable--; // Groundwater table rises
 
@@ -1336,13 +1352,13 @@ void SoilMoisture::fm_PercolationWithoutGroundwater() {
 
   for (int i_Layer = 0; i_Layer < vm_NumberOfLayers - 1; i_Layer++) {
 
-    vm_SoilMoisture[i_Layer + 1] += vm_PercolationRate[i_Layer] / 1000.0 / vm_LayerThickness[i_Layer];
+    vm_SoilMoisture[i_Layer + 1] += vm_PercolationRate[i_Layer] / 1000.0 / vm_LayerThickness[i_Layer + 1];
 
     if ((vm_SoilMoisture[i_Layer + 1] > vm_FieldCapacity[i_Layer + 1])) {
 
       // too much water for this layer so some water is released to layers below
       vm_GravitationalWater[i_Layer + 1] = (vm_SoilMoisture[i_Layer + 1] - vm_FieldCapacity[i_Layer + 1]) * 1000.0
-	* vm_LayerThickness[0];
+	* vm_LayerThickness[i_Layer + 1];
       vm_LambdaReduced = vm_Lambda[i_Layer + 1] * frostComponent.getLambdaRedux(i_Layer + 1);
       vm_PercolationFactor = 1.0 + (vm_LambdaReduced * vm_GravitationalWater[i_Layer + 1]);
       vm_PercolationRate[i_Layer + 1] = (vm_GravitationalWater[i_Layer + 1] * vm_GravitationalWater[i_Layer + 1]
@@ -1491,9 +1507,7 @@ void SoilMoisture::fm_Evapotranspiration(double vc_PercentageSoilCoverage, doubl
     
 	  // calculate reference evapotranspiration if not provided via climate files
 	if (vw_ReferenceEvapotranspiration < 0.0) {		
-		vm_ReferenceEvapotranspiration = ReferenceEvapotranspiration(vs_HeightNN, vw_MaxAirTemperature,
-			vw_MinAirTemperature, vw_RelativeHumidity, vw_MeanAirTemperature, vw_WindSpeed, vw_WindSpeedHeight,
-			vw_GlobalRadiation, vs_JulianDay, vs_Latitude);
+		vm_ReferenceEvapotranspiration = ReferenceEvapotranspiration(monica.dailyAtmosphere(), vw_GlobalRadiation);
 	}
 	else {
 		// use reference evapotranspiration from climate file		
@@ -1542,14 +1556,16 @@ void SoilMoisture::fm_Evapotranspiration(double vc_PercentageSoilCoverage, doubl
 	  vm_PotentialEvapotranspiration);
 
 
-        if (i_Layer >= pm_MaximumEvaporationImpactDepth) {
+        if (soilColumn.layerTopDepth(i_Layer) * 10.0 >= pm_MaximumEvaporationImpactDepth) {
           // layer is too deep for evaporation
           vm_EReducer_2 = 0.0;
         } else {
           // 2nd factor to reduce actual evapotranspiration by
           // MaximumEvaporationImpactDepth and EvaporationZeta
-          vm_EReducer_2 = get_DeprivationFactor(i_Layer + 1, pm_MaximumEvaporationImpactDepth,
-	      pm_EvaporationZeta, vm_LayerThickness[i_Layer]);
+          vm_EReducer_2 = get_DeprivationFactor(soilColumn.layerTopDepth(i_Layer),
+                                                soilColumn.layerBottomDepth(i_Layer),
+                                                pm_MaximumEvaporationImpactDepth,
+                                                pm_EvaporationZeta);
         }
 
         if (i_Layer > 0) {
@@ -1643,140 +1659,29 @@ void SoilMoisture::fm_Evapotranspiration(double vc_PercentageSoilCoverage, doubl
  * Guidelines for computing crop water requirements. FAO Irrigation and
  * Drainage Paper 56, FAO, Roma
  *
- * @param vs_HeightNN
- * @param vw_MaxAirTemperature
- * @param vw_MinAirTemperature
- * @param vw_RelativeHumidity
- * @param vw_MeanAirTemperature
- * @param vw_WindSpeed
- * @param vw_WindSpeedHeight
+ * The weather dependent terms are taken from the daily atmosphere
+ * prepared by MonicaModel, which are shared with the crop module.
+ *
+ * @param atmosphere daily atmospheric terms
  * @param vw_GlobalRadiation
  * @return
  */
-double SoilMoisture::ReferenceEvapotranspiration(double vs_HeightNN, double vw_MaxAirTemperature,
-    double vw_MinAirTemperature, double vw_RelativeHumidity, double vw_MeanAirTemperature, double vw_WindSpeed,
-    double vw_WindSpeedHeight, double vw_GlobalRadiation, int vs_JulianDay, double vs_Latitude) {
-
-  double vc_Declination;
-  double vc_DeclinationSinus; // old SINLD
-  double vc_DeclinationCosinus; // old COSLD
-  double vc_AstronomicDayLenght;
-  double vc_EffectiveDayLenght;
-  double vc_PhotoperiodicDaylength;
-  double vc_PhotActRadiationMean;
-  double vc_ClearDayRadiation;
-  double vc_OvercastDayRadiation;
-
-  double vm_AtmosphericPressure; //[kPA]
-  double vm_PsycrometerConstant; //[kPA °C-1]
-  double vm_SaturatedVapourPressureMax; //[kPA]
-  double vm_SaturatedVapourPressureMin; //[kPA]
-  double vm_SaturatedVapourPressure; //[kPA]
-  double vm_VapourPressure; //[kPA]
-  double vm_SaturationDeficit; //[kPA]
-  double vm_SaturatedVapourPressureSlope; //[kPA °C-1]
-  double vm_WindSpeed_2m; //[m s-1]
-  double vm_AerodynamicResistance; //[s m-1]
-  double vm_SurfaceResistance; //[s m-1]
-  double vc_ExtraterrestrialRadiation;
-  double vm_ReferenceEvapotranspiration; //[mm]
-  double pc_ReferenceAlbedo = cropPs.pc_ReferenceAlbedo; // FAO Green gras reference albedo from Allen et al. (1998)
-  double PI = 3.14159265358979323;
-
-  vc_Declination = -23.4 * cos(2.0 * PI * ((vs_JulianDay + 10.0) / 365.0));
-  vc_DeclinationSinus = sin(vc_Declination * PI / 180.0) * sin(vs_Latitude * PI / 180.0);
-  vc_DeclinationCosinus = cos(vc_Declination * PI / 180.0) * cos(vs_Latitude * PI / 180.0);
-  
-  double arg_AstroDayLength = vc_DeclinationSinus / vc_DeclinationCosinus;
-  arg_AstroDayLength = bound(-1.0, arg_AstroDayLength, 1.0); //The argument of asin must be in the range of -1 to 1  
-  vc_AstronomicDayLenght = 12.0 * (PI + 2.0 * asin(arg_AstroDayLength)) / PI;
-  
-  double arg_EffectiveDayLength = (-sin(8.0 * PI / 180.0) + vc_DeclinationSinus) / vc_DeclinationCosinus;
-  arg_EffectiveDayLength = bound(-1.0, arg_EffectiveDayLength, 1.0); //The argument of asin must be in the range of -1 to 1
-  vc_EffectiveDayLenght = 12.0 * (PI + 2.0 * asin(arg_EffectiveDayLength)) / PI;
-  
-  double arg_PhotoDayLength = (-sin(-6.0 * PI / 180.0) + vc_DeclinationSinus) / vc_DeclinationCosinus;
-  arg_PhotoDayLength = bound(-1.0, arg_PhotoDayLength, 1.0); //The argument of asin must be in the range of -1 to 1
-  vc_PhotoperiodicDaylength = 12.0 * (PI + 2.0 * asin(arg_PhotoDayLength)) / PI;
-  
-  double arg_PhotAct = min(1.0,((vc_DeclinationSinus / vc_DeclinationCosinus) * (vc_DeclinationSinus / vc_DeclinationCosinus))); //The argument of sqrt must be >= 0
-  vc_PhotActRadiationMean = 3600.0 * (vc_DeclinationSinus * vc_AstronomicDayLenght + 24.0 / PI * vc_DeclinationCosinus
-      * sqrt(1.0 - arg_PhotAct));
-  
-  
-  vc_ClearDayRadiation = 0;
-  if (vc_PhotActRadiationMean > 0 && vc_AstronomicDayLenght > 0)
-  {
-	  vc_ClearDayRadiation = 0.5 * 1300.0 * vc_PhotActRadiationMean * exp(-0.14 / (vc_PhotActRadiationMean
-		  / (vc_AstronomicDayLenght * 3600.0)));
-  }
-
-  vc_OvercastDayRadiation = 0.2 * vc_ClearDayRadiation;
-  double SC = 24.0 * 60.0 / PI * 8.20 *(1.0 + 0.033 * cos(2.0 * PI * vs_JulianDay / 365.0));
-  double arg_SHA = bound(-1.0, -tan(vs_Latitude * PI / 180.0) * tan(vc_Declination * PI / 180.0), 1.0); //The argument of acos must be in the range of -1 to 1
-  double SHA = acos(arg_SHA);
-  
-  vc_ExtraterrestrialRadiation = SC * (SHA * vc_DeclinationSinus + vc_DeclinationCosinus * sin(SHA)) / 100.0; // [J cm-2] --> [MJ m-2]
+double SoilMoisture::ReferenceEvapotranspiration(const DailyAtmosphere& atmosphere, double vw_GlobalRadiation) {
 
-  // Calculation of atmospheric pressure
-  vm_AtmosphericPressure = 101.3 * pow(((293.0 - (0.0065 * vs_HeightNN)) / 293.0), 5.26);
-
-  // Calculation of psychrometer constant - Luchtfeuchtigkeit
-  vm_PsycrometerConstant = 0.000665 * vm_AtmosphericPressure;
-
-  // Calc. of saturated water vapour pressure at daily max temperature
-  vm_SaturatedVapourPressureMax = 0.6108 * exp((17.27 * vw_MaxAirTemperature) / (237.3 + vw_MaxAirTemperature));
-
-  // Calc. of saturated water vapour pressure at daily min temperature
-  vm_SaturatedVapourPressureMin = 0.6108 * exp((17.27 * vw_MinAirTemperature) / (237.3 + vw_MinAirTemperature));
-
-  // Calculation of the saturated water vapour pressure
-  vm_SaturatedVapourPressure = (vm_SaturatedVapourPressureMax + vm_SaturatedVapourPressureMin) / 2.0;
-
-  // Calculation of the water vapour pressure
-  if (vw_RelativeHumidity <= 0.0){
-	  // Assuming Tdew = Tmin as suggested in FAO56 Allen et al. 1998
-	  vm_VapourPressure = vm_SaturatedVapourPressureMin;
-  } else {
-	  vm_VapourPressure = vw_RelativeHumidity * vm_SaturatedVapourPressure;
-  }
-
-  // Calculation of the air saturation deficit
-  vm_SaturationDeficit = vm_SaturatedVapourPressure - vm_VapourPressure;
-
-  // Slope of saturation water vapour pressure-to-temperature relation
-  vm_SaturatedVapourPressureSlope = (4098.0 * (0.6108 * exp((17.27 * vw_MeanAirTemperature) / (vw_MeanAirTemperature
-      + 237.3)))) / ((vw_MeanAirTemperature + 237.3) * (vw_MeanAirTemperature + 237.3));
-
-  // Calculation of wind speed in 2m height
-  vm_WindSpeed_2m = vw_WindSpeed * (4.87 / (log(67.8 * vw_WindSpeedHeight - 5.42)));
-
-  // Calculation of the aerodynamic resistance
-  vm_AerodynamicResistance = 208.0 / vm_WindSpeed_2m;
+  double pc_ReferenceAlbedo = cropPs.pc_ReferenceAlbedo; // FAO Green gras reference albedo from Allen et al. (1998)
 
   vc_StomataResistance = 100; // FAO default value [s m-1]
 
-  vm_SurfaceResistance = vc_StomataResistance / 1.44;
+  double vm_SurfaceResistance = vc_StomataResistance / 1.44;
 
-  double vc_ClearSkySolarRadiation = (0.75 + 0.00002 * vs_HeightNN) * vc_ExtraterrestrialRadiation;
+  double vc_ClearSkySolarRadiation = atmosphere.clearSkyFactor * atmosphere.extraterrestrialRadiation;
   double vc_RelativeShortwaveRadiation = vc_ClearSkySolarRadiation > 0 ? min(vw_GlobalRadiation / vc_ClearSkySolarRadiation, 1.0) : 1.0;
 
-  double pc_BolzmannConstant = 0.0000000049;
-  double vc_ShortwaveRadiation = (1.0 - pc_ReferenceAlbedo) * vw_GlobalRadiation;
-  double vc_LongwaveRadiation = pc_BolzmannConstant
-			  * ((pow((vw_MinAirTemperature + 273.16), 4.0)
-			  + pow((vw_MaxAirTemperature + 273.16), 4.0)) / 2.0)
-			  * (1.35 * vc_RelativeShortwaveRadiation - 0.35)
-			  * (0.34 - 0.14 * sqrt(vm_VapourPressure));
-  vw_NetRadiation = vc_ShortwaveRadiation - vc_LongwaveRadiation;
+  vw_NetRadiation = netRadiation(atmosphere, pc_ReferenceAlbedo, vw_GlobalRadiation, vc_RelativeShortwaveRadiation);
 
   // Calculation of the reference evapotranspiration
   // Penman-Monteith-Methode FAO
-  vm_ReferenceEvapotranspiration = ((0.408 * vm_SaturatedVapourPressureSlope * vw_NetRadiation)
-      + (vm_PsycrometerConstant * (900.0 / (vw_MeanAirTemperature + 273.0))
-      * vm_WindSpeed_2m * vm_SaturationDeficit))
-      / (vm_SaturatedVapourPressureSlope + vm_PsycrometerConstant
-      * (1.0 + (vm_SurfaceResistance / 208.0) * vm_WindSpeed_2m));
+  double vm_ReferenceEvapotranspiration = penmanMonteithET0(atmosphere, vw_NetRadiation, vm_SurfaceResistance);
 
   if (vm_ReferenceEvapotranspiration < 0.0){
     vm_ReferenceEvapotranspiration = 0.0;
@@ -1879,36 +1784,31 @@ double SoilMoisture::get_EReducer_1(int i_Layer,
  *
  * PET deprivation distribution (factor as function of depth).
  * The PET is spread over the deprivation depth. This function computes
- * the factor/weight for a given layer/depth[dm] (layerNo).
+ * the factor/weight for the soil slice between topDepth and bottomDepth,
+ * so layers of any thickness get their share of the distribution.
  *
- * @param layerNo [1..NLAYER]
+ * @param topDepth [m] upper boundary of the layer
+ * @param bottomDepth [m] lower boundary of the layer
  * @param deprivationDepth [dm] maximum deprivation depth
  * @param zeta [0..40] shape factor
- * @param vs_LayerThickness
  */
-double SoilMoisture::get_DeprivationFactor(int layerNo, double deprivationDepth, double zeta, double vs_LayerThickness) {
+double SoilMoisture::get_DeprivationFactor(double topDepth, double bottomDepth,
+                                           double deprivationDepth, double zeta) {
   // factor (f(depth)) to distribute the PET along the soil profil/rooting zone
 
-  double deprivationFactor;
-
-  // factor to introduce layer thickness in this algorithm,
-  // to allow layer thickness scaling (Claas Nendel)
-  double layerThicknessFactor = deprivationDepth / (vs_LayerThickness * 10.0);
+  // relative depths of the layer boundaries within the deprivation zone
+  double x0 = min(1.0, topDepth * 10.0 / deprivationDepth);
+  double x1 = min(1.0, bottomDepth * 10.0 / deprivationDepth);
 
   if ((fabs(zeta)) < 0.0003) {
 
-    deprivationFactor = (2.0 / layerThicknessFactor) - (1.0 / (layerThicknessFactor * layerThicknessFactor)) * (2
-        * layerNo - 1);
-    return deprivationFactor;
+    return (2.0 * x1 - x1 * x1) - (2.0 * x0 - x0 * x0);
 
   } else {
 
-    double c2 = 0.0;
-    double c3 = 0.0;
-    c2 = log((layerThicknessFactor + zeta * layerNo) / (layerThicknessFactor + zeta * (layerNo - 1)));
-    c3 = zeta / (layerThicknessFactor * (zeta + 1.0));
-    deprivationFactor = (c2 - c3) / (log(zeta + 1.0) - zeta / (zeta + 1.0));
-    return deprivationFactor;
+    double c2 = log((1.0 + zeta * x1) / (1.0 + zeta * x0));
+    double c3 = zeta * (x1 - x0) / (zeta + 1.0);
+    return (c2 - c3) / (log(zeta + 1.0) - zeta / (zeta + 1.0));
   }
 }
 
@@ -1922,21 +1822,20 @@ double SoilMoisture::get_DeprivationFactor(int layerNo, double deprivationDepth,
 double SoilMoisture::meanWaterContent(double depth_m) const
 {
   double lsum = 0.0, sum = 0.0;
-  int count = 0;
 
   for (int i = 0; i < vs_NumberOfLayers; i++)
   {
-    count++;
     double smm3 = soilColumn[i].get_Vs_SoilMoisture_m3();
     double fc = soilColumn[i].vs_FieldCapacity();
     double pwp = soilColumn[i].vs_PermanentWiltingPoint();
-    sum += smm3 / (fc - pwp); //[%nFK]
-    lsum += soilColumn[i].vs_LayerThickness;
+    double lt = soilColumn[i].vs_LayerThickness;
+    sum += smm3 / (fc - pwp) * lt; //[%nFK]
+    lsum += lt;
     if (lsum >= depth_m)
       break;
   }
 
-  return sum / double(count);
+  return lsum > 0.0 ? sum / lsum : 0.0;
 }
 
 
@@ -26,6 +26,7 @@ Copyright (C) Leibniz Centre for Agricultural Landscape Research (ZALF)
 
 #include "monica-parameters.h"
 #include "crop-growth.h"
+#include "reference-evapotranspiration.h"
 
 namespace Monica 
 {
@@ -244,8 +245,8 @@ namespace Monica
                          double vc_PercentageSoilCoverage,
                          int vm_GroundwaterTable);
 
-    double get_DeprivationFactor(int layerNo, double deprivationDepth,
-                                 double zeta, double vs_LayerThickness);
+    double get_DeprivationFactor(double topDepth, double bottomDepth,
+                                 double deprivationDepth, double zeta);
 
     void fm_CapillaryRise();
 
@@ -272,16 +273,8 @@ namespace Monica
                                double vs_Latitude,
 							   double vw_ReferenceEvapotranspiration);
 
-    double ReferenceEvapotranspiration(double vs_HeightNN,
-                                       double vw_MaxAirTemperature,
-                                       double vw_MinAirTemperature,
-                                       double vw_RelativeHumidity,
-                                       double vw_MeanAirTemperature,
-                                       double vw_WindSpeed,
-                                       double vw_WindSpeedHeight,
-                                       double vw_NetRadiation,
-                                       int vs_JulianDay,
-                                       double vs_Latitude);
+    double ReferenceEvapotranspiration(const DailyAtmosphere& atmosphere,
+                                       double vw_GlobalRadiation);
 
     double meanWaterContent(double depth_m) const;
     double meanWaterContent(int layer, int number_of_layers) const;
@@ -309,7 +302,7 @@ namespace Monica
 		double vm_ActualTranspiration{0.0}; //!< Sum of transpiration of all layers [mm]
     std::vector<double> vm_AvailableWater; //!< Soil available water in [mm]
 		double vm_CapillaryRise{0.0}; //!< Capillary rise [mm]
-    std::vector<double> pm_CapillaryRiseRate; //!< Capillary rise rate from database in dependence of groundwater distance and texture [m d-1]
+    std::vector<std::shared_ptr<const CapillaryRiseRates::Table>> pm_CapillaryRiseRates; //!< Capillary rise rates of each layer's texture in dependence of groundwater distance [m d-1]
     std::vector<double> vm_CapillaryWater; //!< soil capillary water in [mm]
     std::vector<double> vm_CapillaryWater70; //!< 70% of soil capillary water in [mm]
     std::vector<double> vm_Evaporation; //!< Evaporation of layer [mm]
@@ -333,7 +326,6 @@ namespace Monica
 		double vm_LambdaReduced{0.0};
 		double vs_Latitude{0.0};
     std::vector<double> vm_LayerThickness;
-		double pm_LayerThickness{0.0};
 		double pm_LeachingDepth{0.0};
 		int pm_LeachingDepthLayer{0};
 		double vw_MaxAirTemperature{0.0}; //!< [°C]
@@ -20,6 +20,7 @@ Copyright (C) Leibniz Centre for Agricultural Landscape Research (ZALF)
  */
 
 #include <algorithm>
+#include <array>
 #include <cmath>
 
 #include "soilorganic.h"
@@ -63,7 +64,8 @@ SoilOrganic::SoilOrganic(SoilColumn& sc,
 	vo_SMB_SlowDelta(sc.vs_NumberOfOrganicLayers()),
 	vo_SoilOrganicC(sc.vs_NumberOfOrganicLayers()),
 	vo_SOM_FastDelta(sc.vs_NumberOfOrganicLayers()),
-	vo_SOM_SlowDelta(sc.vs_NumberOfOrganicLayers())
+	vo_SOM_SlowDelta(sc.vs_NumberOfOrganicLayers()),
+	vo_TempMoistFactor(sc.vs_NumberOfOrganicLayers())
 {
 	// Subroutine Pool initialisation
 	double po_SOM_SlowUtilizationEfficiency = organicPs.po_SOM_SlowUtilizationEfficiency;
@@ -149,6 +151,9 @@ void SoilOrganic::step(double vw_MeanAirTemperature, double vw_Precipitation,
 	fo_N2OProduction();
 	fo_PoolUpdate();
 
+	if(vo_RecordSpinUpForcing)
+		vo_SpinUpForcing.back().front().SOM_FastInput = vo_SOM_FastInput;
+
 	vo_NetEcosystemProduction =
 		fo_NetEcosystemProduction(vc_NetPrimaryProduction, vo_DecomposerRespiration);
 	vo_NetEcosystemExchange =
@@ -695,6 +700,7 @@ void SoilOrganic::fo_MIT()
 	{
 		double tod = fo_TempOnDecompostion(soilColumn[i_Layer].get_Vs_SoilTemperature());
 		double mod = fo_MoistOnDecompostion(soilColumn[i_Layer].vs_SoilMoisture_pF());
+		vo_TempMoistFactor[i_Layer] = tod * mod;
 
 		vo_SOM_SlowDecCoeff[i_Layer] = po_SOM_SlowDecCoeffStandard * tod * mod;
 		vo_SOM_FastDecCoeff[i_Layer] = po_SOM_FastDecCoeffStandard * tod * mod;
@@ -727,6 +733,13 @@ void SoilOrganic::fo_MIT()
 	// Calculation of pool changes by decomposition
 	for(int i_Layer = 0; i_Layer < nools; i_Layer++)
 	{
+		vo_AOM_SlowDecRateSum[i_Layer] = 0.0;
+		vo_AOM_FastDecRateSum[i_Layer] = 0.0;
+		AOMfast_to_SMBfast[i_Layer] = 0.0;
+		vo_AOM_SlowDeltaSum[i_Layer] = 0.0;
+		vo_AOM_FastDeltaSum[i_Layer] = 0.0;
+
+		// one pass over the (compacted) pools of the layer, the pools are independent of each other
 		for(AOM_Properties& AOM_Pool : soilColumn[i_Layer].vo_AOM_Pool)
 		{
 			// Eq.6-5 and 6-6 in the DAISY manual
@@ -739,13 +752,8 @@ void SoilOrganic::fo_MIT()
 
 			if(-AOM_Pool.vo_AOM_FastDelta > AOM_Pool.vo_AOM_Fast)
 				AOM_Pool.vo_AOM_FastDelta = (-AOM_Pool.vo_AOM_Fast);
-		}
 
-		// Eq.6-7 in the DAISY manual
-		vo_AOM_SlowDecRateSum[i_Layer] = 0.0;
-				
-		for(AOM_Properties& AOM_Pool : soilColumn[i_Layer].vo_AOM_Pool)
-		{
+			// Eq.6-7 in the DAISY manual
 			AOM_Pool.vo_AOM_SlowDecRate_to_SMB_Slow = AOM_Pool.vo_PartAOM_Slow_to_SMB_Slow
 				* AOM_Pool.vo_AOM_SlowDecCoeff * AOM_Pool.vo_AOM_Slow;
 
@@ -757,15 +765,8 @@ void SoilOrganic::fo_MIT()
 			
 			AOMslow_to_SMBfast[i_Layer] += AOM_Pool.vo_AOM_SlowDecRate_to_SMB_Fast;
 			AOMslow_to_SMBslow[i_Layer] += AOM_Pool.vo_AOM_SlowDecRate_to_SMB_Slow;
-		}
 
-		// Eq.6-8 in the DAISY manual
-		vo_AOM_FastDecRateSum[i_Layer] = 0.0;
-
-		AOMfast_to_SMBfast[i_Layer] = 0.0;
-
-		for(AOM_Properties& AOM_Pool : soilColumn[i_Layer].vo_AOM_Pool)
-		{
+			// Eq.6-8 in the DAISY manual
 			//AOM_Pool.vo_AOM_FastDecRate_to_SMB_Slow = AOM_Pool.vo_PartAOM_Slow_to_SMB_Slow
 			//	* AOM_Pool.vo_AOM_FastDecCoeff * AOM_Pool.vo_AOM_Fast;
 
@@ -779,7 +780,10 @@ void SoilOrganic::fo_MIT()
 			vo_AOM_FastDecRateSum[i_Layer] += AOM_Pool.vo_AOM_FastDecRate_to_SMB_Fast;
 
 			AOMfast_to_SMBfast[i_Layer] += AOM_Pool.vo_AOM_FastDecRate_to_SMB_Fast;
-		}		
+
+			vo_AOM_SlowDeltaSum[i_Layer] += AOM_Pool.vo_AOM_SlowDelta;
+			vo_AOM_FastDeltaSum[i_Layer] += AOM_Pool.vo_AOM_FastDelta;
+		}
 		
 		vo_SMB_SlowDelta[i_Layer] = (po_SOM_SlowUtilizationEfficiency * vo_SOM_SlowDecRate[i_Layer])
 			+ (po_SOM_FastUtilizationEfficiency * (1.0 - po_PartSOM_Fast_to_SOM_Slow) * vo_SOM_FastDecRate[i_Layer])
@@ -814,16 +818,6 @@ void SoilOrganic::fo_MIT()
 
 		if((soilColumn[i_Layer].vs_SOM_Fast + vo_SOM_FastDelta[i_Layer]) < 0.0)
 			vo_SOM_FastDelta[i_Layer] = soilColumn[i_Layer].vs_SOM_Fast;
-
-		vo_AOM_SlowDeltaSum[i_Layer] = 0.0;
-		vo_AOM_FastDeltaSum[i_Layer] = 0.0;
-
-		for(AOM_Properties& AOM_Pool : soilColumn[i_Layer].vo_AOM_Pool)
-		{
-			vo_AOM_SlowDeltaSum[i_Layer] += AOM_Pool.vo_AOM_SlowDelta;
-			vo_AOM_FastDeltaSum[i_Layer] += AOM_Pool.vo_AOM_FastDelta;
-		}
-
 	} // for i_Layer
 	
 
@@ -1003,12 +997,27 @@ void SoilOrganic::fo_MIT()
 		}
 
 		vo_NetNMineralisationRate[i_Layer] = fabs(vo_NBalance[i_Layer])
-			* soilColumn[0].vs_LayerThickness; // [kg m-3] --> [kg m-2]
+			* soilColumn[i_Layer].vs_LayerThickness; // [kg m-3] --> [kg m-2]
 		vo_NetNMineralisation += fabs(vo_NBalance[i_Layer])
-			* soilColumn[0].vs_LayerThickness; // [kg m-3] --> [kg m-2]
+			* soilColumn[i_Layer].vs_LayerThickness; // [kg m-3] --> [kg m-2]
 		vo_SumNetNMineralisation += fabs(vo_NBalance[i_Layer])
-			* soilColumn[0].vs_LayerThickness; // [kg m-3] --> [kg m-2]
+			* soilColumn[i_Layer].vs_LayerThickness; // [kg m-3] --> [kg m-2]
+
+	}
 
+	// record the forcing of the SOM/SMB pools for the accelerated spin-up
+	if(vo_RecordSpinUpForcing)
+	{
+		vo_SpinUpForcing.emplace_back(nools);
+		for(int i_Layer = 0; i_Layer < nools; i_Layer++)
+		{
+			auto& f = vo_SpinUpForcing.back()[i_Layer];
+			f.tempMoistFactor = vo_TempMoistFactor[i_Layer];
+			f.clayFactor = fo_ClayOnDecompostion(soilColumn[i_Layer].vs_SoilClayContent(), po_LimitClayEffect);
+			f.SMB_SlowInput = po_AOM_SlowUtilizationEfficiency * AOMslow_to_SMBslow[i_Layer];
+			f.SMB_FastInput = (po_AOM_FastUtilizationEfficiency * AOMfast_to_SMBfast[i_Layer])
+				+ (po_AOM_SlowUtilizationEfficiency * AOMslow_to_SMBfast[i_Layer]);
+		}
 	}
 
 	vo_DecomposerRespiration = 0.0;
@@ -1286,7 +1295,7 @@ void SoilOrganic::fo_Denitrification()
 
 		}
 
-		vo_TotalDenitrification += vo_ActDenitrificationRate[i_Layer] * soilColumn[0].vs_LayerThickness; // [kg m-3] --> [kg m-2] ;
+		vo_TotalDenitrification += vo_ActDenitrificationRate[i_Layer] * soilColumn[i_Layer].vs_LayerThickness; // [kg m-3] --> [kg m-2] ;
 	}
 
 	vo_SumDenitrification += vo_TotalDenitrification; // [kg N m-2]
@@ -1399,6 +1408,208 @@ void SoilOrganic::fo_PoolUpdate()
 	} 
 }
 
+namespace
+{
+	typedef array<double, 4> Pools4;
+	typedef array<Pools4, 4> Matrix4;
+
+	Matrix4 identity4()
+	{
+		Matrix4 m{};
+		for(size_t i = 0; i < 4; i++)
+			m[i][i] = 1.0;
+		return m;
+	}
+
+	Matrix4 mult(const Matrix4& a, const Matrix4& b)
+	{
+		Matrix4 m{};
+		for(size_t i = 0; i < 4; i++)
+			for(size_t k = 0; k < 4; k++)
+				for(size_t j = 0; j < 4; j++)
+					m[i][j] += a[i][k] * b[k][j];
+		return m;
+	}
+
+	Pools4 mult(const Matrix4& a, const Pools4& x)
+	{
+		Pools4 y{};
+		for(size_t i = 0; i < 4; i++)
+			for(size_t j = 0; j < 4; j++)
+				y[i] += a[i][j] * x[j];
+		return y;
+	}
+
+	double poolSum(const Pools4& x)
+	{
+		return x[0] + x[1] + x[2] + x[3];
+	}
+
+	void scaleToTotal(Pools4& x, double total)
+	{
+		double s = poolSum(x);
+		if(s > 0.0)
+			for(auto& v : x)
+				v *= total / s;
+	}
+
+	//! solve a x = b by gaussian elimination with partial pivoting, false if a is (nearly) singular
+	bool solve4(Matrix4 a, Pools4 b, Pools4& x)
+	{
+		for(size_t c = 0; c < 4; c++)
+		{
+			size_t p = c;
+			for(size_t r = c + 1; r < 4; r++)
+				if(fabs(a[r][c]) > fabs(a[p][c]))
+					p = r;
+			if(fabs(a[p][c]) < 1e-14)
+				return false;
+			swap(a[c], a[p]);
+			swap(b[c], b[p]);
+			for(size_t r = c + 1; r < 4; r++)
+			{
+				double f = a[r][c] / a[c][c];
+				for(size_t k = c; k < 4; k++)
+					a[r][k] -= f * a[c][k];
+				b[r] -= f * b[c];
+			}
+		}
+		for(size_t c = 4; c-- > 0;)
+		{
+			double s = b[c];
+			for(size_t k = c + 1; k < 4; k++)
+				s -= a[c][k] * x[k];
+			x[c] = s / a[c][c];
+		}
+		return true;
+	}
+}
+
+vector<SoilOrganic::SOMPools> SoilOrganic::get_SOMPools() const
+{
+	vector<SOMPools> pools;
+	for(size_t i_Layer = 0; i_Layer < soilColumn.vs_NumberOfOrganicLayers(); i_Layer++)
+	{
+		const auto& layer = soilColumn[i_Layer];
+		pools.push_back({{layer.vs_SOM_Slow, layer.vs_SOM_Fast, layer.vs_SMB_Slow, layer.vs_SMB_Fast}});
+	}
+	return pools;
+}
+
+void SoilOrganic::set_SOMPools(const vector<SOMPools>& pools)
+{
+	for(size_t i_Layer = 0; i_Layer < soilColumn.vs_NumberOfOrganicLayers() && i_Layer < pools.size(); i_Layer++)
+	{
+		auto& layer = soilColumn[i_Layer];
+		const SOMPools& x = pools[i_Layer];
+		double total0 = layer.vs_SOM_Slow + layer.vs_SOM_Fast + layer.vs_SMB_Slow + layer.vs_SMB_Fast;
+
+		layer.vs_SOM_Slow = x[0];
+		layer.vs_SOM_Fast = x[1];
+		layer.vs_SMB_Slow = x[2];
+		layer.vs_SMB_Fast = x[3];
+
+		// [kg C m-3] / [kg m-3] --> [kg C kg-1]
+		layer.set_SoilOrganicCarbon(layer.vs_SoilOrganicCarbon()
+																+ (poolSum(x) - total0) / layer.vs_SoilBulkDensity());
+		vo_SoilOrganicC[i_Layer] = layer.vs_SoilOrganicCarbon() * layer.vs_SoilBulkDensity()
+			- vo_InertSoilOrganicC[i_Layer];
+	}
+}
+
+/**
+ * @brief Equilibrium of the SOM and SMB pools under the recorded forcing cycle.
+ *
+ * Without the N limitation and the clamping of negative pool changes, one day of
+ * fo_MIT is linear in the pools x = (SOM slow, SOM fast, SMB slow, SMB fast):
+ * x(d+1) = P(d) x(d) + u(d). Chaining the recorded days gives the map over the
+ * whole cycle x -> Phi x + b, whose fixed point (I - Phi) x = b is the state a
+ * brute force spin-up repeating the cycle would converge to.
+ * If the cycle carries no carbon input, the pools only decay and the dominant
+ * eigenvector of Phi (the asymptotic pool distribution), scaled to the initial
+ * carbon, is used instead.
+ */
+vector<SoilOrganic::SOMPools>
+SoilOrganic::spinUpEquilibrium(const vector<SOMPools>& initialPools,
+                               vector<bool>* decayOnlyLayers) const
+{
+	double ks = organicPs.po_SOM_SlowDecCoeffStandard;
+	double kf = organicPs.po_SOM_FastDecCoeffStandard;
+	double ds = organicPs.po_SMB_SlowDeathRateStandard;
+	double df = organicPs.po_SMB_FastDeathRateStandard;
+	double ms = organicPs.po_SMB_SlowMaintRateStandard;
+	double mf = organicPs.po_SMB_FastMaintRateStandard;
+	double es = organicPs.po_SOM_SlowUtilizationEfficiency;
+	double ef = organicPs.po_SOM_FastUtilizationEfficiency;
+	double eSMB = organicPs.po_SMB_UtilizationEfficiency;
+	double pF = organicPs.po_PartSOM_Fast_to_SOM_Slow;
+	double pSs = organicPs.po_PartSMB_Slow_to_SOM_Fast;
+	double pFf = organicPs.po_PartSMB_Fast_to_SOM_Fast;
+
+	vector<SOMPools> pools;
+	for(size_t i_Layer = 0; i_Layer < soilColumn.vs_NumberOfOrganicLayers() && i_Layer < initialPools.size(); i_Layer++)
+	{
+		Matrix4 phi = identity4();
+		Pools4 b{};
+		for(const auto& day : vo_SpinUpForcing)
+		{
+			const SpinUpForcing& sf = day.at(i_Layer);
+			double f = sf.tempMoistFactor;
+
+			// same terms as in fo_MIT (Eq.6-9, 6-10 and the SMB balances)
+			Matrix4 p = identity4();
+			p[0][0] -= ks * f;
+			p[0][1] += pF * kf * f;
+			p[1][1] -= kf * f;
+			p[1][2] += pSs * ds * f;
+			p[1][3] += pFf * df * f;
+			p[2][0] += es * ks * f;
+			p[2][1] += ef * (1.0 - pF) * kf * f;
+			p[2][2] -= (ds + ms * sf.clayFactor) * f;
+			p[3][2] += eSMB * (1.0 - pSs) * ds * f;
+			p[3][3] += eSMB * (1.0 - pSs) * df * f - (df + mf) * f;
+
+			phi = mult(p, phi);
+			b = mult(p, b);
+			b[1] += sf.SOM_FastInput;
+			b[2] += sf.SMB_SlowInput;
+			b[3] += sf.SMB_FastInput;
+		}
+
+		const Pools4& x0 = initialPools[i_Layer];
+		double total0 = poolSum(x0);
+
+		Matrix4 a = identity4();
+		for(size_t i = 0; i < 4; i++)
+			for(size_t j = 0; j < 4; j++)
+				a[i][j] -= phi[i][j];
+
+		Pools4 x{};
+		bool decayOnly = poolSum(b) <= 1e-12 || !solve4(a, b, x);
+		if(decayOnly)
+		{
+			// power iteration, the slow pools need many cycles to dominate
+			x = x0;
+			for(int i = 0; i < 1000; i++)
+			{
+				x = mult(phi, x);
+				scaleToTotal(x, total0);
+			}
+		}
+		else if(organicPs.po_SpinUpKeepTotalCarbon)
+			scaleToTotal(x, total0);
+
+		for(auto& v : x)
+			v = max(0.0, v);
+
+		pools.push_back(x);
+		if(decayOnlyLayers)
+			decayOnlyLayers->push_back(decayOnly);
+	}
+
+	return pools;
+}
+
 /**
  * @brief Internal Function Clay effect on SOM decompostion
  * @param d_SoilClayContent
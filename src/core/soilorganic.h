@@ -32,6 +32,7 @@ Copyright (C) Leibniz Centre for Agricultural Landscape Research (ZALF)
 #include <vector>
 #include <utility>
 #include <list>
+#include <array>
 
 #include "monica-parameters.h"
 
@@ -101,6 +102,26 @@ namespace Monica
 
 		double get_Organic_N(int i_Layer) const;
 
+    //! SOM slow, SOM fast, SMB slow and SMB fast carbon of an organic layer [kg C m-3]
+    typedef std::array<double, 4> SOMPools;
+
+    std::vector<SOMPools> get_SOMPools() const;
+
+    //! set the pools of each organic layer, the change is booked to the layer's soil organic carbon
+    void set_SOMPools(const std::vector<SOMPools>& pools);
+
+    //! record the daily forcing of the SOM/SMB pools for spinUpEquilibrium()
+    void set_RecordSpinUpForcing(bool record) { vo_RecordSpinUpForcing = record; }
+
+    //! equilibrium pools of each organic layer under the forcing cycle recorded so far,
+    //! decayOnlyLayers tells which layers had no carbon input during the cycle
+    std::vector<SOMPools> spinUpEquilibrium(const std::vector<SOMPools>& initialPools,
+                                            std::vector<bool>* decayOnlyLayers = nullptr) const;
+
+    //! max. relative deviation of the accelerated spin-up from repeating the forcing cycle, -1 if not compared
+    double get_SpinUpDeviation() const { return vo_SpinUpDeviation; }
+    void set_SpinUpDeviation(double deviation) { vo_SpinUpDeviation = deviation; }
+
   private:
     //void fo_OM_Input(bool vo_AOM_Addition);
     void fo_Urea(double vo_RainIrrigation);
@@ -159,8 +180,22 @@ namespace Monica
     double vo_SumNetNMineralisation{0.0};
     double vo_SumN2O_Produced{0.0};
     double vo_SumNH3_Volatilised{0.0};
+    std::vector<double> vo_TempMoistFactor; //!< combined temperature and moisture effect on decomposition []
     double vo_TotalDenitrification{0.0};
 
+    //! daily forcing of the linear SOM/SMB pool system of one layer, recorded for the accelerated spin-up
+    struct SpinUpForcing
+    {
+      double tempMoistFactor{0.0}; //!< temperature * moisture effect on decomposition []
+      double clayFactor{0.0}; //!< clay effect on SMB slow maintenance []
+      double SMB_SlowInput{0.0}; //!< carbon from AOM decomposition assimilated into SMB slow [kg C m-3 d-1]
+      double SMB_FastInput{0.0}; //!< carbon from AOM decomposition assimilated into SMB fast [kg C m-3 d-1]
+      double SOM_FastInput{0.0}; //!< direct input from added organic matter [kg C m-3 d-1]
+    };
+    std::vector<std::vector<SpinUpForcing>> vo_SpinUpForcing; //!< [day][layer]
+    bool vo_RecordSpinUpForcing{false};
+    double vo_SpinUpDeviation{-1.0};
+
     /*
     struct AddedOMParams {
       double vo_AddedOrganicCarbonAmount;
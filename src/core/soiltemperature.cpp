@@ -417,18 +417,17 @@ double SoilTemperature::get_AvgTopSoilTemperature(double sumLT) const
 {
 	double lsum = 0;
 	double tempSum = 0;
-	int count = 0;
 
 	for(size_t i = 0; i < vs_NumberOfLayers; i++)
 	{
-		count++;
-		tempSum += soilColumn.at(i).get_Vs_SoilTemperature();
-		lsum += soilColumn.at(i).vs_LayerThickness;
+		double lt = soilColumn.at(i).vs_LayerThickness;
+		tempSum += soilColumn.at(i).get_Vs_SoilTemperature() * lt;
+		lsum += lt;
 		if(lsum >= sumLT)
 		{
 			break;
 		}
 	}
 
-	return count < 1 ? 0 : tempSum / double(count);
+	return lsum > 0 ? tempSum / lsum : 0;
 }
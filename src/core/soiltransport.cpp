@@ -86,7 +86,7 @@ void SoilTransport::calculateSoilTransportStep() {
     vq_SoilMoisture[i_Layer] = soilColumn[i_Layer].get_Vs_SoilMoisture_m3();
     vq_SoilNO3[i_Layer] = soilColumn[i_Layer].vs_SoilNO3;
 
-    vq_LayerThickness[i_Layer] = soilColumn[0].vs_LayerThickness;
+    vq_LayerThickness[i_Layer] = soilColumn[i_Layer].vs_LayerThickness;
     vc_NUptakeFromLayer[i_Layer] = crop ? crop->get_NUptakeFromLayer(i_Layer) : 0;
     if (i_Layer == (vs_NumberOfLayers - 1)){
       vq_PercolationRate[i_Layer] = soilColumn.vs_FluxAtLowerBoundary ; //[mm]
@@ -340,20 +340,24 @@ void SoilTransport::fq_NTransport(double vs_LeachingDepth, double vq_TimeStepFac
 	+ ((0.5 * vq_TimeStep * vq_TimeStepFactor * fabs((pr + pr_o) / 2.0)) * vq_PoreWaterVelocity[i_Layer]);
     }
 
+    // distances between the centres of this layer and the layers above and below [m]
+    const double dz_o = i_Layer > 0 ? (soilColumn[i_Layer - 1].vs_LayerThickness + lt) * 0.5 : lt;
+    const double dz_u = i_Layer < vs_NumberOfLayers - 1 ? (lt + soilColumn[i_Layer + 1].vs_LayerThickness) * 0.5 : lt;
+
     //old DISP = Gesamt-Dispersion (D in Diss S. 23)
     if (i_Layer == 0) {
       const double NO3_u = vq_SoilNO3_aq[i_Layer + 1];
       // vq_Dispersion = Dispersion upwards or downwards, depending on the position in the profile [kg m-3]
-      vq_Dispersion[i_Layer] = -vq_DispersionCoeff[i_Layer] * (NO3 - NO3_u) / (lt * lt); // [m2] * [kg m-3] / [m2]
+      vq_Dispersion[i_Layer] = -vq_DispersionCoeff[i_Layer] * (NO3 - NO3_u) / (lt * dz_u); // [m2] * [kg m-3] / [m2]
 
     } else if (i_Layer < vs_NumberOfLayers - 1) {
       const double NO3_o = vq_SoilNO3_aq[i_Layer - 1];
       const double NO3_u = vq_SoilNO3_aq[i_Layer + 1];
-      vq_Dispersion[i_Layer] = (vq_DispersionCoeff[i_Layer - 1] * (NO3_o - NO3) / (lt * lt))
-	- (vq_DispersionCoeff[i_Layer] * (NO3 - NO3_u) / (lt * lt));
+      vq_Dispersion[i_Layer] = (vq_DispersionCoeff[i_Layer - 1] * (NO3_o - NO3) / (lt * dz_o))
+	- (vq_DispersionCoeff[i_Layer] * (NO3 - NO3_u) / (lt * dz_u));
     } else {
       const double NO3_o = vq_SoilNO3_aq[i_Layer - 1];
-      vq_Dispersion[i_Layer] = vq_DispersionCoeff[i_Layer - 1] * (NO3_o - NO3) / (lt * lt);
+      vq_Dispersion[i_Layer] = vq_DispersionCoeff[i_Layer - 1] * (NO3_o - NO3) / (lt * dz_o);
     }
   } // for
 
@@ -381,9 +385,10 @@ void SoilTransport::fq_NTransport(double vs_LeachingDepth, double vq_TimeStepFac
     if (vq_LeachingDepthLayerIndex < vs_NumberOfLayers - 1) {
       const double pr_u = vq_PercolationRate[vq_LeachingDepthLayerIndex + 1] / 1000.0 * vq_TimeStepFactor;// [m t-1]
       const double NO3_u = vq_SoilNO3_aq[vq_LeachingDepthLayerIndex + 1]; // [kg m-3]
+      const double dz_u = (lt + soilColumn[vq_LeachingDepthLayerIndex + 1].vs_LayerThickness) * 0.5; // [m]
       //vq_LeachingAtBoundary: Summe für Auswaschung (Diff + Konv), old OUTSUM
       vq_LeachingAtBoundary += ((pr_u * NO3) / lt * 10000.0 * lt) + ((vq_DispersionCoeff[vq_LeachingDepthLayerIndex]
-	* (NO3 - NO3_u)) / (lt * lt) * 10000.0 * lt); //[kg ha-1]
+	* (NO3 - NO3_u)) / (lt * dz_u) * 10000.0 * lt); //[kg ha-1]
     } else {
       const double pr_u = soilColumn.vs_FluxAtLowerBoundary / 1000.0 * vq_TimeStepFactor; // [m t-1]
       vq_LeachingAtBoundary += pr_u * NO3 / lt * 10000.0 * lt; //[kg ha-1]
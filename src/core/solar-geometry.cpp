@@ -0,0 +1,124 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/*
+Authors:
+Claas Nendel <claas.nendel@zalf.de>
+Michael Berg <michael.berg@zalf.de>
+
+Maintainers:
+Currently maintained by the authors.
+
+This file is part of the MONICA model.
+Copyright (C) Leibniz Centre for Agricultural Landscape Research (ZALF)
+*/
+
+#include <cmath>
+#include <map>
+#include <mutex>
+
+#include "solar-geometry.h"
+#include "tools/algorithms.h"
+
+using namespace std;
+using namespace Monica;
+using namespace Tools;
+
+namespace
+{
+	SolarDay calcSolarDay(double latitude, int julianDay)
+	{
+		const double PI = 3.14159265358979323;
+		SolarDay sd;
+
+		// Calculation of declination - old DEC
+		sd.declination = -23.4 * cos(2.0 * PI * ((julianDay + 10.0) / 365.0));
+
+		sd.declinationSinus = sin(sd.declination * PI / 180.0) * sin(latitude * PI / 180.0);
+		sd.declinationCosinus = cos(sd.declination * PI / 180.0) * cos(latitude * PI / 180.0);
+
+		// Calculation of the atmospheric day lenght - old DL
+		double arg_AstroDayLength = sd.declinationSinus / sd.declinationCosinus;
+		arg_AstroDayLength = bound(-1.0, arg_AstroDayLength, 1.0); //The argument of asin must be in the range of -1 to 1 
+		sd.astronomicDayLength = 12.0 * (PI + 2.0 * asin(arg_AstroDayLength)) / PI;
+
+		// Calculation of the effective day length - old DLE
+		double EDLHelper = (-sin(8.0 * PI / 180.0) + sd.declinationSinus) / sd.declinationCosinus;
+		if((EDLHelper < -1.0) || (EDLHelper > 1.0))
+			sd.effectiveDayLength = 0.01;
+		else
+			sd.effectiveDayLength = 12.0 * (PI + 2.0 * asin(EDLHelper)) / PI;
+
+		// old DLP
+		double arg_PhotoDayLength = (-sin(-6.0 * PI / 180.0) + sd.declinationSinus) / sd.declinationCosinus;
+		arg_PhotoDayLength = bound(-1.0, arg_PhotoDayLength, 1.0); //The argument of asin must be in the range of -1 to 1
+		sd.photoperiodicDayLength = 12.0 * (PI + 2.0 * asin(arg_PhotoDayLength)) / PI;
+
+		// Calculation of the mean photosynthetically active radiation [J m-2] - old RDN
+		double arg_PhotAct = min(1.0, ((sd.declinationSinus / sd.declinationCosinus) * (sd.declinationSinus / sd.declinationCosinus))); //The argument of sqrt must be >= 0
+		sd.photActRadiationMean = 3600.0 * (sd.declinationSinus * sd.astronomicDayLength + 24.0 / PI * sd.declinationCosinus
+																				* sqrt(1.0 - arg_PhotAct));
+
+		// Calculation of radiation on a clear day [J m-2] - old DRC	
+		if(sd.photActRadiationMean > 0 && sd.astronomicDayLength > 0)
+			sd.clearDayRadiation = 0.5 * 1300.0 * sd.photActRadiationMean * exp(-0.14 / (sd.photActRadiationMean
+																																									 / (sd.astronomicDayLength * 3600.0)));
+		else
+			sd.clearDayRadiation = 0;
+
+		// Calculation of radiation on an overcast day [J m-2] - old DRO
+		sd.overcastDayRadiation = 0.2 * sd.clearDayRadiation;
+
+		// Calculation of extraterrestrial radiation - old EXT
+		double pc_SolarConstant = 0.082; //[MJ m-2 d-1] Note: Here is the difference to HERMES, which calculates in [J cm-2 d-1]!
+		double SC = 24.0 * 60.0 / PI * pc_SolarConstant *(1.0 + 0.033 * cos(2.0 * PI * julianDay / 365.0));
+
+		double arg_SolarAngle = -tan(latitude * PI / 180.0) * tan(sd.declination * PI / 180.0);
+		arg_SolarAngle = bound(-1.0, arg_SolarAngle, 1.0);
+		double vc_SunsetSolarAngle = acos(arg_SolarAngle);
+		sd.extraterrestrialRadiation = SC * (vc_SunsetSolarAngle * sd.declinationSinus + sd.declinationCosinus * sin(vc_SunsetSolarAngle)); // [MJ m-2]
+
+		for(int h = 0; h < 24; h++)
+		{
+			sd.solarElevation[h] = solarElevation(h, latitude, julianDay);
+			sd.hourlyExtraterrestrialRadiation[h] = hourlyRad(sd.extraterrestrialRadiation, latitude, julianDay, h);
+			if(h > 0 && sd.hourlyExtraterrestrialRadiation[h] > 0 && sd.hourlyExtraterrestrialRadiation[h - 1] == 0.0)
+				sd.sunriseHour = h;
+		}
+
+		return sd;
+	}
+}
+
+SolarGeometry::SolarGeometry(double latitude)
+	: _latitude(latitude)
+{
+	_days.reserve(366);
+	for(int jd = 1; jd <= 366; jd++)
+		_days.push_back(calcSolarDay(latitude, jd));
+}
+
+const SolarDay& SolarGeometry::day(int julianDay) const
+{
+	return _days[bound(1, julianDay, 366) - 1];
+}
+
+shared_ptr<const SolarGeometry> Monica::solarGeometryFor(double latitude)
+{
+	// the tables are only kept as long as a run at the latitude is using them
+	static mutex lockable;
+	static map<double, weak_ptr<const SolarGeometry>> latitude2geometry;
+
+	lock_guard<mutex> lock(lockable);
+	auto sg = latitude2geometry[latitude].lock();
+	if(!sg)
+	{
+		for(auto it = latitude2geometry.begin(); it != latitude2geometry.end();)
+			it = it->second.expired() ? latitude2geometry.erase(it) : ++it;
+
+		sg = make_shared<SolarGeometry>(latitude);
+		latitude2geometry[latitude] = sg;
+	}
+	return sg;
+}
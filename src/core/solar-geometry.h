@@ -0,0 +1,78 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/*
+Authors:
+Claas Nendel <claas.nendel@zalf.de>
+Michael Berg <michael.berg@zalf.de>
+
+Maintainers:
+Currently maintained by the authors.
+
+This file is part of the MONICA model.
+Copyright (C) Leibniz Centre for Agricultural Landscape Research (ZALF)
+*/
+
+#ifndef _SOLAR_GEOMETRY_H
+#define _SOLAR_GEOMETRY_H
+
+/**
+ * @file solar-geometry.h
+ */
+
+#include <array>
+#include <vector>
+#include <memory>
+
+namespace Monica
+{
+	/**
+	 * @brief Astronomic terms of one day of the year at a given latitude.
+	 *
+	 * Day lengths and radiation terms follow the original HERMES formulation
+	 * used in CropGrowth::fc_Radiation.
+	 */
+	struct SolarDay
+	{
+		double declination{0.0}; //!< old DEC [°]
+		double declinationSinus{0.0}; //!< sin(declination) * sin(latitude), old SINLD []
+		double declinationCosinus{0.0}; //!< cos(declination) * cos(latitude), old COSLD []
+		double astronomicDayLength{0.0}; //!< old DL [h]
+		double effectiveDayLength{0.0}; //!< old DLE [h]
+		double photoperiodicDayLength{0.0}; //!< old DLP [h]
+		double photActRadiationMean{0.0}; //!< old RDN [J m-2]
+		double clearDayRadiation{0.0}; //!< old DRC [J m-2]
+		double overcastDayRadiation{0.0}; //!< old DRO [J m-2]
+		double extraterrestrialRadiation{0.0}; //!< old EXT [MJ m-2 d-1]
+		int sunriseHour{0}; //!< first hour with extraterrestrial radiation
+		std::array<double, 24> solarElevation; //!< [rad]
+		std::array<double, 24> hourlyExtraterrestrialRadiation; //!< [MJ m-2 h-1]
+	};
+
+	/**
+	 * @brief Solar geometry of all 366 days of the year (and their 24 hours) at one latitude.
+	 *
+	 * The latitude is fixed during a run, so the table is built once and
+	 * the daily and hourly paths only look the values up.
+	 */
+	class SolarGeometry
+	{
+	public:
+		SolarGeometry(double latitude);
+
+		double latitude() const { return _latitude; }
+
+		//! julian day 1 - 366
+		const SolarDay& day(int julianDay) const;
+
+	private:
+		double _latitude{0.0};
+		std::vector<SolarDay> _days;
+	};
+
+	//! get the (shared) solar geometry for a latitude, tables are reused by all runs at the same latitude
+	std::shared_ptr<const SolarGeometry> solarGeometryFor(double latitude);
+}
+
+#endif
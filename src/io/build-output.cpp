@@ -19,6 +19,9 @@ Copyright (C) Leibniz Centre for Agricultural Landscape Research (ZALF)
 #include <mutex>
 #include <numeric>
 #include <iterator>
+#include <type_traits>
+#include <cstdlib>
+#include <iostream>
 
 #include "build-output.h"
 
@@ -156,6 +159,32 @@ vector<OId> Monica::parseOutputIds(const J11Array& oidArray)
 		return def;
 	};
 
+	//parse a depth like "30cm" or "0.3m" into [m], returns -1 if the string isn't a depth
+	auto getDepth = [](J11Array arr, uint index) -> double
+	{
+		if(arr.size() > index && arr[index].is_string())
+		{
+			string ds = arr[index].string_value();
+			if(!ds.empty() && (isdigit(ds.front()) || ds.front() == '.'))
+			{
+				//strtod instead of stod, as something like "." or ".cm" mustn't throw
+				char* unitStart = nullptr;
+				double depth = strtod(ds.c_str(), &unitStart);
+				string unit = toUpper(string(unitStart));
+				if(unitStart != ds.c_str() && depth >= 0)
+				{
+					if(unit == "CM")
+						return depth / 100.0;
+					else if(unit == "M")
+						return depth;
+				}
+				cerr << "Error: invalid depth '" << ds << "' in output id " << Json(arr).dump()
+					<< ", expected e.g. \"30cm\" or \"0.3m\"." << endl;
+			}
+		}
+		return -1;
+	};
+
 	const auto& name2metadata = buildOutputTable().name2metadata;
 	for(Json idj : oidArray)
 	{
@@ -209,7 +238,7 @@ vector<OId> Monica::parseOutputIds(const J11Array& oidArray)
 							auto op = getAggregationOp(arr, 1);
 							if(op != OId::_UNDEFINED_OP_)
 								oid.timeAggOp = op;
-							else
+							else if((oid.fromDepth = getDepth(arr, 1)) < 0)
 								oid.organ = getOrgan(arr, 1, OId::_UNDEFINED_ORGAN_);
 						}
 						else if(val1.is_array())
@@ -221,7 +250,7 @@ vector<OId> Monica::parseOutputIds(const J11Array& oidArray)
 								auto val1_0 = arr2[0];
 								if(val1_0.is_number())
 									oid.fromLayer = val1_0.int_value() - 1;
-								else if(val1_0.is_string())
+								else if((oid.fromDepth = getDepth(arr2, 0)) < 0)
 									oid.organ = getOrgan(arr2, 0, OId::_UNDEFINED_ORGAN_);
 							}
 							if(arr2.size() >= 2)
@@ -229,7 +258,7 @@ vector<OId> Monica::parseOutputIds(const J11Array& oidArray)
 								auto val1_1 = arr2[1];
 								if(val1_1.is_number())
 									oid.toLayer = val1_1.int_value() - 1;
-								else if(val1_1.is_string())
+								else if(val1_1.is_string() && (oid.toDepth = getDepth(arr2, 1)) < 0)
 								{
 									oid.toLayer = oid.fromLayer;
 									oid.layerAggOp = getAggregationOp(arr2, 1, OId::AVG);
@@ -251,6 +280,38 @@ vector<OId> Monica::parseOutputIds(const J11Array& oidArray)
 	return outputIds;
 }
 
+void Monica::mapOutputDepthsToLayers(vector<OId>& oids, const SoilColumn& soilColumn)
+{
+	int nols = soilColumn.vs_NumberOfLayers();
+	for(auto& oid : oids)
+	{
+		if(oid.fromDepth >= 0)
+		{
+			int from = min(soilColumn.getLayerIndexAtDepth(oid.fromDepth), nols - 1);
+			//a single depth means just the layer at that depth
+			if(oid.toDepth < 0 && oid.toLayer == oid.fromLayer)
+				oid.toLayer = from;
+			oid.fromLayer = from;
+		}
+		//a depth on a layer boundary closes the range with the layer above
+		if(oid.toDepth >= 0)
+			oid.toLayer = max(oid.fromLayer, min(soilColumn.getLayerNumberForDepth(oid.toDepth), nols - 1));
+	}
+}
+
+int Monica::cropDiagnosticsFor(const vector<OId>& oids)
+{
+	const auto& name2metadata = buildOutputTable().name2metadata;
+	int groups = NO_CROP_DIAGNOSTICS;
+	for(const auto& oid : oids)
+	{
+		auto it = name2metadata.find(oid.name);
+		if(it != name2metadata.end())
+			groups |= it->second.cropDiagnostics;
+	}
+	return groups;
+}
+
 //-----------------------------------------------------------------------------
 
 template<typename T, typename Vector>
@@ -326,6 +387,40 @@ void setComplexValues(OId oid, function<void(int, json11::Json)> setValue, Json
 	}
 }
 
+namespace
+{
+	typedef decltype(BOTRes::setfs)::mapped_type SETF_T;
+
+	//! registers the output functions, outputs which are plain numbers are
+	//! additionally registered unboxed (BOTRes::dofs) for compiled expressions
+	struct OutputTableBuilder
+	{
+		BOTRes& m;
+
+		template<typename OF>
+		OutputMetadata operator()(OutputMetadata r, OF of, SETF_T setf = SETF_T())
+		{
+			typedef decltype(of(std::declval<const MonicaModel&>(), OId())) R;
+
+			m.ofs[r.id] = of;
+			addDoubleOutput(r.id, of, std::integral_constant<bool, std::is_arithmetic<R>::value && !std::is_same<R, bool>::value>());
+			if(setf)
+				m.setfs[r.id] = setf;
+			m.name2metadata[r.name] = r;
+			return r;
+		}
+
+		template<typename OF>
+		void addDoubleOutput(int id, OF of, std::true_type)
+		{
+			m.dofs[id] = [of](const MonicaModel& monica, OId oid){ return double(of(monica, oid)); };
+		}
+
+		template<typename OF>
+		void addDoubleOutput(int, OF, std::false_type) {}
+	};
+}
+
 BOTRes& Monica::buildOutputTable()
 {
 	static mutex lockable;
@@ -334,17 +429,7 @@ BOTRes& Monica::buildOutputTable()
 	static BOTRes m;
 	static bool tableBuilt = false;
 
-	typedef decltype(m.setfs)::mapped_type SETF_T;
-	auto build = [&](OutputMetadata r, 
-									 decltype(m.ofs)::mapped_type of,
-									 decltype(m.setfs)::mapped_type setf = SETF_T())
-	{
-		m.ofs[r.id] = of;
-		if(setf)
-			m.setfs[r.id] = setf;
-		m.name2metadata[r.name] = r;
-		return r;
-	};
+	OutputTableBuilder build{m};
 
 	// only initialize once
 	if(!tableBuilt)
@@ -1313,25 +1398,25 @@ BOTRes& Monica::buildOutputTable()
 				return getComplexValues<double>(oid, [&](int i) { return monica.soilColumn().at(i).vs_Saturation(); }, 4);
 			});
 
-			build({id++, "guenther-isoprene-emission", "umol m-2Ground d-1", "daily isoprene-emission of all species from Guenther model"},
+			build({id++, "guenther-isoprene-emission", "umol m-2Ground d-1", "daily isoprene-emission of all species from Guenther model", GUENTHER_VOC_EMISSIONS},
 						[](const MonicaModel& monica, OId oid)
 			{
 				return monica.cropGrowth() ? round(monica.cropGrowth()->guentherEmissions().isoprene_emission, 5) : 0.0;
 			});
 
-			build({id++, "guenther-monoterpene-emission", "umol m-2Ground d-1", "daily monoterpene emission of all species from Guenther model"},
+			build({id++, "guenther-monoterpene-emission", "umol m-2Ground d-1", "daily monoterpene emission of all species from Guenther model", GUENTHER_VOC_EMISSIONS},
 						[](const MonicaModel& monica, OId oid)
 			{
 				return monica.cropGrowth() ? round(monica.cropGrowth()->guentherEmissions().monoterpene_emission, 5) : 0.0;
 			});
 
-			build({id++, "jjv-isoprene-emission", "umol m-2Ground d-1", "daily isoprene-emission of all species from JJV model"},
+			build({id++, "jjv-isoprene-emission", "umol m-2Ground d-1", "daily isoprene-emission of all species from JJV model", JJV_VOC_EMISSIONS},
 						[](const MonicaModel& monica, OId oid)
 			{
 				return monica.cropGrowth() ? round(monica.cropGrowth()->jjvEmissions().isoprene_emission, 5) : 0.0;
 			});
 
-			build({id++, "jjv-monoterpene-emission", "umol m-2Ground d-1", "daily monoterpene emission of all species from JJV model"},
+			build({id++, "jjv-monoterpene-emission", "umol m-2Ground d-1", "daily monoterpene emission of all species from JJV model", JJV_VOC_EMISSIONS},
 						[](const MonicaModel& monica, OId oid)
 			{
 				return monica.cropGrowth() ? round(monica.cropGrowth()->jjvEmissions().monoterpene_emission, 5) : 0.0;
@@ -1515,4 +1600,215 @@ json11::Json Monica::applyPrimitiveCalcOp(std::function<double(double, double)>
 		return toPrimJsonArray(res);
 	}
 	return 0.0;
-}
\ No newline at end of file
+}
+//-----------------------------------------------------------------------------
+
+namespace
+{
+	bool opCodeFor(string ops, CompiledExpression::OpCode& opCode)
+	{
+		static const map<string, CompiledExpression::OpCode> ops2opCode = 
+		{{"+", CompiledExpression::ADD}
+		,{"-", CompiledExpression::SUB}
+		,{"*", CompiledExpression::MUL}
+		,{"/", CompiledExpression::DIV}
+		,{"<", CompiledExpression::LT}
+		,{"<=", CompiledExpression::LE}
+		,{"=", CompiledExpression::EQ}
+		,{"!=", CompiledExpression::NE}
+		,{">", CompiledExpression::GT}
+		,{">=", CompiledExpression::GE}
+		,{"AND", CompiledExpression::AND}
+		,{"OR", CompiledExpression::OR}
+		};
+
+		auto it = ops2opCode.find(toUpper(ops));
+		if(it == ops2opCode.end())
+			return false;
+		opCode = it->second;
+		return true;
+	}
+
+	bool isExpression(const Json& j)
+	{
+		CompiledExpression::OpCode opCode;
+		return j.is_array()
+			&& j.array_items().size() == 3
+			&& j[1].is_string()
+			&& opCodeFor(j[1].string_value(), opCode);
+	}
+
+	bool isCompareOp(CompiledExpression::OpCode opCode)
+	{
+		return CompiledExpression::LT <= opCode && opCode <= CompiledExpression::GE;
+	}
+
+	//! resolve a leaf of an expression to an output id (id < 0 if not possible)
+	OId outputIdFor(const Json& j)
+	{
+		if(j.is_string() || j.is_array())
+		{
+			auto oids = parseOutputIds({j});
+			if(!oids.empty())
+				return oids.front();
+		}
+		return OId();
+	}
+}
+
+vector<OId> Monica::outputIdsInExpression(const Json& j)
+{
+	vector<OId> oids;
+	if(isExpression(j))
+	{
+		for(auto side : {0, 2})
+			for(const auto& oid : outputIdsInExpression(j[side]))
+				oids.push_back(oid);
+	}
+	else
+	{
+		auto oid = outputIdFor(j);
+		if(oid.id >= 0)
+			oids.push_back(oid);
+	}
+	return oids;
+}
+
+CompiledExpression CompiledExpression::compile(const J11Array& a)
+{
+	CompiledExpression ce;
+
+	//keep the semantics of buildCompareExpression, which needed at least one output
+	//and a comparison (or now and/or) at the top
+	OpCode opCode;
+	if(a.size() != 3
+		 || (a[0].is_number() && a[2].is_number())
+		 || !a[1].is_string()
+		 || !opCodeFor(a[1].string_value(), opCode)
+		 || !(isCompareOp(opCode) || opCode == AND || opCode == OR))
+		return ce;
+
+	if(!ce.compileNode(Json(a), 0))
+		return CompiledExpression();
+
+	return ce;
+}
+
+bool CompiledExpression::compileOperand(const Json& j, size_t depth)
+{
+	if(depth >= MaxStackDepth)
+		return false;
+
+	if(j.is_number())
+	{
+		_program.push_back({CONST, j.number_value(), 0});
+		return true;
+	}
+	else if(isExpression(j))
+		return compileNode(j, depth);
+
+	auto oid = outputIdFor(j);
+	const auto& dofs = buildOutputTable().dofs;
+	auto dofi = dofs.find(oid.id);
+	if(dofi == dofs.end())
+		return false;
+
+	_program.push_back({OUTPUT, 0.0, _outputs.size()});
+	_outputs.push_back(make_pair(dofi->second, oid));
+	return true;
+}
+
+bool CompiledExpression::compileNode(const Json& j, size_t depth)
+{
+	if(!isExpression(j) || depth + 2 > MaxStackDepth)
+		return false;
+
+	OpCode opCode;
+	opCodeFor(j[1].string_value(), opCode);
+
+	auto programSize = _program.size();
+	auto noOfOutputs = _outputs.size();
+	if(compileOperand(j[0], depth) && compileOperand(j[2], depth + 1))
+	{
+		_program.push_back({opCode, 0.0, 0});
+		return true;
+	}
+	_program.resize(programSize);
+	_outputs.resize(noOfOutputs);
+
+	//comparisons of non numeric outputs (e.g. arrays of layer values) are done on the Json values
+	if(!isCompareOp(opCode) || isExpression(j[0]) || isExpression(j[2]))
+		return false;
+
+	JsonComparison jc;
+	jc.op = getCompareOp(j[1].string_value());
+	const auto& ofs = buildOutputTable().ofs;
+	for(auto side : {0, 2})
+	{
+		auto& f = side == 0 ? jc.lf : jc.rf;
+		auto& oid = side == 0 ? jc.loid : jc.roid;
+		(side == 0 ? jc.leftj : jc.rightj) = j[side];
+		if(j[side].is_number())
+			continue;
+		oid = outputIdFor(j[side]);
+		auto ofi = ofs.find(oid.id);
+		if(ofi == ofs.end())
+			return false;
+		f = ofi->second;
+	}
+
+	_program.push_back({JSON_COMPARE, 0.0, _jsonComparisons.size()});
+	_jsonComparisons.push_back(jc);
+	return true;
+}
+
+double CompiledExpression::evaluate(const MonicaModel& monica) const
+{
+	double stack[MaxStackDepth];
+	size_t top = 0;
+
+	for(const auto& i : _program)
+	{
+		switch(i.op)
+		{
+		case CONST: stack[top++] = i.value; break;
+		case OUTPUT:
+		{
+			const auto& o = _outputs[i.index];
+			stack[top++] = o.first(monica, o.second);
+			break;
+		}
+		case JSON_COMPARE:
+		{
+			const auto& jc = _jsonComparisons[i.index];
+			stack[top++] = applyCompareOp(jc.op,
+																		jc.lf ? jc.lf(monica, jc.loid) : jc.leftj,
+																		jc.rf ? jc.rf(monica, jc.roid) : jc.rightj) ? 1.0 : 0.0;
+			break;
+		}
+		default:
+		{
+			double r = stack[--top];
+			double& l = stack[top - 1];
+			switch(i.op)
+			{
+			case ADD: l = l + r; break;
+			case SUB: l = l - r; break;
+			case MUL: l = l * r; break;
+			case DIV: l = l / r; break;
+			case LT: l = l < r ? 1.0 : 0.0; break;
+			case LE: l = l <= r ? 1.0 : 0.0; break;
+			case EQ: l = l == r ? 1.0 : 0.0; break;
+			case NE: l = l != r ? 1.0 : 0.0; break;
+			case GT: l = l > r ? 1.0 : 0.0; break;
+			case GE: l = l >= r ? 1.0 : 0.0; break;
+			case AND: l = l != 0.0 && r != 0.0 ? 1.0 : 0.0; break;
+			case OR: l = l != 0.0 || r != 0.0 ? 1.0 : 0.0; break;
+			default: break;
+			}
+		}
+		}
+	}
+
+	return top > 0 ? stack[top - 1] : 0.0;
+}
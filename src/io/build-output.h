@@ -38,6 +38,7 @@ namespace Monica
 		std::string name;
 		std::string unit;
 		std::string description;
+		int cropDiagnostics; //!< the CropDiagnostics groups this output depends on
 	};
 
 	//---------------------------------------------------------------------------
@@ -48,9 +49,21 @@ namespace Monica
 
 	DLL_API std::vector<OId> parseOutputIds(const Tools::J11Array& oidArray);
 
+	//! map layer ranges given as depths (e.g. ["Mois", ["0cm", "30cm", "AVG"]])
+	//! to the layers of the given soil column
+	DLL_API void mapOutputDepthsToLayers(std::vector<OId>& oids, const SoilColumn& soilColumn);
+
+	//! the CropDiagnostics groups the given outputs depend on
+	DLL_API int cropDiagnosticsFor(const std::vector<OId>& oids);
+
+	//! the outputs an expression like ["LAI", ">", ["Stage", "*", 2]] or a single output id refers to
+	DLL_API std::vector<OId> outputIdsInExpression(const json11::Json& j);
+
 	struct DLL_API BOTRes
 	{
 		std::map<int, std::function<json11::Json(const MonicaModel&, OId)>> ofs;
+		//! the outputs which are plain numbers, without boxing them into Json
+		std::map<int, std::function<double(const MonicaModel&, OId)>> dofs;
 		std::map<int, std::function<void(MonicaModel&, OId, json11::Json)>> setfs;
 		std::map<std::string, OutputMetadata> name2metadata;
 	};
@@ -134,8 +147,61 @@ namespace Monica
 		return std::function<APPLY_RT(const Monica::MonicaModel&)>();
 	}
 
+	//! an output expression compiled into a flat (postfix) program
+	//! e.g. ["LAI", ">", 3] or [["LAI", ">", [["Stage", "*", 2], "-", 1]], "and", ["Tmin", ">=", 5]]
+	//! numeric outputs are read unboxed, other outputs are compared like applyCompareOp does
+	class DLL_API CompiledExpression
+	{
+	public:
+		enum OpCode
+		{
+			CONST, OUTPUT, JSON_COMPARE,
+			ADD, SUB, MUL, DIV,
+			LT, LE, EQ, NE, GT, GE,
+			AND, OR
+		};
+
+		static const std::size_t MaxStackDepth = 16;
+
+		bool isValid() const { return !_program.empty(); }
+
+		//! evaluate the expression, comparisons and and/or yield 1 or 0
+		double evaluate(const MonicaModel& monica) const;
+
+		bool test(const MonicaModel& monica) const { return evaluate(monica) != 0.0; }
+
+		//! compile the array [lhs, op, rhs], returns an invalid expression if not possible
+		static CompiledExpression compile(const Tools::J11Array& a);
+
+	private:
+		struct Instruction
+		{
+			OpCode op;
+			double value; //!< CONST
+			std::size_t index; //!< OUTPUT or JSON_COMPARE
+		};
+
+		struct JsonComparison
+		{
+			std::function<bool(double, double)> op;
+			std::function<json11::Json(const MonicaModel&, OId)> lf, rf;
+			OId loid, roid;
+			json11::Json leftj, rightj;
+		};
+
+		bool compileNode(const json11::Json& j, std::size_t depth);
+		bool compileOperand(const json11::Json& j, std::size_t depth);
+
+		std::vector<Instruction> _program;
+		std::vector<std::pair<std::function<double(const MonicaModel&, OId)>, OId>> _outputs;
+		std::vector<JsonComparison> _jsonComparisons;
+	};
+
 	inline std::function<bool(const Monica::MonicaModel&)> buildCompareExpression(Tools::J11Array a)
 	{
+		auto ce = CompiledExpression::compile(a);
+		if(ce.isValid())
+			return [ce](const Monica::MonicaModel& m){ return ce.test(m); };
 		return buildExpression<bool, bool>(a, getCompareOp, applyCompareOp);
 	}
 
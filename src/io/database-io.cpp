@@ -16,9 +16,28 @@ Copyright (C) Leibniz Centre for Agricultural Landscape Research (ZALF)
 */
 
 #include <iostream>
+#include <fstream>
+#include <cstdlib>
 #include <mutex>
 #include <memory>
 #include <tuple>
+#include <set>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+#ifdef WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 #include "tools/debug.h"
 #include "db/abstract-db-connections.h"
@@ -202,200 +221,911 @@ namespace
 	}
 }
 
-SpeciesParametersPtr Monica::getSpeciesParametersFromMonicaDB(const string& species,
-                                                              std::string abstractDbSchema)
+//------------------------------------------------------------------------------
+
+namespace
 {
-	SpeciesParametersPtr sps = make_shared<SpeciesParameters>();
+	//! read-mostly cache for parameters loaded on demand from the database
+	//! readers look up keys in the current immutable snapshot without taking a lock,
+	//! writers publish a new snapshot extended by the freshly loaded entries,
+	//! so parallel runs never wait on each other once their parameters are cached
+	template<typename Key, typename Value>
+	class SnapshotCache
+	{
+	public:
+		typedef map<Key, Value> Map;
 
-	DBPtr con(newConnection(abstractDbSchema));
-	DBRow row;
-	con->select(speciesSelect(species));
-	debug() << speciesSelect(species) << endl;
-	if(!(row = con->getRow()).empty())
+		SnapshotCache() : _snapshot(make_shared<const Map>()) {}
+
+		bool find(const Key& key, Value& value) const
+		{
+			auto snapshot = atomic_load(&_snapshot);
+			auto ci = snapshot->find(key);
+			if(ci == snapshot->end())
+				return false;
+			value = ci->second;
+			return true;
+		}
+
+		bool contains(const Key& key) const
+		{
+			auto snapshot = atomic_load(&_snapshot);
+			return snapshot->find(key) != snapshot->end();
+		}
+
+		//! entries loaded concurrently by another thread in the meantime are kept
+		void insert(const Map& entries)
+		{
+			if(entries.empty())
+				return;
+
+			lock_guard<mutex> lock(_lockable);
+			auto next = make_shared<Map>(*atomic_load(&_snapshot));
+			next->insert(entries.begin(), entries.end());
+			atomic_store(&_snapshot, shared_ptr<const Map>(next));
+		}
+
+		void insert(const Key& key, const Value& value) { insert(Map{{key, value}}); }
+
+	private:
+		shared_ptr<const Map> _snapshot;
+		mutex _lockable;
+	};
+}
+
+//------------------------------------------------------------------------------
+
+namespace
+{
+	const uint32_t ParameterBundleVersion = 3;
+
+	/*!
+	 * Binary layout of a parameter bundle.
+	 *
+	 * The file starts with a BundleHeader and the table of its sections (BundleSection),
+	 * each section starts 8 byte aligned. Numbers are stored in the byte order of the
+	 * writing machine, which is checked via byteOrderMark when opening a bundle.
+	 * Strings are (offset, length) references into the "strings" section.
+	 *
+	 * Sections:
+	 * "meta" ... one BundleString, the abstract database schema the bundle has been written from
+	 * "crops" ... BundleCrop per crop id
+	 * "capillaryRiseRates" ... BundleCapillaryRiseRates per soil texture, sorted by soil texture
+	 * "index" ... BundleRecord per parameter set, sorted by section and key,
+	 *             keys of nested sections (cultivars, crop residues) are "species|name"
+	 * "arrays" ... the numeric arrays of the records (BundleArray), their values are in "values"
+	 * "json" ... a JSON object per record with all other members of the parameter set
+	 *
+	 * Opening a bundle maps the file into memory and reads just the crop ids, the rest is
+	 * used in place: a parameter set is looked up in the index, its JSON part parsed and its
+	 * arrays copied on its first request, the result is cached afterwards.
+	 */
+	struct BundleHeader
 	{
-		int i = 0;
+		char magic[8];
+		uint32_t version;
+		uint32_t byteOrderMark;
+		uint32_t noOfSections;
+		uint32_t reserved;
+	};
 
-		sps->pc_SpeciesId = row[i++];
-		sps->pc_CarboxylationPathway = stoi(row[i++]);
-		sps->pc_MinimumTemperatureForAssimilation = stof(row[i++]);
-		sps->pc_MinimumNConcentration = stof(row[i++]);
-		sps->pc_NConcentrationPN = stof(row[i++]);
-		sps->pc_NConcentrationB0 = stof(row[i++]);
-		sps->pc_NConcentrationAbovegroundBiomass = stof(row[i++]);
-		sps->pc_NConcentrationRoot = stof(row[i++]);
-		sps->pc_InitialKcFactor = stof(row[i++]);
-		sps->pc_DevelopmentAccelerationByNitrogenStress = stoi(row[i++]);
-		sps->pc_PartBiologicalNFixation = stof(row[i++]);
-		sps->pc_LuxuryNCoeff = stof(row[i++]);
-		sps->pc_SamplingDepth = stof(row[i++]);
-		sps->pc_TargetNSamplingDepth = stof(row[i++]);
-		sps->pc_TargetN30 = stof(row[i++]);
-		sps->pc_DefaultRadiationUseEfficiency = stof(row[i++]);
-		sps->pc_StageAtMaxHeight = stof(row[i++]);
-		sps->pc_MaxCropDiameter = stof(row[i++]);
-		sps->pc_StageAtMaxDiameter = stof(row[i++]);
-		sps->pc_MaxNUptakeParam = stof(row[i++]);
-		sps->pc_RootDistributionParam = stof(row[i++]);
-		sps->pc_PlantDensity = (int)stof(row[i++]);
-		sps->pc_RootGrowthLag = stof(row[i++]);
-		sps->pc_MinimumTemperatureRootGrowth = stof(row[i++]);
-		sps->pc_InitialRootingDepth = stof(row[i++]);
-		sps->pc_RootPenetrationRate = stof(row[i++]);
-		sps->pc_RootFormFactor = stof(row[i++]);
-		sps->pc_SpecificRootLength = stof(row[i++]);
-		sps->pc_StageAfterCut = stoi(row[i++]);
-		sps->pc_LimitingTemperatureHeatStress = stof(row[i++]);
-		sps->pc_DroughtImpactOnFertilityFactor = stof(row[i++]);
-		sps->pc_CuttingDelayDays = stoi(row[i++]);
-		sps->pc_FieldConditionModifier = stof(row[i++]);
-		sps->pc_AssimilateReallocation = stof(row[i++]);
-	}
-
-	con->select(organSelect(species));
-	debug() << organSelect(species) << endl;
-	while(!(row = con->getRow()).empty())
+	const char BundleMagic[8] = {'M', 'O', 'N', 'I', 'C', 'A', 'P', 'B'};
+	const uint32_t BundleByteOrderMark = 0x01020304;
+
+	struct BundleSection
+	{
+		char name[24];
+		uint64_t offset;
+		uint64_t size;
+	};
+
+	struct BundleString
+	{
+		uint32_t offset;
+		uint32_t length;
+	};
+
+	struct BundleCrop
+	{
+		int32_t id;
+		BundleString species;
+		BundleString cultivar;
+	};
+
+	struct BundleCapillaryRiseRates
+	{
+		BundleString soilTexture;
+		//! for groundwater distances 1 .. maxDistance [dm]
+		double rates[CapillaryRiseRates::maxDistance];
+	};
+
+	struct BundleRecord
+	{
+		BundleString section;
+		BundleString key;
+		uint64_t jsonOffset;
+		uint64_t jsonSize;
+		uint64_t firstArray;
+		uint64_t noOfArrays;
+	};
+
+	//! row of a BundleArray holding a vector and not a row of a matrix
+	const uint32_t NoRow = 0xFFFFFFFF;
+
+	struct BundleArray
+	{
+		BundleString name;
+		uint32_t row;
+		uint32_t size;
+		uint64_t firstValue;
+	};
+
+	//! the numeric vector and matrix members of species and cultivar parameters, stored as arrays,
+	//! by their JSON names
+	const map<string, vector<double> SpeciesParameters::*>& speciesArrays()
 	{
-		sps->pc_InitialOrganBiomass.push_back(stod(row[2]));
-		sps->pc_OrganMaintenanceRespiration.push_back(stod(row[3]));
-		sps->pc_AbovegroundOrgan.push_back(stob(row[4]));
-		sps->pc_OrganGrowthRespiration.push_back(stod(row[5]));
-		sps->pc_StorageOrgan.push_back(stob(row[6]));
+		static const map<string, vector<double> SpeciesParameters::*> m =
+		{{"BaseTemperature", &SpeciesParameters::pc_BaseTemperature}
+		,{"OrganMaintenanceRespiration", &SpeciesParameters::pc_OrganMaintenanceRespiration}
+		,{"OrganGrowthRespiration", &SpeciesParameters::pc_OrganGrowthRespiration}
+		,{"StageMaxRootNConcentration", &SpeciesParameters::pc_StageMaxRootNConcentration}
+		,{"InitialOrganBiomass", &SpeciesParameters::pc_InitialOrganBiomass}
+		,{"CriticalOxygenContent", &SpeciesParameters::pc_CriticalOxygenContent}
+		};
+		return m;
 	}
 
-	con->select(devStageSpeciesSelect(species));
-	debug() << devStageSpeciesSelect(species) << endl;
+	const map<string, vector<double> CultivarParameters::*>& cultivarArrays()
+	{
+		static const map<string, vector<double> CultivarParameters::*> m =
+		{{"BaseDaylength", &CultivarParameters::pc_BaseDaylength}
+		,{"OptimumTemperature", &CultivarParameters::pc_OptimumTemperature}
+		,{"DaylengthRequirement", &CultivarParameters::pc_DaylengthRequirement}
+		,{"DroughtStressThreshold", &CultivarParameters::pc_DroughtStressThreshold}
+		,{"SpecificLeafArea", &CultivarParameters::pc_SpecificLeafArea}
+		,{"StageKcFactor", &CultivarParameters::pc_StageKcFactor}
+		,{"StageTemperatureSum", &CultivarParameters::pc_StageTemperatureSum}
+		,{"VernalisationRequirement", &CultivarParameters::pc_VernalisationRequirement}
+		};
+		return m;
+	}
 
-	while(!(row = con->getRow()).empty())
+	const map<string, vector<vector<double>> CultivarParameters::*>& cultivarMatrices()
 	{
-		sps->pc_BaseTemperature.push_back(stod(row[2]));
-		sps->pc_CriticalOxygenContent.push_back(stod(row[3]));
-		sps->pc_StageMaxRootNConcentration.push_back(stod(row[4]));
+		static const map<string, vector<vector<double>> CultivarParameters::*> m =
+		{{"AssimilatePartitioningCoeff", &CultivarParameters::pc_AssimilatePartitioningCoeff}
+		,{"OrganSenescenceRate", &CultivarParameters::pc_OrganSenescenceRate}
+		};
+		return m;
 	}
 
-	return sps;
+	//! the "strings" section of a bundle
+	struct BundleStrings
+	{
+		const char* data{nullptr};
+		size_t size{0};
+
+		bool valid(const BundleString& s) const { return size_t(s.offset) + s.length <= size; }
+
+		string operator()(const BundleString& s) const
+		{
+			return valid(s) ? string(data + s.offset, s.length) : string();
+		}
+
+		//! like string::compare
+		int compare(const BundleString& s, const string& other) const
+		{
+			size_t length = valid(s) ? s.length : 0;
+			int c = memcmp(data + s.offset, other.data(), min(length, other.size()));
+			return c != 0 ? c : length < other.size() ? -1 : length > other.size() ? 1 : 0;
+		}
+	};
+
+	//! a file mapped read-only into memory
+	class MappedFile
+	{
+	public:
+		MappedFile() {}
+		~MappedFile() { close(); }
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		bool open(const string& path)
+		{
+			close();
+#ifdef WIN32
+			_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+			                    FILE_ATTRIBUTE_NORMAL, nullptr);
+			LARGE_INTEGER size;
+			if(_file == INVALID_HANDLE_VALUE || !GetFileSizeEx(_file, &size) || size.QuadPart == 0)
+				return close(), false;
+			_mapping = CreateFileMappingA(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if(!_mapping)
+				return close(), false;
+			_data = static_cast<const char*>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+			_size = size_t(size.QuadPart);
+#else
+			_fd = ::open(path.c_str(), O_RDONLY);
+			struct stat st;
+			if(_fd < 0 || fstat(_fd, &st) != 0 || st.st_size == 0)
+				return close(), false;
+			void* p = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_SHARED, _fd, 0);
+			if(p == MAP_FAILED)
+				return close(), false;
+			_data = static_cast<const char*>(p);
+			_size = size_t(st.st_size);
+#endif
+			return _data != nullptr;
+		}
+
+		void close()
+		{
+#ifdef WIN32
+			if(_data)
+				UnmapViewOfFile(_data);
+			if(_mapping)
+				CloseHandle(_mapping);
+			if(_file != INVALID_HANDLE_VALUE)
+				CloseHandle(_file);
+			_mapping = nullptr;
+			_file = INVALID_HANDLE_VALUE;
+#else
+			if(_data)
+				munmap(const_cast<char*>(_data), _size);
+			if(_fd >= 0)
+				::close(_fd);
+			_fd = -1;
+#endif
+			_data = nullptr;
+			_size = 0;
+		}
+
+		const char* data() const { return _data; }
+		size_t size() const { return _size; }
+
+	private:
+#ifdef WIN32
+		HANDLE _file{INVALID_HANDLE_VALUE};
+		HANDLE _mapping{nullptr};
+#else
+		int _fd{-1};
+#endif
+		const char* _data{nullptr};
+		size_t _size{0};
+	};
+
+	/*!
+	 * Parameter sets of one monica database, as read from a parameter bundle
+	 * (see BundleHeader for its layout).
+	 */
+	class ParameterBundle
+	{
+	public:
+		Errors open(const string& pathToBundle);
+
+		string abstractDbSchema;
+		map<int, pair<string, string>> crops;
+		function<double(string, int)> getCapillaryRiseRate;
+		shared_ptr<CapillaryRiseRates> capillaryRiseRates;
+
+		SpeciesParametersPtr species(const string& species) const
+		{
+			return cached(_species, "species", species);
+		}
+
+		CultivarParametersPtr cultivar(const string& species, const string& cultivar) const
+		{
+			return cached(_cultivars, "cultivars", species + "|" + cultivar);
+		}
+
+		shared_ptr<MineralFertiliserParameters> mineralFertiliser(const string& id) const
+		{
+			return cached(_mineralFertilisers, "mineralFertilisers", id);
+		}
+
+		OrganicFertiliserParametersPtr organicFertiliser(const string& id) const
+		{
+			return cached(_organicFertilisers, "organicFertilisers", id);
+		}
+
+		//! falls back to the species' default residue parameters, stored under the empty residue type
+		CropResidueParametersPtr cropResidue(const string& species, const string& residueType) const
+		{
+			auto crp = cached(_cropResidues, "cropResidues", species + "|" + residueType);
+			return crp || residueType.empty() ? crp : cached(_cropResidues, "cropResidues", species + "|");
+		}
+
+		shared_ptr<const CentralParameterProvider> userParameters(const string& type) const;
+
+	private:
+		//! the record of key in section, nullptr if there is none
+		const BundleRecord* find(const string& section, const string& key) const;
+
+		//! the JSON part of a record
+		json11::Json json(const BundleRecord& r) const;
+
+		//! f(name, row, first value, number of values) for each array of the record
+		void forEachArray(const BundleRecord& r,
+		                  const function<void(const string&, uint32_t, const double*, size_t)>& f) const;
+
+		void setArrays(const BundleRecord& r, SpeciesParameters& sps) const;
+		void setArrays(const BundleRecord& r, CultivarParameters& cps) const;
+		template<typename T>
+		void setArrays(const BundleRecord&, T&) const {}
+
+		template<typename Ptr>
+		Ptr cached(SnapshotCache<string, Ptr>& cache, const string& section, const string& key) const
+		{
+			Ptr p;
+			if(cache.find(key, p))
+				return p;
+
+			if(auto r = find(section, key))
+			{
+				p = make_shared<typename Ptr::element_type>();
+				auto res = p->merge(json(*r));
+				for(auto e : res.errors)
+					cerr << e << endl;
+				setArrays(*r, *p);
+			}
+			cache.insert(key, p);
+			return p;
+		}
+
+		string _pathToBundle;
+		shared_ptr<MappedFile> _file;
+		BundleStrings _strings;
+		const BundleRecord* _index{nullptr};
+		size_t _noOfRecords{0};
+		const BundleArray* _arrays{nullptr};
+		size_t _noOfArrays{0};
+		const double* _values{nullptr};
+		size_t _noOfValues{0};
+		const char* _json{nullptr};
+		size_t _jsonSize{0};
+
+		mutable SnapshotCache<string, SpeciesParametersPtr> _species;
+		mutable SnapshotCache<string, CultivarParametersPtr> _cultivars;
+		mutable SnapshotCache<string, shared_ptr<MineralFertiliserParameters>> _mineralFertilisers;
+		mutable SnapshotCache<string, OrganicFertiliserParametersPtr> _organicFertilisers;
+		mutable SnapshotCache<string, CropResidueParametersPtr> _cropResidues;
+		mutable SnapshotCache<string, shared_ptr<const CentralParameterProvider>> _userParameters;
+	};
+	typedef shared_ptr<const ParameterBundle> ParameterBundlePtr;
+
+	Errors ParameterBundle::open(const string& pathToBundle)
+	{
+		Errors res;
+
+		auto file = make_shared<MappedFile>();
+		if(!file->open(pathToBundle))
+		{
+			res.errors.push_back(string("Couldn't read parameter bundle '") + pathToBundle + "'.");
+			return res;
+		}
+		const char* data = file->data();
+		const size_t size = file->size();
+
+		BundleHeader header;
+		if(size < sizeof(BundleHeader)
+		   || (memcpy(&header, data, sizeof(BundleHeader)), memcmp(header.magic, BundleMagic, sizeof(BundleMagic)) != 0))
+		{
+			res.errors.push_back(string("File '") + pathToBundle + "' is not a MONICA parameter bundle"
+			                     + (data[0] == '{' ? " (or one of version 2 or older). Please rewrite the bundle." : "."));
+			return res;
+		}
+
+		if(header.byteOrderMark != BundleByteOrderMark)
+		{
+			res.errors.push_back(string("Parameter bundle '") + pathToBundle
+			                     + "' has been written with a different byte order. Please rewrite the bundle.");
+			return res;
+		}
+
+		if(header.version != ParameterBundleVersion)
+		{
+			res.errors.push_back(string("Parameter bundle '") + pathToBundle + "' has version "
+			                     + to_string(header.version) + ", but version "
+			                     + to_string(ParameterBundleVersion) + " is required. Please rewrite the bundle.");
+			return res;
+		}
+
+		//the sections, checked to lie within the file and to hold whole elements
+		map<string, pair<const char*, size_t>> sections;
+		bool corrupt = sizeof(BundleHeader) + uint64_t(header.noOfSections) * sizeof(BundleSection) > size;
+		for(uint32_t i = 0; !corrupt && i < header.noOfSections; i++)
+		{
+			const auto& s = reinterpret_cast<const BundleSection*>(data + sizeof(BundleHeader))[i];
+			corrupt = s.offset % 8 != 0 || s.offset > size || s.size > size - s.offset;
+			sections[string(s.name, strnlen(s.name, sizeof(s.name)))] = make_pair(data + s.offset, size_t(s.size));
+		}
+		auto section = [&](const string& name, size_t elementSize, size_t& count) -> const char*
+		{
+			auto ci = sections.find(name);
+			if(ci == sections.end() || ci->second.second % elementSize != 0)
+				return corrupt = true, nullptr;
+			count = ci->second.second / elementSize;
+			return ci->second.first;
+		};
+
+		size_t noOfMeta = 0, noOfCrops = 0, noOfRates = 0;
+		_strings.data = section("strings", 1, _strings.size);
+		auto meta = reinterpret_cast<const BundleString*>(section("meta", sizeof(BundleString), noOfMeta));
+		auto bcrops = reinterpret_cast<const BundleCrop*>(section("crops", sizeof(BundleCrop), noOfCrops));
+		auto rates = reinterpret_cast<const BundleCapillaryRiseRates*>(section("capillaryRiseRates",
+		                                                                       sizeof(BundleCapillaryRiseRates),
+		                                                                       noOfRates));
+		_index = reinterpret_cast<const BundleRecord*>(section("index", sizeof(BundleRecord), _noOfRecords));
+		_arrays = reinterpret_cast<const BundleArray*>(section("arrays", sizeof(BundleArray), _noOfArrays));
+		_values = reinterpret_cast<const double*>(section("values", sizeof(double), _noOfValues));
+		_json = section("json", 1, _jsonSize);
+		if(corrupt || noOfMeta != 1)
+		{
+			res.errors.push_back(string("Parameter bundle '") + pathToBundle + "' is corrupt. Please rewrite the bundle.");
+			return res;
+		}
+
+		_pathToBundle = pathToBundle;
+		_file = file;
+		abstractDbSchema = _strings(meta[0]);
+
+		for(size_t i = 0; i < noOfCrops; i++)
+			crops[bcrops[i].id] = make_pair(_strings(bcrops[i].species), _strings(bcrops[i].cultivar));
+
+		//the rates are used in place, so they keep the file mapped, but not the bundle alive
+		auto strings = _strings;
+		getCapillaryRiseRate = [file, strings, rates, noOfRates](string soilTexture, int distance)
+		{
+			auto end = rates + noOfRates;
+			auto ci = lower_bound(rates, end, soilTexture, [&](const BundleCapillaryRiseRates& r, const string& st)
+			{
+				return strings.compare(r.soilTexture, st) < 0;
+			});
+			return ci != end && strings.compare(ci->soilTexture, soilTexture) == 0
+			       && distance >= 1 && distance <= CapillaryRiseRates::maxDistance
+				? ci->rates[distance - 1]
+				: 0.0;
+		};
+		capillaryRiseRates = make_shared<CapillaryRiseRates>(getCapillaryRiseRate);
+
+		return res;
+	}
+
+	const BundleRecord* ParameterBundle::find(const string& section, const string& key) const
+	{
+		auto end = _index + _noOfRecords;
+		auto ci = lower_bound(_index, end, make_pair(&section, &key),
+		                      [this](const BundleRecord& r, const pair<const string*, const string*>& sk)
+		{
+			int c = _strings.compare(r.section, *sk.first);
+			return c < 0 || (c == 0 && _strings.compare(r.key, *sk.second) < 0);
+		});
+		return ci != end && _strings.compare(ci->section, section) == 0 && _strings.compare(ci->key, key) == 0
+			? ci
+			: nullptr;
+	}
+
+	json11::Json ParameterBundle::json(const BundleRecord& r) const
+	{
+		if(r.jsonOffset > _jsonSize || r.jsonSize > _jsonSize - r.jsonOffset)
+		{
+			cerr << "Error couldn't read " << _strings(r.section) << " '" << _strings(r.key) << "' from parameter bundle '"
+				<< _pathToBundle << "'." << endl;
+			return json11::Json();
+		}
+
+		string err;
+		auto j = json11::Json::parse(string(_json + r.jsonOffset, size_t(r.jsonSize)), err);
+		if(!err.empty())
+			cerr << "Error couldn't parse " << _strings(r.section) << " '" << _strings(r.key) << "' from parameter bundle '"
+			<< _pathToBundle << "': " << err << endl;
+		return j;
+	}
+
+	void ParameterBundle::forEachArray(const BundleRecord& r,
+	                                   const function<void(const string&, uint32_t, const double*, size_t)>& f) const
+	{
+		for(uint64_t i = r.firstArray; i < r.firstArray + r.noOfArrays && i < _noOfArrays; i++)
+		{
+			const auto& a = _arrays[i];
+			if(a.firstValue <= _noOfValues && a.size <= _noOfValues - a.firstValue)
+				f(_strings(a.name), a.row, _values + a.firstValue, a.size);
+		}
+	}
+
+	void ParameterBundle::setArrays(const BundleRecord& r, SpeciesParameters& sps) const
+	{
+		forEachArray(r, [&](const string& name, uint32_t row, const double* first, size_t size)
+		{
+			auto ci = speciesArrays().find(name);
+			if(ci != speciesArrays().end() && row == NoRow)
+				(sps.*(ci->second)).assign(first, first + size);
+		});
+	}
+
+	void ParameterBundle::setArrays(const BundleRecord& r, CultivarParameters& cps) const
+	{
+		forEachArray(r, [&](const string& name, uint32_t row, const double* first, size_t size)
+		{
+			auto ci = cultivarArrays().find(name);
+			if(ci != cultivarArrays().end() && row == NoRow)
+				(cps.*(ci->second)).assign(first, first + size);
+
+			auto ci2 = cultivarMatrices().find(name);
+			if(ci2 != cultivarMatrices().end() && row != NoRow)
+			{
+				auto& m = cps.*(ci2->second);
+				if(m.size() <= row)
+					m.resize(row + 1);
+				m[row].assign(first, first + size);
+			}
+		});
+	}
+
+	shared_ptr<const CentralParameterProvider> ParameterBundle::userParameters(const string& type) const
+	{
+		shared_ptr<const CentralParameterProvider> cpp;
+		if(_userParameters.find(type, cpp))
+			return cpp;
+
+		auto r = find("userParameters", type);
+		auto uj = r ? json(*r) : json11::Json();
+		if(!uj.is_null())
+		{
+			auto p = make_shared<CentralParameterProvider>();
+			Errors res;
+			res.append(p->userCropParameters.merge(uj["crop"]));
+			res.append(p->userEnvironmentParameters.merge(uj["environment"]));
+			res.append(p->userSoilMoistureParameters.merge(uj["soilMoisture"]));
+			res.append(p->userSoilTemperatureParameters.merge(uj["soilTemperature"]));
+			res.append(p->userSoilTransportParameters.merge(uj["soilTransport"]));
+			res.append(p->userSoilOrganicParameters.merge(uj["soilOrganic"]));
+			res.append(p->simulationParameters.merge(uj["simulation"]));
+			for(auto e : res.errors)
+				cerr << e << endl;
+			p->userSoilMoistureParameters.getCapillaryRiseRate = getCapillaryRiseRate;
+			p->userSoilMoistureParameters.capillaryRiseRates = capillaryRiseRates;
+			cpp = p;
+		}
+		_userParameters.insert(type, cpp);
+		return cpp;
+	}
+
+	//! the loaded bundle, published via atomic_load/atomic_store (like the snapshots of SnapshotCache),
+	//! so that the lookups of parallel runs don't serialize on a mutex
+	ParameterBundlePtr parameterBundle;
+	once_flag parameterBundleFromEnvironmentOnce;
+
+	//! set while writing a bundle, so the getters read the database and not the currently loaded bundle
+	thread_local bool bypassParameterBundle = false;
+
+	//! load the bundle configured via the environment
+	void loadParameterBundleFromEnvironment()
+	{
+		if(auto pathToBundle = getenv("MONICA_PARAMETER_BUNDLE"))
+		{
+			auto pb = make_shared<ParameterBundle>();
+			auto res = pb->open(pathToBundle);
+			if(res.failure())
+				for(auto e : res.errors)
+					cerr << e << endl;
+			else
+				atomic_store(&parameterBundle, ParameterBundlePtr(pb));
+		}
+	}
+
+	//! the loaded bundle if it has been written from the given database schema, else nullptr
+	ParameterBundlePtr activeParameterBundle(const string& abstractDbSchema)
+	{
+		if(bypassParameterBundle)
+			return ParameterBundlePtr();
+
+		call_once(parameterBundleFromEnvironmentOnce, loadParameterBundleFromEnvironment);
+
+		auto pb = atomic_load(&parameterBundle);
+		return pb && pb->abstractDbSchema == abstractDbSchema ? pb : ParameterBundlePtr();
+	}
 }
 
-CultivarParametersPtr Monica::getCultivarParametersFromMonicaDB(const string& species,
-                                                                const string& cultivar,
-                                                                std::string abstractDbSchema)
+Errors Monica::loadParameterBundle(const string& pathToBundle)
 {
-	CultivarParametersPtr cps = make_shared<CultivarParameters>();
+	auto pb = make_shared<ParameterBundle>();
+	auto res = pb->open(pathToBundle);
+	if(res.failure())
+		return res;
 
-	int cropId = -1;
+	//an explicitly loaded bundle replaces the one configured via the environment, also later on
+	call_once(parameterBundleFromEnvironmentOnce, [](){});
+	atomic_store(&parameterBundle, ParameterBundlePtr(pb));
 
-	DBPtr con(newConnection(abstractDbSchema));
-	DBRow row;
-	con->select(cultivarSelect(species, cultivar));
-	debug() << cultivarSelect(species, cultivar) << endl;
-	if(!(row = con->getRow()).empty())
-	{
-		int i = 0;
+	return res;
+}
 
-		cropId = stoi(row[i++]);
-		i++;
-		cps->pc_CultivarId = row[i++];
-		cps->pc_Description = row[i++];
-		cps->pc_Perennial = stob(row[i++]);
-		//cps->pc_PermanentCultivarId = row[i++];
-		cps->pc_MaxAssimilationRate = stof(row[i++]);
-		cps->pc_MaxCropHeight = stof(row[i++]);
-		cps->pc_CropHeightP1 = stof(row[i++]);
-		cps->pc_CropHeightP2 = stof(row[i++]);
-		cps->pc_CropSpecificMaxRootingDepth = stof(row[i++]);
-		cps->pc_ResidueNRatio = stof(row[i++]);
-		cps->pc_HeatSumIrrigationStart = stof(row[i++]);
-		cps->pc_HeatSumIrrigationEnd = stof(row[i++]);
-		cps->pc_CriticalTemperatureHeatStress = stof(row[i++]);
-		cps->pc_BeginSensitivePhaseHeatStress = stof(row[i++]);
-		cps->pc_EndSensitivePhaseHeatStress = stof(row[i++]);
-		cps->pc_LT50cultivar = stof(row[i++]);
-		cps->pc_FrostHardening = stof(row[i++]);
-		cps->pc_FrostDehardening = stof(row[i++]);
-		cps->pc_LowTemperatureExposure = stof(row[i++]);
-		cps->pc_RespiratoryStress = stof(row[i++]);
-		cps->pc_LatestHarvestDoy = stoi(row[i++]);
-	}
-
-	con->select(devStageCultivarSelect(cropId));
-	debug() << devStageCultivarSelect(cropId) << endl;
-	while(!(row = con->getRow()).empty())
+//------------------------------------------------------------------------------
+
+namespace
+{
+	SpeciesParametersPtr loadSpeciesParameters(DBPtr& con, const string& species)
 	{
-		int i = 2;
+		SpeciesParametersPtr sps = make_shared<SpeciesParameters>();
+
+		DBRow row;
+		con->select(speciesSelect(species));
+		debug() << speciesSelect(species) << endl;
+		if(!(row = con->getRow()).empty())
+		{
+			int i = 0;
+
+			sps->pc_SpeciesId = row[i++];
+			sps->pc_CarboxylationPathway = stoi(row[i++]);
+			sps->pc_MinimumTemperatureForAssimilation = stof(row[i++]);
+			sps->pc_MinimumNConcentration = stof(row[i++]);
+			sps->pc_NConcentrationPN = stof(row[i++]);
+			sps->pc_NConcentrationB0 = stof(row[i++]);
+			sps->pc_NConcentrationAbovegroundBiomass = stof(row[i++]);
+			sps->pc_NConcentrationRoot = stof(row[i++]);
+			sps->pc_InitialKcFactor = stof(row[i++]);
+			sps->pc_DevelopmentAccelerationByNitrogenStress = stoi(row[i++]);
+			sps->pc_PartBiologicalNFixation = stof(row[i++]);
+			sps->pc_LuxuryNCoeff = stof(row[i++]);
+			sps->pc_SamplingDepth = stof(row[i++]);
+			sps->pc_TargetNSamplingDepth = stof(row[i++]);
+			sps->pc_TargetN30 = stof(row[i++]);
+			sps->pc_DefaultRadiationUseEfficiency = stof(row[i++]);
+			sps->pc_StageAtMaxHeight = stof(row[i++]);
+			sps->pc_MaxCropDiameter = stof(row[i++]);
+			sps->pc_StageAtMaxDiameter = stof(row[i++]);
+			sps->pc_MaxNUptakeParam = stof(row[i++]);
+			sps->pc_RootDistributionParam = stof(row[i++]);
+			sps->pc_PlantDensity = (int)stof(row[i++]);
+			sps->pc_RootGrowthLag = stof(row[i++]);
+			sps->pc_MinimumTemperatureRootGrowth = stof(row[i++]);
+			sps->pc_InitialRootingDepth = stof(row[i++]);
+			sps->pc_RootPenetrationRate = stof(row[i++]);
+			sps->pc_RootFormFactor = stof(row[i++]);
+			sps->pc_SpecificRootLength = stof(row[i++]);
+			sps->pc_StageAfterCut = stoi(row[i++]);
+			sps->pc_LimitingTemperatureHeatStress = stof(row[i++]);
+			sps->pc_DroughtImpactOnFertilityFactor = stof(row[i++]);
+			sps->pc_CuttingDelayDays = stoi(row[i++]);
+			sps->pc_FieldConditionModifier = stof(row[i++]);
+			sps->pc_AssimilateReallocation = stof(row[i++]);
+		}
+
+		con->select(organSelect(species));
+		debug() << organSelect(species) << endl;
+		while(!(row = con->getRow()).empty())
+		{
+			sps->pc_InitialOrganBiomass.push_back(stod(row[2]));
+			sps->pc_OrganMaintenanceRespiration.push_back(stod(row[3]));
+			sps->pc_AbovegroundOrgan.push_back(stob(row[4]));
+			sps->pc_OrganGrowthRespiration.push_back(stod(row[5]));
+			sps->pc_StorageOrgan.push_back(stob(row[6]));
+		}
+
+		con->select(devStageSpeciesSelect(species));
+		debug() << devStageSpeciesSelect(species) << endl;
+
+		while(!(row = con->getRow()).empty())
+		{
+			sps->pc_BaseTemperature.push_back(stod(row[2]));
+			sps->pc_CriticalOxygenContent.push_back(stod(row[3]));
+			sps->pc_StageMaxRootNConcentration.push_back(stod(row[4]));
+		}
 
-		cps->pc_StageTemperatureSum.push_back(stod(row[i++]));
-		cps->pc_OptimumTemperature.push_back(stod(row[i++]));
-		cps->pc_VernalisationRequirement.push_back(stod(row[i++]));
-		cps->pc_DaylengthRequirement.push_back(stod(row[i++]));
-		cps->pc_BaseDaylength.push_back(stod(row[i++]));
-		cps->pc_DroughtStressThreshold.push_back(stod(row[i++]));
-		cps->pc_SpecificLeafArea.push_back(stod(row[i++]));
-		cps->pc_StageKcFactor.push_back(stod(row[i++]));
+		return sps;
 	}
 
-	con->select(odsDepParamsSelect(cropId));
-	debug() << odsDepParamsSelect(cropId) << endl;
-	while(!(row = con->getRow()).empty())
+	CultivarParametersPtr loadCultivarParameters(DBPtr& con, const string& species, const string& cultivar)
 	{
-		size_t organId = stoi(row[1]);
-		size_t devStageId = stoi(row[2]);
+		CultivarParametersPtr cps = make_shared<CultivarParameters>();
+
+		int cropId = -1;
+
+		DBRow row;
+		con->select(cultivarSelect(species, cultivar));
+		debug() << cultivarSelect(species, cultivar) << endl;
+		if(!(row = con->getRow()).empty())
+		{
+			int i = 0;
+
+			cropId = stoi(row[i++]);
+			i++;
+			cps->pc_CultivarId = row[i++];
+			cps->pc_Description = row[i++];
+			cps->pc_Perennial = stob(row[i++]);
+			//cps->pc_PermanentCultivarId = row[i++];
+			cps->pc_MaxAssimilationRate = stof(row[i++]);
+			cps->pc_MaxCropHeight = stof(row[i++]);
+			cps->pc_CropHeightP1 = stof(row[i++]);
+			cps->pc_CropHeightP2 = stof(row[i++]);
+			cps->pc_CropSpecificMaxRootingDepth = stof(row[i++]);
+			cps->pc_ResidueNRatio = stof(row[i++]);
+			cps->pc_HeatSumIrrigationStart = stof(row[i++]);
+			cps->pc_HeatSumIrrigationEnd = stof(row[i++]);
+			cps->pc_CriticalTemperatureHeatStress = stof(row[i++]);
+			cps->pc_BeginSensitivePhaseHeatStress = stof(row[i++]);
+			cps->pc_EndSensitivePhaseHeatStress = stof(row[i++]);
+			cps->pc_LT50cultivar = stof(row[i++]);
+			cps->pc_FrostHardening = stof(row[i++]);
+			cps->pc_FrostDehardening = stof(row[i++]);
+			cps->pc_LowTemperatureExposure = stof(row[i++]);
+			cps->pc_RespiratoryStress = stof(row[i++]);
+			cps->pc_LatestHarvestDoy = stoi(row[i++]);
+		}
+
+		con->select(devStageCultivarSelect(cropId));
+		debug() << devStageCultivarSelect(cropId) << endl;
+		while(!(row = con->getRow()).empty())
+		{
+			int i = 2;
+
+			cps->pc_StageTemperatureSum.push_back(stod(row[i++]));
+			cps->pc_OptimumTemperature.push_back(stod(row[i++]));
+			cps->pc_VernalisationRequirement.push_back(stod(row[i++]));
+			cps->pc_DaylengthRequirement.push_back(stod(row[i++]));
+			cps->pc_BaseDaylength.push_back(stod(row[i++]));
+			cps->pc_DroughtStressThreshold.push_back(stod(row[i++]));
+			cps->pc_SpecificLeafArea.push_back(stod(row[i++]));
+			cps->pc_StageKcFactor.push_back(stod(row[i++]));
+		}
+
+		con->select(odsDepParamsSelect(cropId));
+		debug() << odsDepParamsSelect(cropId) << endl;
+		while(!(row = con->getRow()).empty())
+		{
+			size_t organId = stoi(row[1]);
+			size_t devStageId = stoi(row[2]);
+
+			auto& sov = stoi(row[3]) == 1 ? cps->pc_AssimilatePartitioningCoeff : cps->pc_OrganSenescenceRate;
 
-		auto& sov = stoi(row[3]) == 1 ? cps->pc_AssimilatePartitioningCoeff : cps->pc_OrganSenescenceRate;
+			if(sov.size() < devStageId)
+				sov.resize(devStageId);
+			auto& ds = sov[devStageId - 1];
 
-		if(sov.size() < devStageId)
-			sov.resize(devStageId);
-		auto& ds = sov[devStageId - 1];
+			if(ds.size() < organId)
+				ds.resize(organId);
 
-		if(ds.size() < organId)
-			ds.resize(organId);
+			ds[organId - 1] = stod(row[4]);
+		}
 
-		ds[organId - 1] = stod(row[4]);
+		cps->pc_OrganIdsForPrimaryYield.clear();
+		cps->pc_OrganIdsForSecondaryYield.clear();
+		con->select(yieldPartsSelect(cropId));
+		debug() << yieldPartsSelect(cropId) << endl;
+		while(!(row = con->getRow()).empty())
+		{
+			bool isPrimary = stob(row[2]);
+
+			YieldComponent yc;
+			yc.organId = stoi(row[1]);
+			yc.yieldPercentage = stod(row[3]) / 100.0;
+			yc.yieldDryMatter = stod(row[4]);
+
+			// normal case, uses yield partitioning from crop database
+			if(isPrimary)
+				cps->pc_OrganIdsForPrimaryYield.push_back(yc);
+			else
+				cps->pc_OrganIdsForSecondaryYield.push_back(yc);
+		}
+
+		// get cutting parts if there are some data available
+		cps->pc_OrganIdsForCutting.clear();
+		con->select(cuttingPartsSelect(cropId));
+		while(!(row = con->getRow()).empty())
+		{
+			YieldComponent yc;
+			yc.organId = stoi(row[1]);
+			//bool isPrimary = stoi(row[2]) == 1;
+			yc.yieldPercentage = stof(row[3]) / 100.0;
+			yc.yieldDryMatter = stof(row[4]);
+
+			cps->pc_OrganIdsForCutting.push_back(yc);
+		}
+
+		return cps;
 	}
 
-	cps->pc_OrganIdsForPrimaryYield.clear();
-	cps->pc_OrganIdsForSecondaryYield.clear();
-	con->select(yieldPartsSelect(cropId));
-	debug() << yieldPartsSelect(cropId) << endl;
-	while(!(row = con->getRow()).empty())
+	//! (schema, species) -> species parameters
+	typedef SnapshotCache<pair<string, string>, SpeciesParametersPtr> SpeciesParametersCache;
+	SpeciesParametersCache speciesParametersCache;
+
+	//! (schema, species, cultivar) -> cultivar parameters
+	typedef SnapshotCache<tuple<string, string, string>, CultivarParametersPtr> CultivarParametersCache;
+	CultivarParametersCache cultivarParametersCache;
+
+	//! (schema, crop id) -> (species, cultivar), unknown crop ids map to empty names
+	typedef SnapshotCache<pair<string, int>, pair<string, string>> CropIdCache;
+	CropIdCache cropIdCache;
+
+	//! the connection is opened on the first cache miss and can be shared by subsequent lookups
+	SpeciesParametersPtr cachedSpeciesParameters(const string& abstractDbSchema,
+	                                             const string& species,
+	                                             DBPtr& con)
 	{
-		bool isPrimary = stob(row[2]);
+		SpeciesParametersPtr sps;
+		auto key = make_pair(abstractDbSchema, species);
+		if(!speciesParametersCache.find(key, sps))
+		{
+			if(!con)
+				con.reset(newConnection(abstractDbSchema));
+			sps = loadSpeciesParameters(con, species);
+			speciesParametersCache.insert(key, sps);
+		}
+		return sps;
+	}
 
-		YieldComponent yc;
-		yc.organId = stoi(row[1]);
-		yc.yieldPercentage = stod(row[3]) / 100.0;
-		yc.yieldDryMatter = stod(row[4]);
+	CultivarParametersPtr cachedCultivarParameters(const string& abstractDbSchema,
+	                                               const string& species,
+	                                               const string& cultivar,
+	                                               DBPtr& con)
+	{
+		CultivarParametersPtr cps;
+		auto key = make_tuple(abstractDbSchema, species, cultivar);
+		if(!cultivarParametersCache.find(key, cps))
+		{
+			if(!con)
+				con.reset(newConnection(abstractDbSchema));
+			cps = loadCultivarParameters(con, species, cultivar);
+			cultivarParametersCache.insert(key, cps);
+		}
+		return cps;
+	}
 
-		// normal case, uses yield partitioning from crop database
-		if(isPrimary)
-			cps->pc_OrganIdsForPrimaryYield.push_back(yc);
-		else
-			cps->pc_OrganIdsForSecondaryYield.push_back(yc);
+	CropParametersPtr cachedCropParameters(const string& abstractDbSchema,
+	                                       const string& species,
+	                                       const string& cultivar,
+	                                       DBPtr& con)
+	{
+		CropParametersPtr cps = make_shared<CropParameters>();
+		cps->speciesParams = *cachedSpeciesParameters(abstractDbSchema, species, con);
+		cps->cultivarParams = *cachedCultivarParameters(abstractDbSchema, species, cultivar, con);
+		return internCropParameters(cps, J11Object{{"db", abstractDbSchema}});
 	}
+}
 
-	// get cutting parts if there are some data available
-	cps->pc_OrganIdsForCutting.clear();
-	con->select(cuttingPartsSelect(cropId));
-	while(!(row = con->getRow()).empty())
+SpeciesParametersPtr Monica::getSpeciesParametersFromMonicaDB(const string& species,
+                                                              std::string abstractDbSchema)
+{
+	if(auto pb = activeParameterBundle(abstractDbSchema))
 	{
-		YieldComponent yc;
-		yc.organId = stoi(row[1]);
-		//bool isPrimary = stoi(row[2]) == 1;
-		yc.yieldPercentage = stof(row[3]) / 100.0;
-		yc.yieldDryMatter = stof(row[4]);
+		auto sps = pb->species(species);
+		return sps ? make_shared<SpeciesParameters>(*sps) : make_shared<SpeciesParameters>();
+	}
 
-		cps->pc_OrganIdsForCutting.push_back(yc);
+	DBPtr con;
+	return make_shared<SpeciesParameters>(*cachedSpeciesParameters(abstractDbSchema, species, con));
+}
+
+CultivarParametersPtr Monica::getCultivarParametersFromMonicaDB(const string& species,
+                                                                const string& cultivar,
+                                                                std::string abstractDbSchema)
+{
+	if(auto pb = activeParameterBundle(abstractDbSchema))
+	{
+		auto cps = pb->cultivar(species, cultivar);
+		return cps ? make_shared<CultivarParameters>(*cps) : make_shared<CultivarParameters>();
 	}
 
-	return cps;
+	DBPtr con;
+	return make_shared<CultivarParameters>(*cachedCultivarParameters(abstractDbSchema, species, cultivar, con));
 }
 
 CropParametersPtr Monica::getCropParametersFromMonicaDB(const string& species,
 																												const string& cultivar,
 																												std::string abstractDbSchema)
 {
-	CropParametersPtr cps = make_shared<CropParameters>();
-	cps->speciesParams = *getSpeciesParametersFromMonicaDB(species, abstractDbSchema);
-	cps->cultivarParams = *getCultivarParametersFromMonicaDB(species, cultivar, abstractDbSchema);
-	return cps;
+	if(activeParameterBundle(abstractDbSchema))
+	{
+		CropParametersPtr cps = make_shared<CropParameters>();
+		cps->speciesParams = *getSpeciesParametersFromMonicaDB(species, abstractDbSchema);
+		cps->cultivarParams = *getCultivarParametersFromMonicaDB(species, cultivar, abstractDbSchema);
+		return internCropParameters(cps, J11Object{{"db", abstractDbSchema}});
+	}
+
+	DBPtr con;
+	return cachedCropParameters(abstractDbSchema, species, cultivar, con);
 }
 
 const map<int, pair<SpeciesParametersPtr, CultivarParametersPtr>>&
@@ -418,6 +1148,9 @@ getAllCropParametersFromMonicaDB(std::string abstractDbSchema = "monica")
 		if(!initialized)
 		{
 			DBPtr con(newConnection(abstractDbSchema));
+			//a second connection for the parameter queries, which would reset the crop list
+			DBPtr pcon;
+			CropIdCache::Map cropIds;
 			DBRow row;
 			con->select("select crop_id, species_id, id from cultivar order by crop_id");
 			while(!(row = con->getRow()).empty())
@@ -426,9 +1159,11 @@ getAllCropParametersFromMonicaDB(std::string abstractDbSchema = "monica")
 				string speciesId = row[1];
 				string cultivarId = row[2];
 
-				cpss[cropId] = make_pair(getSpeciesParametersFromMonicaDB(speciesId),
-																 getCultivarParametersFromMonicaDB(speciesId, cultivarId));
+				cpss[cropId] = make_pair(cachedSpeciesParameters(abstractDbSchema, speciesId, pcon),
+																 cachedCultivarParameters(abstractDbSchema, speciesId, cultivarId, pcon));
+				cropIds[make_pair(abstractDbSchema, cropId)] = make_pair(speciesId, cultivarId);
 			}
+			cropIdCache.insert(cropIds);
 
 			initialized = true;
 		}
@@ -442,18 +1177,108 @@ CropParametersPtr Monica::getCropParametersFromMonicaDB(int cropId,
 {
 	static CropParametersPtr nothing = make_shared<CropParameters>();
 
-	auto m = getAllCropParametersFromMonicaDB(abstractDbSchema);
-	auto ci = m.find(cropId);
-	if(ci != m.end())
+	if(auto pb = activeParameterBundle(abstractDbSchema))
 	{
-		CropParametersPtr cps = make_shared<CropParameters>();
-		cps->speciesParams = *ci->second.first;
-		cps->cultivarParams = *ci->second.second;
+		auto ci = pb->crops.find(cropId);
+		return ci != pb->crops.end()
+			? getCropParametersFromMonicaDB(ci->second.first, ci->second.second, abstractDbSchema)
+			: nothing;
+	}
 
-		return cps;
+	DBPtr con;
+
+	pair<string, string> speciesAndCultivar;
+	auto key = make_pair(abstractDbSchema, cropId);
+	if(!cropIdCache.find(key, speciesAndCultivar))
+	{
+		con.reset(newConnection(abstractDbSchema));
+		con->select(string("select species_id, id from cultivar where crop_id = ") + to_string(cropId));
+		DBRow row;
+		if(!(row = con->getRow()).empty())
+			speciesAndCultivar = make_pair(row[0], row[1]);
+		cropIdCache.insert(key, speciesAndCultivar);
 	}
 
-	return nothing;
+	if(speciesAndCultivar.first.empty())
+		return nothing;
+
+	return cachedCropParameters(abstractDbSchema, speciesAndCultivar.first, speciesAndCultivar.second, con);
+}
+
+void Monica::prefetchCropParametersFromMonicaDB(const vector<pair<string, string>>& speciesAndCultivars,
+                                                std::string abstractDbSchema)
+{
+	if(activeParameterBundle(abstractDbSchema))
+		return;
+
+	DBPtr con;
+	SpeciesParametersCache::Map species;
+	CultivarParametersCache::Map cultivars;
+	for(const auto& sc : speciesAndCultivars)
+	{
+		auto skey = make_pair(abstractDbSchema, sc.first);
+		if(species.find(skey) == species.end()
+		   && !speciesParametersCache.contains(skey))
+		{
+			if(!con)
+				con.reset(newConnection(abstractDbSchema));
+			species[skey] = loadSpeciesParameters(con, sc.first);
+		}
+
+		auto ckey = make_tuple(abstractDbSchema, sc.first, sc.second);
+		if(cultivars.find(ckey) == cultivars.end()
+		   && !cultivarParametersCache.contains(ckey))
+		{
+			if(!con)
+				con.reset(newConnection(abstractDbSchema));
+			cultivars[ckey] = loadCultivarParameters(con, sc.first, sc.second);
+		}
+	}
+
+	//publish everything at once, instead of a new snapshot per crop
+	speciesParametersCache.insert(species);
+	cultivarParametersCache.insert(cultivars);
+}
+
+namespace
+{
+	//! the crops of env, which don't have their crop parameters set yet
+	void addCropsWithoutParameters(const Env& env, vector<pair<string, string>>& speciesAndCultivars)
+	{
+		auto addCrops = [&](const vector<CultivationMethod>& cms)
+		{
+			for(const auto& cm : cms)
+			{
+				//crops configured via JSON come with their parameters already
+				auto crop = cm.crop();
+				if(crop && !crop->cropParameters())
+					speciesAndCultivars.push_back(make_pair(crop->speciesName(), crop->cultivarName()));
+			}
+		};
+
+		addCrops(env.cropRotation);
+		for(const auto& cr : env.cropRotations)
+			addCrops(cr.cropRotation);
+	}
+}
+
+void Monica::prefetchCropParametersFromMonicaDB(const vector<Env>& envs,
+                                                std::string abstractDbSchema)
+{
+	vector<pair<string, string>> speciesAndCultivars;
+	for(const auto& env : envs)
+		addCropsWithoutParameters(env, speciesAndCultivars);
+
+	prefetchCropParametersFromMonicaDB(speciesAndCultivars, abstractDbSchema);
+}
+
+void Monica::prefetchCropParametersFromMonicaDB(const Env& env,
+                                                std::string abstractDbSchema)
+{
+	vector<pair<string, string>> speciesAndCultivars;
+	addCropsWithoutParameters(env, speciesAndCultivars);
+	if(!speciesAndCultivars.empty())
+		prefetchCropParametersFromMonicaDB(speciesAndCultivars, abstractDbSchema);
 }
 
 void Monica::writeCropParameters(string path, std::string abstractDbSchema)
@@ -533,7 +1358,13 @@ MineralFertiliserParameters
 Monica::getMineralFertiliserParametersFromMonicaDB(const std::string& id,
                                                    string abstractDbSchema)
 {
-	auto m = getAllMineralFertiliserParametersFromMonicaDB(abstractDbSchema);
+	if(auto pb = activeParameterBundle(abstractDbSchema))
+	{
+		auto mf = pb->mineralFertiliser(id);
+		return mf ? *mf : MineralFertiliserParameters();
+	}
+
+	const auto& m = getAllMineralFertiliserParametersFromMonicaDB(abstractDbSchema);
 	auto ci = m.find(id);
 	return ci != m.end() ? ci->second : MineralFertiliserParameters();
 }
@@ -639,7 +1470,13 @@ Monica::getOrganicFertiliserParametersFromMonicaDB(const std::string& id,
 {
 	static OrganicFertiliserParametersPtr nothing = make_shared<OrganicFertiliserParameters>();
 
-	auto m = getAllOrganicFertiliserParametersFromMonicaDB(abstractDbSchema);
+	if(auto pb = activeParameterBundle(abstractDbSchema))
+	{
+		auto of = pb->organicFertiliser(id);
+		return of ? of : nothing;
+	}
+
+	const auto& m = getAllOrganicFertiliserParametersFromMonicaDB(abstractDbSchema);
 	auto ci = m.find(id);
 	return ci != m.end() ? ci->second : nothing;
 }
@@ -675,6 +1512,15 @@ Monica::getResidueParametersFromMonicaDB(const string& species,
 																				 const string& residueType,
 																				 std::string abstractDbSchema)
 {
+	static CropResidueParametersPtr nothing = make_shared<CropResidueParameters>();
+
+	if(auto pb = activeParameterBundle(abstractDbSchema))
+	{
+		//as in the query below, fall back to the species' default residue parameters
+		auto crp = pb->cropResidue(species, residueType);
+		return crp ? crp : nothing;
+	}
+
 	DBPtr con(newConnection(abstractDbSchema));
 	DBRow row;
 	string query = string() +
@@ -731,7 +1577,6 @@ Monica::getResidueParametersFromMonicaDB(const string& species,
 		return omp;
 	}
 
-	static CropResidueParametersPtr nothing = make_shared<CropResidueParameters>();
 	return nothing;
 }
 
@@ -749,7 +1594,7 @@ getAllCropResidueParametersFromMonicaDB(std::string abstractDbSchema = "monica")
 							"order by species_id, residue_type");
 	while(!(row = con->getRow()).empty())
 	{
-		acrps.push_back(getResidueParametersFromMonicaDB(row[0], row[1]));
+		acrps.push_back(getResidueParametersFromMonicaDB(row[0], row[1], abstractDbSchema));
 	}
 
 	return acrps;
@@ -815,6 +1660,12 @@ UserCropParameters
 Monica::readUserCropParametersFromDatabase(string type,
                                            std::string abstractDbSchema)
 {
+	if(auto pb = activeParameterBundle(abstractDbSchema))
+	{
+		if(auto cpp = pb->userParameters(type))
+			return cpp->userCropParameters;
+	}
+
 	UserCropParameters user_crops;
 	
 	DBPtr con = userParamsSelect(type, "crop", abstractDbSchema);
@@ -862,6 +1713,12 @@ SimulationParameters
 Monica::readUserSimParametersFromDatabase(string type,
                                           std::string abstractDbSchema)
 {
+	if(auto pb = activeParameterBundle(abstractDbSchema))
+	{
+		if(auto cpp = pb->userParameters(type))
+			return cpp->simulationParameters;
+	}
+
 	SimulationParameters sim;
 
 	DBPtr con = userParamsSelect(type, "sim", abstractDbSchema);
@@ -893,6 +1750,12 @@ UserEnvironmentParameters
 Monica::readUserEnvironmentParametersFromDatabase(string type,
                                                   std::string abstractDbSchema)
 {
+	if(auto pb = activeParameterBundle(abstractDbSchema))
+	{
+		if(auto cpp = pb->userParameters(type))
+			return cpp->userEnvironmentParameters;
+	}
+
 	UserEnvironmentParameters user_env;
 
 	DBPtr con = userParamsSelect(type, "environment");
@@ -922,15 +1785,34 @@ Monica::readUserEnvironmentParametersFromDatabase(string type,
 	return user_env;
 }
 
+shared_ptr<CapillaryRiseRates> Monica::capillaryRiseRatesFromDatabase()
+{
+	if(auto pb = activeParameterBundle("monica"))
+		return pb->capillaryRiseRates;
+
+	static shared_ptr<CapillaryRiseRates> rates =
+		make_shared<CapillaryRiseRates>([](string soilTexture, int distance)
+	{
+		return Soil::readCapillaryRiseRates().getRate(soilTexture, distance);
+	});
+	return rates;
+}
+
 UserSoilMoistureParameters
 Monica::readUserSoilMoistureParametersFromDatabase(string type,
                                                    std::string abstractDbSchema)
 {
+	//the bundle's parameters come with the bundle's capillary rise rates
+	if(auto pb = activeParameterBundle(abstractDbSchema))
+		if(auto cpp = pb->userParameters(type))
+			return cpp->userSoilMoistureParameters;
+
 	UserSoilMoistureParameters user_soil_moisture;
 	user_soil_moisture.getCapillaryRiseRate = [](string soilTexture, int distance)
 	{
 		return Soil::readCapillaryRiseRates().getRate(soilTexture, distance);
 	};
+	user_soil_moisture.capillaryRiseRates = capillaryRiseRatesFromDatabase();
 
 	DBPtr con = userParamsSelect(type, "soil_moisture", abstractDbSchema);
 
@@ -993,6 +1875,12 @@ UserSoilTemperatureParameters
 Monica::readUserSoilTemperatureParametersFromDatabase(string type,
                                                       std::string abstractDbSchema)
 {
+	if(auto pb = activeParameterBundle(abstractDbSchema))
+	{
+		if(auto cpp = pb->userParameters(type))
+			return cpp->userSoilTemperatureParameters;
+	}
+
 	UserSoilTemperatureParameters user_soil_temperature;
 
 	DBPtr con = userParamsSelect(type, "soil_temperature", abstractDbSchema);
@@ -1034,6 +1922,12 @@ UserSoilTransportParameters
 Monica::readUserSoilTransportParametersFromDatabase(string type,
                                                     std::string abstractDbSchema)
 {
+	if(auto pb = activeParameterBundle(abstractDbSchema))
+	{
+		if(auto cpp = pb->userParameters(type))
+			return cpp->userSoilTransportParameters;
+	}
+
 	UserSoilTransportParameters user_soil_transport;
 
 	DBPtr con = userParamsSelect(type, "soil_transport", abstractDbSchema);
@@ -1057,6 +1951,12 @@ UserSoilOrganicParameters
 Monica::readUserSoilOrganicParametersFromDatabase(string type,
                                                   std::string abstractDbSchema)
 {
+	if(auto pb = activeParameterBundle(abstractDbSchema))
+	{
+		if(auto cpp = pb->userParameters(type))
+			return cpp->userSoilOrganicParameters;
+	}
+
 	UserSoilOrganicParameters user_soil_organic;
 
 	DBPtr con = userParamsSelect(type, "soil_organic", abstractDbSchema);
@@ -1239,6 +2139,195 @@ void Monica::writeUserParameters(int type, string path, std::string abstractDbSc
 
 //----------------------------------------------------------------------------------
 
+namespace
+{
+	template<typename T>
+	string podBytes(const vector<T>& v)
+	{
+		return string(reinterpret_cast<const char*>(v.data()), v.size() * sizeof(T));
+	}
+}
+
+void Monica::writeParameterBundle(string pathToBundle, std::string abstractDbSchema)
+{
+	//always export the database itself, even if a bundle has been loaded already
+	struct Bypass
+	{
+		Bypass() { bypassParameterBundle = true; }
+		~Bypass() { bypassParameterBundle = false; }
+	} bypass;
+
+	//the sections of the bundle, see BundleHeader
+	string strings, json;
+	vector<double> values;
+	vector<BundleArray> arrays;
+	map<pair<string, string>, BundleRecord> records;
+
+	map<string, BundleString> string2bs;
+	auto addString = [&](const string& s)
+	{
+		auto ci = string2bs.find(s);
+		if(ci != string2bs.end())
+			return ci->second;
+		BundleString bs{uint32_t(strings.size()), uint32_t(s.size())};
+		strings += s;
+		return string2bs[s] = bs;
+	};
+
+	//a record's arrays have to be added right after the record itself
+	auto addRecord = [&](const string& section, const string& key, const json11::Json& j) -> BundleRecord&
+	{
+		auto s = j.dump();
+		auto& r = records[make_pair(section, key)];
+		r.section = addString(section);
+		r.key = addString(key);
+		r.jsonOffset = json.size();
+		r.jsonSize = s.size();
+		r.firstArray = arrays.size();
+		r.noOfArrays = 0;
+		json += s;
+		return r;
+	};
+	auto addArray = [&](BundleRecord& r, const string& name, uint32_t row, const vector<double>& vs)
+	{
+		arrays.push_back(BundleArray{addString(name), row, uint32_t(vs.size()), values.size()});
+		values.insert(values.end(), vs.begin(), vs.end());
+		r.noOfArrays++;
+	};
+
+	set<string> species;
+	vector<BundleCrop> crops;
+	for(const auto& p : getAllCropParametersFromMonicaDB(abstractDbSchema))
+	{
+		const auto& sps = p.second.first;
+		const auto& cps = p.second.second;
+		if(species.insert(sps->pc_SpeciesId).second)
+		{
+			auto sj = sps->to_json().object_items();
+			for(const auto& a : speciesArrays())
+				sj.erase(a.first);
+			auto& r = addRecord("species", sps->pc_SpeciesId, sj);
+			for(const auto& a : speciesArrays())
+				addArray(r, a.first, NoRow, (*sps).*(a.second));
+		}
+
+		auto cj = cps->to_json().object_items();
+		for(const auto& a : cultivarArrays())
+			cj.erase(a.first);
+		for(const auto& m : cultivarMatrices())
+			cj.erase(m.first);
+		auto& r = addRecord("cultivars", sps->pc_SpeciesId + "|" + cps->pc_CultivarId, cj);
+		for(const auto& a : cultivarArrays())
+			addArray(r, a.first, NoRow, (*cps).*(a.second));
+		for(const auto& m : cultivarMatrices())
+		{
+			const auto& rows = (*cps).*(m.second);
+			for(size_t row = 0; row < rows.size(); row++)
+				addArray(r, m.first, uint32_t(row), rows.at(row));
+		}
+
+		crops.push_back(BundleCrop{int32_t(p.first), addString(sps->pc_SpeciesId), addString(cps->pc_CultivarId)});
+	}
+
+	for(const auto& p : getAllMineralFertiliserParametersFromMonicaDB(abstractDbSchema))
+		addRecord("mineralFertilisers", p.first, p.second.to_json());
+
+	for(const auto& p : getAllOrganicFertiliserParametersFromMonicaDB(abstractDbSchema))
+		addRecord("organicFertilisers", p.first, p.second->to_json());
+
+	//residue parameters without a residue type are stored under "species|"
+	for(auto r : getAllCropResidueParametersFromMonicaDB(abstractDbSchema))
+		addRecord("cropResidues", r->species + "|" + r->residueType, r->to_json());
+
+	for(auto type : {"hermes", "eva2", "macsur"})
+	{
+		addRecord("userParameters", type, json11::Json::object{
+			{"crop", readUserCropParametersFromDatabase(type, abstractDbSchema).to_json()},
+			{"environment", readUserEnvironmentParametersFromDatabase(type, abstractDbSchema).to_json()},
+			{"soilMoisture", readUserSoilMoistureParametersFromDatabase(type, abstractDbSchema).to_json()},
+			{"soilTemperature", readUserSoilTemperatureParametersFromDatabase(type, abstractDbSchema).to_json()},
+			{"soilTransport", readUserSoilTransportParametersFromDatabase(type, abstractDbSchema).to_json()},
+			{"soilOrganic", readUserSoilOrganicParametersFromDatabase(type, abstractDbSchema).to_json()},
+			{"simulation", readUserSimParametersFromDatabase(type, abstractDbSchema).to_json()}});
+	}
+
+	//rates per soil texture, sorted by soil texture
+	set<string> soilTextures;
+	{
+		DBPtr con(newConnection(abstractDbSchema));
+		con->select("select distinct soil_type from capillary_rise_rate order by soil_type");
+		DBRow row;
+		while(!(row = con->getRow()).empty())
+			soilTextures.insert(row[0]);
+	}
+	vector<BundleCapillaryRiseRates> capillaryRiseRates;
+	for(const auto& st : soilTextures)
+	{
+		BundleCapillaryRiseRates crr;
+		crr.soilTexture = addString(st);
+		for(int d = 1; d <= CapillaryRiseRates::maxDistance; d++)
+			crr.rates[d - 1] = Soil::readCapillaryRiseRates().getRate(st, d);
+		capillaryRiseRates.push_back(crr);
+	}
+
+	vector<BundleRecord> index;
+	for(const auto& p : records)
+		index.push_back(p.second);
+
+	vector<BundleString> meta{addString(abstractDbSchema)};
+
+	const vector<pair<string, string>> sections =
+	{{"meta", podBytes(meta)}
+	,{"crops", podBytes(crops)}
+	,{"capillaryRiseRates", podBytes(capillaryRiseRates)}
+	,{"index", podBytes(index)}
+	,{"arrays", podBytes(arrays)}
+	,{"values", podBytes(values)}
+	,{"json", json}
+	,{"strings", strings}
+	};
+
+	BundleHeader header;
+	memcpy(header.magic, BundleMagic, sizeof(BundleMagic));
+	header.version = ParameterBundleVersion;
+	header.byteOrderMark = BundleByteOrderMark;
+	header.noOfSections = uint32_t(sections.size());
+	header.reserved = 0;
+
+	auto aligned = [](uint64_t offset) { return (offset + 7) / 8 * 8; };
+	vector<BundleSection> table(sections.size());
+	uint64_t offset = aligned(sizeof(BundleHeader) + table.size() * sizeof(BundleSection));
+	for(size_t i = 0; i < sections.size(); i++)
+	{
+		auto& s = table.at(i);
+		memset(&s, 0, sizeof(BundleSection));
+		strncpy(s.name, sections.at(i).first.c_str(), sizeof(s.name) - 1);
+		s.offset = offset;
+		s.size = sections.at(i).second.size();
+		offset = aligned(offset + s.size);
+	}
+
+	ofstream ofs;
+	ofs.open(pathToBundle, ios::binary);
+	if(ofs.good())
+	{
+		ofs.write(reinterpret_cast<const char*>(&header), sizeof(BundleHeader));
+		ofs.write(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(BundleSection));
+		uint64_t pos = sizeof(BundleHeader) + table.size() * sizeof(BundleSection);
+		for(size_t i = 0; i < sections.size(); i++)
+		{
+			ofs.write("\0\0\0\0\0\0\0", table.at(i).offset - pos);
+			ofs.write(sections.at(i).second.data(), sections.at(i).second.size());
+			pos = table.at(i).offset + table.at(i).size;
+		}
+		ofs.close();
+	}
+	else
+		cerr << "Error failed to open parameter bundle file: '" << pathToBundle << "'." << endl;
+}
+
+//----------------------------------------------------------------------------------
+
 vector<AMCRes> Monica::availableMonicaCrops()
 {
 	DBPtr con(newConnection("monica"));
@@ -19,11 +19,15 @@ Copyright (C) Leibniz Centre for Agricultural Landscape Research (ZALF)
 #define DATABASE_IO_H_
 
 #include <string>
+#include <vector>
+#include <utility>
 
 #include "../core/monica-parameters.h"
 
 namespace Monica
 {
+	struct Env;
+
 	enum
 	{
 		MODE_LC_DSS = 0,
@@ -51,6 +55,19 @@ namespace Monica
   CropParametersPtr getCropParametersFromMonicaDB(int cropId,
                                                   std::string abstractDbSchema = "monica");
 
+	//! load the species and cultivar parameters of all given crops in one go,
+	//! so that the following get*ParametersFromMonicaDB calls are served from the cache
+	void prefetchCropParametersFromMonicaDB(const std::vector<std::pair<std::string, std::string>>& speciesAndCultivars,
+	                                        std::string abstractDbSchema = "monica");
+
+	//! prefetch the crops of all given envs, which don't have their crop parameters set yet
+	void prefetchCropParametersFromMonicaDB(const std::vector<Env>& envs,
+	                                        std::string abstractDbSchema = "monica");
+
+	//! prefetch the crops of a single env, e.g. of a ZMQ request, at once
+	void prefetchCropParametersFromMonicaDB(const Env& env,
+	                                        std::string abstractDbSchema = "monica");
+
 	void writeCropParameters(std::string path, std::string abstractDbSchema = "monica");
 
 	//-----------------------------------------------------------
@@ -80,6 +97,9 @@ namespace Monica
 
 	//-----------------------------------------------------------
 
+	//! capillary rise rate tables from the soil database (or a loaded parameter bundle), shared by all runs of the process
+	std::shared_ptr<CapillaryRiseRates> capillaryRiseRatesFromDatabase();
+
 	UserCropParameters readUserCropParametersFromDatabase(std::string type,
 	                                                      std::string abstractDbSchema = "monica");
 	UserEnvironmentParameters readUserEnvironmentParametersFromDatabase(std::string type,
@@ -102,6 +122,18 @@ namespace Monica
 
 	//-----------------------------------------------------------
 
+	//! write all species, cultivar, fertiliser, residue and user parameter sets and the capillary rise rates
+	//! of the database into one versioned, indexed binary bundle file
+	void writeParameterBundle(std::string pathToBundle, std::string abstractDbSchema = "monica");
+
+	//! map a bundle written by writeParameterBundle into memory, the getters above then answer requests
+	//! for the bundle's database schema from the bundle instead of the database,
+	//! converting each parameter set on its first request only
+	//! (a bundle named by the environment variable MONICA_PARAMETER_BUNDLE is loaded on first use)
+	Tools::Errors loadParameterBundle(const std::string& pathToBundle);
+
+	//-----------------------------------------------------------
+
   struct AMCRes
   {
     std::string speciesId, cultivarId, name;
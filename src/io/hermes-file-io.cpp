@@ -16,7 +16,13 @@ Copyright (C) Leibniz Centre for Agricultural Landscape Research (ZALF)
 */
 
 #include <iostream>
+#include <fstream>
+#include <sstream>
 #include <mutex>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <functional>
 
 #include "tools/debug.h"
 #include "tools/algorithms.h"
@@ -77,6 +83,100 @@ namespace
 			return r;
 		}
 	} parseDate;
+
+	//! read a whole file with a single read, so the HERMES parsers can walk
+	//! the buffer instead of going through getline and a stringstream per line
+	bool readWholeFile(const string& pathToFile, string& buffer)
+	{
+		ifstream ifs(pathToFile, ios::binary);
+		if(!ifs.good())
+			return false;
+
+		ifs.seekg(0, ios::end);
+		buffer.resize(size_t(ifs.tellg()));
+		ifs.seekg(0, ios::beg);
+		ifs.read(&buffer[0], buffer.size());
+		return true;
+	}
+
+	//! hands out the lines of a buffer, terminating them in place
+	class LineReader
+	{
+	public:
+		LineReader(string& buffer) : _pos(&buffer[0]), _end(&buffer[0] + buffer.size()) {}
+
+		//! the next line or nullptr at the end of the buffer
+		char* next()
+		{
+			if(_pos >= _end)
+				return nullptr;
+
+			char* line = _pos;
+			char* nl = static_cast<char*>(memchr(_pos, '\n', _end - _pos));
+			if(nl)
+			{
+				*nl = '\0';
+				_pos = nl + 1;
+			}
+			else
+				_pos = _end;
+			return line;
+		}
+
+	private:
+		char* _pos;
+		char* _end;
+	};
+
+	//! parse up to noOfValues whitespace separated numbers of a line,
+	//! missing values are set to -1 and the number of values read is returned
+	size_t parseDoubles(const char* line, double* values, size_t noOfValues)
+	{
+		size_t i = 0;
+		for(char* end = nullptr; i < noOfValues; i++)
+		{
+			values[i] = strtod(line, &end);
+			if(end == line)
+				break;
+			line = end;
+		}
+		for(size_t k = i; k < noOfValues; k++)
+			values[k] = -1.0;
+		return i;
+	}
+
+	//! applications read from a HERMES management file, each with the function adding it to a cultivation method
+	typedef vector<pair<Date, function<void(CultivationMethod&)>>> Applications;
+
+	//! add the applications in a single pass through the crop rotation,
+	//! each one goes to the first cultivation method which ends at or after the application's date
+	void attachDateSortedApplications(vector<CultivationMethod>& cr,
+	                                  Applications& as,
+	                                  const string& pathToFile)
+	{
+		stable_sort(as.begin(), as.end(), [](const Applications::value_type& a1,
+		                                     const Applications::value_type& a2)
+		{
+			return a1.first < a2.first;
+		});
+
+		auto it = cr.begin();
+		Date currentEnd = it->endDate();
+		for(const auto& a : as)
+		{
+			while(a.first > currentEnd)
+			{
+				if(++it == cr.end())
+				{
+					debug() << "Ignoring applications after the end of the crop rotation in \"" << pathToFile << "\"" << endl;
+					return;
+				}
+				currentEnd = it->endDate();
+			}
+
+			a.second(*it);
+		}
+	}
 }
 
 //------------------------------------------------------------------------------------
@@ -443,43 +543,46 @@ Monica::climateDataFromHermesFiles(const std::string& pathToFiles,
 	vector<double> _precip;
 	vector<double> _sunhours;
 
+	//the columns are filled directly, so reserve the whole period up front
+	size_t noOfDays = 0;
+	for(int y = fromYear; y <= toYear; y++)
+		noOfDays += Date(31, 12, y, useLeapYears).dayOfYear();
+	for(auto v : {&_tmin, &_tavg, &_tmax, &_globrad, &_wind, &_precip})
+		v->reserve(noOfDays);
+
 	Date date = Date(1, 1, fromYear, useLeapYears);
 
+	string buffer;
 	for (int y = fromYear; y <= toYear; y++)
 	{
 		string pathToFile = fixSystemSeparator(pathToFiles + to_string(y).substr(1, 3));
 		debug() << "File: " << pathToFile << endl;
-		ifstream ifs(pathToFile);
-		if (!ifs.good()) 
+		if (!readWholeFile(pathToFile, buffer))
 		{
 			cerr << "Could not open file " << pathToFile << ". Aborting now!" << endl;
 			exit(1);
 		}
-		string s;
+		LineReader lines(buffer);
 
 		//skip first line(s)
-		getline(ifs, s);
-		getline(ifs, s);
-		getline(ifs, s);
+		lines.next();
+		lines.next();
+		lines.next();
 
 		int daysCount = 0;
 		int allowedDays = Date(31, 12, y, useLeapYears).dayOfYear();
 		//    cout << "tavg\t" << "tmin\t" << "tmax\t" << "wind\t"
 		debug() << "allowedDays: " << allowedDays << " " << y << "\t" << useLeapYears << "\tlatitude:\t" << latitude << endl;
 		//<< "sunhours\t" << "globrad\t" << "precip\t" << "ti\t" << "relhumid\n";
-		while (getline(ifs, s))
+		while (char* line = lines.next())
 		{
-			if(trim(s) == "")
-				continue;
-
 			//Tp_av Tpmin Tpmax T_s10 T_s20 vappd wind sundu radia prec jday RF
-			double td;
-			int ti;
-			double tmin, tmax, tavg, wind, sunhours, globrad, precip, relhumid;
-			istringstream ss(s);
+			double vs[12];
+			if (parseDoubles(line, vs, 12) == 0)
+				continue;
 
-			ss >> tavg >> tmin >> tmax >> td >> td >> td >> wind
-				>> sunhours >> globrad >> precip >> ti >> relhumid;
+			double tavg = vs[0], tmin = vs[1], tmax = vs[2], wind = vs[6];
+			double sunhours = vs[7], globrad = vs[8], precip = vs[9], relhumid = vs[11];
 
 			// test if globrad or sunhours should be used
 			if (globrad >= 0.0)
@@ -522,7 +625,6 @@ Monica::climateDataFromHermesFiles(const std::string& pathToFiles,
 			_wind.push_back(wind);
 			_precip.push_back(precip);
 
-
 			daysCount++;
 			date++;
 		}
@@ -574,14 +676,16 @@ Monica::attachFertiliserApplicationsToCropRotation(std::vector<CultivationMethod
 	ifstream ifs(pathToFile.c_str(), ios::binary);
 	string s;
 
-	std::vector<CultivationMethod>::iterator it = cr.begin();
-	if (it == cr.end())
+	if (cr.empty())
 		return;
 
+	//get data parsed and to use leap years if the crop rotation uses them
+	bool useLeapYears = cr.front().crop()->seedDate().useLeapYears();
+
 	//skip first line
 	getline(ifs, s);
 
-	Date currentEnd = it->endDate();
+	Applications as;
 	while (getline(ifs, s))
 	{
 		if (trim(s) == "end")
@@ -596,8 +700,7 @@ Monica::attachFertiliserApplicationsToCropRotation(std::vector<CultivationMethod
 		istringstream ss(s);
 		ss >> sid >> n >> frt >> sfdate >> incorp;
 
-		//get data parsed and to use leap years if the crop rotation uses them
-		Date fdate = parseDate(sfdate).toDate(it->crop()->seedDate().useLeapYears());
+		Date fdate = parseDate(sfdate).toDate(useLeapYears);
 
 		if (!fdate.isValid())
 		{
@@ -607,29 +710,6 @@ Monica::attachFertiliserApplicationsToCropRotation(std::vector<CultivationMethod
 			exit(-1);
 		}
 
-		//cout << "PP start: " << it->start().toString()
-		//<< " PP end: " << it->end().toString() << endl;
-		//cout << "fdate: " << fdate.toString()
-		//<< " currentEnd: " << currentEnd.toString() << endl;
-
-		//if the currently read fertiliser date is after the current end
-		//of the crop, move as long through the crop rotation as
-		//we find an end date that lies after the currently read fertiliser date
-		while (fdate > currentEnd)
-		{
-			//move to next crop and possibly exit at the end
-			it++;
-			if (it == cr.end())
-				break;
-
-			currentEnd = it->endDate();
-
-			//cout << "new PP start: " << it->start().toString()
-			//<< " new PP end: " << it->end().toString() << endl;
-			//cout << "new currentEnd: " << currentEnd.toString() << endl;
-
-		}
-
 		//which type and id is the current fertiliser
 		auto fertTypeAndId = hermesFertiliserName2monicaFertiliserId(frt);
 		switch (fertTypeAndId.first)
@@ -637,8 +717,8 @@ Monica::attachFertiliserApplicationsToCropRotation(std::vector<CultivationMethod
 		case mineral:
 		{
 			//create mineral fertiliser application
-			const MineralFertiliserParameters& mfp = getMineralFertiliserParametersFromMonicaDB(fertTypeAndId.second);
-			it->addApplication(MineralFertiliserApplication(fdate, mfp, n));
+			MineralFertiliserApplication mfa(fdate, getMineralFertiliserParametersFromMonicaDB(fertTypeAndId.second), n);
+			as.push_back(make_pair(fdate, [=](CultivationMethod& cm){ cm.addApplication(mfa); }));
 			break;
 		}
 		case organic:
@@ -646,7 +726,8 @@ Monica::attachFertiliserApplicationsToCropRotation(std::vector<CultivationMethod
 			//create organic fertiliser application
 			auto omp = getOrganicFertiliserParametersFromMonicaDB(fertTypeAndId.second);
 			//omp->vo_NConcentration = 100.0;
-			it->addApplication(OrganicFertiliserApplication(fdate, omp, n, incorp));
+			OrganicFertiliserApplication ofa(fdate, omp, n, incorp);
+			as.push_back(make_pair(fdate, [=](CultivationMethod& cm){ cm.addApplication(ofa); }));
 			break;
 		}
 		case undefined:
@@ -654,10 +735,11 @@ Monica::attachFertiliserApplicationsToCropRotation(std::vector<CultivationMethod
 			break;
 		}
 		}
-
-		//cout << "----------------------------------" << endl;
 	}
 
+	//the file doesn't have to be sorted by date, so sort the applications
+	//and then move only once through the crop rotation
+	attachDateSortedApplications(cr, as, pathToFile);
 }
 
 //------------------------------------------------------------------------------
@@ -672,14 +754,16 @@ Monica::attachIrrigationApplicationsToCropRotation(std::vector<CultivationMethod
 	}
 	string s;
 
-	std::vector<CultivationMethod>::iterator it = cr.begin();
-	if (it == cr.end())
+	if (cr.empty())
 		return;
 
+	//get data parsed and to use leap years if the crop rotation uses them
+	bool useLeapYears = cr.front().crop()->seedDate().useLeapYears();
+
 	//skip first line
 	getline(ifs, s);
 
-	Date currentEnd = it->endDate();
+	Applications as;
 	while (getline(ifs, s))
 	{
 		if (trim(s) == "end")
@@ -694,8 +778,7 @@ Monica::attachIrrigationApplicationsToCropRotation(std::vector<CultivationMethod
 		istringstream ss(s);
 		ss >> fid >> mm >> scc >> irrDate >> ncc;
 
-		//get data parsed and to use leap years if the crop rotation uses them
-		Date idate = parseDate(irrDate).toDate(it->crop()->seedDate().useLeapYears());
+		Date idate = parseDate(irrDate).toDate(useLeapYears);
 		if (!idate.isValid())
 		{
 			debug() << "Error - Invalid date in \"" << pathToFile.c_str() << "\"" << endl;
@@ -704,33 +787,11 @@ Monica::attachIrrigationApplicationsToCropRotation(std::vector<CultivationMethod
 			exit(-1);
 		}
 
-		//cout << "PP start: " << it->start().toString()
-		//<< " PP end: " << it->end().toString() << endl;
-		//cout << "irrigationDate: " << idate.toString()
-		//<< " currentEnd: " << currentEnd.toString() << endl;
-
-		//if the currently read irrigation date is after the current end
-		//of the crop, move as long through the crop rotation as
-		//we find an end date that lies after the currently read irrigation date
-		while (idate > currentEnd)
-		{
-			//move to next crop and possibly exit at the end
-			it++;
-			if (it == cr.end())
-				break;
-
-			currentEnd = it->endDate();
-
-			//cout << "new PP start: " << it->start().toString()
-			//<< " new PP end: " << it->end().toString() << endl;
-			//cout << "new currentEnd: " << currentEnd.toString() << endl;
-		}
-
-		//finally add the application to the current crops list
-		it->addApplication(IrrigationApplication(idate, mm, IrrigationParameters(ncc, scc)));
-
-		//cout << "----------------------------------" << endl;
+		IrrigationApplication ia(idate, mm, IrrigationParameters(ncc, scc));
+		as.push_back(make_pair(idate, [=](CultivationMethod& cm){ cm.addApplication(ia); }));
 	}
+
+	attachDateSortedApplications(cr, as, pathToFile);
 }
 
 //------------------------------------------------------------------------------
@@ -51,6 +51,8 @@ Errors OId::merge(json11::Json j)
 
 	set_int_value(fromLayer, j, "fromLayer");
 	set_int_value(toLayer, j, "toLayer");
+	set_double_value(fromDepth, j, "fromDepth");
+	set_double_value(toDepth, j, "toDepth");
 
 	return{};
 }
@@ -69,6 +71,8 @@ json11::Json OId::to_json() const
 	,{"organ", int(organ)}
 	,{"fromLayer", fromLayer}
 	,{"toLayer", toLayer}
+	,{"fromDepth", fromDepth}
+	,{"toDepth", toDepth}
 	};
 }
 
@@ -185,6 +189,11 @@ Errors Output::merge(json11::Json j)
 		data.push_back({d["origSpec"].string_value(), toVector<OId>(d["outputIds"]), vs, os});
 	}
 
+	for(const auto& e : j["errors"].array_items())
+		errors.push_back(e.string_value());
+	for(const auto& w : j["warnings"].array_items())
+		warnings.push_back(w.string_value());
+
 	return es;
 }
 
@@ -211,6 +220,8 @@ json11::Json Output::to_json() const
 	{{"type", "Output"}
 	,{"customId", customId}
 	,{"data", ds}
+	,{"errors", J11Array(errors.begin(), errors.end())}
+	,{"warnings", J11Array(warnings.begin(), warnings.end())}
 	};
 }
 
@@ -95,6 +95,9 @@ namespace Monica
 		OP timeAggOp{AVG}; //! aggregate values in a second time range (e.g. monthly)
 		ORGAN organ{_UNDEFINED_ORGAN_};
 		int fromLayer{-1}, toLayer{-1};
+		//! optional layer range given as depths [m], mapped to fromLayer/toLayer
+		//! once the actual (possibly variable thickness) soil layering is known
+		double fromDepth{-1}, toDepth{-1};
 	};
 
 	//---------------------------------------------------------------------------
@@ -120,6 +123,9 @@ namespace Monica
 			std::vector<Tools::J11Object> resultsObj;
 		};
 		std::vector<Data> data;
+
+		//! problems of the run which didn't stop it
+		std::vector<std::string> errors, warnings;
 	};
 }  
 
@@ -16,6 +16,7 @@ Copyright (C) Leibniz Centre for Agricultural Landscape Research (ZALF)
 */
 
 #include <map>
+#include <algorithm>
 #include <sstream>
 #include <iostream>
 #include <fstream>
@@ -133,14 +134,10 @@ bool Workstep::condition(MonicaModel* model)
 		 || _applyNoOfDaysAfterEvent <= 0)
 		return false;
 
-	auto currEvents = model->currentEvents();
-	auto prevEvents = model->previousDaysEvents();
-	
-	auto ceit = currEvents.find(_afterEvent);
 	if(_daysAfterEventCount > 0)
 		_daysAfterEventCount++;
-	else if(ceit != currEvents.end()
-					|| prevEvents.find(_afterEvent) != prevEvents.end())
+	else if(hasEvent(model->currentEvents(), _afterEventId)
+					|| hasEvent(model->previousDaysEvents(), _afterEventId))
 		_daysAfterEventCount = 1;
 
 	return _daysAfterEventCount == _applyNoOfDaysAfterEvent;
@@ -156,6 +153,7 @@ bool Workstep::reinit(Tools::Date date, bool addYear, bool forceInitYear)
 		_absDate = Date();
 
 	_isActive = true;
+	_afterEventId = _afterEvent.empty() ? -1 : eventId(_afterEvent);
 	_daysAfterEventCount = 0;
 
 	return addedYear;
@@ -184,8 +182,16 @@ Errors Sowing::merge(json11::Json j)
 	{
 		_crop->setSeedDate(date());
 		set_int_value(_plantDensity, j, "PlantDensity");
-		if(_plantDensity > 0)
-			_crop->cropParameters()->speciesParams.pc_PlantDensity = _plantDensity;
+		auto cps = _crop->cropParameters();
+		if(_plantDensity > 0 && cps && cps->speciesParams.pc_PlantDensity != _plantDensity)
+		{
+			// the crop parameters are shared, so change a copy, which only this sowing uses
+			auto newCps = make_shared<CropParameters>(*cps);
+			newCps->speciesParams.pc_PlantDensity = _plantDensity;
+			if(_crop->perennialCropParameters() == cps)
+				_crop->setPerennialCropParameters(newCps);
+			_crop->setCropParameters(newCps);
+		}
 	}
 
 	return res;
@@ -1214,21 +1220,119 @@ void CultivationMethod::apply(const Date& date,
 		ws->apply(model);
 }
 
+namespace
+{
+	typedef pair<Date, WSPtr> DatedWorkstep;
+	typedef pair<size_t, WSPtr> IndexedWorkstep;
+
+	bool dateLess(const DatedWorkstep& dws, const Date& date) { return dws.first < date; }
+	bool lessDate(const Date& date, const DatedWorkstep& dws) { return date < dws.first; }
+
+	//! order of the min-heap of waiting dynamic worksteps (earliest date, then position in cultivation method)
+	bool laterEarliestDate(const IndexedWorkstep& l, const IndexedWorkstep& r)
+	{
+		auto led = l.second->absEarliestDate();
+		auto red = r.second->absEarliestDate();
+		return red < led || (led == red && l.first > r.first);
+	}
+
+	bool lessIndex(const IndexedWorkstep& l, const IndexedWorkstep& r) { return l.first < r.first; }
+
+	void insertByIndex(vector<IndexedWorkstep>& wss, const IndexedWorkstep& iws)
+	{
+		wss.insert(upper_bound(wss.begin(), wss.end(), iws, lessIndex), iws);
+	}
+}
+
 void CultivationMethod::absApply(const Date& date,
 																 MonicaModel* model) const
 {
-	for(auto ws : absWorkstepsAt(date))
-		ws->apply(model);
+	auto first = lower_bound(_absSchedule.begin(), _absSchedule.end(), date, dateLess);
+	auto last = upper_bound(first, _absSchedule.end(), date, lessDate);
+	for(; first != last; ++first)
+		first->second->apply(model);
 }
 
 void CultivationMethod::apply(MonicaModel* model) 
 {
-	auto& udws = _unfinishedDynamicWorksteps;
-	udws.erase(remove_if(udws.begin(), udws.end(),
-											 [model](WSPtr wsp)
+	auto currentDate = model->currentStepDate();
+	const auto& currEvents = model->currentEvents();
+
+	auto& adws = _activeDynamicWorksteps;
+
+	//dynamic worksteps which reached their earliest date have to be checked from now on
+	auto& wdws = _waitingDynamicWorksteps;
+	while(!wdws.empty() && !(currentDate < wdws.front().second->absEarliestDate()))
 	{
-		return wsp->applyWithPossibleCondition(model);
-	}), udws.end());
+		pop_heap(wdws.begin(), wdws.end(), laterEarliestDate);
+		insertByIndex(adws, wdws.back());
+		wdws.pop_back();
+	}
+
+	//as well as worksteps whose event happened yesterday or earlier today
+	if(!_eventTriggeredWorksteps.empty())
+	{
+		const auto& prevEvents = model->previousDaysEvents();
+		for(auto it = _eventTriggeredWorksteps.begin(); it != _eventTriggeredWorksteps.end();)
+		{
+			if(hasEvent(currEvents, it->first) || hasEvent(prevEvents, it->first))
+			{
+				for(const auto& iws : it->second)
+					insertByIndex(adws, iws);
+				it = _eventTriggeredWorksteps.erase(it);
+			}
+			else
+				++it;
+		}
+	}
+
+	if(adws.empty())
+		return;
+
+	EventSet seenEvents = currEvents;
+	vector<IndexedWorkstep> unfinished;
+	for(size_t i = 0; i < adws.size(); i++)
+	{
+		auto iws = adws[i];
+		if(!iws.second->applyWithPossibleCondition(model))
+			unfinished.push_back(iws);
+
+		//an applied workstep can trigger the event of a workstep further down the cultivation method,
+		//which then will be checked still today, the ones before will notice the event tomorrow
+		if(currEvents != seenEvents)
+		{
+			auto newEvents = currEvents & ~seenEvents;
+			seenEvents = currEvents;
+			for(auto& p : _eventTriggeredWorksteps)
+			{
+				if(!hasEvent(newEvents, p.first))
+					continue;
+
+				auto& wss = p.second;
+				auto split = upper_bound(wss.begin(), wss.end(), iws, lessIndex);
+				for(auto it = split; it != wss.end(); ++it)
+					insertByIndex(adws, *it);
+				wss.erase(split, wss.end());
+			}
+			for(auto it = _eventTriggeredWorksteps.begin(); it != _eventTriggeredWorksteps.end();)
+				it = it->second.empty() ? _eventTriggeredWorksteps.erase(it) : ++it;
+		}
+	}
+	adws.swap(unfinished);
+}
+
+vector<WSPtr> CultivationMethod::unfinishedDynamicWorksteps() const
+{
+	vector<IndexedWorkstep> iwss(_activeDynamicWorksteps);
+	iwss.insert(iwss.end(), _waitingDynamicWorksteps.begin(), _waitingDynamicWorksteps.end());
+	for(const auto& p : _eventTriggeredWorksteps)
+		iwss.insert(iwss.end(), p.second.begin(), p.second.end());
+	sort(iwss.begin(), iwss.end(), lessIndex);
+
+	vector<WSPtr> wss;
+	for(const auto& iws : iwss)
+		wss.push_back(iws.second);
+	return wss;
 }
 
 Date CultivationMethod::nextDate(const Date& date) const
@@ -1246,15 +1350,8 @@ Date CultivationMethod::nextDate(const Date& date) const
 
 Date CultivationMethod::nextAbsDate(const Date& date) const
 {
-	//auto ci = _allAbsWorksteps.upper_bound(date);
-	//return ci != _allAbsWorksteps.end() ? ci->first : Date();
-	for(auto ws : _allAbsWorksteps)
-	{
-		auto ad = ws->absDate();
-		if(ad.isValid() && ad > date)
-			return ad;
-	}
-	return Date();
+	auto ci = upper_bound(_absSchedule.begin(), _absSchedule.end(), date, lessDate);
+	return ci != _absSchedule.end() ? ci->first : Date();
 }
 
 
@@ -1277,15 +1374,13 @@ vector<WSPtr> CultivationMethod::workstepsAt(const Date& date) const
 vector<WSPtr> CultivationMethod::absWorkstepsAt(const Date& date) const
 {
 	vector<WSPtr> apps;
-	//auto p = _allAbsWorksteps.equal_range(date);
-	//while(p.first != p.second)
-	//{
-	//	apps.push_back(p.first->second);
-	//	p.first++;
-	//}
-	for(auto ws : _allAbsWorksteps)
-		if(ws->absDate().isValid() && ws->absDate() == date)
-			apps.push_back(ws);
+	if(!date.isValid())
+		return apps;
+
+	auto first = lower_bound(_absSchedule.begin(), _absSchedule.end(), date, dateLess);
+	auto last = upper_bound(first, _absSchedule.end(), date, lessDate);
+	for(; first != last; ++first)
+		apps.push_back(first->second);
 
 	return apps;
 }
@@ -1517,22 +1612,81 @@ std::string CultivationMethod::toString() const
 	return s.str();
 }
 
+CultivationMethod CultivationMethod::deepCopy() const
+{
+	CultivationMethod cm(*this);
+
+	map<const Crop*, CropPtr> crop2copy;
+	auto copyOf = [&](CropPtr crop)
+	{
+		if(!crop)
+			return crop;
+		auto& c = crop2copy[crop.get()];
+		if(!c)
+			c = make_shared<Crop>(*crop);
+		return c;
+	};
+	cm._crop = copyOf(_crop);
+
+	map<const Workstep*, WSPtr> ws2copy;
+	cm._allWorksteps.clear();
+	for(auto ws : _allWorksteps)
+	{
+		WSPtr c(ws->clone());
+		if(auto sowing = dynamic_pointer_cast<Sowing>(c))
+			sowing->setCrop(copyOf(sowing->crop()));
+		else if(auto harvest = dynamic_pointer_cast<Harvest>(c))
+			harvest->setCrop(copyOf(harvest->crop()));
+		ws2copy[ws.get()] = c;
+		cm._allWorksteps.push_back(c);
+	}
+
+	//the current schedule has to refer to the copied worksteps
+	for(auto& ws : cm._allAbsWorksteps)
+		ws = ws2copy[ws.get()];
+	for(auto& p : cm._absSchedule)
+		p.second = ws2copy[p.second.get()];
+	for(auto& p : cm._activeDynamicWorksteps)
+		p.second = ws2copy[p.second.get()];
+	for(auto& p : cm._waitingDynamicWorksteps)
+		p.second = ws2copy[p.second.get()];
+	for(auto& p : cm._eventTriggeredWorksteps)
+		for(auto& p2 : p.second)
+			p2.second = ws2copy[p2.second.get()];
+
+	return cm;
+}
+
 bool CultivationMethod::reinit(Tools::Date date, bool forceInitYear)
 {
 	_allAbsWorksteps.clear();
-	_unfinishedDynamicWorksteps.clear();
+	_absSchedule.clear();
+	_activeDynamicWorksteps.clear();
+	_waitingDynamicWorksteps.clear();
+	_eventTriggeredWorksteps.clear();
 	bool addedYear = false;
 	//for(auto p : _allWorksteps)
-	for(auto ws : _allWorksteps)
+	for(size_t i = 0, size = _allWorksteps.size(); i < size; i++)
 	{
-		//auto ws = p.second;
+		auto ws = _allWorksteps[i];
 		addedYear = ws->reinit(date, addedYear, forceInitYear) || addedYear;
 		//_allAbsWorksteps.insert(make_pair(ws->absDate(), p.second));
 		_allAbsWorksteps.push_back(ws);
-		if(!ws->absDate().isValid())
-			//_unfinishedDynamicWorksteps.push_back(p.second);
-			_unfinishedDynamicWorksteps.push_back(ws);
+
+		//sort the worksteps into the schedule for this run through the crop rotation
+		auto ad = ws->absDate();
+		if(ad.isValid())
+			_absSchedule.push_back(make_pair(ad, ws));
+		else if(!ws->triggeringEvent().empty())
+			_eventTriggeredWorksteps[eventId(ws->triggeringEvent())].push_back(make_pair(i, ws));
+		else if(ws->absEarliestDate().isValid())
+			_waitingDynamicWorksteps.push_back(make_pair(i, ws));
+		else
+			_activeDynamicWorksteps.push_back(make_pair(i, ws));
 	}
+	stable_sort(_absSchedule.begin(), _absSchedule.end(),
+							[](const DatedWorkstep& l, const DatedWorkstep& r) { return l.first < r.first; });
+	make_heap(_waitingDynamicWorksteps.begin(), _waitingDynamicWorksteps.end(), laterEarliestDate);
 
 	return addedYear;
 }
@@ -89,6 +89,10 @@ namespace Monica
 
 		virtual bool isDynamicWorkstep() const { return !_date.isValid(); }
 
+		//! the event a dynamic workstep waits for, before its condition can be met
+		//! (empty if the condition doesn't depend on an event)
+		virtual std::string triggeringEvent() const { return _afterEvent; }
+
 		//! tell if this workstep is active and can be used 
 		//! a workstep might temporarily be deactivated, eg a dynamic sowing workstep
 		//! which has to be checked for sowing every day, but not anymore after sowing
@@ -102,6 +106,7 @@ namespace Monica
 		Tools::Date _absDate;
 		int _applyNoOfDaysAfterEvent{0};
 		std::string _afterEvent;
+		int _afterEventId{-1}; //!< interned _afterEvent, set by reinit
 		int _daysAfterEventCount{0};
 		bool _isActive{true};
 	};
@@ -138,6 +143,7 @@ namespace Monica
     }
 
     CropPtr crop() const { return _crop; }
+		void setCrop(CropPtr c) { _crop = c; }
 
   private:
     CropPtr _crop;
@@ -169,6 +175,8 @@ namespace Monica
 
 		virtual bool isActive() const { return !_cropSeeded; }
 
+		virtual std::string triggeringEvent() const { return std::string(); }
+
 		virtual bool reinit(Tools::Date date, bool addYear = false, bool forceInitYear = false);
 
 		virtual Tools::Date earliestDate() const { return _earliestDate; }
@@ -287,6 +295,8 @@ namespace Monica
 
 		virtual bool isActive() const { return !_cropHarvested; }
 
+		virtual std::string triggeringEvent() const { return std::string(); }
+
 		virtual bool reinit(Tools::Date date, bool addYear = false, bool forceInitYear = false);
 
 		virtual Tools::Date latestDate() const { return _latestDate; }
@@ -396,6 +406,8 @@ namespace Monica
 
 		virtual bool isActive() const { return !_appliedFertilizer; }
 
+		virtual std::string triggeringEvent() const { return std::string(); }
+
 		virtual bool reinit(Tools::Date date, bool addYear = false, bool forceInitYear = false);
 
 	private:
@@ -574,9 +586,14 @@ namespace Monica
 
 		std::vector<WSPtr> allDynamicWorksteps() const;
 
-		std::vector<WSPtr> unfinishedDynamicWorksteps() const { return _unfinishedDynamicWorksteps; }
+		std::vector<WSPtr> unfinishedDynamicWorksteps() const;
 
-		bool allDynamicWorkstepsFinished() const { return _unfinishedDynamicWorksteps.empty(); }
+		bool allDynamicWorkstepsFinished() const
+		{
+			return _activeDynamicWorksteps.empty()
+				&& _waitingDynamicWorksteps.empty()
+				&& _eventTriggeredWorksteps.empty();
+		}
 
 		std::string name() const { return _name; }
 
@@ -612,6 +629,10 @@ namespace Monica
     void setIrrigateCrop(bool irr){ _irrigateCrop = irr; }
     bool irrigateCrop() const { return _irrigateCrop; }
 
+		//! a copy with its own worksteps and crop, so simulating it leaves this one untouched
+		//! (the crop's parameters are still shared, they are read-only)
+		CultivationMethod deepCopy() const;
+
 		//! reinit cultivation method to initial state, if it will be reused (eg in a crop rotation)
 		//! returns if it was necessary to add a year to shift relative dates after date
 		bool reinit(Tools::Date date, bool forceInitYear = false);
@@ -627,7 +648,17 @@ namespace Monica
 		std::vector<WSPtr> _allAbsWorksteps;
 		//std::multimap<Tools::Date, WSPtr> _allWorksteps;
 		//std::multimap<Tools::Date, WSPtr> _allAbsWorksteps;
-		std::vector<WSPtr> _unfinishedDynamicWorksteps;
+
+		//! the schedule of the current run through the crop rotation, built by reinit
+		//! worksteps with an absolute date, sorted by that date
+		std::vector<std::pair<Tools::Date, WSPtr>> _absSchedule;
+		//! unfinished dynamic worksteps which are checked every day,
+		//! kept in the order of the cultivation method (the index into _allWorksteps)
+		std::vector<std::pair<std::size_t, WSPtr>> _activeDynamicWorksteps;
+		//! min-heap of dynamic worksteps (by absEarliestDate), which can't be applied before that date
+		std::vector<std::pair<std::size_t, WSPtr>> _waitingDynamicWorksteps;
+		//! dynamic worksteps waiting for the (id of the) event they are triggered by
+		std::map<int, std::vector<std::pair<std::size_t, WSPtr>>> _eventTriggeredWorksteps;
     int _customId{0};
 		std::string _name;
 		CropPtr _crop;
@@ -37,10 +37,26 @@ using namespace Climate;
 
 Env Monica::createEnvFromJsonConfigFiles(std::map<std::string, std::string> params)
 {
-	Env env;
-	if(!printPossibleErrors(env.merge(createEnvJsonFromJsonStrings(params)), activateDebug))
-		return Env();
-	return env;
+	return createEnvsFromJsonConfigFiles({params}).front();
+}
+
+vector<Env> Monica::createEnvsFromJsonConfigFiles(const vector<map<string, string>>& paramsList)
+{
+	vector<Env> envs;
+	for(const auto& envj : createEnvJsonsFromJsonStrings(paramsList, false))
+	{
+		// the climate data don't take the detour via JSON, but are read directly
+		Env env;
+		if(!printPossibleErrors(env.merge(envj), activateDebug))
+		{
+			envs.push_back(Env());
+			continue;
+		}
+		if(!env.pathsToClimateCSV.empty())
+			env.climateData = readClimateDataFromCSVFilesViaHeaders(env.pathsToClimateCSV, env.csvViaHeaderOptions);
+		envs.push_back(env);
+	}
+	return envs;
 }
 
 //-----------------------------------------------------------------------------
@@ -17,6 +17,8 @@ Copyright (C) Leibniz Centre for Agricultural Landscape Research (ZALF)
 #define MONICA_ENV_FROM_JSON_CONFIG_H
 
 #include <string>
+#include <vector>
+#include <map>
 
 #include "tools/date.h"
 #include "run-monica.h"
@@ -27,6 +29,9 @@ Copyright (C) Leibniz Centre for Agricultural Landscape Research (ZALF)
 namespace Monica
 {
 	Env createEnvFromJsonConfigFiles(std::map<std::string, std::string> params);
+
+	//! create the Envs of a batch run, the references of all of them are resolved in one pass
+	std::vector<Env> createEnvsFromJsonConfigFiles(const std::vector<std::map<std::string, std::string>>& paramsList);
 }
 
 #endif //MONICA_ENV_FROM_JSON_CONFIG_H
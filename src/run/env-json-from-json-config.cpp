@@ -17,6 +17,10 @@ Copyright (C) Leibniz Centre for Agricultural Landscape Research (ZALF)
 #include <fstream>
 #include <string>
 #include <set>
+#include <mutex>
+
+#include <sys/types.h>
+#include <sys/stat.h>
 
 #include "env-json-from-json-config.h"
 #include "tools/debug.h"
@@ -28,6 +32,7 @@ Copyright (C) Leibniz Centre for Agricultural Landscape Research (ZALF)
 #include "soil/conversion.h"
 #include "soil/soil-from-db.h"
 #include "../io/output.h"
+#include "env-stream-reader.h"
 
 using namespace std;
 using namespace Monica;
@@ -39,116 +44,215 @@ using namespace Climate;
 
 const map<string, function<EResult<Json>(const Json&, const Json&)>>& supportedPatterns();
 
-EResult<Json> Monica::findAndReplaceReferences(const Json& root, const Json& j)
+namespace
 {
-	auto sp = supportedPatterns();
+	//! state of resolving the references of a batch of JSON documents
+	struct ResolveContext
+	{
+		//! results of function invocations which don't depend on the current root,
+		//! keyed by include-file-base-path and the function with its resolved arguments,
+		//! these are shared between all roots in the batch
+		map<string, EResult<Json>> sharedResults;
 
-	//auto jstr = j.dump();
-	bool success = true;
-	vector<string> errors;
+		//! resolved ["ref", key1, key2] of the current root
+		map<pair<string, string>, EResult<Json>> refs;
+	};
 
-	if(j.is_array() && j.array_items().size() > 0)
+	//! resolve the references in j, subtrees without references are returned as they are (shared),
+	//! changed is set if the result isn't j itself, rootDependent if a "ref" had to be resolved
+	EResult<Json> resolve(ResolveContext& ctx,
+												const Json& root,
+												const Json& j,
+												bool& changed,
+												bool& rootDependent)
 	{
-		J11Array arr;
+		const auto& sp = supportedPatterns();
+
+		vector<string> errors;
+		auto appendErrors = [&](const EResult<Json>& r)
+		{
+			errors.insert(errors.end(), r.errors.begin(), r.errors.end());
+		};
 
-		bool arrayIsReferenceFunction = false;
-		if(j[0].is_string())
+		if(j.is_array() && j.array_items().size() > 0)
 		{
-			auto p = sp.find(j[0].string_value());
+			const auto& items = j.array_items();
+
+			auto p = items[0].is_string() ? sp.find(items[0].string_value()) : sp.end();
 			if(p != sp.end())
 			{
-				arrayIsReferenceFunction = true;
+				changed = true;
+				bool isRef = p->first == "ref";
 
 				//check for nested function invocations in the arguments
+				bool argsRootDependent = false;
 				J11Array funcArr;
-				for(auto i : j.array_items())
+				funcArr.reserve(items.size());
+				for(const auto& i : items)
 				{
-					auto r = findAndReplaceReferences(root, i);
-					success = success && r.success();
-					if(!r.success())
-						for(auto e : r.errors)
-							errors.push_back(e);
+					bool c = false;
+					auto r = resolve(ctx, root, i, c, argsRootDependent);
+					appendErrors(r);
 					funcArr.push_back(r.result);
 				}
+				Json func(funcArr);
+				rootDependent = rootDependent || isRef || argsRootDependent;
+
+				pair<string, string> refKey;
+				string sharedKey;
+				if(isRef)
+				{
+					if(funcArr.size() == 3 && funcArr[1].is_string() && funcArr[2].is_string())
+					{
+						refKey = make_pair(funcArr[1].string_value(), funcArr[2].string_value());
+						auto it = ctx.refs.find(refKey);
+						if(it != ctx.refs.end())
+							return it->second;
+					}
+				}
+				else if(!argsRootDependent)
+				{
+					sharedKey = string_valueD(root, "include-file-base-path", ".") + "|" + func.dump();
+					auto it = ctx.sharedResults.find(sharedKey);
+					if(it != ctx.sharedResults.end())
+						return it->second;
+				}
 
 				//invoke function
-				auto jaes = (p->second)(root, funcArr);
+				auto jaes = (p->second)(root, func);
+				appendErrors(jaes);
 
-				success = success && jaes.success();
+				//if successful try to recurse into result for functions in result
 				if(!jaes.success())
-					for(auto e : jaes.errors)
-						errors.push_back(e);
+					return{J11Object(), errors};
 
-				//if successful try to recurse into result for functions in result
-				if(jaes.success())
+				bool c = false, resultRootDependent = false;
+				auto r = resolve(ctx, root, jaes.result, c, resultRootDependent);
+				appendErrors(r);
+				rootDependent = rootDependent || resultRootDependent;
+
+				EResult<Json> res{r.result, errors};
+				if(errors.empty())
 				{
-					auto r = findAndReplaceReferences(root, jaes.result);
-					success = success && r.success();
-					if(!r.success())
-						for(auto e : r.errors)
-							errors.push_back(e);
-					return{r.result, errors};
+					if(isRef)
+						ctx.refs[refKey] = res;
+					else if(!argsRootDependent && !resultRootDependent)
+						ctx.sharedResults[sharedKey] = res;
 				}
-				else
-					return{J11Object(), errors};
+				return res;
 			}
-		}
 
-		if(!arrayIsReferenceFunction)
-			for(auto jv : j.array_items())
+			//copy the array only if one of the elements changed
+			J11Array arr;
+			bool anyChanged = false;
+			for(size_t i = 0, size = items.size(); i < size; i++)
 			{
-				auto r = findAndReplaceReferences(root, jv);
-				success = success && r.success();
-				if(!r.success())
-					for(auto e : r.errors)
-						errors.push_back(e);
-				arr.push_back(r.result);
+				bool c = false;
+				auto r = resolve(ctx, root, items[i], c, rootDependent);
+				appendErrors(r);
+				if(c && !anyChanged)
+				{
+					arr.reserve(size);
+					arr.assign(items.begin(), items.begin() + i);
+					anyChanged = true;
+				}
+				if(anyChanged)
+					arr.push_back(r.result);
 			}
 
-		return{arr, errors};
+			if(!anyChanged)
+				return{j, errors};
+
+			changed = true;
+			return{arr, errors};
+		}
+		else if(j.is_object())
+		{
+			//copy the object only if one of the values changed
+			J11Object obj;
+			bool anyChanged = false;
+			for(const auto& p : j.object_items())
+			{
+				bool c = false;
+				auto r = resolve(ctx, root, p.second, c, rootDependent);
+				appendErrors(r);
+				if(c)
+				{
+					if(!anyChanged)
+						obj = j.object_items();
+					anyChanged = true;
+					obj[p.first] = r.result;
+				}
+			}
+
+			if(!anyChanged)
+				return{j, errors};
+
+			changed = true;
+			return{obj, errors};
+		}
+
+		return{j, errors};
 	}
-	else if(j.is_object())
+
+	//! read and parse a JSON file only once per process (or when it changed on disk)
+	EResult<Json> readAndParseJsonFileCached(const string& pathToFile)
 	{
-		J11Object obj;
+		static mutex lockable;
+		static map<string, pair<time_t, EResult<Json>>> cache;
 
-		for(auto p : j.object_items())
+		struct stat st;
+		time_t mtime = stat(pathToFile.c_str(), &st) == 0 ? st.st_mtime : 0;
+		if(mtime != 0)
 		{
-			auto r = findAndReplaceReferences(root, p.second);
-			success = success && r.success();
-			if(!r.success())
-				for(auto e : r.errors)
-					errors.push_back(e);
-			obj[p.first] = r.result;
+			lock_guard<mutex> lock(lockable);
+			auto it = cache.find(pathToFile);
+			if(it != cache.end() && it->second.first == mtime)
+				return it->second.second;
 		}
 
-		return{obj, errors};
+		auto jo = readAndParseJsonFile(pathToFile);
+		if(mtime != 0 && jo.success())
+		{
+			lock_guard<mutex> lock(lockable);
+			cache[pathToFile] = make_pair(mtime, jo);
+		}
+		return jo;
 	}
+}
+
+EResult<Json> Monica::findAndReplaceReferences(const Json& root, const Json& j)
+{
+	ResolveContext ctx;
+	bool changed = false, rootDependent = false;
+	return resolve(ctx, root, j, changed, rootDependent);
+}
 
-	return{j, errors};
+vector<EResult<Json>> Monica::findAndReplaceReferences(const vector<Json>& roots)
+{
+	ResolveContext ctx;
+	vector<EResult<Json>> res;
+	res.reserve(roots.size());
+	for(const auto& root : roots)
+	{
+		ctx.refs.clear();
+		bool changed = false, rootDependent = false;
+		res.push_back(resolve(ctx, root, root, changed, rootDependent));
+	}
+	return res;
 }
 
 //-----------------------------------------------------------------------------
 
 const map<string, function<EResult<Json>(const Json&, const Json&)>>& supportedPatterns()
 {
+	//the referenced value will be resolved (and cached per root) by the caller
 	auto ref = [](const Json& root, const Json& j) -> EResult<Json>
 	{
-		static map<pair<string, string>, EResult<Json>> cache;
 		if(j.array_items().size() == 3
 			 && j[1].is_string()
 			 && j[2].is_string())
-		{
-			string key1 = j[1].string_value();
-			string key2 = j[2].string_value();
-
-			auto it = cache.find(make_pair(key1, key2));
-			if(it != cache.end())
-				return it->second;
-			
-			auto res = findAndReplaceReferences(root, root[key1][key2]);
-			cache[make_pair(key1, key2)] = res;
-			return res;
-		}
+			return{root[j[1].string_value()][j[2].string_value()]};
 		return{j, string("Couldn't resolve reference: ") + j.dump() + "!"};
 	};
 
@@ -311,7 +415,7 @@ const map<string, function<EResult<Json>(const Json&, const Json&)>>& supportedP
 				pathToFile = basePath + "/" + pathToFile;
 			pathToFile = replaceEnvVars(pathToFile);
 			pathToFile = fixSystemSeparator(pathToFile);
-			auto jo = readAndParseJsonFile(pathToFile);
+			auto jo = readAndParseJsonFileCached(pathToFile);
 			if(jo.success() && !jo.result.is_null())
 				return{jo.result};
 			
@@ -415,99 +519,173 @@ const map<string, function<EResult<Json>(const Json&, const Json&)>>& supportedP
 
 //-----------------------------------------------------------------------------
 
-Json Monica::createEnvJsonFromJsonStrings(std::map<std::string, std::string> params)
+Json Monica::createEnvJsonFromJsonStrings(std::map<std::string, std::string> params,
+																					bool includeClimateData)
 {
-	map<string, Json> ps;
-	for(const auto& p : map<string, string>({{"crop-json-str", "crop"}, {"site-json-str", "site"}, {"sim-json-str", "sim"}}))
-		ps[p.second] = printPossibleErrors(parseJsonString(params[p.first]));
-
-	return createEnvJsonFromJsonObjects(ps);
+	return createEnvJsonsFromJsonStrings({params}, includeClimateData).front();
 }
 
-Json Monica::createEnvJsonFromJsonObjects(std::map<std::string, json11::Json> params)
+vector<Json> Monica::createEnvJsonsFromJsonStrings(const vector<map<string, string>>& paramsList,
+																									 bool includeClimateData)
 {
-	vector<Json> cropSiteSim;
-	for(auto name : {"crop", "site", "sim"})
-		cropSiteSim.push_back(params[name]);
+	vector<map<string, Json>> psList;
+	for(const auto& params : paramsList)
+	{
+		map<string, Json> ps;
+		for(const auto& p : map<string, string>({{"crop-json-str", "crop"}, {"site-json-str", "site"}, {"sim-json-str", "sim"}}))
+		{
+			auto it = params.find(p.first);
+			ps[p.second] = printPossibleErrors(parseJsonString(it == params.end() ? string() : it->second));
+		}
+		psList.push_back(ps);
+	}
 
-	for(auto& j : cropSiteSim)
-		if(j.is_null())
-			return Json();
+	return createEnvJsonsFromJsonObjects(psList, includeClimateData);
+}
 
-	string pathToParameters = cropSiteSim.at(2)["include-file-base-path"].string_value();
+Json Monica::createEnvJsonFromJsonObjects(std::map<std::string, json11::Json> params,
+																					bool includeClimateData)
+{
+	return createEnvJsonsFromJsonObjects({params}, includeClimateData).front();
+}
 
-	auto addBasePath = [&](Json& j, string basePath)
+namespace
+{
+	//! assemble the Env JSON from the resolved crop, site and sim JSON objects
+	Json envJsonFromCropSiteSim(const Json& cropj,
+															const Json& sitej,
+															const Json& simj,
+															bool includeClimateData)
+	{
+		J11Object env;
+		env["type"] = "Env";
+
+		//store debug mode in env, take from sim.json, but prefer params map
+		env["debugMode"] = simj["debug?"].bool_value();
+
+		J11Object cpp = {
+				{"type", "CentralParameterProvider"}
+			, {"userCropParameters", cropj["CropParameters"]}
+			, {"userEnvironmentParameters", sitej["EnvironmentParameters"]}
+			, {"userSoilMoistureParameters", sitej["SoilMoistureParameters"]}
+			, {"userSoilTemperatureParameters", sitej["SoilTemperatureParameters"]}
+			, {"userSoilTransportParameters", sitej["SoilTransportParameters"]}
+			, {"userSoilOrganicParameters", sitej["SoilOrganicParameters"]}
+			, {"simulationParameters", simj}
+			, {"siteParameters", sitej["SiteParameters"]}
+		};
+
+		env["params"] = cpp;
+		env["cropRotation"] = cropj["cropRotation"];
+		env["cropRotations"] = cropj["cropRotations"];
+		env["events"] = simj["output"]["events"];
+		env["outputs"] = simj["output"];
+
+		env["pathToClimateCSV"] = simj["climate.csv"];
+		auto csvos = simj["climate.csv-options"].object_items();
+		csvos["latitude"] = double_valueD(sitej["SiteParameters"], "Latitude", 0.0);
+		env["csvViaHeaderOptions"] = csvos;
+
+		// without the climate data the Env just references the CSV files,
+		// they are read straight into the DataAccessor by the user of the Env
+		if(!includeClimateData)
+			return env;
+
+		// as columns, which the receiver can read without a JSON DOM (see readEnvFromJsonString)
+		if(simj["climate.csv"].is_string() && !simj["climate.csv"].string_value().empty())
+			env["climateColumns"] = climateColumnsJson(readClimateDataFromCSVFileViaHeaders(simj["climate.csv"].string_value(),
+																																											env["csvViaHeaderOptions"]));
+		else if(simj["climate.csv"].is_array() && !simj["climate.csv"].array_items().empty())
+			env["climateColumns"] = climateColumnsJson(readClimateDataFromCSVFilesViaHeaders(toStringVector(simj["climate.csv"].array_items()),
+																																											 env["csvViaHeaderOptions"]));
+
+		return env;
+	}
+}
+
+vector<Json> Monica::createEnvJsonsFromJsonObjects(const vector<map<string, Json>>& paramsList,
+																									 bool includeClimateData)
+{
+	//collect crop, site and sim of all Envs, to resolve their references in one pass
+	vector<Json> roots;
+	vector<bool> valid;
+	for(const auto& params : paramsList)
 	{
-		string err;
-		if(!j.has_shape({{"include-file-base-path", Json::STRING}}, err))
+		vector<Json> cropSiteSim;
+		for(auto name : {"crop", "site", "sim"})
 		{
-			auto m = j.object_items();
-			m["include-file-base-path"] = pathToParameters;
-			j = m;
+			auto it = params.find(name);
+			cropSiteSim.push_back(it == params.end() ? Json() : it->second);
 		}
-	};
 
-	vector<Json> cropSiteSim2;
-	//collect all errors in all files and don't stop as early as possible
-	set<string> errors;
-	for(auto& j : cropSiteSim)
-	{
-		addBasePath(j, pathToParameters);
-		auto r = findAndReplaceReferences(j, j);
-		if(r.success())
-			cropSiteSim2.push_back(r.result);
-		else
-			errors.insert(r.errors.begin(), r.errors.end());
+		bool isValid = true;
+		for(const auto& j : cropSiteSim)
+			isValid = isValid && !j.is_null();
+		valid.push_back(isValid);
+		if(!isValid)
+			continue;
+
+		string pathToParameters = cropSiteSim.at(2)["include-file-base-path"].string_value();
+
+		auto addBasePath = [&](Json& j, string basePath)
+		{
+			string err;
+			if(!j.has_shape({{"include-file-base-path", Json::STRING}}, err))
+			{
+				auto m = j.object_items();
+				m["include-file-base-path"] = pathToParameters;
+				j = m;
+			}
+		};
+
+		for(auto& j : cropSiteSim)
+		{
+			addBasePath(j, pathToParameters);
+			roots.push_back(j);
+		}
 	}
 
-	if(!errors.empty())
+	auto resolved = findAndReplaceReferences(roots);
+
+	vector<Json> envs;
+	envs.reserve(paramsList.size());
+	size_t ri = 0;
+	for(bool isValid : valid)
 	{
-		for(auto e : errors)
-			cerr << e << endl;
-		return Json();
-	}
+		if(!isValid)
+		{
+			envs.push_back(Json());
+			continue;
+		}
 
-	auto cropj = cropSiteSim2.at(0);
-	auto sitej = cropSiteSim2.at(1);
-	auto simj = cropSiteSim2.at(2);
-
-	J11Object env;
-	env["type"] = "Env";
-
-	//store debug mode in env, take from sim.json, but prefer params map
-	env["debugMode"] = simj["debug?"].bool_value();
-
-	J11Object cpp = {
-			{"type", "CentralParameterProvider"}
-		, {"userCropParameters", cropj["CropParameters"]}
-		, {"userEnvironmentParameters", sitej["EnvironmentParameters"]}
-		, {"userSoilMoistureParameters", sitej["SoilMoistureParameters"]}
-		, {"userSoilTemperatureParameters", sitej["SoilTemperatureParameters"]}
-		, {"userSoilTransportParameters", sitej["SoilTransportParameters"]}
-		, {"userSoilOrganicParameters", sitej["SoilOrganicParameters"]}
-		, {"simulationParameters", simj}
-		, {"siteParameters", sitej["SiteParameters"]}
-	};
+		vector<Json> cropSiteSim2;
+		//collect all errors in all files and don't stop as early as possible
+		set<string> errors;
+		for(int i = 0; i < 3; i++)
+		{
+			const auto& r = resolved.at(ri++);
+			if(r.success())
+				cropSiteSim2.push_back(r.result);
+			else
+				errors.insert(r.errors.begin(), r.errors.end());
+		}
+
+		if(!errors.empty())
+		{
+			for(auto e : errors)
+				cerr << e << endl;
+			envs.push_back(Json());
+			continue;
+		}
 
-	env["params"] = cpp;
-	env["cropRotation"] = cropj["cropRotation"];
-	env["cropRotations"] = cropj["cropRotations"];
-	env["events"] = simj["output"]["events"];
-	env["outputs"] = simj["output"];
-
-	env["pathToClimateCSV"] = simj["climate.csv"];
-	auto csvos = simj["climate.csv-options"].object_items();
-	csvos["latitude"] = double_valueD(sitej["SiteParameters"], "Latitude", 0.0);
-	env["csvViaHeaderOptions"] = csvos;
-		
-	if(simj["climate.csv"].is_string() && !simj["climate.csv"].string_value().empty())
-		env["climateData"] = readClimateDataFromCSVFileViaHeaders(simj["climate.csv"].string_value(),
-																															env["csvViaHeaderOptions"]);
-	else if(simj["climate.csv"].is_array() && !simj["climate.csv"].array_items().empty())
-		env["climateData"] = readClimateDataFromCSVFilesViaHeaders(toStringVector(simj["climate.csv"].array_items()),
-																															 env["csvViaHeaderOptions"]);
-
-	return env;
+		envs.push_back(envJsonFromCropSiteSim(cropSiteSim2.at(0),
+																					cropSiteSim2.at(1),
+																					cropSiteSim2.at(2),
+																					includeClimateData));
+	}
+
+	return envs;
 }
 
 
+
@@ -17,6 +17,8 @@ Copyright (C) Leibniz Centre for Agricultural Landscape Research (ZALF)
 #define MONICA_ENV_JSON_FROM_JSON_CONFIG_H
 
 #include <string>
+#include <vector>
+#include <map>
 
 #include "tools/date.h"
 #include "run-monica.h"
@@ -28,9 +30,26 @@ namespace Monica
 	Tools::EResult<json11::Json> findAndReplaceReferences(const json11::Json& root, 
 																												const json11::Json& j);
 
-	json11::Json createEnvJsonFromJsonStrings(std::map<std::string, std::string> params);
+	//! resolve the references of a batch of JSON documents (each against itself) in one pass,
+	//! the results of included files and other root independent functions are shared between them
+	std::vector<Tools::EResult<json11::Json>> findAndReplaceReferences(const std::vector<json11::Json>& roots);
 
-	json11::Json createEnvJsonFromJsonObjects(std::map<std::string, json11::Json> params);
+	//! create the JSON representation of an Env, if includeClimateData is false
+	//! the climate data are only referenced by the paths to the CSV files
+	json11::Json createEnvJsonFromJsonStrings(std::map<std::string, std::string> params,
+																						bool includeClimateData = true);
+
+	json11::Json createEnvJsonFromJsonObjects(std::map<std::string, json11::Json> params,
+																						bool includeClimateData = true);
+
+	//! create the Envs for many crop/site/sim parameter maps, resolving their references in one pass
+	std::vector<json11::Json>
+	createEnvJsonsFromJsonObjects(const std::vector<std::map<std::string, json11::Json>>& paramsList,
+																bool includeClimateData = true);
+
+	std::vector<json11::Json>
+	createEnvJsonsFromJsonStrings(const std::vector<std::map<std::string, std::string>>& paramsList,
+																bool includeClimateData = true);
 }
 
 #endif //MONICA_ENV_FROM_JSON_H
@@ -0,0 +1,349 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/*
+Authors:
+Michael Berg <michael.berg@zalf.de>
+
+Maintainers:
+Currently maintained by the authors.
+
+This file is part of the MONICA model.
+Copyright (C) Leibniz Centre for Agricultural Landscape Research (ZALF)
+*/
+
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+#include "env-stream-reader.h"
+#include "tools/date.h"
+
+using namespace std;
+using namespace Monica;
+using namespace Tools;
+using namespace json11;
+using namespace Climate;
+
+const map<string, ACD>& Monica::climateColumnNames()
+{
+	static const map<string, ACD> names =
+	{{"tmin", tmin}
+	,{"tavg", tavg}
+	,{"tmax", tmax}
+	,{"precip", precip}
+	,{"globrad", globrad}
+	,{"wind", wind}
+	,{"sunhours", sunhours}
+	,{"relhumid", relhumid}
+	,{"co2", co2}
+	,{"o3", o3}
+	,{"et0", et0}
+	};
+	return names;
+}
+
+Json Monica::climateColumnsJson(const DataAccessor& da)
+{
+	J11Object cols;
+	cols["startDate"] = da.startDate().toIsoDateString();
+	cols["endDate"] = da.endDate().toIsoDateString();
+	for(const auto& p : climateColumnNames())
+		if(da.hasAvailableClimateData(p.second))
+			cols[p.first] = toPrimJsonArray(da.dataAsVector(p.second));
+	return cols;
+}
+
+Errors Monica::mergeClimateColumns(const Json& j, DataAccessor& da)
+{
+	Errors es;
+
+	DataAccessor cda(Date::fromIsoDateString(j["startDate"].string_value()),
+	                 Date::fromIsoDateString(j["endDate"].string_value()));
+	for(const auto& p : climateColumnNames())
+	{
+		if(!j[p.first].is_array())
+			continue;
+
+		vector<double> data;
+		data.reserve(j[p.first].array_items().size());
+		for(const auto& v : j[p.first].array_items())
+			data.push_back(v.number_value());
+		cda.addOrReplaceClimateData(p.second, data);
+	}
+	da = cda;
+
+	return es;
+}
+
+namespace
+{
+	//! pulls the tokens of a JSON text one by one out of the (null terminated) buffer
+	class JsonCursor
+	{
+	public:
+		JsonCursor(const string& s) : _p(s.c_str()), _end(s.c_str() + s.size()) {}
+
+		const char* pos() const { return _p; }
+
+		bool atEnd() { skipWs(); return _p >= _end; }
+
+		bool consume(char c)
+		{
+			skipWs();
+			if(_p < _end && *_p == c)
+				return ++_p, true;
+			return false;
+		}
+
+		//! read the next member name of an object, including the ':',
+		//! returns false at the end of the object (or on errors)
+		bool nextMember(string& name, bool first)
+		{
+			if(consume('}'))
+				return false;
+			if(!first && !consume(','))
+				return _failed = true, false;
+			if(!readString(name) || !consume(':'))
+				return _failed = true, false;
+			return true;
+		}
+
+		bool readString(string& out)
+		{
+			out.clear();
+			if(!consume('"'))
+				return _failed = true, false;
+			while(_p < _end && *_p != '"')
+			{
+				if(*_p != '\\')
+				{
+					out.push_back(*_p++);
+					continue;
+				}
+				if(++_p >= _end)
+					break;
+				switch(*_p++)
+				{
+				case '"': out.push_back('"'); break;
+				case '\\': out.push_back('\\'); break;
+				case '/': out.push_back('/'); break;
+				case 'b': out.push_back('\b'); break;
+				case 'f': out.push_back('\f'); break;
+				case 'n': out.push_back('\n'); break;
+				case 'r': out.push_back('\r'); break;
+				case 't': out.push_back('\t'); break;
+				case 'u':
+				{
+					if(_end - _p < 4)
+						return _failed = true, false;
+					unsigned long cp = strtoul(string(_p, 4).c_str(), nullptr, 16);
+					_p += 4;
+					//as UTF-8, surrogate pairs are not combined (they don't occur in member names or dates)
+					if(cp < 0x80)
+						out.push_back(char(cp));
+					else if(cp < 0x800)
+						out.push_back(char(0xC0 | (cp >> 6))), out.push_back(char(0x80 | (cp & 0x3F)));
+					else
+						out.push_back(char(0xE0 | (cp >> 12))), out.push_back(char(0x80 | ((cp >> 6) & 0x3F))),
+						out.push_back(char(0x80 | (cp & 0x3F)));
+					break;
+				}
+				default: return _failed = true, false;
+				}
+			}
+			if(_p >= _end)
+				return _failed = true, false;
+			++_p;
+			return true;
+		}
+
+		//! read an array of numbers straight into out
+		bool readNumberArray(vector<double>& out)
+		{
+			out.clear();
+			if(!consume('['))
+				return _failed = true, false;
+			if(consume(']'))
+				return true;
+			do
+			{
+				skipWs();
+				char* numberEnd = nullptr;
+				double d = strtod(_p, &numberEnd);
+				if(numberEnd == _p || numberEnd > _end)
+					return _failed = true, false;
+				out.push_back(d);
+				_p = numberEnd;
+			}
+			while(consume(','));
+			if(!consume(']'))
+				return _failed = true, false;
+			return true;
+		}
+
+		//! skip the next value, whatever it is
+		bool skipValue()
+		{
+			skipWs();
+			if(_p >= _end)
+				return _failed = true, false;
+			if(*_p == '"')
+			{
+				string s;
+				return readString(s);
+			}
+			if(*_p != '{' && *_p != '[')
+			{
+				//number, true, false or null
+				const char* start = _p;
+				while(_p < _end && !strchr(",}] \t\r\n", *_p))
+					++_p;
+				return _p > start || (_failed = true, false);
+			}
+
+			int depth = 0;
+			do
+			{
+				if(*_p == '"')
+				{
+					string s;
+					if(!readString(s))
+						return false;
+					continue;
+				}
+				if(*_p == '{' || *_p == '[')
+					depth++;
+				else if(*_p == '}' || *_p == ']')
+					depth--;
+				++_p;
+			}
+			while(depth > 0 && _p < _end);
+			return depth == 0 || (_failed = true, false);
+		}
+
+		bool failed() const { return _failed; }
+
+	private:
+		void skipWs()
+		{
+			while(_p < _end && (*_p == ' ' || *_p == '\t' || *_p == '\r' || *_p == '\n'))
+				++_p;
+		}
+
+		const char* _p{nullptr};
+		const char* _end{nullptr};
+		bool _failed{false};
+	};
+
+	//! read the "climateColumns" object, the columns go straight into vectors
+	Errors readClimateColumns(JsonCursor& c, DataAccessor& da)
+	{
+		Errors es;
+		if(!c.consume('{'))
+		{
+			es.errors.push_back("climateColumns is not an object");
+			return es;
+		}
+
+		const auto& names = climateColumnNames();
+		string startDate, endDate, name;
+		vector<pair<ACD, vector<double>>> columns;
+		for(bool first = true; c.nextMember(name, first); first = false)
+		{
+			auto it = names.find(name);
+			if(name == "startDate")
+				c.readString(startDate);
+			else if(name == "endDate")
+				c.readString(endDate);
+			else if(it != names.end())
+			{
+				columns.push_back(make_pair(it->second, vector<double>()));
+				c.readNumberArray(columns.back().second);
+			}
+			else
+				c.skipValue();
+
+			if(c.failed())
+			{
+				es.errors.push_back(string("Couldn't read climateColumns member '") + name + "'");
+				return es;
+			}
+		}
+
+		DataAccessor cda(Date::fromIsoDateString(startDate), Date::fromIsoDateString(endDate));
+		for(auto& p : columns)
+		{
+			cda.addOrReplaceClimateData(p.first, p.second);
+			vector<double>().swap(p.second);
+		}
+		da = cda;
+
+		return es;
+	}
+}
+
+string Monica::jsonObjectType(const string& jsonStr)
+{
+	JsonCursor c(jsonStr);
+	if(!c.consume('{'))
+		return string();
+
+	string name, type;
+	for(bool first = true; c.nextMember(name, first); first = false)
+	{
+		if(name == "type")
+			return c.readString(type) ? type : string();
+		if(!c.skipValue())
+			break;
+	}
+	return string();
+}
+
+Errors Monica::readEnvFromJsonString(const string& jsonStr, Env& env)
+{
+	Errors es;
+
+	JsonCursor c(jsonStr);
+	if(!c.consume('{'))
+	{
+		es.errors.push_back("Env JSON is not an object");
+		return es;
+	}
+
+	bool hasClimateColumns = false;
+	DataAccessor climateData;
+	J11Object envj;
+	string name;
+	for(bool first = true; c.nextMember(name, first); first = false)
+	{
+		if(name == "climateColumns")
+		{
+			es.append(readClimateColumns(c, climateData));
+			if(es.failure())
+				return es;
+			hasClimateColumns = true;
+			continue;
+		}
+
+		const char* start = c.pos();
+		if(!c.skipValue())
+			break;
+		string err;
+		envj[name] = Json::parse(string(start, c.pos()), err);
+		if(!err.empty())
+			es.errors.push_back(string("Couldn't parse Env member '") + name + "': " + err);
+	}
+	if(c.failed() || !c.atEnd())
+	{
+		es.errors.push_back(string("Couldn't read Env JSON after member '") + name + "'");
+		return es;
+	}
+
+	es.append(env.merge(Json(std::move(envj))));
+	if(hasClimateColumns)
+		env.climateData = climateData;
+
+	return es;
+}
@@ -0,0 +1,51 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/*
+Authors:
+Michael Berg <michael.berg@zalf.de>
+
+Maintainers:
+Currently maintained by the authors.
+
+This file is part of the MONICA model.
+Copyright (C) Leibniz Centre for Agricultural Landscape Research (ZALF)
+*/
+
+#ifndef MONICA_ENV_STREAM_READER_H_
+#define MONICA_ENV_STREAM_READER_H_
+
+#include <string>
+#include <vector>
+#include <map>
+
+#include "json11/json11.hpp"
+#include "common/dll-exports.h"
+#include "tools/json11-helper.h"
+#include "climate/climate-common.h"
+#include "run-monica.h"
+
+namespace Monica
+{
+	//! the names of the climate elements in the "climateColumns" layout
+	DLL_API const std::map<std::string, Climate::ACD>& climateColumnNames();
+
+	//! the climate data as columns: {"startDate": ISO-DATE, "endDate": ISO-DATE, "tmin": [...], ...},
+	//! only the climate elements in climateColumnNames are written
+	DLL_API json11::Json climateColumnsJson(const Climate::DataAccessor& da);
+
+	//! the DataAccessor for climate data in the "climateColumns" layout (parsed JSON)
+	DLL_API Tools::Errors mergeClimateColumns(const json11::Json& j, Climate::DataAccessor& da);
+
+	//! the value of the top level "type" member of a JSON object,
+	//! found without parsing the rest of the object
+	DLL_API std::string jsonObjectType(const std::string& jsonStr);
+
+	//! read an Env from its JSON representation without building a DOM of the whole message,
+	//! the columns of "climateColumns" are read straight from the buffer into env.climateData,
+	//! all other members are small and parsed one by one before they are merged into env
+	DLL_API Tools::Errors readEnvFromJsonString(const std::string& jsonStr, Env& env);
+}
+
+#endif //MONICA_ENV_STREAM_READER_H_
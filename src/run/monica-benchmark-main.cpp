@@ -0,0 +1,584 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/*
+Authors:
+Michael Berg <michael.berg@zalf.de>
+
+Maintainers:
+Currently maintained by the authors.
+
+This file is part of the MONICA model.
+Copyright (C) Leibniz Centre for Agricultural Landscape Research (ZALF)
+*/
+
+#include <cstdlib>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <algorithm>
+#include <memory>
+#include <atomic>
+#include <new>
+
+#include "json11/json11.hpp"
+
+#include "tools/helper.h"
+#include "tools/json11-helper.h"
+#include "db/abstract-db-connections.h"
+#include "../run/run-monica.h"
+#include "../run/cultivation-method.h"
+#include "env-from-json-config.h"
+#include "env-json-from-json-config.h"
+#include "env-stream-reader.h"
+#include "../core/monica-model.h"
+#include "../core/crop-growth.h"
+#include "../core/photosynthesis-FvCB.h"
+#include "../io/build-output.h"
+
+using namespace std;
+using namespace Monica;
+using namespace Tools;
+using namespace json11;
+
+string appName = "monica-benchmark";
+string version = "1.0.0";
+
+namespace
+{
+	struct Options
+	{
+		size_t reps{100};
+		string pathToSimJson{"./sim.json"};
+		size_t noOfLayers{25};
+	};
+
+	//! results of the timed code end up here, so the compiler can't drop it
+	volatile double sink = 0.0;
+
+	//! bytes currently allocated by operator new and their peak since the last resetHeapPeak
+	atomic<size_t> heapInUse{0};
+	atomic<size_t> heapPeak{0};
+
+	//! the requested size is kept in front of each block, so the header keeps malloc's alignment
+	const size_t heapHeaderSize = 16;
+
+	void* countedAlloc(size_t n)
+	{
+		auto block = static_cast<char*>(malloc(n + heapHeaderSize));
+		if(!block)
+			return nullptr;
+		*reinterpret_cast<size_t*>(block) = n;
+		auto inUse = heapInUse.fetch_add(n, memory_order_relaxed) + n;
+		auto peak = heapPeak.load(memory_order_relaxed);
+		while(inUse > peak && !heapPeak.compare_exchange_weak(peak, inUse, memory_order_relaxed));
+		return block + heapHeaderSize;
+	}
+
+	void countedFree(void* p)
+	{
+		if(!p)
+			return;
+		auto block = static_cast<char*>(p) - heapHeaderSize;
+		heapInUse.fetch_sub(*reinterpret_cast<size_t*>(block), memory_order_relaxed);
+		free(block);
+	}
+
+	//! how many bytes more than before f have been allocated at the same time while f ran
+	size_t peakHeapGrowth(const function<void()>& f)
+	{
+		auto before = heapInUse.load();
+		heapPeak.store(before);
+		f();
+		return heapPeak.load() - before;
+	}
+
+	//! average run time of f in ns, f is called n times
+	double nsPerCall(size_t n, const function<void()>& f)
+	{
+		auto start = chrono::steady_clock::now();
+		for(size_t i = 0; i < n; i++)
+			f();
+		auto end = chrono::steady_clock::now();
+		return chrono::duration<double, nano>(end - start).count() / n;
+	}
+
+	void printTiming(const string& what, double ns, const string& unit)
+	{
+		printf("  %-52s %10.1f ns/%s\n", what.c_str(), ns, unit.c_str());
+	}
+
+	//! a synthetic but plausible summer day, varied a bit by day
+	FvCB::FvCB_canopy_day_in fvcbDay(int day)
+	{
+		const double PI = 3.14159265358979323;
+		FvCB::FvCB_canopy_day_in in;
+		for(int h = 0; h < 24; h++)
+		{
+			double el = sin((h - 6) / 12.0 * PI) * 0.9;
+			in.solar_el[h] = el;
+			in.global_rad[h] = el > 0 ? 2.5 * sin(el) * (0.6 + 0.4 * ((day % 7) / 6.0)) : 0.0;
+			in.extra_terr_rad[h] = el > 0 ? 4.5 * sin(el) : 0.0;
+			in.leaf_temp[h] = 10 + (day % 15) + 8 * sin((h - 9) / 12.0 * PI);
+			in.VPD[h] = 0.3 + 0.05 * h;
+		}
+		in.LAI = 0.5 + (day % 50) * 0.1;
+		in.Ca = 400;
+		return in;
+	}
+
+	//! the bernacchi tables as they were before, looked up in std::maps
+	map<FvCB::FvCB_Model_Consts, double> c_bernacchi_map =
+	{{FvCB::Rd, 18.72}, {FvCB::Vcmax, 26.35}, {FvCB::Vomax, 22.98}, {FvCB::Gamma, 19.02},
+	{FvCB::Kc, 38.05}, {FvCB::Ko, 20.30}, {FvCB::Jmax, 17.57}};
+	map<FvCB::FvCB_Model_Consts, double> deltaH_bernacchi_map =
+	{{FvCB::Rd, 46.39}, {FvCB::Vcmax, 65.33}, {FvCB::Vomax, 60.11}, {FvCB::Gamma, 37.83},
+	{FvCB::Kc, 79.43}, {FvCB::Ko, 36.38}, {FvCB::Jmax, 43.54}};
+
+	double Tresp_bernacchi_map_f(FvCB::FvCB_Model_Consts which, double leafT)
+	{
+		double Tk = leafT + 273;
+		double R = 8.314472 * pow(10, -3);
+		return exp(c_bernacchi_map[which] - deltaH_bernacchi_map[which] / (R * Tk));
+	}
+
+	double Tresp_bernacchi_array_f(FvCB::FvCB_Model_Consts which, double leafT)
+	{
+		double Tk = leafT + 273;
+		double R = 8.314472 * pow(10, -3);
+		return exp(FvCB::c_bernacchi[which] - FvCB::deltaH_bernacchi[which] / (R * Tk));
+	}
+
+	//! hourly FvCB canopy photosynthesis: bernacchi table lookups,
+	//! the scalar hour against the batched day and the equivalence check of both
+	int benchmarkFvCB(const Options& opts)
+	{
+		size_t reps = opts.reps;
+		using namespace FvCB;
+		cout << "FvCB canopy photosynthesis (C3, hourly)" << endl;
+
+		const vector<FvCB_Model_Consts> perHour = {Vcmax, Jmax, Vomax, Rd, Kc, Ko};
+		size_t n = 1000 * reps;
+		double leafT = 0;
+		// the six factors an hour needs, once per canopy fraction as before and shared once now
+		printTiming("bernacchi factors, std::map tables, per fraction", nsPerCall(n, [&]()
+		{
+			leafT = leafT > 40 ? 0 : leafT + 0.1;
+			for(int fraction = 0; fraction < 2; fraction++)
+				for(auto c : perHour)
+					sink = sink + Tresp_bernacchi_map_f(c, leafT);
+		}), "hour");
+		printTiming("bernacchi factors, constexpr tables, shared", nsPerCall(n, [&]()
+		{
+			leafT = leafT > 40 ? 0 : leafT + 0.1;
+			for(auto c : perHour)
+				sink = sink + Tresp_bernacchi_array_f(c, leafT);
+		}), "hour");
+		printTiming("FvCB_leaf_T_responses_f", nsPerCall(n, [&]()
+		{
+			leafT = leafT > 40 ? 0 : leafT + 0.1;
+			sink = sink + FvCB_leaf_T_responses_f(leafT).Vcmax;
+		}), "hour");
+
+		const int noOfDays = 64;
+		vector<FvCB_canopy_day_in> days;
+		for(int d = 0; d < noOfDays; d++)
+			days.push_back(fvcbDay(d));
+		FvCB_canopy_hourly_params par;
+		par.Vcmax_25 = 90;
+
+		int day = 0;
+		double scalar = nsPerCall(10 * reps, [&]()
+		{
+			const auto& in = days[day++ % noOfDays];
+			for(int h = 0; h < 24; h++)
+				sink = sink + FvCB_canopy_hourly_C3(in.at(h), par).canopy_gross_photos;
+		}) / 24;
+		printTiming("FvCB_canopy_hourly_C3, scalar hour", scalar, "hour");
+		double batched = nsPerCall(10 * reps, [&]()
+		{
+			const auto& in = days[day++ % noOfDays];
+			auto d = FvCB_canopy_day_C3(in, par.kn);
+			for(int h = 0; h < 24; h++)
+				sink = sink + FvCB_canopy_hourly_C3(d, h, par).canopy_gross_photos;
+		}) / 24;
+		printTiming("FvCB_canopy_day_C3 + FvCB_canopy_hourly_C3, batched", batched, "hour");
+		printf("  speedup batched vs. scalar: %.2f\n", scalar / batched);
+
+		size_t noOfDiffs = 0;
+		for(const auto& in : days)
+		{
+			for(const auto& diff : check_FvCB_canopy_day_C3(in, par))
+			{
+				if(noOfDiffs++ < 10)
+					cerr << "Error: FvCB canopy day differs at " << diff << endl;
+			}
+		}
+		printf("  equivalence check (rel. 1e-10) over %d days: %s\n", noOfDays, noOfDiffs == 0 ? "ok" : "FAILED");
+
+		return noOfDiffs == 0 ? 0 : 1;
+	}
+
+	//! the parameters for createEnv(Json)FromJsonConfigFiles/Strings: sim.json and the 
+	//! crop.json, site.json and climate.csv it references (relative to sim.json)
+	map<string, string> simJsonParams(const string& pathToSimJson)
+	{
+		string pathOfSimJson, simFileName;
+		tie(pathOfSimJson, simFileName) = splitPathToFile(pathToSimJson);
+
+		auto simm = printPossibleErrors(readAndParseJsonFile(pathToSimJson)).object_items();
+		simm["sim.json"] = pathToSimJson;
+		for(auto key : {"crop.json", "site.json", "climate.csv"})
+		{
+			auto path = simm[key].string_value();
+			if(!path.empty() && !isAbsolutePath(path))
+				simm[key] = pathOfSimJson + path;
+		}
+
+		map<string, string> ps;
+		ps["sim-json-str"] = json11::Json(simm).dump();
+		ps["crop-json-str"] = printPossibleErrors(readFile(simm["crop.json"].string_value()));
+		ps["site-json-str"] = printPossibleErrors(readFile(simm["site.json"].string_value()));
+		return ps;
+	}
+
+	Env envFromSimJson(const string& pathToSimJson)
+	{
+		return createEnvFromJsonConfigFiles(simJsonParams(pathToSimJson));
+	}
+
+	//! a MONICA model with the first crop of env's crop rotation sown and grown with env's 
+	//! weather until its roots reach the deepest layers, the soil profile is deepened to 
+	//! the requested number of layers before
+	unique_ptr<MonicaModel> growFirstCrop(Env& env, const Options& opts)
+	{
+		if(!env.params.siteParameters.vs_SoilParameters
+		   || env.params.siteParameters.vs_SoilParameters->empty())
+		{
+			cerr << "Error: no soil profile in " << opts.pathToSimJson << endl;
+			return nullptr;
+		}
+
+		//deepen the profile by repeating the lowest layer
+		auto sps = make_shared<Soil::SoilPMs>(*env.params.siteParameters.vs_SoilParameters);
+		while(sps->size() < opts.noOfLayers)
+			sps->push_back(sps->back());
+		env.params.siteParameters.vs_SoilParameters = sps;
+
+		shared_ptr<Sowing> sowing;
+		for(const auto& cm : env.cropRotation)
+			for(const auto& wss : {cm.staticWorksteps(), cm.allDynamicWorksteps()})
+				for(const auto& ws : wss)
+					if(!sowing)
+						sowing = dynamic_pointer_cast<Sowing>(ws);
+		if(!sowing)
+		{
+			cerr << "Error: no sowing in the crop rotation of " << opts.pathToSimJson << endl;
+			return nullptr;
+		}
+
+		unique_ptr<MonicaModel> monica(new MonicaModel(env.params));
+		monica->simulationParametersNC().startDate = env.climateData.startDate();
+		monica->simulationParametersNC().endDate = env.climateData.endDate();
+		int nols = monica->soilColumn().vs_NumberOfLayers();
+		Date sowingDate = sowing->earliestDate();
+		Date currentDate = env.climateData.startDate();
+		size_t daysAfterSowing = 0;
+		for(size_t d = 0; d < env.climateData.noOfStepsPossible() && daysAfterSowing < 300; ++d, ++currentDate)
+		{
+			monica->dailyReset();
+			monica->setCurrentStepDate(currentDate);
+			monica->setCurrentStepClimateData(env.climateData.allDataForStep(d, env.params.siteParameters.vs_Latitude));
+			if(!monica->isCropPlanted()
+			   && currentDate.day() == sowingDate.day()
+			   && currentDate.month() == sowingDate.month())
+				sowing->apply(monica.get());
+			monica->step();
+			
+			if(auto cg = monica->cropGrowth())
+			{
+				if(cg->isDying() || cg->get_RootingDepth() >= nols - 1)
+					break;
+				daysAfterSowing++;
+			}
+		}
+
+		auto cg = monica->cropGrowth();
+		if(!cg)
+		{
+			cerr << "Error: the crop of " << opts.pathToSimJson << " couldn't be sown" << endl;
+			return nullptr;
+		}
+		printf("  %d layers, rooting depth %d layers, %d days after sowing\n", 
+					 nols, cg->get_RootingDepth(), int(daysAfterSowing));
+
+		return monica;
+	}
+
+	//! root water and N uptake of the first crop of sim.json, grown in a soil profile 
+	//! deepened to the requested number of layers and fully rooted
+	int benchmarkUptake(const Options& opts)
+	{
+		cout << "root water and N uptake (" << opts.pathToSimJson << ")" << endl;
+
+		Env env = envFromSimJson(opts.pathToSimJson);
+		auto monica = growFirstCrop(env, opts);
+		if(!monica)
+			return 1;
+		auto cg = monica->cropGrowth();
+		int nols = monica->soilColumn().vs_NumberOfLayers();
+
+		//the uptake of a day, with the whole profile as rooting zone and no groundwater
+		double soilCoverage = cg->get_SoilCoverage();
+		double et0 = cg->get_ReferenceEvapotranspiration();
+		printTiming("fc_CropWaterUptake", nsPerCall(1000 * opts.reps, [&]()
+		{
+			cg->fc_CropWaterUptake(soilCoverage, size_t(nols), size_t(nols), et0, 0.0, 0.0, 0.0);
+			sink = sink + cg->get_ActualTranspiration();
+		}), "day");
+		printTiming("fc_CropNUptake", nsPerCall(1000 * opts.reps, [&]()
+		{
+			cg->fc_CropNUptake(nols, nols, 0.0, 0.0);
+			sink = sink + cg->get_ActNUptake();
+		}), "day");
+
+		return 0;
+	}
+
+	//! reading an Env message as the ZMQ server gets it, as JSON DOM and streamed by readEnvFromJsonString,
+	//! with the climate data as columns ("climateColumns") and as DataAccessor JSON ("climateData")
+	int benchmarkEnvRead(const Options& opts)
+	{
+		cout << "reading Env messages (" << opts.pathToSimJson << ")" << endl;
+
+		string columnsMsg, dataMsg;
+		{
+			auto envj = createEnvJsonFromJsonStrings(simJsonParams(opts.pathToSimJson));
+			if(!envj["climateColumns"].is_object())
+			{
+				cerr << "Error: sim.json references no climate data" << endl;
+				return 1;
+			}
+			columnsMsg = envj.dump();
+
+			Env env;
+			printPossibleErrors(readEnvFromJsonString(columnsMsg, env));
+			auto envm = envj.object_items();
+			envm.erase("climateColumns");
+			envm["climateData"] = env.climateData.to_json();
+			dataMsg = Json(envm).dump();
+		}
+		printf("  message size: %.1f kB (climateColumns), %.1f kB (climateData)\n",
+		       columnsMsg.size() / 1024.0, dataMsg.size() / 1024.0);
+
+		auto readDom = [](const string& msg)
+		{
+			string err;
+			Env env(Json::parse(msg, err));
+			sink = sink + env.climateData.noOfStepsPossible();
+		};
+		auto readStreamed = [](const string& msg)
+		{
+			Env env;
+			readEnvFromJsonString(msg, env);
+			sink = sink + env.climateData.noOfStepsPossible();
+		};
+
+		int failed = 0;
+		{
+			string err;
+			Env dom(Json::parse(columnsMsg, err));
+			Env streamed;
+			auto es = readEnvFromJsonString(columnsMsg, streamed);
+			if(es.failure() || dom.to_json().dump() != streamed.to_json().dump())
+			{
+				cerr << "Error: DOM and streamed Env differ" << endl;
+				failed = 1;
+			}
+		}
+
+		struct Read { string what; const string& msg; function<void(const string&)> read; };
+		const vector<Read> reads =
+		{{"climateData, DOM", dataMsg, readDom}
+		,{"climateColumns, DOM", columnsMsg, readDom}
+		,{"climateColumns, streamed", columnsMsg, readStreamed}
+		};
+
+		size_t n = max(size_t(1), opts.reps / 10);
+		for(const auto& r : reads)
+		{
+			double ns = nsPerCall(n, [&](){ r.read(r.msg); });
+			size_t peak = peakHeapGrowth([&](){ r.read(r.msg); });
+			printf("  %-52s %10.2f ms/Env %10.1f kB peak heap\n", r.what.c_str(), ns / 1e6, peak / 1024.0);
+		}
+
+		return failed;
+	}
+
+	//! output compare expressions of events ('while', 'at'), evaluated on a grown crop, 
+	//! as compiled program and as nested closures
+	int benchmarkExpressions(const Options& opts)
+	{
+		cout << "output compare expressions (" << opts.pathToSimJson << ")" << endl;
+
+		Env env = envFromSimJson(opts.pathToSimJson);
+		auto monica = growFirstCrop(env, opts);
+		if(!monica)
+			return 1;
+
+		//representative specs, which both ways accept
+		const vector<string> specs = 
+		{R"(["LAI", ">", 3])"
+		,R"(["Stage", "=", 5])"
+		,R"(["Tmin", "<", "Tmax"])"
+		,R"([["Mois", 1, 3], ">", 0.2])"
+		};
+
+		int failed = 0;
+		for(const auto& spec : specs)
+		{
+			string err;
+			auto a = Json::parse(spec, err).array_items();
+			auto ce = CompiledExpression::compile(a);
+			auto closure = buildExpression<bool, bool>(a, getCompareOp, applyCompareOp);
+			if(!ce.isValid() || !closure)
+			{
+				cerr << "Error: couldn't build " << spec << (ce.isValid() ? " as closures" : " as program") << endl;
+				failed = 1;
+				continue;
+			}
+			if(ce.test(*monica) != closure(*monica))
+			{
+				cerr << "Error: program and closures differ for " << spec << endl;
+				failed = 1;
+			}
+
+			double program = nsPerCall(10000 * opts.reps, [&]()
+			{
+				sink = sink + ce.test(*monica);
+			});
+			double closures = nsPerCall(10000 * opts.reps, [&]()
+			{
+				sink = sink + closure(*monica);
+			});
+			printTiming(spec + " program", program, "test");
+			printTiming(spec + " closures", closures, "test");
+			printf("  speedup program vs. closures: %.2f\n", closures / program);
+		}
+
+		return failed;
+	}
+}
+
+//! count the heap use of the whole program, for the peak heap of the env suite
+void* operator new(size_t n)
+{
+	if(auto p = countedAlloc(n))
+		return p;
+	throw bad_alloc();
+}
+
+void* operator new[](size_t n)
+{
+	if(auto p = countedAlloc(n))
+		return p;
+	throw bad_alloc();
+}
+
+void* operator new(size_t n, const nothrow_t&) noexcept { return countedAlloc(n); }
+void* operator new[](size_t n, const nothrow_t&) noexcept { return countedAlloc(n); }
+void operator delete(void* p) noexcept { countedFree(p); }
+void operator delete[](void* p) noexcept { countedFree(p); }
+void operator delete(void* p, const nothrow_t&) noexcept { countedFree(p); }
+void operator delete[](void* p, const nothrow_t&) noexcept { countedFree(p); }
+
+int main(int argc, char** argv)
+{
+	setlocale(LC_ALL, "");
+	setlocale(LC_NUMERIC, "C");
+
+	//init path to db-connections.ini
+	if(auto monicaHome = getenv("MONICA_HOME"))
+	{
+		auto pathToFile = string(monicaHome) + pathSeparator() + "db-connections.ini";
+		initPathToDB(pathToFile);
+		Db::dbConnectionParameters(pathToFile);
+	}
+
+	set<string> suites;
+	Options opts;
+
+	const map<string, function<int(const Options&)>> name2suite =
+	{{"fvcb", benchmarkFvCB}
+	,{"uptake", benchmarkUptake}
+	,{"expressions", benchmarkExpressions}
+	,{"env", benchmarkEnvRead}
+	};
+
+	auto printHelp = [=]()
+	{
+		cout
+			<< appName << " [options] [suites]" << endl
+			<< endl
+			<< "suites (default: all):" << endl
+			<< endl
+			<< " fvcb ... hourly FvCB canopy photosynthesis" << endl
+			<< " uptake ... root water and N uptake of the first crop in sim.json" << endl
+			<< " expressions ... output compare expressions, compiled program vs. closures" << endl
+			<< " env ... parse time and peak heap of reading the Env message of sim.json" << endl
+			<< endl
+			<< "options:" << endl
+			<< endl
+			<< " -h   | --help ... this help output" << endl
+			<< " -v   | --version ... outputs " << appName << " version" << endl
+			<< endl
+			<< " -r   | --repetitions NUMBER (default: " << opts.reps << ") ... scales the number of timed calls" << endl
+			<< " -s   | --path-to-sim-json FILE (default: " << opts.pathToSimJson << ") ... sim.json of the suites running MONICA" << endl
+			<< " -l   | --layers NUMBER (default: " << opts.noOfLayers << ") ... min. number of soil layers for the uptake suite" << endl;
+	};
+
+	for(auto i = 1; i < argc; i++)
+	{
+		string arg = argv[i];
+		if((arg == "-r" || arg == "--repetitions")
+		   && i + 1 < argc)
+			opts.reps = max(1, atoi(argv[++i]));
+		else if((arg == "-s" || arg == "--path-to-sim-json")
+		        && i + 1 < argc)
+			opts.pathToSimJson = argv[++i];
+		else if((arg == "-l" || arg == "--layers")
+		        && i + 1 < argc)
+			opts.noOfLayers = max(1, atoi(argv[++i]));
+		else if(arg == "-h" || arg == "--help")
+			printHelp(), exit(0);
+		else if(arg == "-v" || arg == "--version")
+			cout << appName << " version " << version << endl, exit(0);
+		else if(name2suite.find(arg) != name2suite.end())
+			suites.insert(arg);
+		else
+		{
+			cerr << "Error: unknown suite or option: " << arg << endl;
+			printHelp();
+			exit(1);
+		}
+	}
+
+	int failed = 0;
+	for(const auto& p : name2suite)
+	{
+		if(suites.empty() || suites.find(p.first) != suites.end())
+		{
+			failed += p.second(opts);
+			cout << endl;
+		}
+	}
+
+	return failed == 0 ? 0 : 1;
+}
@@ -18,6 +18,8 @@ Copyright (C) Leibniz Centre for Agricultural Landscape Research (ZALF)
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <vector>
+#include <map>
 #include <tuple>
 
 #include "json11/json11.hpp"
@@ -30,6 +32,7 @@ Copyright (C) Leibniz Centre for Agricultural Landscape Research (ZALF)
 #include "tools/algorithms.h"
 #include "../io/csv-format.h"
 #include "db/abstract-db-connections.h"
+#include "../io/database-io.h"
 
 using namespace std;
 using namespace Monica;
@@ -59,13 +62,15 @@ int main(int argc, char** argv)
 	string pathToOutput;
 	string pathToOutputFile;
 	bool writeOutputFile = false;
-	string pathToSimJson = "./sim.json", crop, site, climate;
+	vector<string> pathsToSimJson;
+	string crop, site, climate;
 	string dailyOutputs;
+	string pathToParameterBundle, pathToWriteParameterBundle;
 	
 	auto printHelp = [=]()
 	{
 		cout
-			<< appName << " [options] path-to-sim-json" << endl
+			<< appName << " [options] path-to-sim-json ..." << endl
 			<< endl
 			<< "options:" << endl 
 			<< endl
@@ -77,11 +82,13 @@ int main(int argc, char** argv)
 			//<< " -ed  | --end-date ISO-DATE (default: end of given climate data) ... date in iso-date-format yyyy-mm-dd" << endl
 			<< " -w   | --write-output-files ... write MONICA output files" << endl
 			<< " -op  | --path-to-output DIRECTORY (default: .) ... path to output directory" << endl
-			<< " -o   | --path-to-output-file FILE ... path to output file" << endl
+			<< " -o   | --path-to-output-file FILE ... path to output file (only for a single sim.json)" << endl
 			//<< " -do  | --daily-outputs [LIST] (default: value of key 'sim.json:output.daily') ... list of daily output elements" << endl
 			<< " -c   | --path-to-crop FILE (default: ./crop.json) ... path to crop.json file" << endl
 			<< " -s   | --path-to-site FILE (default: ./site.json) ... path to site.json file" << endl
-			<< " -w   | --path-to-climate FILE (default: ./climate.csv) ... path to climate.csv" << endl;
+			<< " -w   | --path-to-climate FILE (default: ./climate.csv) ... path to climate.csv" << endl
+			<< " -pb  | --parameter-bundle FILE ... read crop, fertiliser, residue and user parameters from this parameter bundle instead of the database" << endl
+			<< " -wpb | --write-parameter-bundle FILE ... write all parameters of the MONICA database into this parameter bundle and exit" << endl;
 	};
 	
 	if(argc > 1)
@@ -115,171 +122,217 @@ int main(int argc, char** argv)
 			else if((arg == "-w" || arg == "--path-to-climate")
 			        && i+1 < argc)
 				climate = argv[++i];
+			else if((arg == "-pb" || arg == "--parameter-bundle")
+			        && i+1 < argc)
+				pathToParameterBundle = argv[++i];
+			else if((arg == "-wpb" || arg == "--write-parameter-bundle")
+			        && i+1 < argc)
+				pathToWriteParameterBundle = argv[++i];
 			else if(arg == "-h" || arg == "--help")
 				printHelp(), exit(0);
 			else if(arg == "-v" || arg == "--version")
 				cout << appName << " version " << version << endl, exit(0);
 			else
-				pathToSimJson = argv[i];
+				pathsToSimJson.push_back(argv[i]);
 		}
 
-		string pathOfSimJson, simFileName;
-		tie(pathOfSimJson, simFileName) = splitPathToFile(pathToSimJson);
+		if(!pathToWriteParameterBundle.empty())
+		{
+			writeParameterBundle(pathToWriteParameterBundle);
+			exit(0);
+		}
 
-		auto simj = readAndParseJsonFile(pathToSimJson);
-		if(simj.failure())
-			for(auto e : simj.errors)
-				cerr << e << endl;
-		auto simm = simj.result.object_items();
+		if(!pathToParameterBundle.empty())
+		{
+			auto res = loadParameterBundle(pathToParameterBundle);
+			if(res.failure())
+				for(auto e : res.errors)
+					cerr << e << endl;
+		}
 
-		//if(!startDate.empty())
-		//	simm["start-date"] = startDate;
+		if(pathsToSimJson.empty())
+			pathsToSimJson.push_back("./sim.json");
 
-		//if(!endDate.empty())
-		//	simm["end-date"] = endDate;
+		vector<J11Object> simms;
+		vector<map<string, string>> psList;
+		for(const auto& pathToSimJson : pathsToSimJson)
+		{
+			string pathOfSimJson, simFileName;
+			tie(pathOfSimJson, simFileName) = splitPathToFile(pathToSimJson);
 
-		if(debugSet)
-			simm["debug?"] = debug;
+			auto simj = readAndParseJsonFile(pathToSimJson);
+			if(simj.failure())
+				for(auto e : simj.errors)
+					cerr << e << endl;
+			auto simm = simj.result.object_items();
 
-		//set debug mode in run-monica ... in libmonica has to be set separately in runMonica
-		activateDebug = simm["debug?"].bool_value();
+			//if(!startDate.empty())
+			//	simm["start-date"] = startDate;
 
-		if(!pathToOutput.empty())
-			simm["path-to-output"] = pathToOutput;
+			//if(!endDate.empty())
+			//	simm["end-date"] = endDate;
 
-		//if(!pathToOutputFile.empty())
-		//	simm["path-to-output-file"] = pathToOutputFile;
+			if(debugSet)
+				simm["debug?"] = debug;
 
-		simm["sim.json"] = pathToSimJson;
+			//set debug mode in run-monica ... in libmonica has to be set separately in runMonica
+			activateDebug = simm["debug?"].bool_value();
 
-		if(!crop.empty())
-			simm["crop.json"] = crop;
-		auto pathToCropJson = simm["crop.json"].string_value();
-		if(!isAbsolutePath(pathToCropJson))
-			simm["crop.json"] = pathOfSimJson + pathToCropJson;
+			if(!pathToOutput.empty())
+				simm["path-to-output"] = pathToOutput;
 
-		if(!site.empty())
-			simm["site.json"] = site;
-		auto pathToSiteJson = simm["site.json"].string_value();
-		if(!isAbsolutePath(pathToSiteJson))
-			simm["site.json"] = pathOfSimJson + pathToSiteJson;
+			//if(!pathToOutputFile.empty())
+			//	simm["path-to-output-file"] = pathToOutputFile;
 
-		if(!climate.empty())
-			simm["climate.csv"] = climate;
-		if(simm["climate.csv"].is_string())
-		{
-			auto pathToClimateCSV = simm["climate.csv"].string_value();
-			if(!isAbsolutePath(pathToClimateCSV))
-				simm["climate.csv"] = pathOfSimJson + pathToClimateCSV;
-		}
-		else if(simm["climate.csv"].is_array())
-		{
-			vector<string> ps;
-			for(auto j : simm["climate.csv"].array_items())
+			simm["sim.json"] = pathToSimJson;
+
+			if(!crop.empty())
+				simm["crop.json"] = crop;
+			auto pathToCropJson = simm["crop.json"].string_value();
+			if(!isAbsolutePath(pathToCropJson))
+				simm["crop.json"] = pathOfSimJson + pathToCropJson;
+
+			if(!site.empty())
+				simm["site.json"] = site;
+			auto pathToSiteJson = simm["site.json"].string_value();
+			if(!isAbsolutePath(pathToSiteJson))
+				simm["site.json"] = pathOfSimJson + pathToSiteJson;
+
+			if(!climate.empty())
+				simm["climate.csv"] = climate;
+			if(simm["climate.csv"].is_string())
 			{
-				auto pathToClimateCSV = j.string_value();
+				auto pathToClimateCSV = simm["climate.csv"].string_value();
 				if(!isAbsolutePath(pathToClimateCSV))
-					ps.push_back(pathOfSimJson + pathToClimateCSV);
+					simm["climate.csv"] = pathOfSimJson + pathToClimateCSV;
+			}
+			else if(simm["climate.csv"].is_array())
+			{
+				vector<string> ps;
+				for(auto j : simm["climate.csv"].array_items())
+				{
+					auto pathToClimateCSV = j.string_value();
+					if(!isAbsolutePath(pathToClimateCSV))
+						ps.push_back(pathOfSimJson + pathToClimateCSV);
+				}
+				simm["climate.csv"] = toPrimJsonArray(ps);
 			}
-			simm["climate.csv"] = toPrimJsonArray(ps);
-		}
 
-		/*
-		if(!dailyOutputs.empty())
-		{
-			auto outm = simm["output"].object_items();
-			string err;
-			J11Array daily;
+			/*
+			if(!dailyOutputs.empty())
+			{
+				auto outm = simm["output"].object_items();
+				string err;
+				J11Array daily;
 
-			string trimmedDailyOutputs = trim(dailyOutputs);
-			if(trimmedDailyOutputs.front() == '[')
-				trimmedDailyOutputs.erase(0, 1);
-			if(trimmedDailyOutputs.back() == ']')
-				trimmedDailyOutputs.pop_back();
+				string trimmedDailyOutputs = trim(dailyOutputs);
+				if(trimmedDailyOutputs.front() == '[')
+					trimmedDailyOutputs.erase(0, 1);
+				if(trimmedDailyOutputs.back() == ']')
+					trimmedDailyOutputs.pop_back();
 
-			for(auto el : splitString(trimmedDailyOutputs, ",", make_pair("[", "]")))
-			{
-				if(trim(el).at(0) == '[')
+				for(auto el : splitString(trimmedDailyOutputs, ",", make_pair("[", "]")))
 				{
-					J11Array a;
-					auto es = splitString(trim(el, "[]"), ",");
-					if(es.size() >= 1)
-						a.push_back(es.at(0));
-					if(es.size() >= 3)
-						a.push_back(stoi(es.at(1))), a.push_back(stoi(es.at(2)));
-					if(es.size() >= 4)
-						a.push_back(es.at(3));
-					daily.push_back(a);
+					if(trim(el).at(0) == '[')
+					{
+						J11Array a;
+						auto es = splitString(trim(el, "[]"), ",");
+						if(es.size() >= 1)
+							a.push_back(es.at(0));
+						if(es.size() >= 3)
+							a.push_back(stoi(es.at(1))), a.push_back(stoi(es.at(2)));
+						if(es.size() >= 4)
+							a.push_back(es.at(3));
+						daily.push_back(a);
+					}
+					else
+						daily.push_back(el);
 				}
-				else
-					daily.push_back(el);
+				outm["daily"] = daily;
+				simm["output"] = outm;
 			}
-			outm["daily"] = daily;
-			simm["output"] = outm;
+			*/
+
+			map<string, string> ps;
+			ps["sim-json-str"] = json11::Json(simm).dump();
+			ps["crop-json-str"] = printPossibleErrors(readFile(simm["crop.json"].string_value()), activateDebug);
+			ps["site-json-str"] = printPossibleErrors(readFile(simm["site.json"].string_value()), activateDebug);
+			//ps["path-to-climate-csv"] = simm["climate.csv"].string_value();
+
+			simms.push_back(simm);
+			psList.push_back(ps);
 		}
-		*/
 
-		map<string, string> ps;
-		ps["sim-json-str"] = json11::Json(simm).dump();
-		ps["crop-json-str"] = printPossibleErrors(readFile(simm["crop.json"].string_value()), activateDebug);
-		ps["site-json-str"] = printPossibleErrors(readFile(simm["site.json"].string_value()), activateDebug);
-		//ps["path-to-climate-csv"] = simm["climate.csv"].string_value();
+		//the references of all sim.jsons are resolved in one pass
+		auto envs = createEnvsFromJsonConfigFiles(psList);
+		//and the crops without parameters of all Envs are loaded from the database at once
+		prefetchCropParametersFromMonicaDB(envs);
 
-		auto env = createEnvFromJsonConfigFiles(ps);
+		const string pathToOutputFileArg = pathToOutputFile;
+		for(size_t si = 0; si < envs.size(); si++)
+		{
+			auto& env = envs.at(si);
+			auto& simm = simms.at(si);
+			pathToOutputFile = pathsToSimJson.size() == 1 ? pathToOutputFileArg : string();
 
-		if(activateDebug)
-			cout << "starting MONICA with JSON input files" << endl;
+			if(activateDebug)
+				cout << "starting MONICA with JSON input files" << endl;
 
-		Output output = runMonica(env);
+			Output output = runMonica(env);
+			for(const auto& e : output.errors)
+				cerr << "Error: " << e << endl;
+			for(const auto& w : output.warnings)
+				cerr << "Warning: " << w << endl;
 
-		if(pathToOutputFile.empty() && simm["output"]["write-file?"].bool_value())
-			pathToOutputFile = fixSystemSeparator(simm["output"]["path-to-output"].string_value() + "/"
-																						+ simm["output"]["file-name"].string_value());
+			if(pathToOutputFile.empty() && simm["output"]["write-file?"].bool_value())
+				pathToOutputFile = fixSystemSeparator(simm["output"]["path-to-output"].string_value() + "/"
+																							+ simm["output"]["file-name"].string_value());
 
-		writeOutputFile = !pathToOutputFile.empty();
+			writeOutputFile = !pathToOutputFile.empty();
 
-		ofstream fout;
-		if(writeOutputFile)
-		{
-			string path, filename;
-			tie(path, filename) = splitPathToFile(pathToOutputFile);
-			if (!Tools::ensureDirExists(path))
+			ofstream fout;
+			if(writeOutputFile)
 			{
-				cerr << "Error failed to create path: '" << path << "'." << endl;
-			}
-			fout.open(pathToOutputFile);
-			if(fout.fail())
-			{
-				cerr << "Error while opening output file \"" << pathToOutputFile << "\"" << endl;
-				writeOutputFile = false;
+				string path, filename;
+				tie(path, filename) = splitPathToFile(pathToOutputFile);
+				if (!Tools::ensureDirExists(path))
+				{
+					cerr << "Error failed to create path: '" << path << "'." << endl;
+				}
+				fout.open(pathToOutputFile);
+				if(fout.fail())
+				{
+					cerr << "Error while opening output file \"" << pathToOutputFile << "\"" << endl;
+					writeOutputFile = false;
+				}
 			}
-		}
 
-		ostream& out = writeOutputFile ? fout : cout;
+			ostream& out = writeOutputFile ? fout : cout;
 
-		string csvSep = simm["output"]["csv-options"]["csv-separator"].string_value();
-		bool includeHeaderRow = simm["output"]["csv-options"]["include-header-row"].bool_value();
-		bool includeUnitsRow = simm["output"]["csv-options"]["include-units-row"].bool_value();
-		bool includeAggRows = simm["output"]["csv-options"]["include-aggregation-rows"].bool_value();
+			string csvSep = simm["output"]["csv-options"]["csv-separator"].string_value();
+			bool includeHeaderRow = simm["output"]["csv-options"]["include-header-row"].bool_value();
+			bool includeUnitsRow = simm["output"]["csv-options"]["include-units-row"].bool_value();
+			bool includeAggRows = simm["output"]["csv-options"]["include-aggregation-rows"].bool_value();
 
-		for(const auto& d : output.data)
-		{
-			out << "\"" << replace(d.origSpec, "\"", "") << "\"" << endl;
-			writeOutputHeaderRows(out, d.outputIds, csvSep, includeHeaderRow, includeUnitsRow, includeAggRows);
-			if(env.returnObjOutputs())
-				writeOutputObj(out, d.outputIds, d.resultsObj, csvSep);
-			else
-				writeOutput(out, d.outputIds, d.results, csvSep);
-			out << endl;
+			for(const auto& d : output.data)
+			{
+				out << "\"" << replace(d.origSpec, "\"", "") << "\"" << endl;
+				writeOutputHeaderRows(out, d.outputIds, csvSep, includeHeaderRow, includeUnitsRow, includeAggRows);
+				if(env.returnObjOutputs())
+					writeOutputObj(out, d.outputIds, d.resultsObj, csvSep);
+				else
+					writeOutput(out, d.outputIds, d.results, csvSep);
+				out << endl;
 			
-		}
+			}
 
-		if(writeOutputFile)
-			fout.close();
+			if(writeOutputFile)
+				fout.close();
 
-		if(activateDebug)
-			cout << "finished MONICA" << endl;
-	}
+			if(activateDebug)
+				cout << "finished MONICA" << endl;
+		}
+		}
 	else 
 		printHelp();
 
@@ -17,6 +17,8 @@ Copyright (C) Leibniz Centre for Agricultural Landscape Research (ZALF)
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <vector>
+#include <map>
 #include <tuple>
 
 #include "zhelpers.hpp"
@@ -66,6 +68,7 @@ int main(int argc, char** argv)
 	string pathToSimJson = "./sim.json", crop, site, climate;
 	string dailyOutputs;
 	bool cesMode = false;
+	bool includeClimateData = false;
 
 	auto printHelp = [=]()
 	{
@@ -87,7 +90,9 @@ int main(int argc, char** argv)
 			<< " -c   | --path-to-crop FILE (default: ./crop.json) ... path to crop.json file" << endl
 			<< " -s   | --path-to-site FILE (default: ./site.json) ... path to site.json file" << endl
 			<< " -w   | --path-to-climate FILE (default: ./climate.csv) ... path to climate.csv" << endl
-			<< " -ces  | --create-env-server ... start monica-zmq-run as a server on given port and create JSON env for clients" << endl;
+			<< " -icd | --include-climate-data ... send the climate data, instead of the path to climate.csv, which the server then has to be able to read" << endl
+			<< " -ces  | --create-env-server ... start monica-zmq-run as a server on given port and create JSON env for clients" << endl
+			<< "         ('CreateEnv' requests get an 'Env', 'CreateEnvs' requests with a list of 'envs' get an 'Envs' reply)" << endl;
 	};
 
 	zmq::context_t context(1);
@@ -134,6 +139,8 @@ int main(int argc, char** argv)
 		else if((arg == "-w" || arg == "--path-to-climate")
 			      && i+1 < argc)
 			climate = argv[++i];
+		else if(arg == "-icd" || arg == "--include-climate-data")
+			includeClimateData = true;
 		else if(arg == "-h" || arg == "--help")
 			printHelp(), exit(0);
 		else if(arg == "-v" || arg == "--version")
@@ -186,10 +193,13 @@ int main(int argc, char** argv)
 				{
 					Json& fullMsg = msg.json;
 
+					//the climate data are only referenced by the path to the CSV files, 
+					//unless the client asks for them with "includeClimateData": true
 					auto env = createEnvJsonFromJsonObjects(
 					{{"sim", fullMsg["sim"]}
 					,{"crop", fullMsg["crop"]}
-					,{"site", fullMsg["site"]}});
+					,{"site", fullMsg["site"]}},
+					fullMsg["includeClimateData"].bool_value());
 
 					try
 					{
@@ -202,6 +212,29 @@ int main(int argc, char** argv)
 					}
 
 				}
+				else if(msgType == "CreateEnvs")
+				{
+					Json& fullMsg = msg.json;
+
+					//a batch of {"sim": ..., "crop": ..., "site": ...}, their references are resolved in one pass
+					vector<map<string, Json>> paramsList;
+					for(const auto& j : fullMsg["envs"].array_items())
+						paramsList.push_back({{"sim", j["sim"]}, {"crop", j["crop"]}, {"site", j["site"]}});
+
+					J11Object envsMsg;
+					envsMsg["type"] = "Envs";
+					envsMsg["envs"] = createEnvJsonsFromJsonObjects(paramsList, fullMsg["includeClimateData"].bool_value());
+
+					try
+					{
+						s_send(cesSocket, Json(envsMsg).dump());
+					}
+					catch(zmq::error_t e)
+					{
+						cerr << "Exception on trying to reply to 'CreateEnvs' request with 'Envs' message on zmq socket with address: tcp://*:" + to_string(port);
+						cerr << "! Will continue to receive requests! Error: [" << e.what() << "]" << endl;
+					}
+				}
 			}
 			catch(zmq::error_t e)
 			{
@@ -297,7 +330,7 @@ int main(int argc, char** argv)
 		ps["site-json-str"] = printPossibleErrors(readFile(simm["site.json"].string_value()), activateDebug);
 		//ps["path-to-climate-csv"] = simm["climate.csv"].string_value();
 
-		auto env = createEnvJsonFromJsonStrings(ps);
+		auto env = createEnvJsonFromJsonStrings(ps, includeClimateData);
 		activateDebug = env["debugMode"].bool_value();
 
 		if(activateDebug)
@@ -26,8 +26,11 @@ Copyright (C) Leibniz Centre for Agricultural Landscape Research (ZALF)
 #include <thread>
 #include <tuple>
 #include <limits>
+#include <functional>
+#include <cmath>
 
 #include "run-monica.h"
+#include "env-stream-reader.h"
 #include "tools/debug.h"
 #include "climate/climate-common.h"
 #include "db/abstract-db-connections.h"
@@ -110,7 +113,11 @@ Errors Env::merge(json11::Json j)
 
 	es.append(params.merge(j["params"]));
 
-	es.append(climateData.merge(j["climateData"]));
+	// the climate data might be just referenced by pathToClimateCSV
+	if(!j["climateData"].is_null())
+		es.append(climateData.merge(j["climateData"]));
+	else if(j["climateColumns"].is_object())
+		es.append(mergeClimateColumns(j["climateColumns"], climateData));
 
 	events = j["events"];
 	outputs = j["outputs"];
@@ -199,27 +206,8 @@ void
 Env::addOrReplaceClimateData(std::string name, const std::vector<double>& data)
 {
 	cout << "addOrReplaceClimsteData " << name.c_str() << endl;
-	int acd = 0;
-	if (name == "tmin")
-		acd = tmin;
-	else if (name == "tmax")
-		acd = tmax;
-	else if (name == "tavg")
-		acd = tavg;
-	else if (name == "precip")
-		acd = precip;
-	else if (name == "globrad")
-		acd = globrad;
-	else if (name == "wind")
-		acd = wind;
-	else if (name == "sunhours")
-		acd = sunhours;
-	else if (name == "relhumid")
-		acd = relhumid;
-	else if (name == "co2")
-		acd = co2;
-	else if (name == "et0")
-		acd = et0;
+	auto it = climateColumnNames().find(name);
+	int acd = it == climateColumnNames().end() ? 0 : it->second;
 	
 	climateData.addOrReplaceClimateData(AvailableClimateData(acd), data);
 }
@@ -325,6 +313,8 @@ void Spec::init(Maybe<DMY>& member, Json j, string time)
 		if(auto f = buildCompareExpression(jt.array_items()))
 		{
 			time2expression[time] = f;
+			for(const auto& oid : outputIdsInExpression(jt))
+				expressionOutputIds.push_back(oid);
 			if(eventType == eUnset)
 				eventType = eExpression;
 		}
@@ -353,6 +343,17 @@ void Spec::init(Maybe<DMY>& member, Json j, string time)
 			else
 			{
 				time2event[time] = jts;
+				int id = eventId(jts);
+				if(time == "start")
+					startEventId = id;
+				else if(time == "end")
+					endEventId = id;
+				else if(time == "at")
+					atEventId = id;
+				else if(time == "from")
+					fromEventId = id;
+				else if(time == "to")
+					toEventId = id;
 				eventType = eCrop;
 			}
 		}
@@ -584,31 +585,22 @@ void StoreData::storeResultsIfSpecApplies(const MonicaModel& monica)
 	{
 		bool isCurrentlyEndEvent = false;
 		const auto& currentEvents = monica.currentEvents();
-		if(!spec.time2event.empty() || !currentEvents.empty())
+		if(!spec.time2event.empty() || currentEvents.any())
 		{
 			//set possibly start/end markers
 			if(withinEventStartEndRange.isNothing() || !withinEventStartEndRange.value())
 			{
-				auto s = spec.time2event["start"];
-				if(!s.empty())
-				{
-					if(currentEvents.find(s) != currentEvents.end())
-						withinEventStartEndRange = true;
-				}
+				if(hasEvent(currentEvents, spec.startEventId))
+					withinEventStartEndRange = true;
 			}
 			else if(withinEventStartEndRange.isValue())
 			{
-				auto e = spec.time2event["end"];
-				if(!e.empty())
-				{
-					if(currentEvents.find(e) != currentEvents.end())
-						isCurrentlyEndEvent = true;
-				}
+				if(hasEvent(currentEvents, spec.endEventId))
+					isCurrentlyEndEvent = true;
 			}
 
 			//is at event
-			auto a = spec.time2event["at"];
-			if(!a.empty() && currentEvents.find(a) != currentEvents.end())
+			if(hasEvent(currentEvents, spec.atEventId))
 			{
 				storeResults(outputIds, results, monica);
 			}
@@ -618,21 +610,13 @@ void StoreData::storeResultsIfSpecApplies(const MonicaModel& monica)
 				bool isCurrentlyToEvent = false;
 				if(withinEventFromToRange.isNothing() || !withinEventFromToRange.value())
 				{
-					auto f = spec.time2event["from"];
-					if(!f.empty())
-					{
-						if(currentEvents.find(f) != currentEvents.end())
-							withinEventFromToRange = true;
-					}
+					if(hasEvent(currentEvents, spec.fromEventId))
+						withinEventFromToRange = true;
 				}
 				else if(withinEventFromToRange.isValue())
 				{
-					auto t = spec.time2event["to"];
-					if(!t.empty())
-					{
-						if(currentEvents.find(t) != currentEvents.end())
-							isCurrentlyToEvent = true;
-					}
+					if(hasEvent(currentEvents, spec.toEventId))
+						isCurrentlyToEvent = true;
 				}
 
 				if(withinEventStartEndRange.isNothing() || withinEventStartEndRange.value())
@@ -824,31 +808,22 @@ void StoreData::storeResultsIfSpecAppliesObj(const MonicaModel& monica)
 	{
 		bool isCurrentlyEndEvent = false;
 		const auto& currentEvents = monica.currentEvents();
-		if(!spec.time2event.empty() || !currentEvents.empty())
+		if(!spec.time2event.empty() || currentEvents.any())
 		{
 			//set possibly start/end markers
 			if(withinEventStartEndRange.isNothing() || !withinEventStartEndRange.value())
 			{
-				auto s = spec.time2event["start"];
-				if(!s.empty())
-				{
-					if(currentEvents.find(s) != currentEvents.end())
-						withinEventStartEndRange = true;
-				}
+				if(hasEvent(currentEvents, spec.startEventId))
+					withinEventStartEndRange = true;
 			}
 			else if(withinEventStartEndRange.isValue())
 			{
-				auto e = spec.time2event["end"];
-				if(!e.empty())
-				{
-					if(currentEvents.find(e) != currentEvents.end())
-						isCurrentlyEndEvent = true;
-				}
+				if(hasEvent(currentEvents, spec.endEventId))
+					isCurrentlyEndEvent = true;
 			}
 
 			//is at event
-			auto a = spec.time2event["at"];
-			if(!a.empty() && currentEvents.find(a) != currentEvents.end())
+			if(hasEvent(currentEvents, spec.atEventId))
 			{
 				storeResults2(outputIds, resultsObj, monica);
 			}
@@ -858,21 +833,13 @@ void StoreData::storeResultsIfSpecAppliesObj(const MonicaModel& monica)
 				bool isCurrentlyToEvent = false;
 				if(withinEventFromToRange.isNothing() || !withinEventFromToRange.value())
 				{
-					auto f = spec.time2event["from"];
-					if(!f.empty())
-					{
-						if(currentEvents.find(f) != currentEvents.end())
-							withinEventFromToRange = true;
-					}
+					if(hasEvent(currentEvents, spec.fromEventId))
+						withinEventFromToRange = true;
 				}
 				else if(withinEventFromToRange.isValue())
 				{
-					auto t = spec.time2event["to"];
-					if(!t.empty())
-					{
-						if(currentEvents.find(t) != currentEvents.end())
-							isCurrentlyToEvent = true;
-					}
+					if(hasEvent(currentEvents, spec.toEventId))
+						isCurrentlyToEvent = true;
 				}
 
 				if(withinEventStartEndRange.isNothing() || withinEventStartEndRange.value())
@@ -1040,197 +1007,348 @@ void Monica::initPathToDB(const std::string& initialPathToIniFile)
 	Db::dbConnectionParameters(initialPathToIniFile);
 }
 
-Output Monica::runMonica(Env env)
+namespace
 {
-	Output out;
-	bool returnObjOutputs = env.returnObjOutputs();
-	out.customId = env.customId;
-
-	activateDebug = env.debugMode;
-	if(activateDebug)
+	//! step monica through the first noOfDays days of env's climate data,
+	//! while applying the cultivation methods of env's crop rotations,
+	//! stepped is called at the end of each day
+	void simulate(Env& env,
+	              MonicaModel& monica,
+	              size_t noOfDays,
+	              function<void()> stepped = function<void()>())
 	{
-		writeDebugInputs(env, "inputs.json");
-	}
-
-	//prefer multiple crop rotations, but use a single rotation if there
-	if(env.cropRotations.empty() && !env.cropRotation.empty())
-		env.cropRotations.push_back(CropRotation(env.climateData.startDate(), 
-																						 env.climateData.endDate(), 
-																						 env.cropRotation));
-
-	debug() << "starting Monica" << endl;
-	debug() << "-----" << endl;
-
-	MonicaModel monica(env.params);
-	monica.simulationParametersNC().startDate = env.climateData.startDate();
-	monica.simulationParametersNC().endDate = env.climateData.endDate();
-
-	debug() << "currentDate" << endl;
-	Date currentDate = env.climateData.startDate();
+		debug() << "currentDate" << endl;
+		Date currentDate = env.climateData.startDate();
 	
-	//auto crit = env.cropRotations.empty() ? env.cropRotations.end() : env.cropRotations.begin();
-	auto crit = env.cropRotations.begin();
+		//auto crit = env.cropRotations.empty() ? env.cropRotations.end() : env.cropRotations.begin();
+		auto crit = env.cropRotations.begin();
 
-	//cropRotation is a shadow of the env.cropRotation, which will hold pointers to CMs in env.cropRotation, but might shrink
-	//if pure absolute CMs are finished
-	vector<CultivationMethod*> cropRotation;
+		//cropRotation is a shadow of the env.cropRotation, which will hold pointers to CMs in env.cropRotation, but might shrink
+		//if pure absolute CMs are finished
+		vector<CultivationMethod*> cropRotation;
 
-	auto checkAndInitShadowOfNextCropRotation = [&](Date currentDate)
-	{
-		if(crit != env.cropRotations.end())
+		auto checkAndInitShadowOfNextCropRotation = [&](Date currentDate)
 		{
-			//if current cropRotation is finished, try to move to next
-			if(crit->end.isValid()
-				 && currentDate == crit->end + 1)
-			{
-				crit++;
-				cropRotation.clear();
-			}
-
-			//check again, because we might have moved to next cropRotation
 			if(crit != env.cropRotations.end())
 			{
-				//if a new cropRotation starts, copy the the pointers to the CMs to the shadow CR
-				if(crit->start.isValid() 
-					 && currentDate == crit->start)
+				//if current cropRotation is finished, try to move to next
+				if(crit->end.isValid()
+					 && currentDate == crit->end + 1)
 				{
-					for(auto& cm : crit->cropRotation)
-						cropRotation.push_back(&cm);
-					return true;
+					crit++;
+					cropRotation.clear();
+				}
+
+				//check again, because we might have moved to next cropRotation
+				if(crit != env.cropRotations.end())
+				{
+					//if a new cropRotation starts, copy the the pointers to the CMs to the shadow CR
+					if(crit->start.isValid() 
+						 && currentDate == crit->start)
+					{
+						for(auto& cm : crit->cropRotation)
+							cropRotation.push_back(&cm);
+						return true;
+					}
 				}
 			}
-		}
-		return false;
-	};
+			return false;
+		};
 
-	//iterator through the crop rotation
-	//auto cmit = cropRotation.empty() ? cropRotation.end() : cropRotation.begin();
-	auto cmit = cropRotation.begin();
+		//iterator through the crop rotation
+		//auto cmit = cropRotation.empty() ? cropRotation.end() : cropRotation.begin();
+		auto cmit = cropRotation.begin();
 
-	auto findNextCultivationMethod = [&](Date currentDate,
-																			 bool advanceToNextCM = true)
-	{
-		CultivationMethod* currentCM = nullptr;
-		Date nextAbsoluteCMApplicationDate;
-
-		//it might be possible that the next cultivation method has to be skipped (if cover/catch crop)
-		bool notFoundNextCM = true;
-		while(notFoundNextCM)
+		auto findNextCultivationMethod = [&](Date currentDate,
+																				 bool advanceToNextCM = true)
 		{
-			if(advanceToNextCM)
+			CultivationMethod* currentCM = nullptr;
+			Date nextAbsoluteCMApplicationDate;
+
+			//it might be possible that the next cultivation method has to be skipped (if cover/catch crop)
+			bool notFoundNextCM = true;
+			while(notFoundNextCM)
 			{
-				//delete fully cultivation methods with only absolute worksteps,
-				//because they won't participate in a new run when wrapping the crop rotation 
-				if((*cmit)->areOnlyAbsoluteWorksteps() 
-					 || !(*cmit)->repeat())
-					cmit = cropRotation.erase(cmit);
-				else
-					cmit++;
+				if(advanceToNextCM)
+				{
+					//delete fully cultivation methods with only absolute worksteps,
+					//because they won't participate in a new run when wrapping the crop rotation 
+					if((*cmit)->areOnlyAbsoluteWorksteps() 
+						 || !(*cmit)->repeat())
+						cmit = cropRotation.erase(cmit);
+					else
+						cmit++;
 
-				//start anew if we reached the end of the crop rotation
-				if(cmit == cropRotation.end())
-					cmit = cropRotation.begin();
-			}
+					//start anew if we reached the end of the crop rotation
+					if(cmit == cropRotation.end())
+						cmit = cropRotation.begin();
+				}
 
-			//check if there's at least a cultivation method left in cropRotation
-			if(cmit != cropRotation.end())
-			{
-				advanceToNextCM = true;
-				currentCM = *cmit;
-				
-				//addedYear tells that the start of the cultivation method was before currentDate and thus the whole 
-				//CM had to be moved into the next year
-				//is possible for relative dates
-				bool addedYear = currentCM->reinit(currentDate);
-				if(addedYear)
+				//check if there's at least a cultivation method left in cropRotation
+				if(cmit != cropRotation.end())
 				{
-					//current CM is a cover crop, check if the latest sowing date would have been before current date, 
-					//if so, skip current CM
-					if(currentCM->isCoverCrop())
+					advanceToNextCM = true;
+					currentCM = *cmit;
+				
+					//addedYear tells that the start of the cultivation method was before currentDate and thus the whole 
+					//CM had to be moved into the next year
+					//is possible for relative dates
+					bool addedYear = currentCM->reinit(currentDate);
+					if(addedYear)
 					{
-						//if current CM's latest sowing date is actually after current date, we have to 
-						//reinit current CM again, but this time prevent shifting it to the next year
-						if(!(notFoundNextCM = currentCM->absLatestSowingDate().withYear(currentDate.year()) < currentDate))
-							currentCM->reinit(currentDate, true);
+						//current CM is a cover crop, check if the latest sowing date would have been before current date, 
+						//if so, skip current CM
+						if(currentCM->isCoverCrop())
+						{
+							//if current CM's latest sowing date is actually after current date, we have to 
+							//reinit current CM again, but this time prevent shifting it to the next year
+							if(!(notFoundNextCM = currentCM->absLatestSowingDate().withYear(currentDate.year()) < currentDate))
+								currentCM->reinit(currentDate, true);
+						}
+						else //if current CM was marked skipable, skip it
+							notFoundNextCM = currentCM->canBeSkipped();
 					}
-					else //if current CM was marked skipable, skip it
-						notFoundNextCM = currentCM->canBeSkipped();
-				}
-				else //not added year or CM was had also absolute dates
-				{
-					if(currentCM->isCoverCrop())
-						notFoundNextCM = currentCM->absLatestSowingDate() < currentDate;
-					else if(currentCM->canBeSkipped())
-						notFoundNextCM = currentCM->absStartDate() < currentDate;
+					else //not added year or CM was had also absolute dates
+					{
+						if(currentCM->isCoverCrop())
+							notFoundNextCM = currentCM->absLatestSowingDate() < currentDate;
+						else if(currentCM->canBeSkipped())
+							notFoundNextCM = currentCM->absStartDate() < currentDate;
+						else
+							notFoundNextCM = false;
+					}
+
+					if(notFoundNextCM)
+						nextAbsoluteCMApplicationDate = Date();
 					else
-						notFoundNextCM = false;
+					{
+						nextAbsoluteCMApplicationDate = currentCM->staticWorksteps().empty() ? Date() : currentCM->absStartDate(false);
+						debug() << "new valid next abs app-date: " << nextAbsoluteCMApplicationDate.toString() << endl;
+					}
 				}
-
-				if(notFoundNextCM)
-					nextAbsoluteCMApplicationDate = Date();
 				else
 				{
-					nextAbsoluteCMApplicationDate = currentCM->staticWorksteps().empty() ? Date() : currentCM->absStartDate(false);
-					debug() << "new valid next abs app-date: " << nextAbsoluteCMApplicationDate.toString() << endl;
+					currentCM = nullptr;
+					nextAbsoluteCMApplicationDate = Date();
+					notFoundNextCM = false;
 				}
 			}
-			else
+
+			return make_pair(currentCM, nextAbsoluteCMApplicationDate);
+		};
+
+		//direct handle to current cultivation method
+		CultivationMethod* currentCM;
+		Date nextAbsoluteCMApplicationDate;
+		tie(currentCM, nextAbsoluteCMApplicationDate) = findNextCultivationMethod(currentDate, false);
+
+		for(size_t d = 0; d < noOfDays; ++d, ++currentDate)
+		{
+			debug() << "currentDate: " << currentDate.toString() << endl;
+
+			if(checkAndInitShadowOfNextCropRotation(currentDate))
 			{
-				currentCM = nullptr;
-				nextAbsoluteCMApplicationDate = Date();
-				notFoundNextCM = false;
+				//cmit = cropRotation.empty() ? cropRotation.end() : cropRotation.begin();
+				cmit = cropRotation.begin();
+				tie(currentCM, nextAbsoluteCMApplicationDate) = findNextCultivationMethod(currentDate, false);
 			}
-		}
+		
+			monica.dailyReset();
 
-		return make_pair(currentCM, nextAbsoluteCMApplicationDate);
-	};
+			monica.setCurrentStepDate(currentDate);
+			monica.setCurrentStepClimateData(env.climateData.allDataForStep(d, env.params.siteParameters.vs_Latitude));
 
-	//direct handle to current cultivation method
-	CultivationMethod* currentCM;
-	Date nextAbsoluteCMApplicationDate;
-	tie(currentCM, nextAbsoluteCMApplicationDate) = findNextCultivationMethod(currentDate, false);
+			// test if monica's crop has been dying in previous step
+			// if yes, it will be incorporated into soil
+			if(monica.cropGrowth() && monica.cropGrowth()->isDying())
+				monica.incorporateCurrentCrop();
 
-	vector<StoreData> store = setupStorage(env.events, env.climateData.startDate(), env.climateData.endDate());
-	
-	for(size_t d = 0, nods = env.climateData.noOfStepsPossible(); d < nods; ++d, ++currentDate)
-	{
-		debug() << "currentDate: " << currentDate.toString() << endl;
+			//try to apply dynamic worksteps
+			if(currentCM)
+				currentCM->apply(&monica);
 
-		if(checkAndInitShadowOfNextCropRotation(currentDate))
-		{
-			//cmit = cropRotation.empty() ? cropRotation.end() : cropRotation.begin();
-			cmit = cropRotation.begin();
-			tie(currentCM, nextAbsoluteCMApplicationDate) = findNextCultivationMethod(currentDate, false);
+			//apply worksteps and cycle through crop rotation
+			if(currentCM && nextAbsoluteCMApplicationDate == currentDate)
+			{
+				debug() << "applying absolute-at: " << nextAbsoluteCMApplicationDate.toString() << endl;
+				currentCM->absApply(nextAbsoluteCMApplicationDate, &monica);
+
+				nextAbsoluteCMApplicationDate = currentCM->nextAbsDate(nextAbsoluteCMApplicationDate);
+						
+				debug() << " next abs app-date: " << nextAbsoluteCMApplicationDate.toString() << endl;
+			}
+
+			//monica main stepping method
+			monica.step();
+
+			if(stepped)
+				stepped();
+
+			//if the next application date is not valid, we're at the end
+			//of the application list of this cultivation method
+			//and go to the next one in the crop rotation
+			if(currentCM 
+				 && currentCM->allDynamicWorkstepsFinished()
+				 && !nextAbsoluteCMApplicationDate.isValid())
+			{
+				//to count the applied fertiliser for the next production process
+				monica.resetFertiliserCounter();
+
+				tie(currentCM, nextAbsoluteCMApplicationDate) = findNextCultivationMethod(currentDate + 1);
+			}
 		}
-		
-		monica.dailyReset();
+	}
 
-		monica.setCurrentStepDate(currentDate);
-		monica.setCurrentStepClimateData(env.climateData.allDataForStep(d, env.params.siteParameters.vs_Latitude));
+	/*!
+	 * Accelerated spin-up of the SOM and SMB pools before day 0.
+	 *
+	 * A copy of the run records the daily forcing of the pools over the first
+	 * SpinUpDays days and the equilibrium of that cycle initialises monica's pools.
+	 * With SpinUpBruteForceYears > 0 the cycle is also simulated that many times
+	 * in a row, each time starting from the pools the last one ended with,
+	 * and the result is compared with the equilibrium, the deviation is returned as warning.
+	 */
+	Errors spinUpSoilOrganicPools(const Env& env, MonicaModel& monica)
+	{
+		Errors es;
+		const auto& sops = env.params.userSoilOrganicParameters;
+		size_t noOfDays = min(size_t(sops.po_SpinUpDays), env.climateData.noOfStepsPossible());
+		if(noOfDays == 0)
+			return es;
 
-		// test if monica's crop has been dying in previous step
-		// if yes, it will be incorporated into soil
-		if(monica.cropGrowth() && monica.cropGrowth()->isDying())
-			monica.incorporateCurrentCrop();
+		//run one cycle with a fresh copy of the model and management, starting from the given pools
+		auto runCycle = [&](const vector<SoilOrganic::SOMPools>& pools, bool recordForcing)
+		{
+			//the worksteps and crops change while they are applied, so each cycle gets its own
+			Env cycleEnv = env;
+			for(auto& cr : cycleEnv.cropRotations)
+				for(auto& cm : cr.cropRotation)
+					cm = cm.deepCopy();
+
+			auto m = make_shared<MonicaModel>(cycleEnv.params);
+			m->simulationParametersNC().startDate = cycleEnv.climateData.startDate();
+			m->simulationParametersNC().endDate = cycleEnv.climateData.endDate();
+			m->soilOrganicNC().set_SOMPools(pools);
+			m->soilOrganicNC().set_RecordSpinUpForcing(recordForcing);
+			simulate(cycleEnv, *m, noOfDays);
+			return m;
+		};
 
-		//try to apply dynamic worksteps
-		if(currentCM)
-			currentCM->apply(&monica);
+		auto initialPools = monica.soilOrganic().get_SOMPools();
+		vector<bool> decayOnly;
+		auto pools = runCycle(initialPools, true)->soilOrganic().spinUpEquilibrium(initialPools, &decayOnly);
 
-		//apply worksteps and cycle through crop rotation
-		if(currentCM && nextAbsoluteCMApplicationDate == currentDate)
+		if(sops.po_SpinUpBruteForceYears > 0)
 		{
-			debug() << "applying absolute-at: " << nextAbsoluteCMApplicationDate.toString() << endl;
-			currentCM->absApply(nextAbsoluteCMApplicationDate, &monica);
+			auto bruteForcePools = initialPools;
+			for(int y = 0; y < sops.po_SpinUpBruteForceYears; y++)
+				bruteForcePools = runCycle(bruteForcePools, false)->soilOrganic().get_SOMPools();
 
-			nextAbsoluteCMApplicationDate = currentCM->nextAbsDate(nextAbsoluteCMApplicationDate);
-						
-			debug() << " next abs app-date: " << nextAbsoluteCMApplicationDate.toString() << endl;
+			double deviation = 0.0;
+			for(size_t i_Layer = 0; i_Layer < pools.size(); i_Layer++)
+			{
+				auto& xb = bruteForcePools.at(i_Layer);
+				const auto& x = pools.at(i_Layer);
+
+				//compare the pool distribution, if the equilibrium has been scaled to the initial carbon
+				if(decayOnly.at(i_Layer) || sops.po_SpinUpKeepTotalCarbon)
+				{
+					const auto& x0 = initialPools.at(i_Layer);
+					double total0 = x0[0] + x0[1] + x0[2] + x0[3];
+					double total = xb[0] + xb[1] + xb[2] + xb[3];
+					if(total > 0.0)
+						for(auto& v : xb)
+							v *= total0 / total;
+				}
+
+				for(size_t i = 0; i < 4; i++)
+					if(x[i] > 0.0)
+						deviation = max(deviation, fabs(xb[i] - x[i]) / x[i]);
+			}
+			monica.soilOrganicNC().set_SpinUpDeviation(deviation);
+
+			ostringstream oss;
+			oss << "SoilOrganic: accelerated spin-up over " << noOfDays
+				<< " days, max. relative deviation from " << sops.po_SpinUpBruteForceYears
+				<< " simulated cycles: " << deviation;
+			es.warnings.push_back(oss.str());
+			debug() << oss.str() << endl;
 		}
 
-		//monica main stepping method
-		monica.step();
+		monica.soilOrganicNC().set_SOMPools(pools);
+		return es;
+	}
+}
+
+Output Monica::runMonica(Env env)
+{
+	Output out;
+	bool returnObjOutputs = env.returnObjOutputs();
+	out.customId = env.customId;
+
+	activateDebug = env.debugMode;
+	if(activateDebug)
+	{
+		writeDebugInputs(env, "inputs.json");
+	}
+
+	//prefer multiple crop rotations, but use a single rotation if there
+	if(env.cropRotations.empty() && !env.cropRotation.empty())
+		env.cropRotations.push_back(CropRotation(env.climateData.startDate(), 
+																						 env.climateData.endDate(), 
+																						 env.cropRotation));
+
+	debug() << "starting Monica" << endl;
+	debug() << "-----" << endl;
+
+	MonicaModel monica(env.params);
+	monica.simulationParametersNC().startDate = env.climateData.startDate();
+	monica.simulationParametersNC().endDate = env.climateData.endDate();
+
+	//equilibrate the SOM/SMB pools before the run starts
+	if(env.params.userSoilOrganicParameters.po_SpinUpDays > 0)
+	{
+		auto es = spinUpSoilOrganicPools(env, monica);
+		out.errors.insert(out.errors.end(), es.errors.begin(), es.errors.end());
+		out.warnings.insert(out.warnings.end(), es.warnings.begin(), es.warnings.end());
+	}
+
+	vector<StoreData> store = setupStorage(env.events, env.climateData.startDate(), env.climateData.endDate());
+	//output ids may address soil layers by depth, which depends on the actual layering
+	for(auto& sd : store)
+		mapOutputDepthsToLayers(sd.outputIds, monica.soilColumn());
 
+	//calculate only the crop diagnostics which are read by outputs, event expressions or SetValue worksteps
+	int cropDiagnostics = NO_CROP_DIAGNOSTICS;
+	for(const auto& sd : store)
+	{
+		cropDiagnostics |= cropDiagnosticsFor(sd.outputIds);
+		cropDiagnostics |= cropDiagnosticsFor(sd.spec.expressionOutputIds);
+	}
+	for(const auto& cr : env.cropRotations)
+	{
+		for(const auto& cm : cr.cropRotation)
+		{
+			for(const auto& wss : {cm.staticWorksteps(), cm.allDynamicWorksteps()})
+			{
+				for(auto ws : wss)
+				{
+					if(auto sv = dynamic_pointer_cast<SetValue>(ws))
+					{
+						//skip the "=" marking a calculated value
+						auto v = sv->value();
+						if(v.is_array() && v.array_items().size() == 4 && v[0] == "=")
+							v = J11Array(v.array_items().begin() + 1, v.array_items().end());
+						cropDiagnostics |= cropDiagnosticsFor(outputIdsInExpression(v));
+					}
+				}
+			}
+		}
+	}
+	monica.setCropDiagnostics(cropDiagnostics);
+	
+	simulate(env, monica, env.climateData.noOfStepsPossible(), [&]()
+	{
 		//store results
 		for(auto& s : store)
 		{
@@ -1239,20 +1357,7 @@ Output Monica::runMonica(Env env)
 			else
 				s.storeResultsIfSpecApplies(monica);
 		}
-
-		//if the next application date is not valid, we're at the end
-		//of the application list of this cultivation method
-		//and go to the next one in the crop rotation
-		if(currentCM 
-			 && currentCM->allDynamicWorkstepsFinished()
-			 && !nextAbsoluteCMApplicationDate.isValid())
-		{
-			//to count the applied fertiliser for the next production process
-			monica.resetFertiliserCounter();
-
-			tie(currentCM, nextAbsoluteCMApplicationDate) = findNextCultivationMethod(currentDate + 1);
-		}
-	}
+	});
 	
 	for(auto& sd : store)
 	{
@@ -146,7 +146,11 @@ namespace Monica
 		EventType eventType{eUnset};
 
 		std::map<std::string, std::string> time2event;
+		//! the interned ids of the events in time2event (-1 = no event)
+		int startEventId{-1}, endEventId{-1}, atEventId{-1}, fromEventId{-1}, toEventId{-1};
 		std::map<std::string, std::function<bool(const MonicaModel&)>> time2expression;
+		//! the outputs the expressions in time2expression refer to
+		std::vector<OId> expressionOutputIds;
 
 		Tools::Maybe<DMY> start;
 		Tools::Maybe<DMY> end;
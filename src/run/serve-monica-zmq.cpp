@@ -36,6 +36,7 @@ Copyright (C) Leibniz Centre for Agricultural Landscape Research (ZALF)
 #include "tools/zmq-helper.h"
 #include "../io/output.h"
 #include "climate/climate-file-io.h"
+#include "env-stream-reader.h"
 
 using namespace std;
 using namespace Monica;
@@ -471,17 +472,35 @@ void Monica::ZmqServer::serveZmqMonicaFull(zmq::context_t* zmqContext,
 					try
 					{
 						Msg msg;
+						//an Env message (which may carry years of climate data) is kept as string
+						//and read by readEnvFromJsonString, without building a JSON DOM of it
+						string envMsgStr;
+						string msgType;
 						zmq::poll(&items[0], distinctControlSocket ? 2 : 1, -1);
 
 						if(items[0].revents & ZMQ_POLLIN)
-							msg = receiveMsg(socket);
+						{
+							auto msgStr = s_recv(socket);
+							msgType = jsonObjectType(msgStr);
+							if(msgType == "Env")
+								envMsgStr.swap(msgStr);
+							else
+							{
+								string err;
+								msg.json = Json::parse(msgStr, err);
+								msg.msg.swap(msgStr);
+							}
+						}
 						if(distinctControlSocket
 							 && items[1].revents & ZMQ_POLLIN)
+						{
 							msg = receiveMsg(controlSocket, topicCharCount);
+							msgType = msg.type();
+							envMsgStr.clear();
+						}
 
 						//auto msg = receiveMsg(socket);
 
-						string msgType = msg.type();
 						if(msgType == "finish")
 						{
 							//only send reply when not in pipeline configuration
@@ -515,9 +534,11 @@ void Monica::ZmqServer::serveZmqMonicaFull(zmq::context_t* zmqContext,
 						}
 						else if(msgType == "Env")
 						{
-							Json& fullMsg = msg.json;
-
-							Env env(msg.json);
+							Env env;
+							auto es = readEnvFromJsonString(envMsgStr, env);
+							string().swap(envMsgStr);
+							for(const auto& e : es.errors)
+								cerr << "Error: " << e << endl;
 							if(!env.climateData.isValid() && !env.pathsToClimateCSV.empty())
 								env.climateData = readClimateDataFromCSVFilesViaHeaders(env.pathsToClimateCSV, env.csvViaHeaderOptions);
 
@@ -528,6 +549,10 @@ void Monica::ZmqServer::serveZmqMonicaFull(zmq::context_t* zmqContext,
 							{
 								return Soil::readCapillaryRiseRates().getRate(soilTexture, distance);
 							};
+							env.params.userSoilMoistureParameters.capillaryRiseRates = capillaryRiseRatesFromDatabase();
+
+							//crops without parameters are loaded in one go, instead of a query per species and cultivar
+							prefetchCropParametersFromMonicaDB(env);
 
 							auto out = runMonica(env);
 